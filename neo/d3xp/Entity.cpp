@@ -220,6 +220,44 @@ void AddRenderGui( const char* name, idUserInterface** gui, const idDict* args )
 	UpdateGuiParms( *gui, args );
 }
 
+// spawn args that are parsed for every entity, interned once so the lookups don't hash strings
+static idDictKey	spawnKey_shader( "shader" );
+static idDictKey	spawnKey_color( "_color" );
+static idDictKey	spawnKey_shaderParm3( "shaderParm3" );
+static idDictKey	spawnKey_shaderParm4( "shaderParm4" );
+static idDictKey	spawnKey_shaderParm5( "shaderParm5" );
+static idDictKey	spawnKey_shaderParm6( "shaderParm6" );
+static idDictKey	spawnKey_shaderParm7( "shaderParm7" );
+static idDictKey	spawnKey_shaderParm8( "shaderParm8" );
+static idDictKey	spawnKey_shaderParm9( "shaderParm9" );
+static idDictKey	spawnKey_shaderParm10( "shaderParm10" );
+static idDictKey	spawnKey_shaderParm11( "shaderParm11" );
+static idDictKey	spawnKey_noDynamicInteractions( "noDynamicInteractions" );
+static idDictKey	spawnKey_noshadows( "noshadows" );
+static idDictKey	spawnKey_noselfshadows( "noselfshadows" );
+static idDictKey	spawnKey_gui( "gui" );
+static idDictKey	spawnKey_s_mindistance( "s_mindistance" );
+static idDictKey	spawnKey_s_maxdistance( "s_maxdistance" );
+static idDictKey	spawnKey_s_volume( "s_volume" );
+static idDictKey	spawnKey_s_shakes( "s_shakes" );
+static idDictKey	spawnKey_s_diversity( "s_diversity" );
+static idDictKey	spawnKey_s_waitfortrigger( "s_waitfortrigger" );
+static idDictKey	spawnKey_s_omni( "s_omni" );
+static idDictKey	spawnKey_s_looping( "s_looping" );
+static idDictKey	spawnKey_s_occlusion( "s_occlusion" );
+static idDictKey	spawnKey_s_global( "s_global" );
+static idDictKey	spawnKey_s_unclamped( "s_unclamped" );
+static idDictKey	spawnKey_s_soundClass( "s_soundClass" );
+static idDictKey	spawnKey_s_shader( "s_shader" );
+static idDictKey	spawnKey_noGrab( "noGrab" );
+static idDictKey	spawnKey_skin_xray( "skin_xray" );
+static idDictKey	spawnKey_cameraTarget( "cameraTarget" );
+static idDictKey	spawnKey_solidForTeam( "solidForTeam" );
+static idDictKey	spawnKey_neverDormant( "neverDormant" );
+static idDictKey	spawnKey_cinematic( "cinematic" );
+static idDictKey	spawnKey_networkSync( "networkSync" );
+static idDictKey	spawnKey_slowmo( "slowmo" );
+
 /*
 ================
 idGameEdit::ParseSpawnArgsToRenderEntity
@@ -239,7 +277,7 @@ void idGameEdit::ParseSpawnArgsToRenderEntity( const idDict* args, renderEntity_
 	
 	memset( renderEntity, 0, sizeof( *renderEntity ) );
 	
-	temp = args->GetString( "model" );
+	temp = args->GetString( dictKey_model );
 	
 	modelDef = NULL;
 	if( temp[0] != '\0' )
@@ -263,7 +301,7 @@ void idGameEdit::ParseSpawnArgsToRenderEntity( const idDict* args, renderEntity_
 		renderEntity->bounds.Zero();
 	}
 	
-	temp = args->GetString( "skin" );
+	temp = args->GetString( dictKey_skin );
 	if( temp[0] != '\0' )
 	{
 		renderEntity->customSkin = declManager->FindSkin( temp );
@@ -273,18 +311,18 @@ void idGameEdit::ParseSpawnArgsToRenderEntity( const idDict* args, renderEntity_
 		renderEntity->customSkin = modelDef->GetDefaultSkin();
 	}
 	
-	temp = args->GetString( "shader" );
+	temp = args->GetString( spawnKey_shader );
 	if( temp[0] != '\0' )
 	{
 		renderEntity->customShader = declManager->FindMaterial( temp );
 	}
 	
-	args->GetVector( "origin", "0 0 0", renderEntity->origin );
+	args->GetVector( dictKey_origin, "0 0 0", renderEntity->origin );
 	
 	// get the rotation matrix in either full form, or single angle form
-	if( !args->GetMatrix( "rotation", "1 0 0 0 1 0 0 0 1", renderEntity->axis ) )
+	if( !args->GetMatrix( dictKey_rotation, "1 0 0 0 1 0 0 0 1", renderEntity->axis ) )
 	{
-		angle = args->GetFloat( "angle" );
+		angle = args->GetFloat( dictKey_angle );
 		if( angle != 0.0f )
 		{
 			renderEntity->axis = idAngles( 0.0f, angle, 0.0f ).ToMat3();
@@ -298,33 +336,33 @@ void idGameEdit::ParseSpawnArgsToRenderEntity( const idDict* args, renderEntity_
 	renderEntity->referenceSound = NULL;
 	
 	// get shader parms
-	args->GetVector( "_color", "1 1 1", color );
+	args->GetVector( spawnKey_color, "1 1 1", color );
 	renderEntity->shaderParms[ SHADERPARM_RED ]		= color[0];
 	renderEntity->shaderParms[ SHADERPARM_GREEN ]	= color[1];
 	renderEntity->shaderParms[ SHADERPARM_BLUE ]	= color[2];
-	renderEntity->shaderParms[ 3 ]					= args->GetFloat( "shaderParm3", "1" );
-	renderEntity->shaderParms[ 4 ]					= args->GetFloat( "shaderParm4", "0" );
-	renderEntity->shaderParms[ 5 ]					= args->GetFloat( "shaderParm5", "0" );
-	renderEntity->shaderParms[ 6 ]					= args->GetFloat( "shaderParm6", "0" );
-	renderEntity->shaderParms[ 7 ]					= args->GetFloat( "shaderParm7", "0" );
-	renderEntity->shaderParms[ 8 ]					= args->GetFloat( "shaderParm8", "0" );
-	renderEntity->shaderParms[ 9 ]					= args->GetFloat( "shaderParm9", "0" );
-	renderEntity->shaderParms[ 10 ]					= args->GetFloat( "shaderParm10", "0" );
-	renderEntity->shaderParms[ 11 ]					= args->GetFloat( "shaderParm11", "0" );
+	renderEntity->shaderParms[ 3 ]					= args->GetFloat( spawnKey_shaderParm3, "1" );
+	renderEntity->shaderParms[ 4 ]					= args->GetFloat( spawnKey_shaderParm4, "0" );
+	renderEntity->shaderParms[ 5 ]					= args->GetFloat( spawnKey_shaderParm5, "0" );
+	renderEntity->shaderParms[ 6 ]					= args->GetFloat( spawnKey_shaderParm6, "0" );
+	renderEntity->shaderParms[ 7 ]					= args->GetFloat( spawnKey_shaderParm7, "0" );
+	renderEntity->shaderParms[ 8 ]					= args->GetFloat( spawnKey_shaderParm8, "0" );
+	renderEntity->shaderParms[ 9 ]					= args->GetFloat( spawnKey_shaderParm9, "0" );
+	renderEntity->shaderParms[ 10 ]					= args->GetFloat( spawnKey_shaderParm10, "0" );
+	renderEntity->shaderParms[ 11 ]					= args->GetFloat( spawnKey_shaderParm11, "0" );
 	
 	// check noDynamicInteractions flag
-	renderEntity->noDynamicInteractions = args->GetBool( "noDynamicInteractions" );
+	renderEntity->noDynamicInteractions = args->GetBool( spawnKey_noDynamicInteractions );
 	
 	// check noshadows flag
-	renderEntity->noShadow = args->GetBool( "noshadows" );
+	renderEntity->noShadow = args->GetBool( spawnKey_noshadows );
 	
 	// check noselfshadows flag
-	renderEntity->noSelfShadow = args->GetBool( "noselfshadows" );
+	renderEntity->noSelfShadow = args->GetBool( spawnKey_noselfshadows );
 	
 	// init any guis, including entity-specific states
 	for( i = 0; i < MAX_RENDERENTITY_GUI; i++ )
 	{
-		temp = args->GetString( i == 0 ? "gui" : va( "gui%d", i + 1 ) );
+		temp = ( i == 0 ) ? args->GetString( spawnKey_gui ) : args->GetString( va( "gui%d", i + 1 ) );
 		if( temp[ 0 ] != '\0' )
 		{
 			AddRenderGui( temp, &renderEntity->gui[ i ], args );
@@ -347,44 +385,44 @@ void idGameEdit::ParseSpawnArgsToRefSound( const idDict* args, refSound_t* refSo
 	
 	memset( refSound, 0, sizeof( *refSound ) );
 	
-	refSound->parms.minDistance = args->GetFloat( "s_mindistance" );
-	refSound->parms.maxDistance = args->GetFloat( "s_maxdistance" );
-	refSound->parms.volume = args->GetFloat( "s_volume" );
-	refSound->parms.shakes = args->GetFloat( "s_shakes" );
+	refSound->parms.minDistance = args->GetFloat( spawnKey_s_mindistance );
+	refSound->parms.maxDistance = args->GetFloat( spawnKey_s_maxdistance );
+	refSound->parms.volume = args->GetFloat( spawnKey_s_volume );
+	refSound->parms.shakes = args->GetFloat( spawnKey_s_shakes );
 	
-	args->GetVector( "origin", "0 0 0", refSound->origin );
+	args->GetVector( dictKey_origin, "0 0 0", refSound->origin );
 	
 	refSound->referenceSound  = NULL;
 	
 	// if a diversity is not specified, every sound start will make
 	// a random one.  Specifying diversity is usefull to make multiple
 	// lights all share the same buzz sound offset, for instance.
-	refSound->diversity = args->GetFloat( "s_diversity", "-1" );
-	refSound->waitfortrigger = args->GetBool( "s_waitfortrigger" );
+	refSound->diversity = args->GetFloat( spawnKey_s_diversity, "-1" );
+	refSound->waitfortrigger = args->GetBool( spawnKey_s_waitfortrigger );
 	
-	if( args->GetBool( "s_omni" ) )
+	if( args->GetBool( spawnKey_s_omni ) )
 	{
 		refSound->parms.soundShaderFlags |= SSF_OMNIDIRECTIONAL;
 	}
-	if( args->GetBool( "s_looping" ) )
+	if( args->GetBool( spawnKey_s_looping ) )
 	{
 		refSound->parms.soundShaderFlags |= SSF_LOOPING;
 	}
-	if( args->GetBool( "s_occlusion" ) )
+	if( args->GetBool( spawnKey_s_occlusion ) )
 	{
 		refSound->parms.soundShaderFlags |= SSF_NO_OCCLUSION;
 	}
-	if( args->GetBool( "s_global" ) )
+	if( args->GetBool( spawnKey_s_global ) )
 	{
 		refSound->parms.soundShaderFlags |= SSF_GLOBAL;
 	}
-	if( args->GetBool( "s_unclamped" ) )
+	if( args->GetBool( spawnKey_s_unclamped ) )
 	{
 		refSound->parms.soundShaderFlags |= SSF_UNCLAMPED;
 	}
-	refSound->parms.soundClass = args->GetInt( "s_soundClass" );
+	refSound->parms.soundClass = args->GetInt( spawnKey_s_soundClass );
 	
-	temp = args->GetString( "s_shader" );
+	temp = args->GetString( spawnKey_s_shader );
 	if( temp[0] != '\0' )
 	{
 		refSound->shader = declManager->FindSound( temp );
@@ -520,7 +558,7 @@ void idEntity::Spawn()
 	
 	gameLocal.RegisterEntity( this, -1, gameLocal.GetSpawnArgs() );
 	
-	spawnArgs.GetString( "classname", NULL, &classname );
+	spawnArgs.GetString( dictKey_classname, NULL, &classname );
 	const idDeclEntityDef* def = gameLocal.FindEntityDef( classname, false );
 	if( def )
 	{
@@ -534,13 +572,13 @@ void idEntity::Spawn()
 	
 	renderEntity.entityNum = entityNumber;
 	
-	noGrab = spawnArgs.GetBool( "noGrab", "0" );
+	noGrab = spawnArgs.GetBool( spawnKey_noGrab, "0" );
 	
 	xraySkin = NULL;
 	renderEntity.xrayIndex = 1;
 	
 	idStr str;
-	if( spawnArgs.GetString( "skin_xray", "", str ) )
+	if( spawnArgs.GetString( spawnKey_skin_xray, "", str ) )
 	{
 		xraySkin = declManager->FindSkin( str.c_str() );
 	}
@@ -559,7 +597,7 @@ void idEntity::Spawn()
 	refSound.listenerId = entityNumber + 1;
 	
 	cameraTarget = NULL;
-	temp = spawnArgs.GetString( "cameraTarget" );
+	temp = spawnArgs.GetString( spawnKey_cameraTarget );
 	if( temp != NULL && temp[0] != '\0' )
 	{
 		// update the camera taget
@@ -571,17 +609,17 @@ void idEntity::Spawn()
 		UpdateGuiParms( renderEntity.gui[ i ], &spawnArgs );
 	}
 	
-	fl.solidForTeam = spawnArgs.GetBool( "solidForTeam", "0" );
-	fl.neverDormant = spawnArgs.GetBool( "neverDormant", "0" );
-	fl.hidden = spawnArgs.GetBool( "hide", "0" );
+	fl.solidForTeam = spawnArgs.GetBool( spawnKey_solidForTeam, "0" );
+	fl.neverDormant = spawnArgs.GetBool( spawnKey_neverDormant, "0" );
+	fl.hidden = spawnArgs.GetBool( dictKey_hide, "0" );
 	if( fl.hidden )
 	{
 		// make sure we're hidden, since a spawn function might not set it up right
 		PostEventMS( &EV_Hide, 0 );
 	}
-	cinematic = spawnArgs.GetBool( "cinematic", "0" );
+	cinematic = spawnArgs.GetBool( spawnKey_cinematic, "0" );
 	
-	networkSync = spawnArgs.FindKey( "networkSync" );
+	networkSync = spawnArgs.FindKey( spawnKey_networkSync );
 	if( networkSync )
 	{
 		fl.networkSync = ( atoi( networkSync->GetValue() ) != 0 );
@@ -599,7 +637,7 @@ void idEntity::Spawn()
 #endif
 	
 	// every object will have a unique name
-	temp = spawnArgs.GetString( "name", va( "%s_%s_%d", GetClassname(), spawnArgs.GetString( "classname" ), entityNumber ) );
+	temp = spawnArgs.GetString( dictKey_name, va( "%s_%s_%d", GetClassname(), spawnArgs.GetString( dictKey_classname ), entityNumber ) );
 	SetName( temp );
 	
 	// if we have targets, wait until all entities are spawned to get them
@@ -616,20 +654,20 @@ void idEntity::Spawn()
 		}
 	}
 	
-	health = spawnArgs.GetInt( "health" );
+	health = spawnArgs.GetInt( dictKey_health );
 	
 	InitDefaultPhysics( origin, axis );
 	
 	SetOrigin( origin );
 	SetAxis( axis );
 	
-	temp = spawnArgs.GetString( "model" );
+	temp = spawnArgs.GetString( dictKey_model );
 	if( temp != NULL && *temp != '\0' )
 	{
 		SetModel( temp );
 	}
 	
-	if( spawnArgs.GetString( "bind", "", &temp ) )
+	if( spawnArgs.GetString( dictKey_bind, "", &temp ) )
 	{
 		PostEventMS( &EV_SpawnBind, 0 );
 	}
@@ -641,7 +679,7 @@ void idEntity::Spawn()
 	}
 	
 	// setup script object
-	if( ShouldConstructScriptObjectAtSpawn() && spawnArgs.GetString( "scriptobject", NULL, &scriptObjectName ) )
+	if( ShouldConstructScriptObjectAtSpawn() && spawnArgs.GetString( dictKey_scriptobject, NULL, &scriptObjectName ) )
 	{
 		if( !scriptObject.SetType( scriptObjectName ) )
 		{
@@ -652,7 +690,7 @@ void idEntity::Spawn()
 	}
 	
 	// determine time group
-	DetermineTimeGroup( spawnArgs.GetBool( "slowmo", "1" ) );
+	DetermineTimeGroup( spawnArgs.GetBool( spawnKey_slowmo, "1" ) );
 }
 
 /*
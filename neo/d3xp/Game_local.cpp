@@ -48,6 +48,7 @@ idCollisionModelManager* 	collisionModelManager = NULL;
 idCVar* 					idCVar::staticVars = NULL;
 
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL | CVAR_SYSTEM, "force generic platform independent SIMD" );
+idCVar com_deterministicMath( "com_deterministicMath", "0", CVAR_BOOL | CVAR_SYSTEM, "use bit reproducible math on every CPU for lock-step simulation and replay verification" );
 
 #endif
 
@@ -212,6 +213,7 @@ void idGameLocal::Clear()
 	}
 	memset( entities, 0, sizeof( entities ) );
 	memset( spawnIds, -1, sizeof( spawnIds ) );
+	stateHashFile = NULL;
 	firstFreeEntityIndex[0] = 0;
 	firstFreeEntityIndex[1] = ENTITYNUM_FIRST_NON_REPLICATED;
 	num_entities = 0;
@@ -305,7 +307,7 @@ void idGameLocal::Init()
 	idCVar::RegisterStaticVars();
 	
 	// initialize processor specific SIMD
-	idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool() );
+	idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool(), com_deterministicMath.GetBool() );
 	
 #endif
 	
@@ -1627,6 +1629,8 @@ void idGameLocal::MapShutdown()
 	
 	MapClear( true );
 	
+	CloseStateHashFile();
+	
 	common->UpdateLevelLoadPacifier();
 	
 	// reset the script to the state it was before the map was started
@@ -2347,6 +2351,149 @@ const idVec3& idGameLocal::GetGravity() const
 	return gravity;
 }
 
+/*
+================
+HashPhysicsState
+
+Hashes the bits of the position, orientation and velocities of every body of the entity.
+================
+*/
+static unsigned int HashPhysicsState( const idEntity* ent )
+{
+	const idPhysics* physics = ent->GetPhysics();
+	
+	unsigned int hash;
+	CRC32_InitChecksum( hash );
+	
+	// articulated figures have a clip model for each body
+	const int numBodies = Max( physics->GetNumClipModels(), 1 );
+	for( int id = 0; id < numBodies; id++ )
+	{
+		CRC32_UpdateChecksum( hash, physics->GetOrigin( id ).ToFloatPtr(), sizeof( idVec3 ) );
+		CRC32_UpdateChecksum( hash, physics->GetAxis( id ).ToFloatPtr(), sizeof( idMat3 ) );
+		CRC32_UpdateChecksum( hash, physics->GetLinearVelocity( id ).ToFloatPtr(), sizeof( idVec3 ) );
+		CRC32_UpdateChecksum( hash, physics->GetAngularVelocity( id ).ToFloatPtr(), sizeof( idVec3 ) );
+	}
+	
+	CRC32_FinishChecksum( hash );
+	return hash;
+}
+
+/*
+================
+idGameLocal::WriteStateHash
+
+Appends the physics state hash of the current frame to g_stateHashFile. The
+entity lines of a frame come before its frame line.
+================
+*/
+void idGameLocal::WriteStateHash()
+{
+	if( g_stateHashFile.GetString()[0] == '\0' )
+	{
+		CloseStateHashFile();
+		return;
+	}
+	
+	if( stateHashFile == NULL || g_stateHashFile.IsModified() )
+	{
+		CloseStateHashFile();
+		g_stateHashFile.ClearModified();
+		
+		stateHashFile = fileSystem->OpenFileWrite( g_stateHashFile.GetString() );
+		if( stateHashFile == NULL )
+		{
+			Warning( "couldn't open %s for writing", g_stateHashFile.GetString() );
+			g_stateHashFile.SetString( "" );
+			return;
+		}
+		stateHashFile->Printf( "// map %s, %s, deterministic math %d\n", GetMapName(), SIMDProcessor->GetName(), idSIMD::IsDeterministic() );
+	}
+	
+	unsigned int frameHash;
+	CRC32_InitChecksum( frameHash );
+	
+	const int seed = random.GetSeed();
+	CRC32_UpdateChecksum( frameHash, &seed, sizeof( seed ) );
+	
+	int numHashed = 0;
+	for( int i = 0; i < MAX_GENTITIES; i++ )
+	{
+		const idEntity* ent = entities[i];
+		if( ent == NULL || ent->GetPhysics() == NULL )
+		{
+			continue;
+		}
+		
+		const unsigned int entityHash = HashPhysicsState( ent );
+		CRC32_UpdateChecksum( frameHash, &i, sizeof( i ) );
+		CRC32_UpdateChecksum( frameHash, &entityHash, sizeof( entityHash ) );
+		numHashed++;
+		
+		if( g_stateHashEntities.GetBool() )
+		{
+			stateHashFile->Printf( "entity %d %08x %s\n", i, entityHash, ent->name.c_str() );
+		}
+	}
+	
+	CRC32_FinishChecksum( frameHash );
+	stateHashFile->Printf( "frame %d %d %08x %d\n", framenum, time, frameHash, numHashed );
+}
+
+/*
+================
+idGameLocal::CloseStateHashFile
+================
+*/
+void idGameLocal::CloseStateHashFile()
+{
+	if( stateHashFile != NULL )
+	{
+		fileSystem->CloseFile( stateHashFile );
+		stateHashFile = NULL;
+	}
+}
+
+/*
+================
+idGameLocal::CreateAnimatorFrames
+
+  Builds the joints of all animated entities in the player PVS on the job
+  threads, instead of one by one when the renderer issues the model callbacks.
+================
+*/
+void idGameLocal::CreateAnimatorFrames()
+{
+	frameAnimators.SetNum( 0 );
+	frameAnimatorTimes.SetNum( 0 );
+	
+	for( idEntity* ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() )
+	{
+		idAnimator* animator = ent->GetAnimator();
+		if( animator == NULL || ent->GetModelDefHandle() == -1 )
+		{
+			continue;
+		}
+		
+		// entities with their own callbacks may change the joints before creating the frame
+		const renderEntity_t* renderEntity = ent->GetRenderEntity();
+		if( renderEntity->callback != idEntity::ModelCallback )
+		{
+			continue;
+		}
+		
+		if( !InPlayerPVS( ent ) )
+		{
+			continue;
+		}
+		
+		frameAnimators.Append( animator );
+		frameAnimatorTimes.Append( GetTimeGroupTime( renderEntity->timeGroup ) );
+	}
+	
+	animationLib.CreateFrames( frameAnimators.Ptr(), frameAnimatorTimes.Ptr(), frameAnimators.Num() );
+}
+
 /*
 ================
 idGameLocal::SortActiveEntityList
@@ -2567,9 +2714,9 @@ void idGameLocal::RunFrame( idUserCmdMgr& cmdMgr, gameReturn_t& ret )
 		
 #ifdef GAME_DLL
 		// allow changing SIMD usage on the fly
-		if( com_forceGenericSIMD.IsModified() )
+		if( com_forceGenericSIMD.IsModified() || com_deterministicMath.IsModified() )
 		{
-			idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool() );
+			idSIMD::InitProcessor( "game", com_forceGenericSIMD.GetBool(), com_deterministicMath.GetBool() );
 		}
 #endif
 		
@@ -2709,6 +2856,12 @@ void idGameLocal::RunFrame( idUserCmdMgr& cmdMgr, gameReturn_t& ret )
 		
 		timer_events.Stop();
 		
+		// build the animation frames for everything the players might see
+		if( g_parallelAnimFrames.GetBool() )
+		{
+			CreateAnimatorFrames();
+		}
+		
 		// free the player pvs
 		FreePlayerPVS();
 		
@@ -2726,6 +2879,12 @@ void idGameLocal::RunFrame( idUserCmdMgr& cmdMgr, gameReturn_t& ret )
 					timer_think.Milliseconds(), timer_events.Milliseconds(), num );
 		}
 		
+		// record the physics state for replay verification
+		if( g_stateHashFile.GetString()[0] != '\0' || stateHashFile != NULL )
+		{
+			WriteStateHash();
+		}
+		
 		BuildReturnValue( ret );
 	}
 	
@@ -3705,12 +3864,12 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 	
 	spawnArgs = args;
 	
-	if( spawnArgs.GetString( "name", "", &name ) )
+	if( spawnArgs.GetString( dictKey_name, "", &name ) )
 	{
 		sprintf( error, " on '%s'", name );
 	}
 	
-	spawnArgs.GetString( "classname", NULL, &classname );
+	spawnArgs.GetString( dictKey_classname, NULL, &classname );
 	
 	const idDeclEntityDef* def = FindEntityDef( classname, false );
 	
@@ -3742,7 +3901,7 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 	}
 	
 	// check if we should spawn a class object
-	spawnArgs.GetString( "spawnclass", NULL, &spawn );
+	spawnArgs.GetString( dictKey_spawnclass, NULL, &spawn );
 	if( spawn )
 	{
 	
@@ -3771,7 +3930,7 @@ bool idGameLocal::SpawnEntityDef( const idDict& args, idEntity** ent, bool setDe
 	}
 	
 	// check if we should call a script function to spawn
-	spawnArgs.GetString( "spawnfunc", NULL, &spawn );
+	spawnArgs.GetString( dictKey_spawnfunc, NULL, &spawn );
 	if( spawn )
 	{
 		const function_t* func = program.FindFunction( spawn );
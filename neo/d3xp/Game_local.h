@@ -635,6 +635,11 @@ private:
 	pvsHandle_t				playerPVS;				// merged pvs of all players
 	pvsHandle_t				playerConnectedAreas;	// all areas connected to any player area
 	
+	idList<idAnimator*>		frameAnimators;			// animators handed to animationLib.CreateFrames
+	idList<int>				frameAnimatorTimes;
+	
+	idFile* 				stateHashFile;			// per frame physics state hashes for g_stateHashFile
+	
 	idVec3					gravity;				// global gravity vector
 	gameState_t				gamestate;				// keeps track of whether we're spawning, shutting down, or normal gameplay
 	bool					influenceActive;		// true when a phantasm is happening
@@ -689,6 +694,9 @@ private:
 	void					FreePlayerPVS();
 	void					UpdateGravity();
 	void					SortActiveEntityList();
+	void					CreateAnimatorFrames();
+	void					WriteStateHash();
+	void					CloseStateHashFile();
 	void					ShowTargets();
 	void					RunDebugInfo();
 	
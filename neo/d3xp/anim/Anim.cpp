@@ -1120,6 +1120,7 @@ idAnimManager::idAnimManager
 */
 idAnimManager::idAnimManager()
 {
+	frameJobList = NULL;
 }
 
 /*
@@ -1142,6 +1143,76 @@ void idAnimManager::Shutdown()
 	animations.DeleteContents();
 	jointnames.Clear();
 	jointnamesHash.Free();
+	
+	if( frameJobList != NULL )
+	{
+		parallelJobManager->FreeJobList( frameJobList );
+		frameJobList = NULL;
+	}
+}
+
+struct animatorFrameJob_t
+{
+	idAnimator* const* 			animators;
+	const int* 					currentTimes;
+	int							numAnimators;
+};
+
+/*
+====================
+CreateAnimatorFramesJob
+====================
+*/
+static void CreateAnimatorFramesJob( animatorFrameJob_t* job )
+{
+	for( int i = 0; i < job->numAnimators; i++ )
+	{
+		job->animators[i]->CreateFrameAhead( job->currentTimes[i] );
+	}
+}
+
+REGISTER_PARALLEL_JOB( CreateAnimatorFramesJob, "CreateAnimatorFramesJob" );
+
+/*
+====================
+idAnimManager::CreateFrames
+
+Every animator only touches its own joints and reads shared model and anim
+data, so the frames can be built in any order. The render callbacks that
+follow find the frames already built for the current time.
+====================
+*/
+void idAnimManager::CreateFrames( idAnimator* const* animators, const int* currentTimes, int numAnimators )
+{
+	const int MIN_ANIMATORS_PER_JOB = 4;
+	const int MAX_FRAME_JOBS = 64;
+	
+	if( numAnimators <= MIN_ANIMATORS_PER_JOB )
+	{
+		animatorFrameJob_t job = { animators, currentTimes, numAnimators };
+		CreateAnimatorFramesJob( &job );
+		return;
+	}
+	
+	if( frameJobList == NULL )
+	{
+		frameJobList = parallelJobManager->AllocJobList( JOBLIST_GAME, JOBLIST_PRIORITY_HIGH, MAX_FRAME_JOBS, 0, NULL );
+	}
+	
+	const int animatorsPerJob = Max( MIN_ANIMATORS_PER_JOB, ( numAnimators + MAX_FRAME_JOBS - 1 ) / MAX_FRAME_JOBS );
+	
+	idStaticList< animatorFrameJob_t, MAX_FRAME_JOBS > jobs;
+	for( int i = 0; i < numAnimators; i += animatorsPerJob )
+	{
+		animatorFrameJob_t* job = jobs.Alloc();
+		job->animators = animators + i;
+		job->currentTimes = currentTimes + i;
+		job->numAnimators = Min( animatorsPerJob, numAnimators - i );
+		frameJobList->AddJob( ( jobRun_t )CreateAnimatorFramesJob, job );
+	}
+	
+	frameJobList->Submit();
+	frameJobList->Wait();
 }
 
 /*
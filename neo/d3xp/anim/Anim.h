@@ -325,6 +325,7 @@ public:
 	const idDeclSkin* 			GetDefaultSkin() const;
 	const idJointQuat* 			GetDefaultPose() const;
 	void						SetupJoints( int* numJoints, idJointMat** jointList, idBounds& frameBounds, bool removeOriginOffset ) const;
+	void						TransformJointHierarchy( idJointMat* jointList ) const;
 	idRenderModel* 				ModelHandle() const;
 	void						GetJointList( const char* jointnames, idList<jointHandle_t>& jointList ) const;
 	const jointInfo_t* 			FindJoint( const char* name ) const;
@@ -349,11 +350,14 @@ public:
 private:
 	void						CopyDecl( const idDeclModelDef* decl );
 	bool						ParseAnim( idLexer& src, int numDefaultAnims );
+	void						SetupJointLevels();
 	
 private:
 	idVec3						offset;
 	idList<jointInfo_t, TAG_ANIM>			joints;
 	idList<int, TAG_ANIM>					jointParents;
+	idList<int, TAG_ANIM>					jointLevels;		// all joints but the root sorted by hierarchy depth
+	idList<int, TAG_ANIM>					jointLevelOffsets;	// first index in jointLevels for each depth, plus one past the end
 	idList<int, TAG_ANIM>					channelJoints[ ANIM_NumAnimChannels ];
 	idRenderModel* 				modelHandle;
 	idList<idAnim*, TAG_ANIM>			anims;
@@ -513,6 +517,7 @@ public:
 	void						ForceUpdate();
 	void						ClearForceUpdate();
 	bool						CreateFrame( int animtime, bool force );
+	bool						CreateFrameAhead( int animtime );
 	bool						FrameHasChanged( int animtime ) const;
 	void						GetDelta( int fromtime, int totime, idVec3& delta ) const;
 	bool						GetDeltaRotation( int fromtime, int totime, idMat3& delta ) const;
@@ -572,6 +577,7 @@ private:
 	
 	mutable int					lastTransformTime;		// mutable because the value is updated in CreateFrame
 	mutable bool				stoppedAnimatingUpdate;
+	bool						frameCreatedAhead;		// set when idAnimManager::CreateFrames built the frame before the render callback
 	bool						removeOriginOffset;
 	bool						forceUpdate;
 	
@@ -612,10 +618,14 @@ public:
 	void						ClearAnimsInUse();
 	void						FlushUnusedAnims();
 	
+	// builds the frames of many animators at once on the job threads
+	void						CreateFrames( idAnimator* const* animators, const int* currentTimes, int numAnimators );
+	
 private:
 	idHashTable<idMD5Anim*>	animations;
 	idStrList					jointnames;
 	idHashIndex					jointnamesHash;
+	idParallelJobList* 			frameJobList;
 };
 
 #endif /* !__ANIM_H__ */
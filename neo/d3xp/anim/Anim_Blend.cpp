@@ -2770,6 +2770,8 @@ void idDeclModelDef::FreeData()
 	anims.DeleteContents( true );
 	joints.Clear();
 	jointParents.Clear();
+	jointLevels.Clear();
+	jointLevelOffsets.Clear();
 	modelHandle	= NULL;
 	skin = NULL;
 	offset.Zero();
@@ -3022,7 +3024,7 @@ void idDeclModelDef::SetupJoints( int* numJoints, idJointMat** jointList, idBoun
 	}
 	
 	// transform the joint hierarchy
-	SIMDProcessor->TransformJoints( list, jointParents.Ptr(), 1, joints.Num() - 1 );
+	TransformJointHierarchy( list );
 	
 	SIMD_INIT_LAST_JOINT( list, num );
 	
@@ -3033,6 +3035,91 @@ void idDeclModelDef::SetupJoints( int* numJoints, idJointMat** jointList, idBoun
 	frameBounds = modelHandle->Bounds( NULL );
 }
 
+/*
+=====================
+idDeclModelDef::TransformJointHierarchy
+
+Transforms all joints but the root from parent space to model space. All
+joints at the same depth only depend on joints at lower depths, so each
+depth is transformed as one batch.
+=====================
+*/
+void idDeclModelDef::TransformJointHierarchy( idJointMat* jointList ) const
+{
+	for( int i = 0; i < jointLevelOffsets.Num() - 1; i++ )
+	{
+		SIMDProcessor->TransformJointsBatch( jointList, jointParents.Ptr(), jointLevels.Ptr() + jointLevelOffsets[i], jointLevelOffsets[i + 1] - jointLevelOffsets[i] );
+	}
+}
+
+/*
+=====================
+idDeclModelDef::SetupJointLevels
+=====================
+*/
+void idDeclModelDef::SetupJointLevels()
+{
+	jointLevels.Clear();
+	jointLevelOffsets.Clear();
+	
+	const int num = jointParents.Num();
+	if( num <= 1 )
+	{
+		return;
+	}
+	
+	idTempArray< int > depth( num );
+	int maxDepth = 0;
+	int numLevelJoints = 0;
+	
+	depth[0] = 0;
+	for( int i = 1; i < num; i++ )
+	{
+		const int parent = jointParents[i];
+		if( parent < 0 )
+		{
+			// a second root is never transformed
+			depth[i] = 0;
+			continue;
+		}
+		assert( parent < i );
+		depth[i] = depth[parent] + 1;
+		maxDepth = Max( maxDepth, depth[i] );
+		numLevelJoints++;
+	}
+	
+	// count the joints per depth and turn the counts into offsets
+	jointLevelOffsets.SetGranularity( 1 );
+	jointLevelOffsets.AssureSize( maxDepth + 1, 0 );
+	for( int i = 1; i < num; i++ )
+	{
+		if( depth[i] > 0 )
+		{
+			jointLevelOffsets[depth[i]]++;
+		}
+	}
+	for( int i = 1; i <= maxDepth; i++ )
+	{
+		jointLevelOffsets[i] += jointLevelOffsets[i - 1];
+	}
+	
+	// fill in the joints in hierarchy order within each depth
+	idTempArray< int > next( maxDepth );
+	for( int i = 0; i < maxDepth; i++ )
+	{
+		next[i] = jointLevelOffsets[i];
+	}
+	jointLevels.SetGranularity( 1 );
+	jointLevels.SetNum( numLevelJoints );
+	for( int i = 1; i < num; i++ )
+	{
+		if( depth[i] > 0 )
+		{
+			jointLevels[next[depth[i] - 1]++] = i;
+		}
+	}
+}
+
 /*
 =====================
 idDeclModelDef::ParseAnim
@@ -3529,6 +3616,8 @@ bool idDeclModelDef::Parse( const char* text, const int textLength, bool allowBi
 	anims.SetGranularity( 1 );
 	anims.SetNum( anims.Num() );
 	
+	SetupJointLevels();
+	
 	return true;
 }
 
@@ -3803,6 +3892,7 @@ idAnimator::idAnimator()
 	joints					= NULL;
 	lastTransformTime		= -1;
 	stoppedAnimatingUpdate	= false;
+	frameCreatedAhead		= false;
 	removeOriginOffset		= false;
 	forceUpdate				= false;
 	
@@ -5178,6 +5268,12 @@ bool idAnimator::CreateFrame( int currentTime, bool force )
 	{
 		if( lastTransformTime == currentTime )
 		{
+			// report a frame built by idAnimManager::CreateFrames as changed to the first caller
+			if( frameCreatedAhead )
+			{
+				frameCreatedAhead = false;
+				return true;
+			}
 			return false;
 		}
 		if( lastTransformTime != -1 && !stoppedAnimatingUpdate && !IsAnimating( currentTime ) )
@@ -5188,6 +5284,7 @@ bool idAnimator::CreateFrame( int currentTime, bool force )
 	
 	lastTransformTime = currentTime;
 	stoppedAnimatingUpdate = false;
+	frameCreatedAhead = false;
 	
 	if( entity && ( ( g_debugAnim.GetInteger() == entity->entityNumber ) || ( g_debugAnim.GetInteger() == -2 ) ) )
 	{
@@ -5421,11 +5518,37 @@ bool idAnimator::CreateFrame( int currentTime, bool force )
 	}
 	
 	// transform the rest of the hierarchy
-	SIMDProcessor->TransformJoints( joints, jointParent, i, numJoints - 1 );
+	if( i == 1 )
+	{
+		// no joint modifications below the root, so the hierarchy can go one depth at a time
+		modelDef->TransformJointHierarchy( joints );
+	}
+	else
+	{
+		SIMDProcessor->TransformJoints( joints, jointParent, i, numJoints - 1 );
+	}
 	
 	return true;
 }
 
+/*
+=====================
+idAnimator::CreateFrameAhead
+
+Builds the frame before the render callback asks for it, the next
+CreateFrame for the same time still reports the frame as changed.
+=====================
+*/
+bool idAnimator::CreateFrameAhead( int currentTime )
+{
+	if( !CreateFrame( currentTime, false ) )
+	{
+		return false;
+	}
+	frameCreatedAhead = true;
+	return true;
+}
+
 /*
 =====================
 idAnimator::ForceUpdate
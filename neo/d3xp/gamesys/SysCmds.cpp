@@ -317,6 +317,251 @@ void Cmd_KillRagdolls_f( const idCmdArgs& args )
 	KillEntities( args, idAFEntity_WithAttachedHead::Type );
 }
 
+/*
+==================
+Cmd_TestRagdolls_f
+
+Drops a pile of ragdolls in front of the player to benchmark the articulated figure LCP solvers.
+==================
+*/
+static void Cmd_TestRagdolls_f( const idCmdArgs& args )
+{
+	const int	ragdollsPerLayer = 9;
+	int			i, count;
+	float		yaw;
+	idVec3		org, center;
+	idPlayer*	player;
+	idDict		dict;
+	
+	player = gameLocal.GetLocalPlayer();
+	if( !player || !gameLocal.CheatsOk( false ) )
+	{
+		return;
+	}
+	
+	if( args.Argc() < 2 || args.Argc() > 4 )
+	{
+		gameLocal.Printf( "usage: testRagdolls <ragdoll entityDef> [count] [iterativeLCP]\n" );
+		return;
+	}
+	
+	count = ( args.Argc() > 2 ) ? atoi( args.Argv( 2 ) ) : 50;
+	yaw = player->viewAngles.yaw;
+	center = player->GetPhysics()->GetOrigin() + idAngles( 0, yaw, 0 ).ToForward() * 160 + idVec3( 0, 0, 32 );
+	
+	for( i = 0; i < count; i++ )
+	{
+		// stack the ragdolls in layers of 3x3 so they fall into a single pile
+		org = center;
+		org.x += ( ( i % ragdollsPerLayer ) % 3 - 1 ) * 40.0f;
+		org.y += ( ( i % ragdollsPerLayer ) / 3 - 1 ) * 40.0f;
+		org.z += ( i / ragdollsPerLayer ) * 48.0f;
+		
+		dict.Clear();
+		dict.Set( "classname", args.Argv( 1 ) );
+		dict.Set( "angle", va( "%f", yaw + 180 + i * 37 ) );
+		dict.Set( "origin", org.ToString() );
+		if( args.Argc() > 3 )
+		{
+			dict.Set( "iterativeLCP", args.Argv( 3 ) );
+		}
+		
+		gameLocal.SpawnEntityDef( dict );
+	}
+	
+	gameLocal.Printf( "spawned %d ragdolls, set af_compareLCP 1 and use printLCPStats to compare the LCP solvers\n", count );
+}
+
+/*
+==================
+Cmd_PrintLCPStats_f
+==================
+*/
+static void Cmd_PrintLCPStats_f( const idCmdArgs& args )
+{
+	idPhysics_AF::PrintLCPStats();
+}
+
+struct stateHashEntity_t
+{
+	int					number;
+	unsigned int		hash;
+	idStr				name;
+};
+
+struct stateHashFrame_t
+{
+	int					frame;
+	int					time;
+	unsigned int		hash;
+	int					firstEntity;
+	int					numEntities;
+};
+
+/*
+==================
+LoadStateHashes
+
+Reads a file written with g_stateHashFile.
+==================
+*/
+static bool LoadStateHashes( const char* fileName, idStr& header, idList<stateHashFrame_t>& frames, idList<stateHashEntity_t>& entities )
+{
+	char* buffer = NULL;
+	const int length = fileSystem->ReadFile( fileName, ( void** )&buffer );
+	if( length <= 0 || buffer == NULL )
+	{
+		gameLocal.Printf( "couldn't read %s\n", fileName );
+		return false;
+	}
+	
+	int firstEntity = 0;
+	
+	idStr line;
+	const char* text = buffer;
+	while( *text != '\0' )
+	{
+		const char* end = strchr( text, '\n' );
+		if( end == NULL )
+		{
+			end = text + strlen( text );
+		}
+		line.Clear();
+		line.Append( text, end - text );
+		text = ( *end != '\0' ) ? end + 1 : end;
+		line.StripTrailingWhitespace();
+		
+		char name[256];
+		stateHashEntity_t entity;
+		stateHashFrame_t frame;
+		int numHashed;
+		
+		if( line.Cmpn( "//", 2 ) == 0 )
+		{
+			header = line.c_str() + 2;
+			header.StripLeading( ' ' );
+		}
+		else if( sscanf( line.c_str(), "entity %d %x %255s", &entity.number, &entity.hash, name ) == 3 )
+		{
+			entity.name = name;
+			entities.Append( entity );
+		}
+		else if( sscanf( line.c_str(), "frame %d %d %x %d", &frame.frame, &frame.time, &frame.hash, &numHashed ) == 4 )
+		{
+			frame.firstEntity = firstEntity;
+			frame.numEntities = entities.Num() - firstEntity;
+			frames.Append( frame );
+			firstEntity = entities.Num();
+		}
+	}
+	
+	fileSystem->FreeFile( buffer );
+	return true;
+}
+
+/*
+==================
+Cmd_CompareStateHashes_f
+
+Reports the first frame where two runs recorded with g_stateHashFile diverge.
+==================
+*/
+static void Cmd_CompareStateHashes_f( const idCmdArgs& args )
+{
+	if( args.Argc() != 3 )
+	{
+		gameLocal.Printf( "usage: compareStateHashes <file1> <file2>\n" );
+		return;
+	}
+	
+	idStr headers[2];
+	idList<stateHashFrame_t> frames[2];
+	idList<stateHashEntity_t> entities[2];
+	
+	for( int i = 0; i < 2; i++ )
+	{
+		if( !LoadStateHashes( args.Argv( 1 + i ), headers[i], frames[i], entities[i] ) )
+		{
+			return;
+		}
+	}
+	
+	if( headers[0] != headers[1] )
+	{
+		gameLocal.Printf( "the runs used different settings:\n  %s\n  %s\n", headers[0].c_str(), headers[1].c_str() );
+	}
+	
+	const int numFrames = Min( frames[0].Num(), frames[1].Num() );
+	for( int i = 0; i < numFrames; i++ )
+	{
+		const stateHashFrame_t& a = frames[0][i];
+		const stateHashFrame_t& b = frames[1][i];
+		
+		if( a.frame != b.frame )
+		{
+			gameLocal.Printf( "frame numbers diverge after %d frames: %d and %d\n", i, a.frame, b.frame );
+			return;
+		}
+		
+		if( a.hash == b.hash )
+		{
+			continue;
+		}
+		
+		gameLocal.Printf( "first diverging frame: %d (time %d and %d ms), %d frames matched\n", a.frame, a.time, b.time, i );
+		
+		if( a.numEntities == 0 || b.numEntities == 0 )
+		{
+			gameLocal.Printf( "set g_stateHashEntities 1 to find the diverging entities\n" );
+			return;
+		}
+		
+		// both entity lists are sorted on the entity number
+		const stateHashEntity_t* ea = &entities[0][a.firstEntity];
+		const stateHashEntity_t* eb = &entities[1][b.firstEntity];
+		int ia = 0;
+		int ib = 0;
+		int numDiverged = 0;
+		while( ( ia < a.numEntities || ib < b.numEntities ) && numDiverged < 10 )
+		{
+			if( ib >= b.numEntities || ( ia < a.numEntities && ea[ia].number < eb[ib].number ) )
+			{
+				gameLocal.Printf( "  entity %d '%s' only exists in %s\n", ea[ia].number, ea[ia].name.c_str(), args.Argv( 1 ) );
+				ia++;
+				numDiverged++;
+			}
+			else if( ia >= a.numEntities || eb[ib].number < ea[ia].number )
+			{
+				gameLocal.Printf( "  entity %d '%s' only exists in %s\n", eb[ib].number, eb[ib].name.c_str(), args.Argv( 2 ) );
+				ib++;
+				numDiverged++;
+			}
+			else
+			{
+				if( ea[ia].hash != eb[ib].hash || ea[ia].name != eb[ib].name )
+				{
+					gameLocal.Printf( "  entity %d '%s' differs\n", ea[ia].number, ea[ia].name.c_str() );
+					numDiverged++;
+				}
+				ia++;
+				ib++;
+			}
+		}
+		if( numDiverged == 0 )
+		{
+			gameLocal.Printf( "  all entity states match, the random seed differs\n" );
+		}
+		return;
+	}
+	
+	gameLocal.Printf( "%d frames match\n", numFrames );
+	if( frames[0].Num() != frames[1].Num() )
+	{
+		const int longer = ( frames[0].Num() > frames[1].Num() ) ? 0 : 1;
+		gameLocal.Printf( "%s has %d more frames\n", args.Argv( 1 + longer ), frames[longer].Num() - numFrames );
+	}
+}
+
 /*
 ==================
 Cmd_Give_f
@@ -2652,6 +2897,81 @@ void Cmd_TestId_f( const idCmdArgs& args )
 }
 
 
+/*
+===============
+Cmd_BenchSpawnArgs_f
+
+times the spawn arg lookups every entity does when it spawns, once by string and once with interned keys
+===============
+*/
+void Cmd_BenchSpawnArgs_f( const idCmdArgs& args )
+{
+	static const char* spawnKeys[] =
+	{
+		"classname", "name", "spawnclass", "spawnfunc", "slowmo", "model", "skin", "shader", "origin", "rotation", "angle", "_color",
+		"shaderParm3", "shaderParm4", "shaderParm5", "shaderParm6", "shaderParm7", "shaderParm8", "shaderParm9", "shaderParm10", "shaderParm11",
+		"noDynamicInteractions", "noshadows", "noselfshadows", "gui", "s_mindistance", "s_maxdistance", "s_volume", "s_shakes", "s_diversity",
+		"s_waitfortrigger", "s_omni", "s_looping", "s_occlusion", "s_global", "s_unclamped", "s_soundClass", "s_shader", "noGrab", "skin_xray",
+		"cameraTarget", "solidForTeam", "neverDormant", "hide", "cinematic", "networkSync", "health", "bind", "scriptobject"
+	};
+	const int numKeys = sizeof( spawnKeys ) / sizeof( spawnKeys[0] );
+	
+	int numPasses = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 100;
+	numPasses = Max( numPasses, 1 );
+	
+	idList< idDictKey* > keys;
+	for( int i = 0; i < numKeys; i++ )
+	{
+		keys.Append( new idDictKey( spawnKeys[i] ) );
+	}
+	
+	idList< const idDict* > dicts;
+	for( idEntity* ent = gameLocal.spawnedEntities.Next(); ent != NULL; ent = ent->spawnNode.Next() )
+	{
+		dicts.Append( &ent->spawnArgs );
+	}
+	
+	int found = 0;
+	
+	uint64 start = Sys_Microseconds();
+	for( int pass = 0; pass < numPasses; pass++ )
+	{
+		for( int i = 0; i < dicts.Num(); i++ )
+		{
+			for( int j = 0; j < numKeys; j++ )
+			{
+				found += ( dicts[i]->FindKey( spawnKeys[j] ) != NULL );
+			}
+		}
+	}
+	const int stringTime = ( int )( Sys_Microseconds() - start );
+	
+	start = Sys_Microseconds();
+	for( int pass = 0; pass < numPasses; pass++ )
+	{
+		for( int i = 0; i < dicts.Num(); i++ )
+		{
+			for( int j = 0; j < numKeys; j++ )
+			{
+				found -= ( dicts[i]->FindKey( *keys[j] ) != NULL );
+			}
+		}
+	}
+	const int internedTime = ( int )( Sys_Microseconds() - start );
+	
+	keys.DeleteContents();
+	
+	if( found != 0 )
+	{
+		gameLocal.Warning( "interned key lookups disagree with string lookups" );
+	}
+	
+	const int numLookups = numPasses * dicts.Num() * numKeys;
+	gameLocal.Printf( "%d entities, %d keys, %d passes, %d lookups\n", dicts.Num(), numKeys, numPasses, numLookups );
+	gameLocal.Printf( "string keys:   %6d usec (%5.1f nsec per lookup)\n", stringTime, stringTime * 1000.0f / Max( numLookups, 1 ) );
+	gameLocal.Printf( "interned keys: %6d usec (%5.1f nsec per lookup)\n", internedTime, internedTime * 1000.0f / Max( numLookups, 1 ) );
+}
+
 /*
 =================
 idGameLocal::InitConsoleCommands
@@ -2669,6 +2989,7 @@ void idGameLocal::InitConsoleCommands()
 	cmdSystem->AddCommand( "listActiveEntities",	Cmd_ActiveEntityList_f,		CMD_FL_GAME | CMD_FL_CHEAT,	"lists active game entities" );
 	cmdSystem->AddCommand( "listMonsters",			idAI::List_f,				CMD_FL_GAME | CMD_FL_CHEAT,	"lists monsters" );
 	cmdSystem->AddCommand( "listSpawnArgs",			Cmd_ListSpawnArgs_f,		CMD_FL_GAME | CMD_FL_CHEAT,	"list the spawn args of an entity", idGameLocal::ArgCompletion_EntityName );
+	cmdSystem->AddCommand( "benchSpawnArgs",		Cmd_BenchSpawnArgs_f,		CMD_FL_GAME | CMD_FL_CHEAT,	"times the spawn arg lookups of all entities with string and interned keys" );
 	cmdSystem->AddCommand( "say",					Cmd_Say_f,					CMD_FL_GAME,				"text chat" );
 	cmdSystem->AddCommand( "sayTeam",				Cmd_SayTeam_f,				CMD_FL_GAME,				"team text chat" );
 	cmdSystem->AddCommand( "addChatLine",			Cmd_AddChatLine_f,			CMD_FL_GAME,				"internal use - core to game chat lines" );
@@ -2688,6 +3009,9 @@ void idGameLocal::InitConsoleCommands()
 	cmdSystem->AddCommand( "killMonsters",			Cmd_KillMonsters_f,			CMD_FL_GAME | CMD_FL_CHEAT,	"removes all monsters" );
 	cmdSystem->AddCommand( "killMoveables",			Cmd_KillMovables_f,			CMD_FL_GAME | CMD_FL_CHEAT,	"removes all moveables" );
 	cmdSystem->AddCommand( "killRagdolls",			Cmd_KillRagdolls_f,			CMD_FL_GAME | CMD_FL_CHEAT,	"removes all ragdolls" );
+	cmdSystem->AddCommand( "testRagdolls",			Cmd_TestRagdolls_f,			CMD_FL_GAME | CMD_FL_CHEAT,	"drops a pile of ragdolls in front of the player", idCmdSystem::ArgCompletion_Decl<DECL_ENTITYDEF> );
+	cmdSystem->AddCommand( "printLCPStats",			Cmd_PrintLCPStats_f,		CMD_FL_GAME,				"prints and clears the LCP solver statistics gathered with af_compareLCP" );
+	cmdSystem->AddCommand( "compareStateHashes",	Cmd_CompareStateHashes_f,	CMD_FL_GAME,				"reports the first frame where two runs recorded with g_stateHashFile diverge" );
 	cmdSystem->AddCommand( "addline",				Cmd_AddDebugLine_f,			CMD_FL_GAME | CMD_FL_CHEAT,	"adds a debug line" );
 	cmdSystem->AddCommand( "addarrow",				Cmd_AddDebugLine_f,			CMD_FL_GAME | CMD_FL_CHEAT,	"adds a debug arrow" );
 	cmdSystem->AddCommand( "removeline",			Cmd_RemoveDebugLine_f,		CMD_FL_GAME | CMD_FL_CHEAT,	"removes a debug line" );
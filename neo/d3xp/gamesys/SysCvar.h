@@ -47,6 +47,7 @@ extern idCVar	g_muzzleFlash;
 extern idCVar	g_disasm;
 extern idCVar	g_debugBounds;
 extern idCVar	g_debugAnim;
+extern idCVar	g_parallelAnimFrames;
 extern idCVar	g_debugMove;
 extern idCVar	g_debugDamage;
 extern idCVar	g_debugWeapon;
@@ -79,6 +80,8 @@ extern idCVar	g_showEnemies;
 
 extern idCVar	g_frametime;
 extern idCVar	g_timeentities;
+extern idCVar	g_stateHashFile;
+extern idCVar	g_stateHashEntities;
 
 extern idCVar	ai_debugScript;
 extern idCVar	ai_debugMove;
@@ -149,6 +152,8 @@ extern idCVar	af_showTotalMass;
 extern idCVar	af_showInertia;
 extern idCVar	af_showVelocity;
 extern idCVar	af_showActive;
+extern idCVar	af_iterativeLCP;
+extern idCVar	af_compareLCP;
 extern idCVar	af_testSolid;
 
 extern idCVar	rb_showTimings;
@@ -520,8 +520,8 @@ idMenuHandler_Scoreboard::GetUserID
 */
 void idMenuHandler_Scoreboard::GetUserID( int slot, lobbyUserID_t& luid )
 {
-	idList< int > redList;
-	idList< int > blueList;
+	idList< int, TAG_FRAME_ARENA > redList;
+	idList< int, TAG_FRAME_ARENA > blueList;
 	
 	for( int i = 0; i < scoreboardInfo.Num(); ++i )
 	{
@@ -535,7 +535,7 @@ void idMenuHandler_Scoreboard::GetUserID( int slot, lobbyUserID_t& luid )
 		}
 	}
 	
-	idList< int > displayList;
+	idList< int, TAG_FRAME_ARENA > displayList;
 	
 	for( int i = 0; i < redList.Num(); ++i )
 	{
@@ -40,15 +40,16 @@ typedef struct clipSector_s
 	int						axis;		// -1 = leaf node
 	float					dist;
 	struct clipSector_s* 	children[2];
-	struct clipLink_s* 		clipLinks;
+	// links and absolute bounds of the clip models in a leaf node, bounds[i] belongs to links[i]
+	idList<struct clipLink_s*, TAG_PHYSICS_CLIP>	links;
+	idBoundsBatch			bounds;
 } clipSector_t;
 
 typedef struct clipLink_s
 {
 	idClipModel* 			clipModel;
 	struct clipSector_s* 	sector;
-	struct clipLink_s* 		prevInSector;
-	struct clipLink_s* 		nextInSector;
+	int						index;		// index into the sector links and bounds
 	struct clipLink_s* 		nextLink;
 } clipLink_t;
 
@@ -656,17 +657,14 @@ void idClipModel::Unlink()
 	for( link = clipLinks; link; link = clipLinks )
 	{
 		clipLinks = link->nextLink;
-		if( link->prevInSector )
-		{
-			link->prevInSector->nextInSector = link->nextInSector;
-		}
-		else
-		{
-			link->sector->clipLinks = link->nextInSector;
-		}
-		if( link->nextInSector )
+		
+		// move the last link of the sector into the freed slot
+		clipSector_t* sector = link->sector;
+		sector->links.RemoveIndexFast( link->index );
+		sector->bounds.RemoveIndexFast( link->index );
+		if( link->index < sector->links.Num() )
 		{
-			link->nextInSector->prevInSector = link->prevInSector;
+			sector->links[link->index]->index = link->index;
 		}
 		clipLinkAllocator.Free( link );
 	}
@@ -701,13 +699,9 @@ void idClipModel::Link_r( struct clipSector_s* node )
 	link = clipLinkAllocator.Alloc();
 	link->clipModel = this;
 	link->sector = node;
-	link->nextInSector = node->clipLinks;
-	link->prevInSector = NULL;
-	if( node->clipLinks )
-	{
-		node->clipLinks->prevInSector = link;
-	}
-	node->clipLinks = link;
+	link->index = node->links.Append( link );
+	node->bounds.Append( absBounds );
+	assert( node->bounds.Num() == node->links.Num() );
 	link->nextLink = clipLinks;
 	clipLinks = link;
 }
@@ -834,6 +828,7 @@ clipSector_t* idClip::CreateClipSectors_r( const int depth, const idBounds& boun
 	{
 		anode->axis = -1;
 		anode->children[0] = anode->children[1] = NULL;
+		anode->bounds.SetMemTag( TAG_PHYSICS_CLIP );
 		
 		for( i = 0; i < 3; i++ )
 		{
@@ -884,7 +879,6 @@ void idClip::Init()
 	
 	// clear clip sectors
 	clipSectors = new( TAG_PHYSICS_CLIP ) clipSector_t[MAX_SECTORS];
-	memset( clipSectors, 0, MAX_SECTORS * sizeof( clipSector_t ) );
 	numClipSectors = 0;
 	touchCount = -1;
 	// get world map bounds
@@ -913,6 +907,7 @@ void idClip::Shutdown()
 {
 	delete[] clipSectors;
 	clipSectors = NULL;
+	touchScratch.Clear();
 	
 	// free the trace model used for the temporaryClipModel
 	if( temporaryClipModel.traceModelIndex != -1 )
@@ -965,9 +960,18 @@ void idClip::ClipModelsTouchingBounds_r( const struct clipSector_s* node, listPa
 		}
 	}
 	
-	for( clipLink_t* link = node->clipLinks; link; link = link->nextInSector )
+	if( node->links.Num() == 0 )
 	{
-		idClipModel*	check = link->clipModel;
+		return;
+	}
+	
+	// find all clip models in the sector with bounds that really do overlap
+	int* indexes = ( int* ) _alloca16( node->links.Num() * sizeof( int ) );
+	const int numIndexes = node->bounds.IntersectsBounds( parms.bounds, indexes );
+	
+	for( int i = 0; i < numIndexes; i++ )
+	{
+		idClipModel*	check = node->links[indexes[i]]->clipModel;
 		
 		// if the clip model is enabled
 		if( !check->enabled )
@@ -987,17 +991,6 @@ void idClip::ClipModelsTouchingBounds_r( const struct clipSector_s* node, listPa
 			continue;
 		}
 		
-		// if the bounds really do overlap
-		if(	check->absBounds[0][0] > parms.bounds[1][0] ||
-				check->absBounds[1][0] < parms.bounds[0][0] ||
-				check->absBounds[0][1] > parms.bounds[1][1] ||
-				check->absBounds[1][1] < parms.bounds[0][1] ||
-				check->absBounds[0][2] > parms.bounds[1][2] ||
-				check->absBounds[1][2] < parms.bounds[0][2] )
-		{
-			continue;
-		}
-		
 		if( parms.count >= parms.maxCount )
 		{
 			gameLocal.Warning( "idClip::ClipModelsTouchingBounds_r: max count" );
@@ -1005,8 +998,7 @@ void idClip::ClipModelsTouchingBounds_r( const struct clipSector_s* node, listPa
 		}
 		
 		check->touchCount = touchCount;
-		parms.list[parms.count] = check;
-		parms.count++;
+		parms.list[parms.count++] = check;
 	}
 }
 
@@ -1041,6 +1033,32 @@ int idClip::ClipModelsTouchingBounds( const idBounds& bounds, int contentMask, i
 	return parms.count;
 }
 
+/*
+================
+idClip::ClipModelsTouchingBounds
+
+  Same as above, but the list is only as large as needed instead of
+  being a MAX_GENTITIES array on the stack. The models are gathered in
+  a scratch list first, so the frame arena gets a single allocation
+  instead of one for every time the list would grow.
+================
+*/
+int idClip::ClipModelsTouchingBounds( const idBounds& bounds, int contentMask, clipModelList_t& clipModelList ) const
+{
+	if( touchScratch.Num() == 0 )
+	{
+		touchScratch.SetNum( MAX_GENTITIES );
+	}
+	
+	const int count = ClipModelsTouchingBounds( bounds, contentMask, touchScratch.Ptr(), touchScratch.Num() );
+	clipModelList.SetNum( count );
+	if( count > 0 )
+	{
+		memcpy( clipModelList.Ptr(), touchScratch.Ptr(), count * sizeof( clipModelList[0] ) );
+	}
+	return count;
+}
+
 /*
 ================
 idClip::EntitiesTouchingBounds
@@ -1048,10 +1066,10 @@ idClip::EntitiesTouchingBounds
 */
 int idClip::EntitiesTouchingBounds( const idBounds& bounds, int contentMask, idEntity** entityList, int maxCount ) const
 {
-	idClipModel* clipModelList[MAX_GENTITIES];
+	clipModelList_t clipModelList;
 	int i, j, count, entCount;
 	
-	count = idClip::ClipModelsTouchingBounds( bounds, contentMask, clipModelList, MAX_GENTITIES );
+	count = idClip::ClipModelsTouchingBounds( bounds, contentMask, clipModelList );
 	entCount = 0;
 	for( i = 0; i < count; i++ )
 	{
@@ -1089,13 +1107,13 @@ idClip::GetTraceClipModels
   cm->owner == passOwner ( don't interact with other missiles from same owner )
 ====================
 */
-int idClip::GetTraceClipModels( const idBounds& bounds, int contentMask, const idEntity* passEntity, idClipModel** clipModelList ) const
+int idClip::GetTraceClipModels( const idBounds& bounds, int contentMask, const idEntity* passEntity, clipModelList_t& clipModelList ) const
 {
 	int i, num;
 	idClipModel*	cm;
 	idEntity* passOwner;
 	
-	num = ClipModelsTouchingBounds( bounds, contentMask, clipModelList, MAX_GENTITIES );
+	num = ClipModelsTouchingBounds( bounds, contentMask, clipModelList );
 	
 	if( !passEntity )
 	{
@@ -1248,7 +1266,8 @@ void idClip::TranslationEntities( trace_t& results, const idVec3& start, const i
 								  const idClipModel* mdl, const idMat3& trmAxis, int contentMask, const idEntity* passEntity )
 {
 	int i, num;
-	idClipModel* touch, *clipModelList[MAX_GENTITIES];
+	idClipModel* touch;
+	clipModelList_t clipModelList;
 	idBounds traceBounds;
 	float radius;
 	trace_t trace;
@@ -1321,7 +1340,8 @@ bool idClip::Translation( trace_t& results, const idVec3& start, const idVec3& e
 						  const idClipModel* mdl, const idMat3& trmAxis, int contentMask, const idEntity* passEntity )
 {
 	int i, num;
-	idClipModel* touch, *clipModelList[MAX_GENTITIES];
+	idClipModel* touch;
+	clipModelList_t clipModelList;
 	idBounds traceBounds;
 	float radius;
 	trace_t trace;
@@ -1411,7 +1431,8 @@ bool idClip::Rotation( trace_t& results, const idVec3& start, const idRotation&
 					   const idClipModel* mdl, const idMat3& trmAxis, int contentMask, const idEntity* passEntity )
 {
 	int i, num;
-	idClipModel* touch, *clipModelList[MAX_GENTITIES];
+	idClipModel* touch;
+	clipModelList_t clipModelList;
 	idBounds traceBounds;
 	trace_t trace;
 	const idTraceModel* trm;
@@ -1491,7 +1512,8 @@ bool idClip::Motion( trace_t& results, const idVec3& start, const idVec3& end, c
 					 const idClipModel* mdl, const idMat3& trmAxis, int contentMask, const idEntity* passEntity )
 {
 	int i, num;
-	idClipModel* touch, *clipModelList[MAX_GENTITIES];
+	idClipModel* touch;
+	clipModelList_t clipModelList;
 	idVec3 dir, endPosition;
 	idBounds traceBounds;
 	float radius;
@@ -1689,7 +1711,8 @@ int idClip::Contacts( contactInfo_t* contacts, const int maxContacts, const idVe
 					  const idClipModel* mdl, const idMat3& trmAxis, int contentMask, const idEntity* passEntity )
 {
 	int i, j, num, n, numContacts;
-	idClipModel* touch, *clipModelList[MAX_GENTITIES];
+	idClipModel* touch;
+	clipModelList_t clipModelList;
 	idBounds traceBounds;
 	const idTraceModel* trm;
 	
@@ -1773,7 +1796,8 @@ idClip::Contents
 int idClip::Contents( const idVec3& start, const idClipModel* mdl, const idMat3& trmAxis, int contentMask, const idEntity* passEntity )
 {
 	int i, num, contents;
-	idClipModel* touch, *clipModelList[MAX_GENTITIES];
+	idClipModel* touch;
+	clipModelList_t clipModelList;
 	idBounds traceBounds;
 	const idTraceModel* trm;
 	
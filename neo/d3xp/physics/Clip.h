@@ -272,6 +272,9 @@ ID_INLINE const idTraceModel* idClipModel::GetTraceModel() const
 //
 //===============================================================
 
+// the clip models found by a single trace or query, taken from the frame arena in one allocation
+typedef idList<idClipModel*, TAG_FRAME_ARENA> clipModelList_t;
+
 class idClip
 {
 
@@ -325,6 +328,7 @@ public:
 	// get entities/clip models within or touching the given bounds
 	int						EntitiesTouchingBounds( const idBounds& bounds, int contentMask, idEntity** entityList, int maxCount ) const;
 	int						ClipModelsTouchingBounds( const idBounds& bounds, int contentMask, idClipModel** clipModelList, int maxCount ) const;
+	int						ClipModelsTouchingBounds( const idBounds& bounds, int contentMask, clipModelList_t& clipModelList ) const;
 	
 	const idBounds& 		GetWorldBounds() const;
 	idClipModel* 			DefaultClipModel();
@@ -341,6 +345,8 @@ private:
 	idClipModel				temporaryClipModel;
 	idClipModel				defaultClipModel;
 	mutable int				touchCount;
+	// the clip models are gathered here before they are copied to a clipModelList_t of the right size
+	mutable idList<idClipModel*, TAG_IDLIB_LIST_PHYSICS> touchScratch;
 	// statistics
 	int						numTranslations;
 	int						numRotations;
@@ -353,7 +359,7 @@ private:
 	struct clipSector_s* 	CreateClipSectors_r( const int depth, const idBounds& bounds, idVec3& maxSector );
 	void					ClipModelsTouchingBounds_r( const struct clipSector_s* node, struct listParms_s& parms ) const;
 	const idTraceModel* 	TraceModelForClipModel( const idClipModel* mdl ) const;
-	int						GetTraceClipModels( const idBounds& bounds, int contentMask, const idEntity* passEntity, idClipModel** clipModelList ) const;
+	int						GetTraceClipModels( const idBounds& bounds, int contentMask, const idEntity* passEntity, clipModelList_t& clipModelList ) const;
 	void					TraceRenderModel( trace_t& trace, const idVec3& start, const idVec3& end, const float radius, const idMat3& axis, idClipModel* touch ) const;
 };
 
@@ -40,6 +40,7 @@ const float LIMIT_ERROR_REDUCTION			= 0.3f;
 const float LCP_EPSILON						= 1e-7f;
 const float LIMIT_LCP_EPSILON				= 1e-4f;
 const float CONTACT_LCP_EPSILON				= 1e-6f;
+const float CONTACT_WARM_START_DISTANCE		= 1.0f;
 const float CENTER_OF_MASS_EPSILON			= 1e-4f;
 const float NO_MOVE_TIME					= 1.0f;
 const float NO_MOVE_TRANSLATION_TOLERANCE	= 10.0f;
@@ -62,6 +63,19 @@ static int numArticulatedFigures = 0;
 static idTimer timer_total, timer_pc, timer_ac, timer_collision, timer_lcp;
 #endif
 
+// statistics gathered with af_compareLCP
+typedef struct lcpStats_s
+{
+	int						numSolves;
+	int						numFailed;
+	int						numRows;
+	int						numIterations;
+	int						maxIterations;
+	double					msec;
+} lcpStats_t;
+
+static lcpStats_t lcpStats[2];		// symmetric, gauss-seidel
+
 
 
 //===============================================================
@@ -3408,6 +3422,14 @@ void idAFConstraint_Contact::Setup( idAFBody* b1, idAFBody* b2, contactInfo_t& c
 	
 	assert( b1 );
 	
+	// keep the multiplier of the previous frame as the initial guess for the iterative LCP solver
+	// as long as this is still the same contact
+	if( body1 != b1 || body2 != b2 || contact.entityNum != c.entityNum || contact.id != c.id ||
+			( contact.point - c.point ).LengthSqr() > Square( CONTACT_WARM_START_DISTANCE ) )
+	{
+		lm.Zero();
+	}
+	
 	body1 = b1;
 	body2 = b2;
 	contact = c;
@@ -5663,6 +5685,67 @@ void idPhysics_AF::PrimaryForces( float timeStep )
 	}
 }
 
+/*
+================
+CompareLCP
+
+  Solves the same auxiliary constraint problem with both LCP solvers and gathers statistics.
+================
+*/
+static void CompareLCP( idLCP* symmetric, idLCP* gaussSeidel, const idMatX& jmk, const idVecX& lm, const idVecX& rhs, const idVecX& lo, const idVecX& hi, const int* boxIndex )
+{
+	idLCP* solvers[2] = { symmetric, gaussSeidel };
+	idVecX x;
+	idTimer timer;
+	
+	x.SetData( lm.GetSize(), VECX_ALLOCA( lm.GetSize() ) );
+	
+	for( int i = 0; i < 2; i++ )
+	{
+		lcpStats_t& stats = lcpStats[i];
+		
+		x = lm;
+		timer.Clear();
+		timer.Start();
+		if( !solvers[i]->Solve( jmk, x, rhs, lo, hi, boxIndex ) )
+		{
+			stats.numFailed++;
+		}
+		timer.Stop();
+		
+		stats.numSolves++;
+		stats.numRows += lm.GetSize();
+		stats.numIterations += solvers[i]->GetNumIterations();
+		stats.maxIterations = Max( stats.maxIterations, solvers[i]->GetNumIterations() );
+		stats.msec += timer.Milliseconds();
+	}
+}
+
+/*
+================
+idPhysics_AF::PrintLCPStats
+================
+*/
+void idPhysics_AF::PrintLCPStats()
+{
+	const char* names[2] = { "symmetric", "gauss-seidel" };
+	
+	gameLocal.Printf( "%12s %8s %6s %8s %10s %8s %10s\n", "solver", "solves", "failed", "rows", "iterations", "max", "msec" );
+	for( int i = 0; i < 2; i++ )
+	{
+		const lcpStats_t& stats = lcpStats[i];
+		gameLocal.Printf( "%12s %8d %6d %8d %10d %8d %10.2f\n", names[i], stats.numSolves, stats.numFailed, stats.numRows,
+						  stats.numIterations, stats.maxIterations, stats.msec );
+	}
+	if( lcpStats[0].numSolves > 0 && lcpStats[1].msec > 0.0 )
+	{
+		gameLocal.Printf( "average iterations %1.1f vs %1.1f, gauss-seidel speedup %1.2fx\n",
+						  ( float ) lcpStats[0].numIterations / lcpStats[0].numSolves, ( float ) lcpStats[1].numIterations / lcpStats[1].numSolves,
+						  lcpStats[0].msec / lcpStats[1].msec );
+	}
+	memset( lcpStats, 0, sizeof( lcpStats ) );
+}
+
 /*
 ================
 idPhysics_AF::AuxiliaryForces
@@ -5873,15 +5956,23 @@ void idPhysics_AF::AuxiliaryForces( float timeStep )
 				boxIndex[k] = -1;
 			}
 			jmk[k][k] += constraint->e[j] * invStep;
+			
+			// the multipliers of the previous frame are the initial guess for the iterative solver
+			lm[k] = constraint->lm[j];
 		}
 	}
 	
+	if( af_compareLCP.GetBool() )
+	{
+		CompareLCP( lcp, iterativeLcp, jmk, lm, rhs, lo, hi, boxIndex );
+	}
+	
 #ifdef AF_TIMINGS
 	timer_lcp.Start();
 #endif
 	
 	// calculate lagrange multipliers for auxiliary constraints
-	if( !lcp->Solve( jmk, lm, rhs, lo, hi, boxIndex ) )
+	if( !( iterativeLCP ? iterativeLcp : lcp )->Solve( jmk, lm, rhs, lo, hi, boxIndex ) )
 	{
 		return;		// bad monkey!
 	}
@@ -7478,6 +7569,7 @@ idPhysics_AF::idPhysics_AF()
 	masterBody = NULL;
 	
 	lcp = idLCP::AllocSymmetric();
+	iterativeLcp = idLCP::AllocGaussSeidel();
 	
 	memset( &current, 0, sizeof( current ) );
 	current.atRest = -1;
@@ -7523,6 +7615,7 @@ idPhysics_AF::idPhysics_AF()
 	noImpact = false;
 	worldConstraintsLocked = false;
 	forcePushable = false;
+	iterativeLCP = false;
 	
 #ifdef AF_TIMINGS
 	lastTimerReset = 0;
@@ -7557,6 +7650,7 @@ idPhysics_AF::~idPhysics_AF()
 	}
 	
 	delete lcp;
+	delete iterativeLcp;
 	
 	if( masterBody )
 	{
@@ -1062,6 +1062,11 @@ public:
 	{
 		selfCollision = enable;
 	}
+	// use the iterative Gauss-Seidel LCP solver warm started with the multipliers of the previous frame
+	void					SetIterativeLCP( const bool enable )
+	{
+		iterativeLCP = enable;
+	}
 	// enable or disable coming to a dead stop
 	void					SetComeToRest( bool enable )
 	{
@@ -1087,6 +1092,8 @@ public:
 	}
 	// update the clip model positions
 	void					UpdateClipModels();
+	// print and clear the statistics gathered with af_compareLCP
+	static void				PrintLCPStats();
 	
 public:	// common physics interface
 	void					SetClipModel( idClipModel* model, float density, int id = 0, bool freeOld = true );
@@ -1207,6 +1214,7 @@ private:
 	bool					noImpact;						// if true do not activate when another object collides
 	bool					worldConstraintsLocked;			// if true world constraints cannot be moved
 	bool					forcePushable;					// if true can be pushed even when bound to a master
+	bool					iterativeLCP;					// if true the auxiliary constraints are solved with the iterative LCP solver
 	
 	// physics state
 	AFPState_t				current;
@@ -1214,6 +1222,7 @@ private:
 	
 	idAFBody* 				masterBody;						// master body
 	idLCP* 					lcp;							// linear complementarity problem solver
+	idLCP* 					iterativeLcp;					// iterative linear complementarity problem solver
 	
 private:
 	void					BuildTrees();
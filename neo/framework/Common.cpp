@@ -66,6 +66,7 @@ struct version_s
 
 idCVar com_version( "si_version", version.string, CVAR_SYSTEM | CVAR_ROM | CVAR_SERVERINFO, "engine version" );
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_NOCHEAT, "force generic platform independent SIMD" );
+idCVar com_deterministicMath( "com_deterministicMath", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_NOCHEAT, "use bit reproducible math on every CPU for lock-step simulation and replay verification" );
 
 #ifdef ID_RETAIL
 idCVar com_allowConsole( "com_allowConsole", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_INIT, "allow toggling console with the tilde key" );
@@ -223,6 +224,8 @@ void idCommonLocal::Quit()
 	{
 		Shutdown();
 	}
+	// the thread exit callback isn't called for the main thread
+	Mem_ReleaseThreadCache();
 	Sys_Quit();
 }
 
@@ -1007,8 +1010,9 @@ idCommonLocal::InitSIMD
 */
 void idCommonLocal::InitSIMD()
 {
-	idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool() );
+	idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool(), com_deterministicMath.GetBool() );
 	com_forceGenericSIMD.ClearModified();
+	com_deterministicMath.ClearModified();
 }
 
 
@@ -1232,15 +1236,15 @@ void idCommonLocal::Init( int argc, const char* const* argv, const char* cmdline
 		
 		fileSystem->BeginLevelLoad( "_startup", saveFile.GetDataPtr(), saveFile.GetAllocated() );
 		
+		// init the parallel job manager, the decl files are scanned in jobs
+		parallelJobManager->Init();
+		
 		// initialize the declaration manager
 		declManager->Init();
 		
 		// init journalling, etc
 		eventLoop->Init();
 		
-		// init the parallel job manager
-		parallelJobManager->Init();
-		
 		// exec the startup scripts
 		cmdSystem->BufferCommandText( CMD_EXEC_APPEND, "exec default.cfg\n" );
 		
@@ -2017,6 +2021,14 @@ CONSOLE_COMMAND( testSIMD, "test SIMD code", NULL )
 {
 	idSIMD::Test_f( args );
 }
+CONSOLE_COMMAND( testMatX, "benchmark matrix factorizations, optionally takes the matrix sizes", NULL )
+{
+	idMatX::Test_f( args );
+}
+CONSOLE_COMMAND( testBoundsBatch, "benchmark bounds batch operations, optionally takes the batch sizes", NULL )
+{
+	idBoundsBatch::Test_f( args );
+}
 
 // RB begin
 CONSOLE_COMMAND( testFormattingSizes, "test printf format security", 0 )
@@ -75,11 +75,14 @@ class idMatchParameters;
 
 struct lobbyConnectInfo_t;
 
+// the name is copied while a timeline is captured, see idTimelineProfiler
 ID_INLINE void BeginProfileNamedEventColor( uint32 color, VERIFY_FORMAT_STRING const char* szName )
 {
+	idTimelineProfiler::BeginEvent( szName );
 }
 ID_INLINE void EndProfileNamedEvent()
 {
+	idTimelineProfiler::EndEvent();
 }
 
 ID_INLINE void BeginProfileNamedEvent( VERIFY_FORMAT_STRING const char* szName )
@@ -254,7 +254,7 @@ float idConsoleLocal::DrawFPS( float y )
 	// DG end
 	
 	// print the resolution scale so we can tell when we are at reduced resolution
-	idStr resolutionText;
+	idStrStatic< 64 > resolutionText;
 	resolutionScale.GetConsoleText( resolutionText );
 	int w = resolutionText.Length() * BIGCHAR_WIDTH;
 	renderSystem->DrawBigStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, resolutionText.c_str(), colorWhite, true );
@@ -269,7 +269,7 @@ float idConsoleLocal::DrawFPS( float y )
 	const int maxTime = 16;
 	
 	y += SMALLCHAR_HEIGHT + 4;
-	idStr timeStr;
+	idStrStatic< 64 > timeStr;
 	timeStr.Format( "%sG+RF: %4d", gameThreadTotalTime > maxTime ? S_COLOR_RED : "", gameThreadTotalTime );
 	w = timeStr.LengthWithoutColors() * SMALLCHAR_WIDTH;
 	renderSystem->DrawSmallStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, timeStr.c_str(), colorWhite, false );
@@ -314,6 +314,36 @@ idConsoleLocal::DrawMemoryUsage
 */
 float idConsoleLocal::DrawMemoryUsage( float y )
 {
+	static int64 previousTotal;
+	
+	const int64 total = Mem_GetTotalBytes();
+	const int64 frameDelta = total - previousTotal;
+	previousTotal = total;
+	
+	idStrStatic< 64 > memStr;
+	memStr.Format( "%.1f MB total", total / ( 1024.0f * 1024.0f ) );
+	int w = memStr.LengthWithoutColors() * SMALLCHAR_WIDTH;
+	renderSystem->DrawSmallStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, memStr.c_str(), colorWhite, false );
+	y += SMALLCHAR_HEIGHT + 4;
+	
+	memStr.Format( "%s%+d KB frame", frameDelta != 0 ? S_COLOR_YELLOW : "", ( int )( frameDelta / 1024 ) );
+	w = memStr.LengthWithoutColors() * SMALLCHAR_WIDTH;
+	renderSystem->DrawSmallStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, memStr.c_str(), colorWhite, false );
+	y += SMALLCHAR_HEIGHT + 4;
+	
+	memFrameArenaStats_t arenaStats;
+	Mem_GetFrameArenaStats( arenaStats );
+	memStr.Format( "%s%d/%d arena allocs tic", arenaStats.heapAllocs != 0 ? S_COLOR_YELLOW : "", arenaStats.arenaAllocs, arenaStats.arenaAllocs + arenaStats.heapAllocs );
+	w = memStr.LengthWithoutColors() * SMALLCHAR_WIDTH;
+	renderSystem->DrawSmallStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, memStr.c_str(), colorWhite, false );
+	y += SMALLCHAR_HEIGHT + 4;
+	
+	const int strReallocs = idStr::GetFrameReallocs();
+	memStr.Format( "%s%d str reallocs frame", strReallocs != 0 ? S_COLOR_YELLOW : "", strReallocs );
+	w = memStr.LengthWithoutColors() * SMALLCHAR_WIDTH;
+	renderSystem->DrawSmallStringExt( LOCALSAFE_RIGHT - w, idMath::Ftoi( y ) + 2, memStr.c_str(), colorWhite, false );
+	y += SMALLCHAR_HEIGHT + 4;
+	
 	return y;
 }
 
@@ -82,6 +82,37 @@ public:
 
 class idDeclFile;
 
+// a decl, or a warning, found by scanning the text of a decl file
+struct declSourceText_t
+{
+	declType_t					type;					// DECL_MAX_TYPES for a warning
+	idStr						name;					// or the warning message
+	int							line;					// line of the closing brace or the warning
+	int							sourceTextOffset;
+	int							sourceTextLength;
+	int							sourceLine;
+	int							checksum;				// checksum of the decl text
+	char* 						textSource;				// decl text, owned by the scan until it is merged
+	int							compressedLength;
+};
+
+// the text of a decl file split up into its decls, this is all
+// the work that can be done without touching the decl manager
+struct declFileScan_t
+{
+	const char* 				fileName;
+	declType_t					defaultType;
+	char* 						buffer;
+	int							length;
+	int							checksum;
+	int							numLines;
+	bool						hadError;				// the lexer failed while it couldn't print, scan again to report it
+	idList<declSourceText_t, TAG_IDLIB_LIST_DECL>	decls;
+	
+	void						FreeDecls();
+	void						Free();
+};
+
 class idDeclLocal : public idDeclBase
 {
 	friend class idDeclFile;
@@ -132,6 +163,9 @@ protected:
 	// Set textSource possible with compression.
 	void						SetTextLocal( const char* text, const int length );
 	
+	// Takes over a textSource that was compressed by the decl file scan.
+	void						SetCompressedTextLocal( char* text, const int compressedLength, const int length, const int textChecksum );
+	
 private:
 	idDecl* 					self;
 	
@@ -163,8 +197,14 @@ public:
 	idDeclFile( const char* fileName, declType_t defaultType );
 	
 	void						Reload( bool force );
+	bool						Changed() const;
 	int							LoadAndParse();
 	
+	// the stages of LoadAndParse(), ScanText() doesn't touch the decl manager and runs in jobs
+	bool						ReadText( declFileScan_t& scan );
+	static void					ScanText( declFileScan_t& scan, bool inJob );
+	int							MergeScan( declFileScan_t& scan );
+	
 public:
 	idStr						fileName;
 	declType_t					defaultType;
@@ -237,6 +277,9 @@ public:
 	
 	void						ConvertPDAsToStrings( const idCmdArgs& args );
 	
+private:
+	void						LoadDeclFiles( const idList<idDeclFile*>& files );
+	
 private:
 	idSysMutex					mutex;
 	
@@ -244,7 +287,7 @@ private:
 	idList<idDeclFolder*, TAG_IDLIB_LIST_DECL>		declFolders;
 	
 	idList<idDeclFile*, TAG_IDLIB_LIST_DECL>		loadedFiles;
-	idHashIndex					hashTables[DECL_MAX_TYPES];
+	idFlatHashMap< const char*, int, TAG_DECL >	hashTables[DECL_MAX_TYPES];	// keys point at the decl names
 	idList<idDeclLocal*, TAG_IDLIB_LIST_DECL>		linearLists[DECL_MAX_TYPES];
 	idDeclFile					implicitDecls;	// this holds all the decls that were created because explicit
 	// text definitions were not found. Decls that became default
@@ -254,14 +297,17 @@ private:
 	bool						insideLevelLoad;
 	
 	static idCVar				decl_show;
+	static idCVar				decl_parseJobs;
 	
 private:
 	static void					ListDecls_f( const idCmdArgs& args );
 	static void					ReloadDecls_f( const idCmdArgs& args );
 	static void					TouchDecl_f( const idCmdArgs& args );
+	static void					BenchmarkDeclLoad_f( const idCmdArgs& args );
 };
 
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0, 2> );
+idCVar idDeclManagerLocal::decl_parseJobs( "decl_parseJobs", "1", CVAR_SYSTEM | CVAR_BOOL, "split the decl files into decls in parallel jobs" );
 
 idDeclManagerLocal	declManagerLocal;
 idDeclManager* 		declManager = &declManagerLocal;
@@ -330,8 +376,8 @@ static int huffmanFrequencies[] =
 
 static huffmanCode_t huffmanCodes[MAX_HUFFMAN_SYMBOLS];
 static huffmanNode_t* huffmanTree = NULL;
-static int totalUncompressedLength = 0;
-static int totalCompressedLength = 0;
+static interlockedInt_t totalUncompressedLength = 0;	// updated by the decl file scan jobs
+static interlockedInt_t totalCompressedLength = 0;
 static int maxHuffmanBits = 0;
 
 
@@ -510,7 +556,7 @@ int HuffmanCompressText( const char* text, int textLength, byte* compressed, int
 	int i, j;
 	idBitMsg msg;
 	
-	totalUncompressedLength += textLength;
+	Sys_InterlockedAdd( totalUncompressedLength, textLength );
 	
 	msg.InitWrite( compressed, maxCompressedSize );
 	msg.BeginWriting();
@@ -527,7 +573,7 @@ int HuffmanCompressText( const char* text, int textLength, byte* compressed, int
 		}
 	}
 	
-	totalCompressedLength += msg.GetSize();
+	Sys_InterlockedAdd( totalCompressedLength, msg.GetSize() );
 	
 	return msg.GetSize();
 }
@@ -561,6 +607,52 @@ int HuffmanDecompressText( char* text, int textLength, const byte* compressed, i
 	return msg.GetReadCount();
 }
 
+/*
+================
+CompressedDeclTextBufferSize
+================
+*/
+int CompressedDeclTextBufferSize( int textLength )
+{
+#ifdef USE_COMPRESSED_DECLS
+	return textLength * ( ( maxHuffmanBits + 7 ) >> 3 );
+#else
+	return 0;
+#endif
+}
+
+/*
+================
+CompressDeclText
+
+Returns the text source of a decl, compressBuffer has to hold at least
+CompressedDeclTextBufferSize( textLength ) bytes
+================
+*/
+char* CompressDeclText( const char* text, int textLength, int& compressedLength, byte* compressBuffer )
+{
+	char* textSource;
+	
+#ifdef GET_HUFFMAN_FREQUENCIES
+	for( int i = 0; i < textLength; i++ )
+	{
+		huffmanFrequencies[( ( const unsigned char* )text )[i]]++;
+	}
+#endif
+	
+#ifdef USE_COMPRESSED_DECLS
+	compressedLength = HuffmanCompressText( text, textLength, compressBuffer, CompressedDeclTextBufferSize( textLength ) );
+	textSource = ( char* )Mem_Alloc( compressedLength, TAG_DECLTEXT );
+	memcpy( textSource, compressBuffer, compressedLength );
+#else
+	compressedLength = textLength;
+	textSource = ( char* ) Mem_Alloc( textLength + 1, TAG_DECLTEXT );
+	memcpy( textSource, text, textLength );
+	textSource[textLength] = '\0';
+#endif
+	return textSource;
+}
+
 /*
 ================
 ListHuffmanFrequencies_f
@@ -637,21 +729,35 @@ ForceReload will cause it to reload even if the timestamp hasn't changed
 ================
 */
 void idDeclFile::Reload( bool force )
+{
+	if( !force && !Changed() )
+	{
+		return;
+	}
+	
+	// parse the text
+	LoadAndParse();
+}
+
+/*
+================
+idDeclFile::Changed
+================
+*/
+bool idDeclFile::Changed() const
 {
 	// check for an unchanged timestamp
-	if( !force && timestamp != 0 )
+	if( timestamp != 0 )
 	{
 		ID_TIME_T	testTimeStamp;
 		fileSystem->ReadFile( fileName, NULL, &testTimeStamp );
 		
 		if( testTimeStamp == timestamp )
 		{
-			return;
+			return false;
 		}
 	}
-	
-	// parse the text
-	LoadAndParse();
+	return true;
 }
 
 /*
@@ -665,44 +771,102 @@ int c_savedMemory = 0;
 
 int idDeclFile::LoadAndParse()
 {
-	int			i, numTypes;
-	idLexer		src;
-	idToken		token;
-	int			startMarker;
-	char* 		buffer;
-	int			length, size;
-	int			sourceLine;
-	idStr		name;
-	idDeclLocal* newDecl;
-	bool		reparse;
+	declFileScan_t scan;
 	
-	// load the text
-	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
-	length = fileSystem->ReadFile( fileName, ( void** )&buffer, &timestamp );
-	if( length == -1 )
+	if( !ReadText( scan ) )
 	{
-		common->FatalError( "couldn't load %s", fileName.c_str() );
 		return 0;
 	}
+	ScanText( scan, false );
+	MergeScan( scan );
+	scan.Free();
 	
-	if( !src.LoadMemory( buffer, length, fileName ) )
+	return checksum;
+}
+
+/*
+================
+idDeclFile::ReadText
+================
+*/
+bool idDeclFile::ReadText( declFileScan_t& scan )
+{
+	scan.fileName = fileName.c_str();
+	scan.defaultType = defaultType;
+	scan.buffer = NULL;
+	scan.checksum = 0;
+	scan.numLines = 0;
+	scan.hadError = false;
+	
+	// load the text
+	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
+	scan.length = fileSystem->ReadFile( fileName, ( void** )&scan.buffer, &timestamp );
+	if( scan.length == -1 )
 	{
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
+		common->FatalError( "couldn't load %s", fileName.c_str() );
+		return false;
 	}
+	return true;
+}
+
+/*
+================
+AddScanWarning
+================
+*/
+static void AddScanWarning( declFileScan_t& scan, idLexer& src, const char* message )
+{
+	declSourceText_t& warning = scan.decls.Alloc();
+	warning.type = DECL_MAX_TYPES;
+	warning.name = message;
+	warning.line = src.GetLineNum();
+	warning.sourceTextOffset = 0;
+	warning.sourceTextLength = 0;
+	warning.sourceLine = warning.line;
+	warning.checksum = 0;
+	warning.textSource = NULL;
+	warning.compressedLength = 0;
+}
+
+/*
+================
+idDeclFile::ScanText
+
+Identifies each individual declaration in the text and compresses it. This is
+called from jobs, so anything that has to be printed is added to the scan and
+only reported by MergeScan(). The lexer can't report its own errors there, so
+files it fails on have to be scanned again on the main thread.
+================
+*/
+void idDeclFile::ScanText( declFileScan_t& scan, bool inJob )
+{
+	int			i, numTypes;
+	idLexer		src;
+	idToken		token;
+	int			startMarker;
+	int			size;
+	int			sourceLine;
+	idStr		name;
 	
-	// mark all the defs that were from the last reload of this file
-	for( idDeclLocal* decl = decls; decl; decl = decl->nextInFile )
+	scan.FreeDecls();
+	scan.hadError = false;
+	
+	if( !src.LoadMemory( scan.buffer, scan.length, scan.fileName ) )
 	{
-		decl->redefinedInReload = false;
+		if( !inJob )
+		{
+			common->Error( "Couldn't parse %s", scan.fileName );
+		}
+		scan.hadError = true;
+		return;
 	}
 	
-	src.SetFlags( DECL_LEXER_FLAGS );
+	src.SetFlags( inJob ? ( DECL_LEXER_FLAGS | LEXFL_NOERRORS | LEXFL_NOWARNINGS ) : DECL_LEXER_FLAGS );
 	
-	checksum = MD5_BlockChecksum( buffer, length );
+	scan.checksum = MD5_BlockChecksum( scan.buffer, scan.length );
 	
-	fileSize = length;
+	// no decl is larger than the file
+	byte* compressBuffer = ( byte* )Mem_Alloc( Max( CompressedDeclTextBufferSize( scan.length ), 1 ), TAG_DECLTEXT );
 	
 	// scan through, identifying each individual declaration
 	while( 1 )
@@ -738,7 +902,7 @@ int idDeclFile::LoadAndParse()
 			{
 			
 				// if we ever see an open brace, we somehow missed the [type] <name> prefix
-				src.Warning( "Missing decl name" );
+				AddScanWarning( scan, src, "Missing decl name" );
 				src.SkipBracedSection( false );
 				continue;
 				
@@ -746,28 +910,28 @@ int idDeclFile::LoadAndParse()
 			else
 			{
 			
-				if( defaultType == DECL_MAX_TYPES )
+				if( scan.defaultType == DECL_MAX_TYPES )
 				{
-					src.Warning( "No type" );
+					AddScanWarning( scan, src, "No type" );
 					continue;
 				}
 				src.UnreadToken( &token );
 				// use the default type
-				identifiedType = defaultType;
+				identifiedType = scan.defaultType;
 			}
 		}
 		
 		// now parse the name
 		if( !src.ReadToken( &token ) )
 		{
-			src.Warning( "Type without definition at end of file" );
+			AddScanWarning( scan, src, "Type without definition at end of file" );
 			break;
 		}
 		
 		if( !token.Icmp( "{" ) )
 		{
 			// if we ever see an open brace, we somehow missed the [type] <name> prefix
-			src.Warning( "Missing decl name" );
+			AddScanWarning( scan, src, "Missing decl name" );
 			src.SkipBracedSection( false );
 			continue;
 		}
@@ -784,12 +948,15 @@ int idDeclFile::LoadAndParse()
 		// make sure there's a '{'
 		if( !src.ReadToken( &token ) )
 		{
-			src.Warning( "Type without definition at end of file" );
+			AddScanWarning( scan, src, "Type without definition at end of file" );
 			break;
 		}
 		if( token != "{" )
 		{
-			src.Warning( "Expecting '{' but found '%s'", token.c_str() );
+			// va() isn't thread safe
+			idStr message;
+			message.Format( "Expecting '{' but found '%s'", token.c_str() );
+			AddScanWarning( scan, src, message );
 			continue;
 		}
 		src.UnreadToken( &token );
@@ -798,16 +965,65 @@ int idDeclFile::LoadAndParse()
 		src.SkipBracedSection();
 		size = src.GetFileOffset() - startMarker;
 		
+		declSourceText_t& decl = scan.decls.Alloc();
+		decl.type = identifiedType;
+		decl.name = name;
+		decl.line = src.GetLineNum();
+		decl.sourceTextOffset = startMarker;
+		decl.sourceTextLength = size;
+		decl.sourceLine = sourceLine;
+		decl.checksum = MD5_BlockChecksum( scan.buffer + startMarker, size );
+		decl.textSource = CompressDeclText( scan.buffer + startMarker, size, decl.compressedLength, compressBuffer );
+	}
+	
+	Mem_Free( compressBuffer );
+	
+	scan.numLines = src.GetLineNum();
+	scan.hadError = src.HadError();
+}
+
+/*
+================
+idDeclFile::MergeScan
+
+Adds the scanned decls to the decl manager in the order they appear in the file
+================
+*/
+int idDeclFile::MergeScan( declFileScan_t& scan )
+{
+	idDeclLocal* newDecl;
+	bool		reparse;
+	
+	// mark all the defs that were from the last reload of this file
+	for( idDeclLocal* decl = decls; decl; decl = decl->nextInFile )
+	{
+		decl->redefinedInReload = false;
+	}
+	
+	checksum = scan.checksum;
+	
+	fileSize = scan.length;
+	
+	for( int i = 0; i < scan.decls.Num(); i++ )
+	{
+		declSourceText_t& source = scan.decls[i];
+		
+		if( source.type == DECL_MAX_TYPES )
+		{
+			common->Warning( "file %s, line %d: %s", fileName.c_str(), source.line, source.name.c_str() );
+			continue;
+		}
+		
 		// look it up, possibly getting a newly created default decl
 		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
+		newDecl = declManagerLocal.FindTypeWithoutParsing( source.type, source.name, false );
 		if( newDecl )
 		{
 			// update the existing copy
 			if( newDecl->sourceFile != this || newDecl->redefinedInReload )
 			{
-				src.Warning( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ),
-							 name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+				common->Warning( "file %s, line %d: %s '%s' previously defined at %s:%i", fileName.c_str(), source.line,
+								 declManagerLocal.GetDeclNameFromType( source.type ), source.name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
 				continue;
 			}
 			if( newDecl->declState != DS_UNPARSED )
@@ -818,24 +1034,19 @@ int idDeclFile::LoadAndParse()
 		else
 		{
 			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, true );
+			newDecl = declManagerLocal.FindTypeWithoutParsing( source.type, source.name, true );
 			newDecl->nextInFile = this->decls;
 			this->decls = newDecl;
 		}
 		
 		newDecl->redefinedInReload = true;
 		
-		if( newDecl->textSource )
-		{
-			Mem_Free( newDecl->textSource );
-			newDecl->textSource = NULL;
-		}
-		
-		newDecl->SetTextLocal( buffer + startMarker, size );
+		newDecl->SetCompressedTextLocal( source.textSource, source.compressedLength, source.sourceTextLength, source.checksum );
+		source.textSource = NULL;
 		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
+		newDecl->sourceTextOffset = source.sourceTextOffset;
+		newDecl->sourceTextLength = source.sourceTextLength;
+		newDecl->sourceLine = source.sourceLine;
 		newDecl->declState = DS_UNPARSED;
 		
 		// if it is currently in use, reparse it immedaitely
@@ -845,9 +1056,7 @@ int idDeclFile::LoadAndParse()
 		}
 	}
 	
-	numLines = src.GetLineNum();
-	
-	Mem_Free( buffer );
+	numLines = scan.numLines;
 	
 	// any defs that weren't redefinedInReload should now be defaulted
 	for( idDeclLocal* decl = decls ; decl ; decl = decl->nextInFile )
@@ -864,6 +1073,44 @@ int idDeclFile::LoadAndParse()
 	return checksum;
 }
 
+/*
+================
+declFileScan_t::FreeDecls
+================
+*/
+void declFileScan_t::FreeDecls()
+{
+	for( int i = 0; i < decls.Num(); i++ )
+	{
+		Mem_Free( decls[i].textSource );
+	}
+	decls.Clear();
+}
+
+/*
+================
+declFileScan_t::Free
+================
+*/
+void declFileScan_t::Free()
+{
+	FreeDecls();
+	Mem_Free( buffer );
+	buffer = NULL;
+}
+
+/*
+================
+DeclFileScanJob
+================
+*/
+static void DeclFileScanJob( declFileScan_t* scan )
+{
+	idDeclFile::ScanText( *scan, true );
+}
+
+REGISTER_PARALLEL_JOB( DeclFileScanJob, "DeclFileScanJob" );
+
 /*
 ====================================================================================
 
@@ -917,6 +1164,7 @@ void idDeclManagerLocal::Init()
 	
 	cmdSystem->AddCommand( "reloadDecls", ReloadDecls_f, CMD_FL_SYSTEM, "reloads decls" );
 	cmdSystem->AddCommand( "touch", TouchDecl_f, CMD_FL_SYSTEM, "touches a decl" );
+	cmdSystem->AddCommand( "benchmarkDeclLoad", BenchmarkDeclLoad_f, CMD_FL_SYSTEM, "times splitting the loaded decl files into decls serially and with jobs" );
 	
 	cmdSystem->AddCommand( "listTables", idListDecls_f<DECL_TABLE>, CMD_FL_SYSTEM, "lists tables", idCmdSystem::ArgCompletion_String<listDeclStrings> );
 	cmdSystem->AddCommand( "listMaterials", idListDecls_f<DECL_MATERIAL>, CMD_FL_SYSTEM, "lists materials", idCmdSystem::ArgCompletion_String<listDeclStrings> );
@@ -1012,10 +1260,90 @@ idDeclManagerLocal::Reload
 */
 void idDeclManagerLocal::Reload( bool force )
 {
+	idList<idDeclFile*, TAG_IDLIB_LIST_DECL> changedFiles;
 	for( int i = 0; i < loadedFiles.Num(); i++ )
 	{
-		loadedFiles[i]->Reload( force );
+		if( force || loadedFiles[i]->Changed() )
+		{
+			changedFiles.Append( loadedFiles[i] );
+		}
+	}
+	LoadDeclFiles( changedFiles );
+}
+
+/*
+===================
+idDeclManagerLocal::LoadDeclFiles
+
+The files are read through a read batch and split up into decls in parallel
+jobs. The decls are merged on this thread in file order while the later files
+are still being scanned, so the decl indices and the checksum are the same as
+when the files are parsed one after the other. Decls that are in use and have
+to be reparsed are still parsed on this thread, idDecl::Parse() isn't thread safe.
+===================
+*/
+void idDeclManagerLocal::LoadDeclFiles( const idList<idDeclFile*>& files )
+{
+	const int numFiles = files.Num();
+	
+	bool useJobs = decl_parseJobs.GetBool() && numFiles > 1 && parallelJobManager->GetNumProcessingUnits() > 0;
+#ifdef GET_HUFFMAN_FREQUENCIES
+	// the frequencies are counted without locking
+	useJobs = false;
+#endif
+	
+	if( !useJobs )
+	{
+		for( int i = 0; i < numFiles; i++ )
+		{
+			files[i]->LoadAndParse();
+		}
+		return;
+	}
+	
+	// the files inside the .resources containers are read ahead on the async read threads
+	idAsyncReadBatch batch;
+	for( int i = 0; i < numFiles; i++ )
+	{
+		batch.Add( files[i]->fileName );
+	}
+	batch.Submit();
+	
+	idList<declFileScan_t, TAG_IDLIB_LIST_DECL> scans;
+	scans.SetNum( numFiles );
+	
+	fileSystem->SetReadBatch( &batch );
+	for( int i = 0; i < numFiles; i++ )
+	{
+		files[i]->ReadText( scans[i] );
+	}
+	fileSystem->SetReadBatch( NULL );
+	
+	// the default punctuation table is set up by the first lexer, don't leave that to the jobs
+	idLexer setupLexer;
+	
+	idParallelJobList* jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, numFiles, 0, NULL );
+	for( int i = 0; i < numFiles; i++ )
+	{
+		jobList->AddJob( ( jobRun_t )DeclFileScanJob, &scans[i] );
+	}
+	jobList->Submit( NULL, JOBLIST_PARALLELISM_MAX_CORES );
+	
+	for( int i = 0; i < numFiles; i++ )
+	{
+		jobList->WaitForJobs( i, 1 );
+		
+		declFileScan_t& scan = scans[i];
+		if( scan.hadError )
+		{
+			idDeclFile::ScanText( scan, false );
+		}
+		files[i]->MergeScan( scan );
+		scan.Free();
 	}
+	
+	jobList->Wait();
+	parallelJobManager->FreeJobList( jobList );
 }
 
 /*
@@ -1118,6 +1446,7 @@ void idDeclManagerLocal::RegisterDeclFolder( const char* folder, const char* ext
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 	
 	// load and parse decl files
+	idList<idDeclFile*, TAG_IDLIB_LIST_DECL> filesToLoad;
 	for( i = 0; i < fileList->GetNumFiles(); i++ )
 	{
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
@@ -1139,8 +1468,9 @@ void idDeclManagerLocal::RegisterDeclFolder( const char* folder, const char* ext
 			df = new( TAG_DECL ) idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+		filesToLoad.Append( df );
 	}
+	LoadDeclFiles( filesToLoad );
 	
 	fileSystem->FreeFileList( fileList );
 }
@@ -1540,7 +1870,7 @@ idDeclManagerLocal::CreateNewDecl
 idDecl* idDeclManagerLocal::CreateNewDecl( declType_t type, const char* name, const char* _fileName )
 {
 	int typeIndex = ( int )type;
-	int i, hash;
+	int i;
 	
 	if( typeIndex < 0 || typeIndex >= declTypes.Num() || declTypes[typeIndex] == NULL || typeIndex >= DECL_MAX_TYPES )
 	{
@@ -1556,14 +1886,11 @@ idDecl* idDeclManagerLocal::CreateNewDecl( declType_t type, const char* name, co
 	fileName.BackSlashesToSlashes();
 	
 	// see if it already exists
-	hash = hashTables[typeIndex].GenerateKey( canonicalName, false );
-	for( i = hashTables[typeIndex].First( hash ); i >= 0; i = hashTables[typeIndex].Next( i ) )
+	const int* index;
+	if( hashTables[typeIndex].Get( canonicalName, &index ) )
 	{
-		if( linearLists[typeIndex][i]->name.Icmp( canonicalName ) == 0 )
-		{
-			linearLists[typeIndex][i]->AllocateSelf();
-			return linearLists[typeIndex][i]->self;
-		}
+		linearLists[typeIndex][*index]->AllocateSelf();
+		return linearLists[typeIndex][*index]->self;
 	}
 	
 	idDeclFile* sourceFile;
@@ -1618,7 +1945,7 @@ idDecl* idDeclManagerLocal::CreateNewDecl( declType_t type, const char* name, co
 	
 	// add it to the hash table and linear list
 	decl->index = linearLists[typeIndex].Num();
-	hashTables[typeIndex].Add( hash, linearLists[typeIndex].Append( decl ) );
+	hashTables[typeIndex].Set( decl->name.c_str(), linearLists[typeIndex].Append( decl ) );
 	
 	return decl->self;
 }
@@ -1641,35 +1968,20 @@ bool idDeclManagerLocal::RenameDecl( declType_t type, const char* oldName, const
 	
 	// make sure it already exists
 	int typeIndex = ( int )type;
-	int i, hash;
-	hash = hashTables[typeIndex].GenerateKey( canonicalOldName, false );
-	for( i = hashTables[typeIndex].First( hash ); i >= 0; i = hashTables[typeIndex].Next( i ) )
-	{
-		if( linearLists[typeIndex][i]->name.Icmp( canonicalOldName ) == 0 )
-		{
-			decl = linearLists[typeIndex][i];
-			break;
-		}
-	}
-	if( !decl )
+	const int* index;
+	if( !hashTables[typeIndex].Get( canonicalOldName, &index ) )
 		return false;
 		
-	//if ( !hashTables[(int)type].Get( canonicalOldName, &declPtr ) )
-	//	return false;
+	decl = linearLists[typeIndex][*index];
 	
-	//decl = *declPtr;
+	// the hash key points at the name, so remove it before the name changes
+	hashTables[typeIndex].Remove( canonicalOldName );
 	
 	//Change the name
 	decl->name = canonicalNewName;
 	
-	
 	// add it to the hash table
-	//hashTables[(int)decl->type].Set( decl->name, decl );
-	int newhash = hashTables[typeIndex].GenerateKey( canonicalNewName, false );
-	hashTables[typeIndex].Add( newhash, decl->index );
-	
-	//Remove the old hash item
-	hashTables[typeIndex].Remove( hash, decl->index );
+	hashTables[typeIndex].Set( decl->name.c_str(), decl->index );
 	
 	return true;
 }
@@ -1900,6 +2212,100 @@ void idDeclManagerLocal::ReloadDecls_f( const idCmdArgs& args )
 	declManagerLocal.Reload( force );
 }
 
+/*
+===================
+idDeclManagerLocal::BenchmarkDeclLoad_f
+
+Scans all the loaded decl files serially and with jobs without merging the
+results, so the decls are left alone.
+
+benchmarkDeclLoad [passes]
+===================
+*/
+void idDeclManagerLocal::BenchmarkDeclLoad_f( const idCmdArgs& args )
+{
+	const int numPasses = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 5;
+	const idList<idDeclFile*, TAG_IDLIB_LIST_DECL>& files = declManagerLocal.loadedFiles;
+	const int numFiles = files.Num();
+	
+	idList<declFileScan_t, TAG_IDLIB_LIST_DECL> scans;
+	scans.SetNum( numFiles );
+	int64 numBytes = 0;
+	for( int i = 0; i < numFiles; i++ )
+	{
+		declFileScan_t& scan = scans[i];
+		scan.fileName = files[i]->fileName.c_str();
+		scan.defaultType = files[i]->defaultType;
+		scan.buffer = NULL;
+		scan.length = Max( fileSystem->ReadFile( scan.fileName, ( void** )&scan.buffer, NULL ), 0 );
+		numBytes += scan.length;
+	}
+	
+	idLexer setupLexer;
+	
+	uint64 bestTime[2] = { 0, 0 };
+	int numDecls[2] = { 0, 0 };
+	int checksum[2] = { 0, 0 };
+	for( int useJobs = 0; useJobs < 2; useJobs++ )
+	{
+		for( int pass = 0; pass < numPasses; pass++ )
+		{
+			const uint64 startTime = Sys_Microseconds();
+			if( useJobs )
+			{
+				idParallelJobList* jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, Max( numFiles, 1 ), 0, NULL );
+				for( int i = 0; i < numFiles; i++ )
+				{
+					jobList->AddJob( ( jobRun_t )DeclFileScanJob, &scans[i] );
+				}
+				jobList->Submit( NULL, JOBLIST_PARALLELISM_MAX_CORES );
+				jobList->Wait();
+				parallelJobManager->FreeJobList( jobList );
+			}
+			else
+			{
+				for( int i = 0; i < numFiles; i++ )
+				{
+					idDeclFile::ScanText( scans[i], true );
+				}
+			}
+			const uint64 time = Sys_Microseconds() - startTime;
+			if( pass == 0 || time < bestTime[useJobs] )
+			{
+				bestTime[useJobs] = time;
+			}
+		}
+		
+		for( int i = 0; i < numFiles; i++ )
+		{
+			for( int j = 0; j < scans[i].decls.Num(); j++ )
+			{
+				if( scans[i].decls[j].type != DECL_MAX_TYPES )
+				{
+					numDecls[useJobs]++;
+					checksum[useJobs] ^= scans[i].decls[j].checksum + j;
+				}
+			}
+		}
+	}
+	
+	for( int i = 0; i < numFiles; i++ )
+	{
+		scans[i].Free();
+	}
+	
+	common->Printf( "%i decl files, %i decls, %.1f MB, best of %i passes\n", numFiles, numDecls[0], numBytes / ( 1024.0 * 1024.0 ), numPasses );
+	common->Printf( "mode     time ms     MB/s\n" );
+	for( int useJobs = 0; useJobs < 2; useJobs++ )
+	{
+		common->Printf( "%-6s  %8.1f  %7.1f\n", useJobs ? "jobs" : "serial", bestTime[useJobs] * 0.001, ( double )numBytes / Max( bestTime[useJobs], ( uint64 )1 ) );
+	}
+	if( numDecls[0] != numDecls[1] || checksum[0] != checksum[1] )
+	{
+		common->Warning( "serial and job scans found different decls" );
+	}
+}
+
 /*
 ===================
 idDeclManagerLocal::TouchDecl_f
@@ -1954,7 +2360,6 @@ This finds or creats the decl, but does not cause a parse.  This is only used in
 idDeclLocal* idDeclManagerLocal::FindTypeWithoutParsing( declType_t type, const char* name, bool makeDefault )
 {
 	int typeIndex = ( int )type;
-	int i, hash;
 	
 	if( typeIndex < 0 || typeIndex >= declTypes.Num() || declTypes[typeIndex] == NULL || typeIndex >= DECL_MAX_TYPES )
 	{
@@ -1967,18 +2372,15 @@ idDeclLocal* idDeclManagerLocal::FindTypeWithoutParsing( declType_t type, const
 	MakeNameCanonical( name, canonicalName, sizeof( canonicalName ) );
 	
 	// see if it already exists
-	hash = hashTables[typeIndex].GenerateKey( canonicalName, false );
-	for( i = hashTables[typeIndex].First( hash ); i >= 0; i = hashTables[typeIndex].Next( i ) )
+	const int* index;
+	if( hashTables[typeIndex].Get( canonicalName, &index ) )
 	{
-		if( linearLists[typeIndex][i]->name.Icmp( canonicalName ) == 0 )
+		// only print these when decl_show is set to 2, because it can be a lot of clutter
+		if( decl_show.GetInteger() > 1 )
 		{
-			// only print these when decl_show is set to 2, because it can be a lot of clutter
-			if( decl_show.GetInteger() > 1 )
-			{
-				MediaPrint( "referencing %s %s\n", declTypes[ type ]->typeName.c_str(), name );
-			}
-			return linearLists[typeIndex][i];
+			MediaPrint( "referencing %s %s\n", declTypes[ type ]->typeName.c_str(), name );
 		}
+		return linearLists[typeIndex][*index];
 	}
 	
 	if( !makeDefault )
@@ -2000,7 +2402,7 @@ idDeclLocal* idDeclManagerLocal::FindTypeWithoutParsing( declType_t type, const
 	
 	// add it to the linear list and hash table
 	decl->index = linearLists[typeIndex].Num();
-	hashTables[typeIndex].Add( hash, linearLists[typeIndex].Append( decl ) );
+	hashTables[typeIndex].Set( decl->name.c_str(), linearLists[typeIndex].Append( decl ) );
 	
 	return decl;
 }
@@ -2383,25 +2785,23 @@ void idDeclLocal::SetTextLocal( const char* text, const int length )
 	
 	checksum = MD5_BlockChecksum( text, length );
 	
-#ifdef GET_HUFFMAN_FREQUENCIES
-	for( int i = 0; i < length; i++ )
-	{
-		huffmanFrequencies[( ( const unsigned char* )text )[i]]++;
-	}
-#endif
+	byte* compressed = ( byte* )_alloca( CompressedDeclTextBufferSize( length ) );
+	textSource = CompressDeclText( text, length, compressedLength, compressed );
+	textLength = length;
+}
+
+/*
+=================
+idDeclLocal::SetCompressedTextLocal
+=================
+*/
+void idDeclLocal::SetCompressedTextLocal( char* text, const int compressedLength, const int length, const int textChecksum )
+{
+	Mem_Free( textSource );
 	
-#ifdef USE_COMPRESSED_DECLS
-	int maxBytesPerCode = ( maxHuffmanBits + 7 ) >> 3;
-	byte* compressed = ( byte* )_alloca( length * maxBytesPerCode );
-	compressedLength = HuffmanCompressText( text, length, compressed, length * maxBytesPerCode );
-	textSource = ( char* )Mem_Alloc( compressedLength, TAG_DECLTEXT );
-	memcpy( textSource, compressed, compressedLength );
-#else
-	compressedLength = length;
-	textSource = ( char* ) Mem_Alloc( length + 1, TAG_DECLTEXT );
-	memcpy( textSource, text, length );
-	textSource[length] = '\0';
-#endif
+	checksum = textChecksum;
+	textSource = text;
+	this->compressedLength = compressedLength;
 	textLength = length;
 }
 
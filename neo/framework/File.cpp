@@ -1884,6 +1884,7 @@ idFile_InnerResource::idFile_InnerResource( const char* _name, idFile* rezFile,
 	resourceFile = rezFile;
 	internalFilePos = 0;
 	resourceBuffer = NULL;
+	mappedData = NULL;
 }
 
 /*
@@ -1908,7 +1909,7 @@ Properly handles partial reads
 */
 int idFile_InnerResource::Read( void* buffer, int len )
 {
-	if( resourceFile == NULL )
+	if( resourceFile == NULL && mappedData == NULL )
 	{
 		return 0;
 	}
@@ -1922,7 +1923,12 @@ int idFile_InnerResource::Read( void* buffer, int len )
 	
 	if( read != len )
 	{
-		if( resourceBuffer != NULL )
+		if( mappedData != NULL )
+		{
+			memcpy( buffer, &mappedData[ internalFilePos ], len );
+			read = len;
+		}
+		else if( resourceBuffer != NULL )
 		{
 			memcpy( buffer, &resourceBuffer[ internalFilePos ], len );
 			read = len;
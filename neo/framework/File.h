@@ -403,6 +403,18 @@ public:
 		resourceBuffer = buf;
 		internalFilePos = 0;
 	}
+	// reads are served straight from a memory mapped resource container
+	void					SetMappedData( const byte* data )
+	{
+		mappedData = data;
+		internalFilePos = 0;
+	}
+	// the whole file when the container is memory mapped, NULL otherwise. The data stays valid
+	// as long as the resource container is loaded, so it can be consumed without a copy
+	const byte* 			GetMappedData() const
+	{
+		return mappedData;
+	}
 	
 private:
 	idStr				name;				// name of the file in the pak
@@ -411,6 +423,7 @@ private:
 	idFile* 			resourceFile;		// actual file
 	int					internalFilePos;	// seek offset
 	byte* 				resourceBuffer;		// if using the temp save memory
+	const byte* 		mappedData;			// if the resource container is memory mapped
 };
 #endif
 /*
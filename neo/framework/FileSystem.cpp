@@ -219,6 +219,13 @@ public:
 	{
 		preloadList.AddCollisionModel( resName );
 	}
+	
+	virtual void			SetReadBatch( const idAsyncReadBatch* batch )
+	{
+		readBatch = batch;
+	}
+	virtual const byte* 	GetMappedResourceData( const idResourceCacheEntry& rc );
+	virtual idFile* 		OpenResourceContainerRead( int containerIndex );
 	virtual void			AddParticlePreload( const char* resName )
 	{
 		preloadList.AddParticle( resName );
@@ -235,6 +242,9 @@ public:
 	static void				ExtractResourceFile_f( const idCmdArgs& args );
 	static void				UpdateResourceFile_f( const idCmdArgs& args );
 	static void				GenerateResourceCRCs_f( const idCmdArgs& args );
+	static void				ResourceStats_f( const idCmdArgs& args );
+	static void				TestResourceMapping_f( const idCmdArgs& args );
+	static void				TestResourceFormat_f( const idCmdArgs& args );
 	static void				CreateCRCsForResourceFileList( const idFileList& list );
 	
 	void					BuildOrderedStartupContainer();
@@ -263,6 +273,13 @@ private:
 	int		resourceBufferAvailable;
 	int		numFilesOpenedAsCached;
 	
+	// resource container traffic, see resourceStats, updated with interlocked adds because
+	// the main thread, the game thread and the save game thread all open files
+	int64	resourceBytesCopied;		// staged into a temporary buffer before the caller sees them
+	int64	resourceBytesMapped;		// handed out as views into a memory mapped container
+	
+	const idAsyncReadBatch* readBatch;	// resources read ahead for the current level load stage
+	
 private:
 
 	// .resource file creation
@@ -308,6 +325,8 @@ idCVar  idFileSystemLocal::fs_game_base( "fs_game_base", "", CVAR_SYSTEM | CVAR_
 idCVar	fs_basepath( "fs_basepath", "", CVAR_SYSTEM | CVAR_INIT, "" );
 idCVar	fs_savepath( "fs_savepath", "", CVAR_SYSTEM | CVAR_INIT, "" );
 idCVar	fs_resourceLoadPriority( "fs_resourceLoadPriority", "1", CVAR_SYSTEM , "if 1, open requests will be honored from resource files first; if 0, the resource files are checked after normal search paths" );
+idCVar	fs_mapResources( "fs_mapResources", "1", CVAR_SYSTEM | CVAR_BOOL, "memory map .resources containers and read resources straight from the mapping instead of copying them" );
+idCVar	fs_resourceCompression( "fs_resourceCompression", "0", CVAR_SYSTEM | CVAR_BOOL, "compress the entries of written .resources files where it pays off, compressed entries can't be used straight from the mapping" );
 idCVar	fs_enableBackgroundCaching( "fs_enableBackgroundCaching", "1", CVAR_SYSTEM , "if 1 allow the 360 to precache game files in the background" );
 
 idFileSystemLocal	fileSystemLocal;
@@ -334,6 +353,25 @@ idFileSystemLocal::StartPreload
 */
 void idFileSystemLocal::StartPreload( const idStrList& _preload )
 {
+	if( !fs_mapResources.GetBool() )
+	{
+		return;
+	}
+	
+	// let the kernel start paging in the resources we are about to load while
+	// the rest of the level load keeps the main thread busy
+	static idResourceCacheEntry rc;
+	for( int i = 0; i < _preload.Num(); i++ )
+	{
+		if( GetResourceCacheEntry( _preload[ i ], rc ) )
+		{
+			const byte* data = resourceFiles[ rc.containerIndex ]->GetMappedData( rc );
+			if( data != NULL )
+			{
+				Sys_AdviseMappedRange( data, rc.length, true );
+			}
+		}
+	}
 }
 
 /*
@@ -357,6 +395,9 @@ idFileSystemLocal::idFileSystemLocal()
 	resourceBufferPtr = NULL;
 	resourceBufferSize = 0;
 	resourceBufferAvailable = 0;
+	resourceBytesCopied = 0;
+	resourceBytesMapped = 0;
+	readBatch = NULL;
 	numFilesOpenedAsCached = 0;
 }
 
@@ -1920,6 +1961,41 @@ bool idFileSystemLocal::RemoveDir( const char* relativePath )
 	return success;
 }
 
+/*
+========================
+idFileSystemLocal::GetMappedResourceData
+========================
+*/
+const byte* idFileSystemLocal::GetMappedResourceData( const idResourceCacheEntry& rc )
+{
+	if( !fs_mapResources.GetBool() || rc.containerIndex >= resourceFiles.Num() )
+	{
+		return NULL;
+	}
+	return resourceFiles[ rc.containerIndex ]->GetMappedData( rc );
+}
+
+/*
+========================
+idFileSystemLocal::OpenResourceContainerRead
+========================
+*/
+idFile* idFileSystemLocal::OpenResourceContainerRead( int containerIndex )
+{
+	if( containerIndex < 0 || containerIndex >= resourceFiles.Num() )
+	{
+		return NULL;
+	}
+	
+	// _ordered.resources lives in memory
+	idFile* resourceFile = resourceFiles[ containerIndex ]->resourceFile;
+	if( resourceFile == NULL || dynamic_cast< idFile_Permanent* >( resourceFile ) == NULL )
+	{
+		return NULL;
+	}
+	return OpenExplicitFileRead( resourceFile->GetFullPath() );
+}
+
 /*
 ============
 idFileSystemLocal::ReadFile
@@ -2245,9 +2321,10 @@ int idFileSystemLocal::GetFileList( const char* relativePath, const idStrList& e
 		int idx = resourceFiles.Num() - 1;
 		while( idx >= 0 )
 		{
-			for( int i = 0; i < resourceFiles[ idx ]->cacheTable.Num(); i++ )
+			idResourceCacheEntry rt;
+			for( int i = 0; i < resourceFiles[ idx ]->NumEntries(); i++ )
 			{
-				idResourceCacheEntry& rt = resourceFiles[ idx ]->cacheTable[ i ];
+				resourceFiles[ idx ]->GetEntry( i, rt );
 				// if the name is not long anough to at least contain the path
 				
 				if( rt.filename.Length() <= pathLength )
@@ -2669,6 +2746,328 @@ void idFileSystemLocal::Path_f( const idCmdArgs& args )
 	}
 }
 
+/*
+============
+idFileSystemLocal::ResourceStats_f
+============
+*/
+void idFileSystemLocal::ResourceStats_f( const idCmdArgs& args )
+{
+	if( args.Argc() > 1 && idStr::Icmp( args.Argv( 1 ), "reset" ) == 0 )
+	{
+		Sys_InterlockedAdd64( fileSystemLocal.resourceBytesCopied, -fileSystemLocal.resourceBytesCopied );
+		Sys_InterlockedAdd64( fileSystemLocal.resourceBytesMapped, -fileSystemLocal.resourceBytesMapped );
+		return;
+	}
+	
+	for( int i = 0; i < fileSystemLocal.resourceFiles.Num(); i++ )
+	{
+		const idResourceContainer* rc = fileSystemLocal.resourceFiles[ i ];
+		common->Printf( "%s%s\n", rc->GetFileName(), rc->IsMapped() ? " (mapped)" : "" );
+	}
+	common->Printf( "%5.1f MB copied, %5.1f MB mapped\n", fileSystemLocal.resourceBytesCopied / ( 1024.0f * 1024.0f ), fileSystemLocal.resourceBytesMapped / ( 1024.0f * 1024.0f ) );
+}
+
+/*
+============
+idFileSystemLocal::TestResourceMapping_f
+
+Reads every resource of the last loaded container, or of the
+given .preload manifest, with and without memory mapping
+============
+*/
+void idFileSystemLocal::TestResourceMapping_f( const idCmdArgs& args )
+{
+	if( fileSystemLocal.resourceFiles.Num() == 0 )
+	{
+		common->Printf( "no resource files loaded\n" );
+		return;
+	}
+	
+	idStrList files;
+	if( args.Argc() > 1 )
+	{
+		idPreloadManifest manifest;
+		if( !manifest.LoadManifest( args.Argv( 1 ) ) )
+		{
+			common->Printf( "couldn't load manifest %s\n", args.Argv( 1 ) );
+			return;
+		}
+		for( int i = 0; i < manifest.NumResources(); i++ )
+		{
+			files.Append( manifest.GetResourceNameByIndex( i ) );
+		}
+	}
+	else
+	{
+		const idResourceContainer* rc = fileSystemLocal.resourceFiles[ fileSystemLocal.resourceFiles.Num() - 1 ];
+		idResourceCacheEntry rt;
+		for( int i = 0; i < rc->NumEntries(); i++ )
+		{
+			rc->GetEntry( i, rt );
+			files.Append( rt.filename.c_str() );
+		}
+	}
+	
+	const bool mapResources = fs_mapResources.GetBool();
+	byte* scratch = NULL;
+	int scratchSize = 0;
+	
+	// the first two passes warm up the page cache so both variants are measured the same way
+	for( int pass = 0; pass < 4; pass++ )
+	{
+		const bool mapped = ( pass & 1 ) != 0;
+		fs_mapResources.SetBool( mapped );
+		
+		const int64 copiedBefore = fileSystemLocal.resourceBytesCopied;
+		const int64 mappedBefore = fileSystemLocal.resourceBytesMapped;
+		int64 bytesRead = 0;
+		int numFiles = 0;
+		volatile byte touched = 0;
+		
+		const uint64 start = Sys_Microseconds();
+		for( int i = 0; i < files.Num(); i++ )
+		{
+			idFile* f = fileSystemLocal.GetResourceFile( files[ i ], false );
+			if( f == NULL )
+			{
+				continue;
+			}
+			
+			// consume the file the way the loaders do, either in place from the mapping or with a read
+			idFile_InnerResource* inner = dynamic_cast< idFile_InnerResource* >( f );
+			if( inner != NULL && inner->GetMappedData() != NULL )
+			{
+				// touch every page so the mapping is actually faulted in
+				const byte* data = inner->GetMappedData();
+				for( int j = 0; j < f->Length(); j += 4096 )
+				{
+					touched += data[ j ];
+				}
+				bytesRead += f->Length();
+			}
+			else
+			{
+				if( f->Length() > scratchSize )
+				{
+					Mem_Free( scratch );
+					scratchSize = f->Length();
+					scratch = ( byte* )Mem_Alloc( scratchSize, TAG_TEMP );
+				}
+				bytesRead += f->Read( scratch, f->Length() );
+			}
+			numFiles++;
+			delete f;
+		}
+		const uint64 end = Sys_Microseconds();
+		
+		if( pass >= 2 )
+		{
+			common->Printf( "%s: %d files, %5.1f MB in %5.1f msec, %5.1f MB copied, %5.1f MB mapped\n", mapped ? "mapped" : "copied", numFiles,
+							bytesRead / ( 1024.0f * 1024.0f ), ( end - start ) * 0.001f,
+							( fileSystemLocal.resourceBytesCopied - copiedBefore ) / ( 1024.0f * 1024.0f ),
+							( fileSystemLocal.resourceBytesMapped - mappedBefore ) / ( 1024.0f * 1024.0f ) );
+		}
+	}
+	
+	Mem_Free( scratch );
+	fs_mapResources.SetBool( mapResources );
+}
+
+struct resourceFileOrder_t
+{
+	int		offset;
+	int		index;
+};
+
+class idSort_ResourceFileOrder : public idSort_Quick< resourceFileOrder_t, idSort_ResourceFileOrder >
+{
+public:
+	int Compare( const resourceFileOrder_t& a, const resourceFileOrder_t& b ) const
+	{
+		if( a.offset != b.offset )
+		{
+			return ( a.offset < b.offset ) ? -1 : 1;
+		}
+		return a.index - b.index;
+	}
+};
+
+/*
+============
+idFileSystemLocal::TestResourceFormat_f
+
+Rewrites a container as v1, v2 and compressed v2 and compares the bytes
+and time it takes to open each of them, and the bytes and seeks it takes
+to read the files of a level in the order of its .manifest, or in the
+order of the container without a manifest. With a manifest the v2
+containers store the manifest files first, in load order.
+
+testResourceFormat <resource file> [file manifest]
+============
+*/
+void idFileSystemLocal::TestResourceFormat_f( const idCmdArgs& args )
+{
+	if( args.Argc() < 2 )
+	{
+		common->Printf( "Usage: testResourceFormat <resource file> [file manifest]\n" );
+		return;
+	}
+	
+	const char* sourceName = args.Argv( 1 );
+	idResourceContainer source;
+	if( idResourceContainer::ReadFileVersion( sourceName ) == 0 || !source.Init( sourceName, 0 ) )
+	{
+		common->Printf( "%s is not a resource file\n", sourceName );
+		return;
+	}
+	
+	// the order the files are stored in the source
+	idList< resourceFileOrder_t > fileOrder;
+	fileOrder.SetNum( source.NumEntries() );
+	idResourceCacheEntry rt;
+	for( int i = 0; i < source.NumEntries(); i++ )
+	{
+		source.GetEntry( i, rt );
+		fileOrder[ i ].offset = rt.offset;
+		fileOrder[ i ].index = i;
+	}
+	fileOrder.SortWithTemplate( idSort_ResourceFileOrder() );
+	
+	idStrList storedOrder;
+	for( int i = 0; i < fileOrder.Num(); i++ )
+	{
+		source.GetEntry( fileOrder[ i ].index, rt );
+		storedOrder.Append( rt.filename.c_str() );
+	}
+	
+	// the order a level loads them in
+	idStrList loadOrder;
+	if( args.Argc() > 2 )
+	{
+		idFileManifest manifest;
+		if( !manifest.LoadManifest( args.Argv( 2 ) ) )
+		{
+			common->Printf( "couldn't load manifest %s\n", args.Argv( 2 ) );
+			return;
+		}
+		for( int i = 0; i < manifest.NumFiles(); i++ )
+		{
+			idStr name = manifest.GetFileNameByIndex( i );
+			name.BackSlashesToSlashes();
+			name.ToLower();
+			if( source.FindEntry( name ) >= 0 )
+			{
+				loadOrder.AddUnique( name );
+			}
+		}
+	}
+	else
+	{
+		loadOrder = storedOrder;
+	}
+	
+	// v2 groups the files of the level at the front in load order
+	idStrList groupedOrder = loadOrder;
+	for( int i = 0; i < storedOrder.Num(); i++ )
+	{
+		groupedOrder.AddUnique( storedOrder[ i ] );
+	}
+	
+	struct formatTest_t
+	{
+		const char* 	name;
+		const char* 	fileName;
+		int				version;
+		bool			compress;
+		const idStrList* order;
+	};
+	const formatTest_t tests[] =
+	{
+		{ "v1", "_testformat_v1.resources", 1, false, &storedOrder },
+		{ "v2", "_testformat_v2.resources", 2, false, &groupedOrder },
+		{ "v2 compressed", "_testformat_v2z.resources", 2, true, &groupedOrder },
+	};
+	const int NUM_OPENS = 10;
+	
+	common->Printf( "%s: %d files, %d loaded by the level, open time is the best of %d, the page cache is warm\n", sourceName, source.NumEntries(), loadOrder.Num(), NUM_OPENS );
+	common->Printf( "format           size MB  open KB  open ms  load MB  seeks  load ms\n" );
+	
+	for( int t = 0; t < sizeof( tests ) / sizeof( tests[ 0 ] ); t++ )
+	{
+		const formatTest_t& test = tests[ t ];
+		
+		idResourceWriter writer;
+		if( !writer.Open( test.fileName, test.version, test.compress ) )
+		{
+			common->Printf( "couldn't write %s\n", test.fileName );
+			continue;
+		}
+		for( int i = 0; i < test.order->Num(); i++ )
+		{
+			source.GetEntry( source.FindEntry( ( *test.order )[ i ] ), rt );
+			byte* data = source.ReadEntryData( rt );
+			if( data != NULL )
+			{
+				writer.AddFile( rt.filename, data, rt.length );
+				Mem_Free( data );
+			}
+		}
+		writer.Close();
+		
+		// startup, the v1 table is parsed and hashed, the v2 directory is used as is
+		uint64 openTime = 0;
+		int openBytes = 0;
+		int fileLength = 0;
+		for( int i = 0; i < NUM_OPENS; i++ )
+		{
+			idResourceContainer container;
+			const uint64 start = Sys_Microseconds();
+			container.Init( test.fileName, 0 );
+			const uint64 time = Sys_Microseconds() - start;
+			if( i == 0 || time < openTime )
+			{
+				openTime = time;
+			}
+			openBytes = container.GetDirectoryLength() + ( ( test.version == 1 ) ? 12 : RESOURCE_FILE_V2_HEADER_SIZE );
+			fileLength = ( container.resourceFile != NULL ) ? container.resourceFile->Length() : 0;
+		}
+		
+		// level load, count the stored bytes and the jumps between files that aren't adjacent
+		idResourceContainer container;
+		container.Init( test.fileName, 0 );
+		int64 loadBytes = 0;
+		int seeks = 0;
+		int nextOffset = -1;
+		const uint64 loadStart = Sys_Microseconds();
+		for( int i = 0; i < loadOrder.Num(); i++ )
+		{
+			const int index = container.FindEntry( loadOrder[ i ] );
+			if( index < 0 )
+			{
+				continue;
+			}
+			container.GetEntry( index, rt );
+			if( rt.offset < nextOffset || rt.offset > nextOffset + 15 )
+			{
+				seeks++;
+			}
+			nextOffset = rt.offset + rt.storedLength;
+			loadBytes += rt.storedLength;
+			Mem_Free( container.ReadEntryData( rt ) );
+		}
+		const uint64 loadTime = Sys_Microseconds() - loadStart;
+		
+		common->Printf( "%-14s  %8.1f  %7.1f  %7.2f  %7.1f  %5d  %7.1f\n", test.name, fileLength / ( 1024.0f * 1024.0f ), openBytes / 1024.0f,
+						openTime * 0.001f, loadBytes / ( 1024.0f * 1024.0f ), seeks, loadTime * 0.001f );
+	}
+	
+	for( int t = 0; t < sizeof( tests ) / sizeof( tests[ 0 ] ); t++ )
+	{
+		fileSystemLocal.RemoveFile( tests[ t ].fileName );
+	}
+}
+
 /*
 ============
 idFileSystemLocal::TouchFile_f
@@ -2771,50 +3170,30 @@ void idFileSystemLocal::CreateCRCsForResourceFileList( const idFileList& list )
 	{
 		idLib::Printf( " Processing %s.\n", list.GetFile( fileIndex ) );
 		
-		std::auto_ptr<idFile_Memory> currentFile( static_cast<idFile_Memory*>( fileSystem->OpenFileReadMemory( list.GetFile( fileIndex ) ) ) );
-		
-		if( currentFile.get() == NULL )
+		if( idResourceContainer::ReadFileVersion( list.GetFile( fileIndex ) ) == 0 )
 		{
-			idLib::Printf( " Error reading %s.\n", list.GetFile( fileIndex ) );
+			idLib::Printf( "Resource file magic number doesn't match, skipping %s.\n", list.GetFile( fileIndex ) );
 			continue;
 		}
 		
-		uint32 resourceMagic;
-		currentFile->ReadBig( resourceMagic );
-		
-		if( resourceMagic != RESOURCE_FILE_MAGIC )
+		idResourceContainer container;
+		if( !container.Init( list.GetFile( fileIndex ), 0 ) )
 		{
-			idLib::Printf( "Resource file magic number doesn't match, skipping %s.\n", list.GetFile( fileIndex ) );
+			idLib::Printf( " Error reading %s.\n", list.GetFile( fileIndex ) );
 			continue;
 		}
 		
-		int tableOffset;
-		currentFile->ReadBig( tableOffset );
-		
-		int tableLength;
-		currentFile->ReadBig( tableLength );
-		
-		// Read in the table
-		currentFile->Seek( tableOffset, FS_SEEK_SET );
-		
-		int numFileResources;
-		currentFile->ReadBig( numFileResources );
-		
-		idList< idResourceCacheEntry > cacheEntries;
-		cacheEntries.SetNum( numFileResources );
+		const int numFileResources = container.NumEntries();
 		
-		for( int innerFileIndex = 0; innerFileIndex < numFileResources; ++innerFileIndex )
-		{
-			cacheEntries[innerFileIndex].Read( currentFile.get() );
-		}
-		
-		// All tables read, now seek to each one and calculate the CRC.
+		// the CRCs are of the uncompressed data, so they don't depend on the container version
 		idTempArray< unsigned int > innerFileCRCs( numFileResources ); // DG: use int instead of long for 64bit compatibility
 		for( int innerFileIndex = 0; innerFileIndex < numFileResources; ++innerFileIndex )
 		{
-			const char* innerFileDataBegin = currentFile->GetDataPtr() + cacheEntries[innerFileIndex].offset;
-			
-			innerFileCRCs[innerFileIndex] = CRC32_BlockChecksum( innerFileDataBegin, cacheEntries[innerFileIndex].length );
+			idResourceCacheEntry rt;
+			container.GetEntry( innerFileIndex, rt );
+			byte* innerFileData = container.ReadEntryData( rt );
+			innerFileCRCs[innerFileIndex] = ( innerFileData != NULL ) ? CRC32_BlockChecksum( innerFileData, rt.length ) : 0;
+			Mem_Free( innerFileData );
 		}
 		
 		// Get the CRC for all the CRCs.
@@ -3094,6 +3473,9 @@ void idFileSystemLocal::Startup()
 	cmdSystem->AddCommand( "updateResourceFile", UpdateResourceFile_f, CMD_FL_SYSTEM, "updates or appends the supplied files in the supplied resource file" );
 	
 	cmdSystem->AddCommand( "generateResourceCRCs", GenerateResourceCRCs_f, CMD_FL_SYSTEM, "Generates CRC checksums for all the resource files." );
+	cmdSystem->AddCommand( "resourceStats", ResourceStats_f, CMD_FL_SYSTEM, "prints bytes copied and mapped from resource files, 'resourceStats reset' clears them" );
+	cmdSystem->AddCommand( "testResourceMapping", TestResourceMapping_f, CMD_FL_SYSTEM, "compares loading resources through copies and through memory mapped views" );
+	cmdSystem->AddCommand( "testResourceFormat", TestResourceFormat_f, CMD_FL_SYSTEM, "compares opening and level loading I/O of v1 and v2 .resources files" );
 	
 	// print the current search paths
 	Path_f( idCmdArgs() );
@@ -3177,6 +3559,8 @@ void idFileSystemLocal::Shutdown( bool reloading )
 	gameFolder.Clear();
 	searchPaths.Clear();
 	
+	asyncFileReader.Shutdown();
+	
 	resourceFiles.DeleteContents();
 	
 	
@@ -3184,6 +3568,9 @@ void idFileSystemLocal::Shutdown( bool reloading )
 	cmdSystem->RemoveCommand( "dir" );
 	cmdSystem->RemoveCommand( "dirtree" );
 	cmdSystem->RemoveCommand( "touchFile" );
+	cmdSystem->RemoveCommand( "resourceStats" );
+	cmdSystem->RemoveCommand( "testResourceMapping" );
+	cmdSystem->RemoveCommand( "testResourceFormat" );
 }
 
 /*
@@ -3233,18 +3620,12 @@ bool idFileSystemLocal::GetResourceCacheEntry( const char* fileName, idResourceC
 	int idx = resourceFiles.Num() - 1;
 	while( idx >= 0 )
 	{
-		const int key = resourceFiles[ idx ]->cacheHash.GenerateKey( canonical, false );
-		for( int index = resourceFiles[ idx ]->cacheHash.GetFirst( key ); index != idHashIndex::NULL_INDEX; index = resourceFiles[ idx ]->cacheHash.GetNext( index ) )
+		const int index = resourceFiles[ idx ]->FindEntry( canonical );
+		if( index >= 0 )
 		{
-			idResourceCacheEntry& rt = resourceFiles[ idx ]->cacheTable[ index ];
-			if( idStr::Icmp( rt.filename, canonical ) == 0 )
-			{
-				rc.filename = rt.filename;
-				rc.length = rt.length;
-				rc.containerIndex = idx;
-				rc.offset = rt.offset;
-				return true;
-			}
+			resourceFiles[ idx ]->GetEntry( index, rc );
+			rc.containerIndex = idx;
+			return true;
 		}
 		idx--;
 	}
@@ -3267,6 +3648,16 @@ idFile* idFileSystemLocal::GetResourceFile( const char* fileName, bool memFile )
 		return NULL;
 	}
 	
+	// already read, or being read, by the async read threads
+	if( readBatch != NULL )
+	{
+		idFile* file = readBatch->OpenFile( fileName, memFile );
+		if( file != NULL )
+		{
+			return file;
+		}
+	}
+	
 	static idResourceCacheEntry rc;
 	if( GetResourceCacheEntry( fileName, rc ) )
 	{
@@ -3274,6 +3665,36 @@ idFile* idFileSystemLocal::GetResourceFile( const char* fileName, bool memFile )
 		{
 			idLib::Printf( "RES: loading file %s\n", rc.filename.c_str() );
 		}
+		
+		// hand out a view into the mapped container, no copy and no seek+read
+		const byte* mappedData = fs_mapResources.GetBool() ? resourceFiles[ rc.containerIndex ]->GetMappedData( rc ) : NULL;
+		if( mappedData != NULL )
+		{
+			Sys_InterlockedAdd64( resourceBytesMapped, rc.length );
+			if( memFile )
+			{
+				// read only, the idFile_Memory doesn't own the data
+				return new idFile_Memory( rc.filename, ( const char* )mappedData, rc.length );
+			}
+			idFile_InnerResource* file = new idFile_InnerResource( rc.filename, resourceFiles[ rc.containerIndex ]->resourceFile, rc.offset, rc.length );
+			file->SetMappedData( mappedData );
+			return file;
+		}
+		
+		// compressed entries are always inflated into memory
+		if( rc.compression != RESOURCE_COMPRESSION_NONE )
+		{
+			byte* data = resourceFiles[ rc.containerIndex ]->ReadEntryData( rc );
+			if( data == NULL )
+			{
+				return NULL;
+			}
+			Sys_InterlockedAdd64( resourceBytesCopied, rc.storedLength );
+			idFile_Memory* mfile = new idFile_Memory( rc.filename, ( const char* )data, rc.length );
+			mfile->TakeDataOwnership();
+			return mfile;
+		}
+		
 		idFile_InnerResource* file = new idFile_InnerResource( rc.filename, resourceFiles[ rc.containerIndex ]->resourceFile, rc.offset, rc.length );
 		// DG: add parenthesis to make sure this block is only entered when file != NULL - bug found by clang.
 		if( file != NULL && ( ( memFile || rc.length <= resourceBufferAvailable ) || rc.length < 8 * 1024 * 1024 ) )
@@ -3293,6 +3714,7 @@ idFile* idFileSystemLocal::GetResourceFile( const char* fileName, bool memFile )
 				buf = ( byte* )Mem_Alloc( rc.length, TAG_TEMP );
 			}
 			file->Read( ( void* )buf, rc.length );
+			Sys_InterlockedAdd64( resourceBytesCopied, rc.length );
 			
 			if( buf == resourceBufferPtr )
 			{
@@ -94,6 +94,8 @@ private:
 	idStrList				list;
 };
 
+class idAsyncReadBatch;
+
 class idFileSystem
 {
 public:
@@ -217,6 +219,14 @@ public:
 	virtual void			AddParticlePreload( const char* resName ) = 0;
 	virtual void			AddCollisionPreload( const char* resName ) = 0;
 	
+	// async level loading, see idAsyncReadBatch
+	// while a batch is set, resources opened for reading are taken from it
+	virtual void			SetReadBatch( const idAsyncReadBatch* batch ) = 0;
+	// NULL if the container of the resource isn't memory mapped
+	virtual const byte* 	GetMappedResourceData( const idResourceCacheEntry& rc ) = 0;
+	// a new handle to a resource container that can be read from another thread, NULL for in memory containers
+	virtual idFile* 		OpenResourceContainerRead( int containerIndex ) = 0;
+	
 };
 
 extern idFileSystem* 		fileSystem;
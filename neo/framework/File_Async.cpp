@@ -0,0 +1,687 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+idCVar fs_asyncReadThreads( "fs_asyncReadThreads", "2", CVAR_SYSTEM | CVAR_INTEGER | CVAR_INIT, "number of threads reading resources ahead during level loads, 0 reads everything on demand", 0, MAX_ASYNC_READ_THREADS );
+
+idCVar fs_asyncReadAheadMB( "fs_asyncReadAheadMB", "64", CVAR_SYSTEM | CVAR_INTEGER, "megabytes of resources that are read ahead and not yet consumed before the async read threads wait", 1, 1024 );
+
+idAsyncFileReader	asyncFileReader;
+
+/*
+================================================================================================
+
+idAsyncReadThread
+
+================================================================================================
+*/
+
+class idAsyncReadThread : public idSysThread
+{
+public:
+	idAsyncReadThread() : threadNum( 0 ) {}
+	
+	virtual int		Run()
+	{
+		idAsyncReadBatch* batch;
+		int index;
+		while( asyncFileReader.GetNextRequest( batch, index ) )
+		{
+			batch->ReadRequest( index, threadNum );
+		}
+		return 0;
+	}
+	
+	int				threadNum;
+};
+
+static idAsyncReadThread	asyncReadThreads[ MAX_ASYNC_READ_THREADS ];
+
+/*
+================================================================================================
+
+idAsyncReadBatch
+
+================================================================================================
+*/
+
+struct asyncReadSort_t
+{
+	int		index;
+	int		containerIndex;
+	int		offset;
+};
+
+class idSort_AsyncRead : public idSort_Quick< asyncReadSort_t, idSort_AsyncRead >
+{
+public:
+	int Compare( const asyncReadSort_t& a, const asyncReadSort_t& b ) const
+	{
+		if( a.containerIndex != b.containerIndex )
+		{
+			return a.containerIndex - b.containerIndex;
+		}
+		return a.offset - b.offset;
+	}
+};
+
+/*
+========================
+idAsyncReadBatch::idAsyncReadBatch
+========================
+*/
+idAsyncReadBatch::idAsyncReadBatch() :
+	nextRead( 0 ),
+	submitted( false ),
+	maxBufferedBytes( 0 ),
+	bufferedBytes( 0 ),
+	unblockedReads( -1 ),
+	cancelled( false )
+{
+	requests.SetGranularity( 1024 );
+	readOrder.SetGranularity( 1024 );
+}
+
+/*
+========================
+idAsyncReadBatch::~idAsyncReadBatch
+========================
+*/
+idAsyncReadBatch::~idAsyncReadBatch()
+{
+	Clear();
+}
+
+/*
+========================
+idAsyncReadBatch::Add
+========================
+*/
+int idAsyncReadBatch::Add( const char* fileName, asyncReadCallback_t callback, void* userData )
+{
+	assert( !submitted );
+	
+	asyncReadRequest_t& r = requests.Alloc();
+	r.fileName = fileName;
+	r.fileName.BackSlashesToSlashes();
+	r.callback = callback;
+	r.userData = userData;
+	r.containerIndex = -1;
+	r.offset = 0;
+	r.length = 0;
+	r.storedLength = 0;
+	r.compression = RESOURCE_COMPRESSION_NONE;
+	r.mappedData = NULL;
+	r.buffer = NULL;
+	r.readPosition = 0;
+	r.done = false;
+	
+	const int index = requests.Num() - 1;
+	hash.Add( hash.GenerateKey( r.fileName, false ), index );
+	return index;
+}
+
+/*
+========================
+idAsyncReadBatch::Submit
+========================
+*/
+void idAsyncReadBatch::Submit()
+{
+	assert( !submitted );
+	submitted = true;
+	
+	const int numThreads = fileSystem->UsingResourceFiles() ? asyncFileReader.NumThreads() : 0;
+	
+	idList< asyncReadSort_t, TAG_RESOURCE > sort;
+	sort.SetNum( requests.Num() );
+	
+	idResourceCacheEntry rc;
+	for( int i = 0; i < requests.Num(); i++ )
+	{
+		asyncReadRequest_t& r = requests[ i ];
+		
+		if( numThreads > 0 && fileSystem->GetResourceCacheEntry( r.fileName, rc ) )
+		{
+			r.containerIndex = rc.containerIndex;
+			r.offset = rc.offset;
+			r.length = rc.length;
+			r.storedLength = rc.storedLength;
+			r.compression = rc.compression;
+			r.mappedData = fileSystem->GetMappedResourceData( rc );
+			
+			// every thread needs its own handle to seek in a container that isn't mapped,
+			// compressed entries are never mapped and are inflated on the read thread
+			if( r.mappedData == NULL )
+			{
+				int h;
+				for( h = 0; h < handles.Num(); h++ )
+				{
+					if( handles[ h ].containerIndex == r.containerIndex )
+					{
+						break;
+					}
+				}
+				if( h == handles.Num() )
+				{
+					containerHandles_t& ch = handles.Alloc();
+					memset( &ch, 0, sizeof( ch ) );
+					ch.containerIndex = r.containerIndex;
+					for( int t = 0; t < numThreads; t++ )
+					{
+						ch.files[ t ] = fileSystem->OpenResourceContainerRead( r.containerIndex );
+					}
+				}
+				if( handles[ h ].files[ numThreads - 1 ] == NULL )
+				{
+					// in memory containers can't be read in the background
+					r.containerIndex = -1;
+				}
+			}
+		}
+		
+		sort[ i ].index = i;
+		sort[ i ].containerIndex = r.containerIndex;
+		sort[ i ].offset = r.offset;
+	}
+	
+	// the requests that aren't read in the background sort first and are done right away
+	sort.SortWithTemplate( idSort_AsyncRead() );
+	
+	readOrder.SetNum( sort.Num() );
+	nextRead = 0;
+	for( int i = 0; i < sort.Num(); i++ )
+	{
+		readOrder[ i ] = sort[ i ].index;
+		requests[ sort[ i ].index ].readPosition = i;
+		if( sort[ i ].containerIndex == -1 )
+		{
+			requests[ sort[ i ].index ].done = true;
+			nextRead = i + 1;
+		}
+	}
+	numCompleted.Exchange( nextRead );
+	
+	maxBufferedBytes = fs_asyncReadAheadMB.GetInteger() * 1024 * 1024;
+	bufferedBytes = 0;
+	unblockedReads = -1;
+	cancelled = false;
+	
+	if( nextRead < readOrder.Num() )
+	{
+		asyncFileReader.SubmitBatch( this );
+	}
+}
+
+/*
+========================
+idAsyncReadBatch::Clear
+========================
+*/
+void idAsyncReadBatch::Clear()
+{
+	if( submitted )
+	{
+		// requests that were never consumed don't need to be read anymore
+		cancelled = true;
+		WaitAll();
+	}
+	
+	// free the data of the requests that weren't consumed
+	for( int i = 0; i < requests.Num(); i++ )
+	{
+		Mem_Free( requests[ i ].buffer );
+	}
+	for( int i = 0; i < handles.Num(); i++ )
+	{
+		for( int t = 0; t < MAX_ASYNC_READ_THREADS; t++ )
+		{
+			delete handles[ i ].files[ t ];
+		}
+	}
+	
+	requests.Clear();
+	readOrder.Clear();
+	handles.Clear();
+	hash.Clear();
+	nextRead = 0;
+	bufferedBytes = 0;
+	unblockedReads = -1;
+	numCompleted.Exchange( 0 );
+	submitted = false;
+}
+
+/*
+========================
+idAsyncReadBatch::WaitForBudget
+
+Runs on an async read thread. A single request larger than the budget is still
+read once nothing else is buffered, and the threads that check at the same time
+may all go ahead, so the budget can be exceeded by a few requests. Returns false
+when the batch is cleared while waiting, the request isn't read then.
+========================
+*/
+bool idAsyncReadBatch::WaitForBudget( const asyncReadRequest_t& r ) const
+{
+	const int size = r.length + 1;
+	for( ;; )
+	{
+		// sample the signal first so no release after the check is missed
+		const int signal = budgetSignal.GetValue();
+		if( cancelled )
+		{
+			return false;
+		}
+		const int buffered = bufferedBytes;
+		if( buffered == 0 || buffered + size <= maxBufferedBytes || r.readPosition <= unblockedReads )
+		{
+			break;
+		}
+		budgetSignal.WaitWhileEqual( signal );
+	}
+	Sys_InterlockedAdd( bufferedBytes, size );
+	return true;
+}
+
+/*
+========================
+idAsyncReadBatch::FreeBuffer
+
+Frees the buffered data of a request unless it was already handed out.
+========================
+*/
+void idAsyncReadBatch::FreeBuffer( int index ) const
+{
+	asyncReadRequest_t& r = requests[ index ];
+	void* buffer = Sys_InterlockedExchangePointer( r.buffer, NULL );
+	if( buffer != NULL )
+	{
+		Mem_Free( buffer );
+		Sys_InterlockedAdd( bufferedBytes, -( r.length + 1 ) );
+		budgetSignal.Increment();
+	}
+}
+
+/*
+========================
+idAsyncReadBatch::ReadRequest
+
+Runs on an async read thread
+========================
+*/
+void idAsyncReadBatch::ReadRequest( int index, int threadNum )
+{
+	asyncReadRequest_t& r = requests[ index ];
+	
+	const byte* data = NULL;
+	if( cancelled )
+	{
+		// the batch is being cleared
+	}
+	else if( r.mappedData != NULL )
+	{
+		// touch every page, the actual reads happen in the page fault handler
+		volatile byte touched = 0;
+		for( int i = 0; i < r.length; i += 4096 )
+		{
+			touched += r.mappedData[ i ];
+		}
+		data = r.mappedData;
+	}
+	else
+	{
+		idFile* file = NULL;
+		for( int h = 0; h < handles.Num(); h++ )
+		{
+			if( handles[ h ].containerIndex == r.containerIndex )
+			{
+				file = handles[ h ].files[ threadNum ];
+				break;
+			}
+		}
+		
+		if( !WaitForBudget( r ) )
+		{
+			r.done = true;
+			numCompleted.Increment();
+			return;
+		}
+		
+		// keep a trailing 0 for text parsing
+		byte* buffer = ( byte* )Mem_Alloc( r.length + 1, TAG_RESOURCE );
+		byte* storedBuffer = ( r.compression != RESOURCE_COMPRESSION_NONE ) ? ( byte* )Mem_Alloc( Max( r.storedLength, 1 ), TAG_RESOURCE ) : buffer;
+		bool ok = ( file != NULL && file->Seek( r.offset, FS_SEEK_SET ) == 0 && file->Read( storedBuffer, r.storedLength ) == r.storedLength );
+		if( storedBuffer != buffer )
+		{
+			if( ok )
+			{
+				idResourceCacheEntry rc;
+				rc.length = r.length;
+				rc.storedLength = r.storedLength;
+				rc.compression = r.compression;
+				ok = idResourceContainer::DecompressEntry( rc, storedBuffer, buffer );
+			}
+			Mem_Free( storedBuffer );
+		}
+		if( ok )
+		{
+			buffer[ r.length ] = 0;
+			r.buffer = buffer;
+			data = buffer;
+		}
+		else
+		{
+			// let the consumer open it the regular way
+			Mem_Free( buffer );
+			Sys_InterlockedAdd( bufferedBytes, -( r.length + 1 ) );
+			budgetSignal.Increment();
+		}
+	}
+	
+	if( data != NULL && r.callback != NULL )
+	{
+		r.callback( r.fileName, data, r.length, r.userData );
+	}
+	
+	r.done = true;
+	numCompleted.Increment();
+}
+
+/*
+========================
+idAsyncReadBatch::Wait
+========================
+*/
+void idAsyncReadBatch::Wait( int index ) const
+{
+	const asyncReadRequest_t& r = requests[ index ];
+	if( r.done )
+	{
+		SYS_MEMORYBARRIER;
+		return;
+	}
+	
+	// the budget may be taken by requests that are consumed after this one
+	for( ;; )
+	{
+		const int unblocked = unblockedReads;
+		if( unblocked >= r.readPosition || Sys_InterlockedCompareExchange( unblockedReads, unblocked, r.readPosition ) == unblocked )
+		{
+			break;
+		}
+	}
+	budgetSignal.Increment();
+	
+	while( !r.done )
+	{
+		const int completed = numCompleted.GetValue();
+		if( r.done )
+		{
+			break;
+		}
+		numCompleted.WaitWhileEqual( completed );
+	}
+	SYS_MEMORYBARRIER;
+}
+
+/*
+========================
+idAsyncReadBatch::WaitAll
+========================
+*/
+void idAsyncReadBatch::WaitAll() const
+{
+	// nothing may be consumed while waiting, so the budget can't hold any read back
+	Sys_InterlockedExchange( unblockedReads, INT_MAX );
+	budgetSignal.Increment();
+	
+	for( ;; )
+	{
+		const int completed = numCompleted.GetValue();
+		if( completed >= requests.Num() )
+		{
+			break;
+		}
+		numCompleted.WaitWhileEqual( completed );
+	}
+	SYS_MEMORYBARRIER;
+}
+
+/*
+========================
+idAsyncReadBatch::OpenFile
+========================
+*/
+idFile* idAsyncReadBatch::OpenFile( int index, bool memFile ) const
+{
+	if( !submitted )
+	{
+		return NULL;
+	}
+	
+	Wait( index );
+	
+	asyncReadRequest_t& r = requests[ index ];
+	if( r.mappedData != NULL )
+	{
+		if( memFile )
+		{
+			return new idFile_Memory( r.fileName, ( const char* )r.mappedData, r.length );
+		}
+		idFile_InnerResource* file = new idFile_InnerResource( r.fileName, NULL, r.offset, r.length );
+		file->SetMappedData( r.mappedData );
+		return file;
+	}
+	
+	// the file frees the data when it is closed
+	char* buffer = ( char* )Sys_InterlockedExchangePointer( r.buffer, NULL );
+	if( buffer == NULL )
+	{
+		return NULL;
+	}
+	Sys_InterlockedAdd( bufferedBytes, -( r.length + 1 ) );
+	budgetSignal.Increment();
+	
+	if( r.length == 0 )
+	{
+		Mem_Free( buffer );
+		return new idFile_Memory( r.fileName, "", 0 );
+	}
+	idFile_Memory* file = new idFile_Memory( r.fileName, ( const char* )buffer, r.length );
+	file->TakeDataOwnership();
+	return file;
+}
+
+/*
+========================
+idAsyncReadBatch::GetData
+========================
+*/
+const byte* idAsyncReadBatch::GetData( int index, int& length ) const
+{
+	length = 0;
+	if( !submitted )
+	{
+		return NULL;
+	}
+	
+	Wait( index );
+	
+	const asyncReadRequest_t& r = requests[ index ];
+	const byte* data = ( r.mappedData != NULL ) ? r.mappedData : ( const byte* )r.buffer;
+	if( data != NULL )
+	{
+		length = r.length;
+	}
+	return data;
+}
+
+/*
+========================
+idAsyncReadBatch::ReleaseData
+========================
+*/
+void idAsyncReadBatch::ReleaseData( int index ) const
+{
+	if( submitted )
+	{
+		FreeBuffer( index );
+	}
+}
+
+/*
+========================
+idAsyncReadBatch::OpenFile
+========================
+*/
+idFile* idAsyncReadBatch::OpenFile( const char* fileName, bool memFile ) const
+{
+	if( !submitted )
+	{
+		return NULL;
+	}
+	
+	idStrStatic< MAX_OSPATH > canonical = fileName;
+	canonical.BackSlashesToSlashes();
+	
+	const int key = hash.GenerateKey( canonical, false );
+	for( int i = hash.First( key ); i != -1; i = hash.Next( i ) )
+	{
+		if( canonical.Icmp( requests[ i ].fileName ) == 0 )
+		{
+			return OpenFile( i, memFile );
+		}
+	}
+	return NULL;
+}
+
+/*
+================================================================================================
+
+idAsyncFileReader
+
+================================================================================================
+*/
+
+/*
+========================
+idAsyncFileReader::idAsyncFileReader
+========================
+*/
+idAsyncFileReader::idAsyncFileReader() :
+	numThreads( -1 )
+{
+}
+
+/*
+========================
+idAsyncFileReader::StartThreads
+========================
+*/
+void idAsyncFileReader::StartThreads()
+{
+	numThreads = idMath::ClampInt( 0, MAX_ASYNC_READ_THREADS, fs_asyncReadThreads.GetInteger() );
+	for( int i = 0; i < numThreads; i++ )
+	{
+		asyncReadThreads[ i ].threadNum = i;
+		asyncReadThreads[ i ].StartWorkerThread( va( "AsyncRead%d", i ), CORE_ANY );
+	}
+}
+
+/*
+========================
+idAsyncFileReader::NumThreads
+========================
+*/
+int idAsyncFileReader::NumThreads()
+{
+	if( numThreads < 0 )
+	{
+		StartThreads();
+	}
+	return numThreads;
+}
+
+/*
+========================
+idAsyncFileReader::Shutdown
+========================
+*/
+void idAsyncFileReader::Shutdown()
+{
+	for( int i = 0; i < numThreads; i++ )
+	{
+		asyncReadThreads[ i ].StopThread();
+	}
+	numThreads = -1;
+}
+
+/*
+========================
+idAsyncFileReader::SubmitBatch
+========================
+*/
+void idAsyncFileReader::SubmitBatch( idAsyncReadBatch* batch )
+{
+	{
+		idScopedCriticalSection lock( mutex );
+		pendingBatches.Append( batch );
+	}
+	for( int i = 0; i < numThreads; i++ )
+	{
+		asyncReadThreads[ i ].SignalWork();
+	}
+}
+
+/*
+========================
+idAsyncFileReader::GetNextRequest
+========================
+*/
+bool idAsyncFileReader::GetNextRequest( idAsyncReadBatch*& batch, int& index )
+{
+	idScopedCriticalSection lock( mutex );
+	
+	if( pendingBatches.Num() == 0 )
+	{
+		return false;
+	}
+	
+	batch = pendingBatches[ 0 ];
+	index = batch->readOrder[ batch->nextRead++ ];
+	
+	// remove the batch as soon as the last request is handed out, the batch
+	// may be freed once that request completes
+	if( batch->nextRead >= batch->readOrder.Num() )
+	{
+		pendingBatches.RemoveIndex( 0 );
+	}
+	return true;
+}
@@ -0,0 +1,209 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __FILE_ASYNC_H__
+#define __FILE_ASYNC_H__
+
+/*
+==============================================================
+
+  Asynchronous batched reads
+
+==============================================================
+*/
+
+/*
+================================================
+idAsyncReadBatch reads a list of files on the async read threads so loaders
+can submit everything they will need up front and then consume the files one
+after the other while the remaining reads are still in flight.
+
+Only files inside the loaded .resources containers are read in the background.
+The reads are sorted by container and offset so the disk sees one forward sweep.
+When the container is memory mapped the I/O threads just fault the pages in.
+Any other file is left alone and is opened synchronously when it is consumed.
+
+The data read from containers that aren't mapped is buffered, and the read
+threads stop once fs_asyncReadAheadMB are buffered until the consumer frees
+some. A file opened from the batch takes over its buffer and frees it when it
+is closed, data from GetData() is freed with ReleaseData(). While a consumer
+waits for a request, the requests up to it are read regardless of the budget,
+so consuming out of read order can't stall.
+
+	idAsyncReadBatch batch;
+	for( ... )
+	{
+		batch.Add( generatedFileName );
+	}
+	batch.Submit();
+	
+	fileSystem->SetReadBatch( &batch );
+	for( int i = 0; i < batch.Num(); i++ )
+	{
+		// consume in read order, OpenFileRead() waits for just this file
+		const int index = batch.GetReadOrder( i );
+		...
+	}
+	fileSystem->SetReadBatch( NULL );
+
+The batch has to outlive all the files opened from it.
+================================================
+*/
+
+const int MAX_ASYNC_READ_THREADS = 4;
+
+// called on an async read thread as soon as the data of a request is in memory
+typedef void ( *asyncReadCallback_t )( const char* fileName, const byte* data, int length, void* userData );
+
+class idAsyncReadBatch
+{
+	friend class idAsyncFileReader;
+	friend class idAsyncReadThread;
+public:
+	idAsyncReadBatch();
+	~idAsyncReadBatch();
+	
+	// main thread only, before Submit()
+	int					Add( const char* fileName, asyncReadCallback_t callback = NULL, void* userData = NULL );
+	
+	// resolves and sorts the requests and starts reading them
+	void				Submit();
+	
+	// waits for outstanding reads and frees all the data
+	void				Clear();
+	
+	int					Num() const
+	{
+		return requests.Num();
+	}
+	// index of the i'th request in the order it is read from disk, valid after Submit()
+	int					GetReadOrder( int i ) const
+	{
+		return readOrder[ i ];
+	}
+	const char* 		GetFileName( int index ) const
+	{
+		return requests[ index ].fileName.c_str();
+	}
+	
+	// blocks until the request is finished
+	void				Wait( int index ) const;
+	void				WaitAll() const;
+	
+	// waits for the request and returns a view of the data, NULL if the file wasn't
+	// read in the background and has to be opened through the file system. The
+	// buffered data is handed to the file, so a request can only be opened once.
+	idFile* 			OpenFile( int index, bool memFile ) const;
+	idFile* 			OpenFile( const char* fileName, bool memFile ) const;
+	
+	// waits for the request and returns the data, which stays valid until it is released,
+	// the batch is cleared or a file is opened from it, NULL if the file wasn't read in the background
+	const byte* 		GetData( int index, int& length ) const;
+	
+	// frees the buffered data of a request that was consumed with GetData()
+	void				ReleaseData( int index ) const;
+	
+private:
+	struct asyncReadRequest_t
+	{
+		idStrStatic< MAX_OSPATH >	fileName;
+		asyncReadCallback_t			callback;
+		void* 						userData;
+		int							containerIndex;		// -1 if not in a resource container
+		int							offset;
+		int							length;
+		int							storedLength;		// differs from length if the entry is compressed
+		int							compression;
+		const byte* 				mappedData;			// set if the container is memory mapped
+		void* 						buffer;				// the data read from disk otherwise, until it is released
+		int							readPosition;		// index into readOrder
+		volatile bool				done;
+	};
+	
+	struct containerHandles_t
+	{
+		int							containerIndex;
+		idFile* 					files[ MAX_ASYNC_READ_THREADS ];	// one seek position per thread
+	};
+	
+	mutable idList< asyncReadRequest_t, TAG_RESOURCE >	requests;
+	idList< int, TAG_RESOURCE >					readOrder;
+	idList< containerHandles_t, TAG_RESOURCE >	handles;
+	idHashIndex									hash;
+	
+	int											nextRead;		// index into readOrder, protected by the reader mutex
+	mutable idSysWaitableInteger				numCompleted;
+	bool										submitted;
+	
+	// read ahead budget for the buffered data
+	int											maxBufferedBytes;
+	mutable interlockedInt_t					bufferedBytes;
+	mutable interlockedInt_t					unblockedReads;		// readOrder positions up to this are read regardless of the budget
+	mutable idSysWaitableInteger				budgetSignal;		// changes whenever data is released or reads are unblocked
+	volatile bool								cancelled;			// set by Clear, the requests that weren't read yet are skipped
+	
+	void				ReadRequest( int index, int threadNum );
+	bool				WaitForBudget( const asyncReadRequest_t& r ) const;
+	void				FreeBuffer( int index ) const;
+	
+	idAsyncReadBatch( const idAsyncReadBatch& ) {}
+	void				operator=( const idAsyncReadBatch& ) {}
+};
+
+/*
+================================================
+idAsyncFileReader owns the async read threads and hands them the
+requests of all submitted batches in submission order.
+================================================
+*/
+class idAsyncFileReader
+{
+public:
+	idAsyncFileReader();
+	
+	void				Shutdown();
+	
+	// starts the threads on first use
+	int					NumThreads();
+	
+	void				SubmitBatch( idAsyncReadBatch* batch );
+	
+	// called by the async read threads
+	bool				GetNextRequest( idAsyncReadBatch*& batch, int& index );
+	
+private:
+	idSysMutex						mutex;
+	idList< idAsyncReadBatch* >		pendingBatches;
+	int								numThreads;
+	
+	void				StartThreads();
+};
+
+extern idAsyncFileReader	asyncFileReader;
+
+#endif /* !__FILE_ASYNC_H__ */
@@ -29,6 +29,25 @@ If you have questions concerning this license or the applicable additional terms
 #include "precompiled.h"
 #pragma hdrstop
 
+#include "../libs/zlib/zlib.h"
+
+extern idCVar fs_mapResources;
+extern idCVar fs_resourceCompression;
+
+/*
+========================
+DirectoryValue
+
+v2 directories are used in place, so the big endian values are swapped on access
+========================
+*/
+template< class type >
+ID_INLINE type DirectoryValue( type value )
+{
+	idSwap::Big( value );
+	return value;
+}
+
 /*
 ================================================================================================
 
@@ -53,7 +72,7 @@ void idResourceContainer::ReOpen()
 idResourceContainer::Init
 ========================
 */
-bool idResourceContainer::Init( const char* _fileName, uint8 containerIndex )
+bool idResourceContainer::Init( const char* _fileName, uint8 _containerIndex )
 {
 
 	if( idStr::Icmp( _fileName, "_ordered.resources" ) == 0 )
@@ -72,15 +91,82 @@ bool idResourceContainer::Init( const char* _fileName, uint8 containerIndex )
 	}
 	
 	resourceFile->ReadBig( resourceMagic );
-	if( resourceMagic != RESOURCE_FILE_MAGIC )
+	if( resourceMagic != RESOURCE_FILE_MAGIC && resourceMagic != RESOURCE_FILE_MAGIC_V2 )
 	{
 		idLib::FatalError( "resourceFileMagic != RESOURCE_FILE_MAGIC" );
 	}
 	
 	fileName = _fileName;
+	containerIndex = _containerIndex;
+	
+	uint64 directoryOffset = 0;
+	if( resourceMagic == RESOURCE_FILE_MAGIC_V2 )
+	{
+		resourceFile->ReadBig( numFileResources );
+		resourceFile->ReadBig( directoryOffset );
+		resourceFile->ReadBig( tableLength );
+		
+		// entries are addressed with 32 bit offsets at runtime, the writer splits containers at 1GB
+		const int directorySize = numFileResources * sizeof( resourceDirectoryEntry_t );
+		if( numFileResources < 0 || tableLength < directorySize || directoryOffset > ( uint64 )( resourceFile->Length() - tableLength ) )
+		{
+			idLib::Warning( "Resource file %s is corrupt", _fileName );
+			return false;
+		}
+		tableOffset = ( int )directoryOffset;
+	}
+	else
+	{
+		resourceFile->ReadBig( tableOffset );
+		resourceFile->ReadBig( tableLength );
+	}
+	
+	// map the whole container once so resources can be handed out as views into the mapping,
+	// the in-memory _ordered.resources doesn't have a file to map
+	if( fs_mapResources.GetBool() && resourceFile->Length() > 0 && idStr::Icmp( _fileName, "_ordered.resources" ) != 0 )
+	{
+		mappedData = Sys_MapFileRead( resourceFile->GetFullPath(), mappedLength );
+		if( mappedData != NULL && mappedLength != resourceFile->Length() )
+		{
+			idLib::Warning( "Unable to map resource file %s", _fileName );
+			Sys_UnmapFile( mappedData, mappedLength );
+			mappedData = NULL;
+			mappedLength = 0;
+		}
+	}
+	
+	if( resourceMagic == RESOURCE_FILE_MAGIC_V2 )
+	{
+		// the directory is already sorted and hashed, use it straight from the mapping
+		// or read it with a single read, nothing is parsed
+		if( mappedData != NULL )
+		{
+			directory = ( const resourceDirectoryEntry_t* )( mappedData + tableOffset );
+		}
+		else
+		{
+			directoryBuffer = ( byte* )Mem_Alloc( tableLength, TAG_RESOURCE );
+			resourceFile->Seek( tableOffset, FS_SEEK_SET );
+			if( resourceFile->Read( directoryBuffer, tableLength ) != tableLength )
+			{
+				idLib::Warning( "Unable to read the directory of resource file %s", _fileName );
+				return false;
+			}
+			directory = ( const resourceDirectoryEntry_t* )directoryBuffer;
+		}
+		names = ( const char* )( directory + numFileResources );
+		namesLength = tableLength - numFileResources * sizeof( resourceDirectoryEntry_t );
+		
+		// every name offset inside the names is a terminated string
+		if( namesLength > 0 && names[ namesLength - 1 ] != '\0' )
+		{
+			idLib::Warning( "Resource file %s is corrupt", _fileName );
+			directory = NULL;
+			return false;
+		}
+		return true;
+	}
 	
-	resourceFile->ReadBig( tableOffset );
-	resourceFile->ReadBig( tableLength );
 	// read this into a memory buffer with a single read
 	char* const buf = ( char* )Mem_Alloc( tableLength, TAG_RESOURCE );
 	resourceFile->Seek( tableOffset, FS_SEEK_SET );
@@ -99,7 +185,7 @@ bool idResourceContainer::Init( const char* _fileName, uint8 containerIndex )
 		rt.Read( &memFile );
 		rt.filename.BackSlashesToSlashes();
 		rt.filename.ToLower();
-		rt.containerIndex = containerIndex;
+		rt.containerIndex = _containerIndex;
 		
 		const int key = cacheHash.GenerateKey( rt.filename, false );
 		bool found = false;
@@ -121,6 +207,180 @@ bool idResourceContainer::Init( const char* _fileName, uint8 containerIndex )
 	return true;
 }
 
+/*
+========================
+idResourceContainer::ReadFileVersion
+========================
+*/
+int idResourceContainer::ReadFileVersion( const char* _fileName )
+{
+	idFileLocal file( fileSystem->OpenFileRead( _fileName ) );
+	if( file == NULL )
+	{
+		return 0;
+	}
+	
+	uint32 magic = 0;
+	file->ReadBig( magic );
+	if( magic == RESOURCE_FILE_MAGIC )
+	{
+		return 1;
+	}
+	if( magic == RESOURCE_FILE_MAGIC_V2 )
+	{
+		return 2;
+	}
+	return 0;
+}
+
+/*
+========================
+idResourceContainer::FindEntry
+========================
+*/
+int idResourceContainer::FindEntry( const char* canonicalName ) const
+{
+	if( directory == NULL )
+	{
+		const int key = cacheHash.GenerateKey( canonicalName, false );
+		for( int index = cacheHash.GetFirst( key ); index != idHashIndex::NULL_INDEX; index = cacheHash.GetNext( index ) )
+		{
+			if( idStr::Icmp( cacheTable[ index ].filename, canonicalName ) == 0 )
+			{
+				return index;
+			}
+		}
+		return -1;
+	}
+	
+	// find the first entry with the hash, any others with the same hash follow it
+	const uint32 hash = HashName( canonicalName );
+	int first = 0;
+	int last = numFileResources;
+	while( first < last )
+	{
+		const int middle = ( first + last ) >> 1;
+		if( DirectoryValue( directory[ middle ].nameHash ) < hash )
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	
+	for( int index = first; index < numFileResources && DirectoryValue( directory[ index ].nameHash ) == hash; index++ )
+	{
+		const uint32 nameOffset = DirectoryValue( directory[ index ].nameOffset );
+		if( nameOffset < ( uint32 )namesLength && idStr::Icmp( names + nameOffset, canonicalName ) == 0 )
+		{
+			return index;
+		}
+	}
+	return -1;
+}
+
+/*
+========================
+idResourceContainer::GetEntry
+========================
+*/
+void idResourceContainer::GetEntry( int index, idResourceCacheEntry& rt ) const
+{
+	assert( index >= 0 && index < numFileResources );
+	
+	if( directory == NULL )
+	{
+		const idResourceCacheEntry& entry = cacheTable[ index ];
+		rt.filename = entry.filename;
+		rt.offset = entry.offset;
+		rt.length = entry.length;
+		rt.storedLength = entry.storedLength;
+		rt.compression = entry.compression;
+		rt.containerIndex = containerIndex;
+		return;
+	}
+	
+	const resourceDirectoryEntry_t& entry = directory[ index ];
+	const uint32 nameOffset = DirectoryValue( entry.nameOffset );
+	const uint64 offset = DirectoryValue( entry.offset );
+	assert( offset <= INT_MAX );
+	
+	rt.filename = ( nameOffset < ( uint32 )namesLength ) ? names + nameOffset : "";
+	rt.offset = ( int )offset;
+	rt.length = DirectoryValue( entry.length );
+	rt.storedLength = DirectoryValue( entry.storedLength );
+	rt.compression = ( uint8 )DirectoryValue( entry.compression );
+	rt.containerIndex = containerIndex;
+}
+
+/*
+========================
+idResourceContainer::DecompressEntry
+========================
+*/
+bool idResourceContainer::DecompressEntry( const idResourceCacheEntry& rt, const byte* storedData, byte* data )
+{
+	if( rt.compression == RESOURCE_COMPRESSION_NONE )
+	{
+		memcpy( data, storedData, rt.length );
+		return true;
+	}
+	if( rt.compression == RESOURCE_COMPRESSION_ZLIB )
+	{
+		uLongf length = rt.length;
+		return uncompress( data, &length, storedData, rt.storedLength ) == Z_OK && length == ( uLongf )rt.length;
+	}
+	return false;
+}
+
+/*
+========================
+idResourceContainer::ReadEntryData
+========================
+*/
+byte* idResourceContainer::ReadEntryData( const idResourceCacheEntry& rt )
+{
+	byte* data = ( byte* )Mem_Alloc( Max( rt.length, 1 ), TAG_RESOURCE );
+	
+	const byte* storedData = NULL;
+	byte* storedBuffer = NULL;
+	if( mappedData != NULL && rt.offset >= 0 && rt.storedLength >= 0 && rt.offset <= mappedLength - rt.storedLength )
+	{
+		storedData = mappedData + rt.offset;
+	}
+	else
+	{
+		// uncompressed entries are read straight into the output
+		storedBuffer = ( rt.compression == RESOURCE_COMPRESSION_NONE ) ? data : ( byte* )Mem_Alloc( Max( rt.storedLength, 1 ), TAG_TEMP );
+		resourceFile->Seek( rt.offset, FS_SEEK_SET );
+		if( resourceFile->Read( storedBuffer, rt.storedLength ) != rt.storedLength )
+		{
+			if( storedBuffer != data )
+			{
+				Mem_Free( storedBuffer );
+			}
+			Mem_Free( data );
+			return NULL;
+		}
+		if( storedBuffer == data )
+		{
+			return data;
+		}
+		storedData = storedBuffer;
+	}
+	
+	if( !DecompressEntry( rt, storedData, data ) )
+	{
+		idLib::Warning( "Unable to decompress %s from resource file %s", rt.filename.c_str(), fileName.c_str() );
+		Mem_Free( data );
+		data = NULL;
+	}
+	Mem_Free( storedBuffer );
+	return data;
+}
+
 
 /*
 ========================
@@ -178,73 +438,39 @@ idResourceContainer::UpdateResourceFile
 */
 void idResourceContainer::UpdateResourceFile( const char* _filename, const idStrList& _filesToUpdate )
 {
-	idFile* outFile = fileSystem->OpenFileWrite( va( "%s.new", _filename ) );
-	if( outFile == NULL )
+	idResourceWriter writer;
+	if( !writer.Open( va( "%s.new", _filename ), 2, fs_resourceCompression.GetBool() ) )
 	{
 		idLib::Warning( "Unable to open resource file %s or new output file", _filename );
 		return;
 	}
 	
-	uint32 magic = 0;
-	int _tableOffset = 0;
-	int _tableLength = 0;
-	idList< idResourceCacheEntry > entries;
 	idStrList filesToUpdate = _filesToUpdate;
 	
-	idFile* inFile = fileSystem->OpenFileRead( _filename );
-	if( inFile == NULL )
+	// copy the existing entries, a v1 container is converted to v2 on the way
+	idResourceContainer container;
+	if( ReadFileVersion( _filename ) != 0 && container.Init( _filename, 0 ) )
 	{
-		magic = RESOURCE_FILE_MAGIC;
-		
-		outFile->WriteBig( magic );
-		outFile->WriteBig( _tableOffset );
-		outFile->WriteBig( _tableLength );
-		
-	}
-	else
-	{
-		inFile->ReadBig( magic );
-		if( magic != RESOURCE_FILE_MAGIC )
+		for( int i = 0; i < container.NumEntries(); i++ )
 		{
-			delete inFile;
-			return;
-		}
-		
-		inFile->ReadBig( _tableOffset );
-		inFile->ReadBig( _tableLength );
-		// read this into a memory buffer with a single read
-		char* const buf = ( char* )Mem_Alloc( _tableLength, TAG_RESOURCE );
-		inFile->Seek( _tableOffset, FS_SEEK_SET );
-		inFile->Read( buf, _tableLength );
-		idFile_Memory memFile( "resourceHeader", ( const char* )buf, _tableLength );
-		
-		int _numFileResources = 0;
-		memFile.ReadBig( _numFileResources );
-		
-		outFile->WriteBig( magic );
-		outFile->WriteBig( _tableOffset );
-		outFile->WriteBig( _tableLength );
-		
-		entries.SetNum( _numFileResources );
-		
-		for( int i = 0; i < _numFileResources; i++ )
-		{
-			entries[ i ].Read( &memFile );
-			
+			idResourceCacheEntry rt;
+			container.GetEntry( i, rt );
 			
-			idLib::Printf( "examining %s\n", entries[ i ].filename.c_str() );
+			idLib::Printf( "examining %s\n", rt.filename.c_str() );
 			byte* fileData = NULL;
+			int length = rt.length;
 			
 			for( int j = filesToUpdate.Num() - 1; j >= 0; j-- )
 			{
-				if( filesToUpdate[ j ].Icmp( entries[ i ].filename ) == 0 )
+				if( filesToUpdate[ j ].Icmp( rt.filename ) == 0 )
 				{
 					idFile* newFile = fileSystem->OpenFileReadMemory( filesToUpdate[ j ] );
 					if( newFile != NULL )
 					{
 						idLib::Printf( "Updating %s\n", filesToUpdate[ j ].c_str() );
-						entries[ i ].length = newFile->Length();
-						fileData = ( byte* )Mem_Alloc( entries[ i ].length, TAG_TEMP );
+						Mem_Free( fileData );
+						length = newFile->Length();
+						fileData = ( byte* )Mem_Alloc( length, TAG_TEMP );
 						newFile->Read( fileData, newFile->Length() );
 						delete newFile;
 					}
@@ -254,18 +480,14 @@ void idResourceContainer::UpdateResourceFile( const char* _filename, const idStr
 			
 			if( fileData == NULL )
 			{
-				inFile->Seek( entries[ i ].offset, FS_SEEK_SET );
-				fileData = ( byte* )Mem_Alloc( entries[ i ].length, TAG_TEMP );
-				inFile->Read( fileData, entries[ i ].length );
+				fileData = container.ReadEntryData( rt );
+			}
+			if( fileData != NULL )
+			{
+				writer.AddFile( rt.filename, fileData, length );
+				Mem_Free( fileData );
 			}
-			
-			entries[ i ].offset = outFile->Tell();
-			outFile->Write( ( void* )fileData, entries[ i ].length );
-			
-			Mem_Free( fileData );
 		}
-		
-		Mem_Free( buf );
 	}
 	
 	while( filesToUpdate.Num() > 0 )
@@ -274,41 +496,17 @@ void idResourceContainer::UpdateResourceFile( const char* _filename, const idStr
 		if( newFile != NULL )
 		{
 			idLib::Printf( "Appending %s\n", filesToUpdate[ 0 ].c_str() );
-			idResourceCacheEntry rt;
-			rt.filename = filesToUpdate[ 0 ];
-			rt.length = newFile->Length();
-			byte* fileData = ( byte* )Mem_Alloc( rt.length, TAG_TEMP );
-			newFile->Read( fileData, rt.length );
-			int idx = entries.Append( rt );
-			if( idx >= 0 )
-			{
-				entries[ idx ].offset = outFile->Tell();
-				outFile->Write( ( void* )fileData, entries[ idx ].length );
-			}
+			const int length = newFile->Length();
+			byte* fileData = ( byte* )Mem_Alloc( length, TAG_TEMP );
+			newFile->Read( fileData, length );
+			writer.AddFile( filesToUpdate[ 0 ], fileData, length );
 			delete newFile;
 			Mem_Free( fileData );
 		}
 		filesToUpdate.RemoveIndex( 0 );
 	}
 	
-	_tableOffset = outFile->Tell();
-	outFile->WriteBig( entries.Num() );
-	
-	// write the individual resource entries
-	for( int i = 0; i < entries.Num(); i++ )
-	{
-		entries[ i ].Write( outFile );
-	}
-	
-	// go back and write the header offsets again, now that we have file offsets and lengths
-	_tableLength = outFile->Tell() - _tableOffset;
-	outFile->Seek( 0, FS_SEEK_SET );
-	outFile->WriteBig( magic );
-	outFile->WriteBig( _tableOffset );
-	outFile->WriteBig( _tableLength );
-	
-	delete outFile;
-	delete inFile;
+	writer.Close();
 }
 
 
@@ -319,6 +517,7 @@ idResourceContainer::ExtractResourceFile
 */
 void idResourceContainer::SetContainerIndex( const int& _idx )
 {
+	containerIndex = _idx;
 	for( int i = 0; i < cacheTable.Num(); i++ )
 	{
 		cacheTable[ i ].containerIndex = _idx;
@@ -332,41 +531,22 @@ idResourceContainer::ExtractResourceFile
 */
 void idResourceContainer::ExtractResourceFile( const char* _fileName, const char* _outPath, bool _copyWavs )
 {
-	idFile* inFile = fileSystem->OpenFileRead( _fileName );
-	
-	if( inFile == NULL )
+	if( ReadFileVersion( _fileName ) == 0 )
 	{
 		idLib::Warning( "Unable to open resource file %s", _fileName );
 		return;
 	}
 	
-	uint32 magic;
-	inFile->ReadBig( magic );
-	if( magic != RESOURCE_FILE_MAGIC )
+	idResourceContainer container;
+	if( !container.Init( _fileName, 0 ) )
 	{
-		delete inFile;
 		return;
 	}
 	
-	int _tableOffset;
-	int _tableLength;
-	inFile->ReadBig( _tableOffset );
-	inFile->ReadBig( _tableLength );
-	// read this into a memory buffer with a single read
-	char* const buf = ( char* )Mem_Alloc( _tableLength, TAG_RESOURCE );
-	inFile->Seek( _tableOffset, FS_SEEK_SET );
-	inFile->Read( buf, _tableLength );
-	idFile_Memory memFile( "resourceHeader", ( const char* )buf, _tableLength );
-	
-	int _numFileResources;
-	memFile.ReadBig( _numFileResources );
-	
-	for( int i = 0; i < _numFileResources; i++ )
+	for( int i = 0; i < container.NumEntries(); i++ )
 	{
 		idResourceCacheEntry rt;
-		rt.Read( &memFile );
-		rt.filename.BackSlashesToSlashes();
-		rt.filename.ToLower();
+		container.GetEntry( i, rt );
 		byte* fbuf = NULL;
 		if( _copyWavs && ( rt.filename.Find( ".idwav" ) >= 0 ||  rt.filename.Find( ".idxma" ) >= 0 ||  rt.filename.Find( ".idmsf" ) >= 0 ) )
 		{
@@ -378,9 +558,11 @@ void idResourceContainer::ExtractResourceFile( const char* _fileName, const char
 		}
 		else
 		{
-			inFile->Seek( rt.offset, FS_SEEK_SET );
-			fbuf = ( byte* )Mem_Alloc( rt.length, TAG_RESOURCE );
-			inFile->Read( fbuf, rt.length );
+			fbuf = container.ReadEntryData( rt );
+			if( fbuf == NULL )
+			{
+				continue;
+			}
 		}
 		idStr outName = _outPath;
 		outName.AppendPath( rt.filename );
@@ -392,8 +574,6 @@ void idResourceContainer::ExtractResourceFile( const char* _fileName, const char
 		}
 		Mem_Free( fbuf );
 	}
-	delete inFile;
-	Mem_Free( buf );
 }
 
 
@@ -460,9 +640,8 @@ void idResourceContainer::WriteResourceFile( const char* manifestName, const idS
 		}
 		fileName.SetFileExtension( "resources" );
 		
-		idFile* resFile = fileSystem->OpenFileWrite( fileName );
-		
-		if( resFile == NULL )
+		idResourceWriter writer;
+		if( !writer.Open( fileName, 2, fs_resourceCompression.GetBool() ) )
 		{
 			idLib::Warning( "Cannot open %s for writing.\n", fileName.c_str() );
 			return;
@@ -470,87 +649,266 @@ void idResourceContainer::WriteResourceFile( const char* manifestName, const idS
 		
 		idLib::Printf( "Writing resource file %s\n", fileName.c_str() );
 		
-		int	tableOffset = 0;
-		int	tableLength = 0;
-		int	tableNewLength = 0;
-		uint32	resourceFileMagic = RESOURCE_FILE_MAGIC;
-		
-		resFile->WriteBig( resourceFileMagic );
-		resFile->WriteBig( tableOffset );
-		resFile->WriteBig( tableLength );
-		
-		idList< idResourceCacheEntry > entries;
-		
-		entries.Resize( fileList.Num() );
-		
+		// the data is written in manifest order, which is the order the level loads it in
 		for( int i = 0; i < fileList.Num(); i++ )
 		{
-			idResourceCacheEntry ent;
-			
-			ent.filename = fileList[ i ];
-			ent.length = 0;
-			ent.offset = 0;
-			
-			idFile* file = fileSystem->OpenFileReadMemory( ent.filename, false );
+			idFile* file = fileSystem->OpenFileReadMemory( fileList[ i ], false );
 			idFile_Memory* fm = dynamic_cast< idFile_Memory* >( file );
 			if( fm == NULL )
 			{
 				continue;
 			}
-			// if the entry is uncompressed, align the file pointer to a 16 byte boundary
-			// so it will be usable if memory mapped
-			ent.length = fm->Length();
-			
-			// always get the offset, even if the file will have zero length
-			ent.offset = resFile->Tell();
-			
-			entries.Append( ent );
-			
-			if( ent.length == 0 )
-			{
-				ent.filename = "";
-				delete fm;
-				continue;
-			}
-			
-			resFile->Write( fm->GetDataPtr(), ent.length );
-			
+			writer.AddFile( fileList[ i ], ( const byte* )fm->GetDataPtr(), fm->Length() );
 			delete fm;
-			
-			// pacifier every ten megs
-			if( ( ent.offset + ent.length ) / 10000000 != ent.offset / 10000000 )
-			{
-				idLib::Printf( "." );
-			}
 		}
 		
 		idLib::Printf( "\n" );
 		
-		// write the table out now that we have all the files
-		tableOffset = resFile->Tell();
-		
-		// count how many we are going to write for this platform
-		int	numFileResources = entries.Num();
-		
-		resFile->WriteBig( numFileResources );
-		
-		// write the individual resource entries
-		for( int i = 0; i < entries.Num(); i++ )
+		writer.Close();
+	}
+}
+
+/*
+================================================================================================
+
+idResourceWriter
+
+================================================================================================
+*/
+
+struct resourceSortEntry_t
+{
+	uint32			hash;
+	int				index;
+	const char* 	name;
+};
+
+class idSort_ResourceDirectory : public idSort_Quick< resourceSortEntry_t, idSort_ResourceDirectory >
+{
+public:
+	int Compare( const resourceSortEntry_t& a, const resourceSortEntry_t& b ) const
+	{
+		if( a.hash != b.hash )
 		{
-			entries[ i ].Write( resFile );
-			if( i + 1 == numFileResources )
-			{
-				// we just wrote out the last new entry
-				tableNewLength = resFile->Tell() - tableOffset;
-			}
+			return ( a.hash < b.hash ) ? -1 : 1;
 		}
-		
-		// go back and write the header offsets again, now that we have file offsets and lengths
-		tableLength = resFile->Tell() - tableOffset;
-		resFile->Seek( 0, FS_SEEK_SET );
-		resFile->WriteBig( resourceFileMagic );
-		resFile->WriteBig( tableOffset );
-		resFile->WriteBig( tableLength );
-		delete resFile;
+		// duplicates are sorted newest first so the lookup finds the one written last, like v1
+		// where idHashIndex::Add puts the newest entry at the head of the hash chain
+		const int c = idStr::Cmp( a.name, b.name );
+		return ( c != 0 ) ? c : ( b.index - a.index );
+	}
+};
+
+/*
+========================
+idResourceWriter::idResourceWriter
+========================
+*/
+idResourceWriter::idResourceWriter() :
+	file( NULL ),
+	version( 2 ),
+	compress( false )
+{
+	entries.SetGranularity( 4096 );
+}
+
+/*
+========================
+idResourceWriter::~idResourceWriter
+========================
+*/
+idResourceWriter::~idResourceWriter()
+{
+	delete file;
+}
+
+/*
+========================
+idResourceWriter::Open
+========================
+*/
+bool idResourceWriter::Open( const char* fileName, int _version, bool _compress )
+{
+	assert( file == NULL );
+	
+	file = fileSystem->OpenFileWrite( fileName );
+	if( file == NULL )
+	{
+		return false;
+	}
+	
+	version = _version;
+	compress = _compress && ( version >= 2 );
+	entries.Clear();
+	
+	// the header is written again by Close() once the directory location is known
+	if( version == 1 )
+	{
+		file->WriteBig( RESOURCE_FILE_MAGIC );
+		file->WriteBig( ( int )0 );
+		file->WriteBig( ( int )0 );
+	}
+	else
+	{
+		file->WriteBig( RESOURCE_FILE_MAGIC_V2 );
+		file->WriteBig( ( uint32 )0 );
+		file->WriteBig( ( uint64 )0 );
+		file->WriteBig( ( uint32 )0 );
+	}
+	return true;
+}
+
+/*
+========================
+idResourceWriter::AddFile
+========================
+*/
+void idResourceWriter::AddFile( const char* fileName, const byte* data, int length )
+{
+	assert( file != NULL );
+	
+	idResourceCacheEntry& ent = entries.Alloc();
+	ent.filename = fileName;
+	if( version >= 2 )
+	{
+		// v2 names are hashed when written, so they are stored the way they are looked up
+		ent.filename.BackSlashesToSlashes();
+		ent.filename.ToLower();
+	}
+	ent.length = length;
+	ent.storedLength = length;
+	ent.compression = RESOURCE_COMPRESSION_NONE;
+	
+	byte* compressed = NULL;
+	if( compress && length > 0 )
+	{
+		uLongf compressedLength = compressBound( length );
+		compressed = ( byte* )Mem_Alloc( compressedLength, TAG_TEMP );
+		if( compress2( compressed, &compressedLength, data, length, Z_BEST_COMPRESSION ) == Z_OK && compressedLength < ( uLongf )( length - length / 8 ) )
+		{
+			ent.storedLength = compressedLength;
+			ent.compression = RESOURCE_COMPRESSION_ZLIB;
+		}
+	}
+	
+	// align uncompressed entries to a 16 byte boundary so they are usable when memory mapped
+	if( version >= 2 && ent.compression == RESOURCE_COMPRESSION_NONE )
+	{
+		static const byte zeros[ 16 ] = { 0 };
+		file->Write( zeros, ( 16 - ( file->Tell() & 15 ) ) & 15 );
+	}
+	
+	// always get the offset, even if the file will have zero length
+	ent.offset = file->Tell();
+	if( ent.storedLength > 0 )
+	{
+		file->Write( ( ent.compression == RESOURCE_COMPRESSION_NONE ) ? data : compressed, ent.storedLength );
+	}
+	Mem_Free( compressed );
+	
+	// pacifier every ten megs
+	if( ( ent.offset + ent.storedLength ) / 10000000 != ent.offset / 10000000 )
+	{
+		idLib::Printf( "." );
+	}
+}
+
+/*
+========================
+idResourceWriter::Close
+========================
+*/
+bool idResourceWriter::Close()
+{
+	if( file == NULL )
+	{
+		return false;
 	}
+	
+	if( version == 1 )
+	{
+		WriteDirectoryV1();
+	}
+	else
+	{
+		WriteDirectoryV2();
+	}
+	
+	delete file;
+	file = NULL;
+	return true;
+}
+
+/*
+========================
+idResourceWriter::WriteDirectoryV1
+========================
+*/
+void idResourceWriter::WriteDirectoryV1()
+{
+	const int tableOffset = file->Tell();
+	
+	file->WriteBig( entries.Num() );
+	for( int i = 0; i < entries.Num(); i++ )
+	{
+		entries[ i ].Write( file );
+	}
+	
+	// go back and write the header offsets again, now that we have file offsets and lengths
+	const int tableLength = file->Tell() - tableOffset;
+	file->Seek( 0, FS_SEEK_SET );
+	file->WriteBig( RESOURCE_FILE_MAGIC );
+	file->WriteBig( tableOffset );
+	file->WriteBig( tableLength );
+}
+
+/*
+========================
+idResourceWriter::WriteDirectoryV2
+========================
+*/
+void idResourceWriter::WriteDirectoryV2()
+{
+	idList< resourceSortEntry_t, TAG_RESOURCE > sorted;
+	sorted.SetNum( entries.Num() );
+	for( int i = 0; i < entries.Num(); i++ )
+	{
+		sorted[ i ].hash = idResourceContainer::HashName( entries[ i ].filename );
+		sorted[ i ].index = i;
+		sorted[ i ].name = entries[ i ].filename.c_str();
+	}
+	sorted.SortWithTemplate( idSort_ResourceDirectory() );
+	
+	// keep the directory entries aligned when the container is mapped
+	static const byte zeros[ 8 ] = { 0 };
+	file->Write( zeros, ( 8 - ( file->Tell() & 7 ) ) & 7 );
+	
+	const uint64 directoryOffset = file->Tell();
+	
+	uint32 nameOffset = 0;
+	for( int i = 0; i < sorted.Num(); i++ )
+	{
+		const idResourceCacheEntry& ent = entries[ sorted[ i ].index ];
+		file->WriteBig( sorted[ i ].hash );
+		file->WriteBig( nameOffset );
+		file->WriteBig( ( uint64 )ent.offset );
+		file->WriteBig( ( uint32 )ent.length );
+		file->WriteBig( ( uint32 )ent.storedLength );
+		file->WriteBig( ( uint32 )ent.compression );
+		file->WriteBig( ( uint32 )sorted[ i ].index );
+		nameOffset += ent.filename.Length() + 1;
+	}
+	for( int i = 0; i < sorted.Num(); i++ )
+	{
+		const idResourceCacheEntry& ent = entries[ sorted[ i ].index ];
+		file->Write( ent.filename.c_str(), ent.filename.Length() + 1 );
+	}
+	
+	// go back and write the header again, now that we know where the directory is
+	const uint32 directoryLength = ( uint32 )( file->Tell() - directoryOffset );
+	file->Seek( 0, FS_SEEK_SET );
+	file->WriteBig( RESOURCE_FILE_MAGIC_V2 );
+	file->WriteBig( ( uint32 )entries.Num() );
+	file->WriteBig( directoryOffset );
+	file->WriteBig( directoryLength );
 }
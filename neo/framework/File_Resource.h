@@ -37,6 +37,12 @@ If you have questions concerning this license or the applicable additional terms
 ==============================================================
 */
 
+enum resourceCompression_t
+{
+	RESOURCE_COMPRESSION_NONE,
+	RESOURCE_COMPRESSION_ZLIB
+};
+
 class idResourceCacheEntry
 {
 public:
@@ -50,13 +56,18 @@ public:
 		//filename = NULL;
 		offset = 0;
 		length = 0;
+		storedLength = 0;
+		compression = RESOURCE_COMPRESSION_NONE;
 		containerIndex = 0;
 	}
+	// v1 table entries, always stored uncompressed
 	size_t Read( idFile* f )
 	{
 		size_t sz = f->ReadString( filename );
 		sz += f->ReadBig( offset );
 		sz += f->ReadBig( length );
+		storedLength = length;
+		compression = RESOURCE_COMPRESSION_NONE;
 		return sz;
 	}
 	size_t Write( idFile* f )
@@ -69,10 +80,44 @@ public:
 	idStrStatic< 256 >	filename;
 	int					offset;							// into the resource file
 	int 				length;
+	int					storedLength;					// length in the resource file, differs from length if compressed
+	uint8				compression;					// resourceCompression_t
 	uint8				containerIndex;
 };
 
 static const uint32 RESOURCE_FILE_MAGIC = 0xD000000D;
+static const uint32 RESOURCE_FILE_MAGIC_V2 = 0xD000020D;
+
+/*
+================================================
+v2 containers, big endian like v1:
+
+	uint32		magic				RESOURCE_FILE_MAGIC_V2
+	uint32		numEntries
+	uint64		directoryOffset
+	uint32		directoryLength
+	
+the entry data follows in the order the files were written, which is the
+load order of the manifest, uncompressed entries are aligned to 16 bytes
+so they can be used straight from the mapping.
+
+The directory holds numEntries resourceDirectoryEntry_t sorted by name hash
+followed by the 0 terminated names. It is used in place, no table is built
+when the container is opened.
+================================================
+*/
+struct resourceDirectoryEntry_t
+{
+	uint32				nameHash;						// idResourceContainer::HashName
+	uint32				nameOffset;						// into the names after the entries
+	uint64				offset;
+	uint32				length;
+	uint32				storedLength;
+	uint32				compression;					// resourceCompression_t
+	uint32				order;							// index in the order the data was written
+};
+
+static const int RESOURCE_FILE_V2_HEADER_SIZE = 20;
 class idResourceContainer
 {
 	friend class	idFileSystemLocal;
@@ -81,17 +126,27 @@ public:
 	idResourceContainer()
 	{
 		resourceFile = NULL;
+		mappedData = NULL;
+		mappedLength = 0;
 		tableOffset = 0;
 		tableLength = 0;
 		resourceMagic = 0;
 		numFileResources = 0;
+		containerIndex = 0;
+		directory = NULL;
+		directoryBuffer = NULL;
+		namesLength = 0;
 	}
 	~idResourceContainer()
 	{
+		Sys_UnmapFile( mappedData, mappedLength );
+		Mem_Free( directoryBuffer );
 		delete resourceFile;
 		cacheTable.Clear();
 	}
 	bool Init( const char* fileName, uint8 containerIndex );
+	// 1 or 2 for a resource container, 0 if the file can't be opened or isn't a container
+	static int ReadFileVersion( const char* fileName );
 	static void WriteResourceFile( const char* fileName, const idStrList& manifest, const bool& _writeManifest );
 	static void WriteManifestFile( const char* name, const idStrList& list );
 	static int ReadManifestFile( const char* filename, idStrList& list );
@@ -104,17 +159,96 @@ public:
 	}
 	void SetContainerIndex( const int& _idx );
 	void ReOpen();
+	// returns a pointer to the entry inside the memory mapped container or NULL if the container
+	// isn't mapped or the entry is compressed
+	const byte* GetMappedData( const idResourceCacheEntry& rt ) const
+	{
+		if( mappedData == NULL || rt.compression != RESOURCE_COMPRESSION_NONE || rt.offset < 0 || rt.length < 0 || rt.offset > mappedLength - rt.length )
+		{
+			return NULL;
+		}
+		return mappedData + rt.offset;
+	}
+	bool IsMapped() const
+	{
+		return mappedData != NULL;
+	}
+	int GetVersion() const
+	{
+		return ( resourceMagic == RESOURCE_FILE_MAGIC_V2 ) ? 2 : 1;
+	}
+	// bytes read to open the container
+	int GetDirectoryLength() const
+	{
+		return tableLength;
+	}
+	int NumEntries() const
+	{
+		return numFileResources;
+	}
+	// index of the entry with the given lower case name, -1 if it isn't in this container
+	int FindEntry( const char* canonicalName ) const;
+	void GetEntry( int index, idResourceCacheEntry& rt ) const;
+	
+	// reads an entry and decompresses it if needed, the caller frees the data with Mem_Free
+	byte* ReadEntryData( const idResourceCacheEntry& rt );
+	static bool DecompressEntry( const idResourceCacheEntry& rt, const byte* storedData, byte* data );
+	
+	static uint32 HashName( const char* canonicalName )
+	{
+		return ( uint32 )idStr::Hash( canonicalName );
+	}
 private:
 	idStrStatic< 256 > fileName;
 	idFile* 	resourceFile;			// open file handle
+	const byte* mappedData;				// the whole container if it could be memory mapped
+	int			mappedLength;
 	// offset should probably be a 64 bit value for development, but 4 gigs won't fit on
 	// a DVD layer, so it isn't a retail limitation.
 	int		tableOffset;			// table offset
 	int		tableLength;			// table length
 	int		resourceMagic;			// magic
 	int		numFileResources;		// number of file resources in this container
-	idList< idResourceCacheEntry, TAG_RESOURCE>	cacheTable;
+	uint8	containerIndex;
+	idList< idResourceCacheEntry, TAG_RESOURCE>	cacheTable;		// v1 only
 	idHashIndex	cacheHash;
+	const resourceDirectoryEntry_t* directory;	// v2 only, in the mapping or in directoryBuffer
+	byte* 	directoryBuffer;
+	const char* names;
+	int		namesLength;
+};
+
+/*
+================================================
+idResourceWriter writes a resource container one file at a time, v2
+unless a v1 container is asked for. Compression only applies to v2
+and is only used for entries that get noticeably smaller.
+================================================
+*/
+class idResourceWriter
+{
+public:
+	idResourceWriter();
+	~idResourceWriter();
+	
+	bool				Open( const char* fileName, int version, bool compress );
+	void				AddFile( const char* fileName, const byte* data, int length );
+	// writes the directory and closes the file
+	bool				Close();
+	
+	int					NumFiles() const
+	{
+		return entries.Num();
+	}
+	
+private:
+	idFile* 			file;
+	int					version;
+	bool				compress;
+	idList< idResourceCacheEntry, TAG_RESOURCE >	entries;
+	
+	void				WriteDirectoryV1();
+	void				WriteDirectoryV2();
 };
 
 
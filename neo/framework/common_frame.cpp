@@ -103,6 +103,9 @@ int idGameThread::Run()
 	{
 		// Ensure there's no stale gameReturn data from a paused game
 		ret = gameReturn_t();
+		
+		// the draw still makes temporaries while paused
+		Mem_FlipFrameArena();
 	}
 	
 	if( isClient )
@@ -111,6 +114,7 @@ int idGameThread::Run()
 		for( int i = 0; i < numGameFrames; i++ )
 		{
 			SCOPED_PROFILE_EVENT( "Client Prediction" );
+			Mem_FlipFrameArena();
 			if( userCmdMgr )
 			{
 				game->ClientRunFrame( *userCmdMgr, ( i == numGameFrames - 1 ), ret );
@@ -127,6 +131,7 @@ int idGameThread::Run()
 		for( int i = 0; i < numGameFrames; i++ )
 		{
 			SCOPED_PROFILE_EVENT( "GameTic" );
+			Mem_FlipFrameArena();
 			if( userCmdMgr )
 			{
 				game->RunFrame( *userCmdMgr, ret );
@@ -437,6 +442,7 @@ void idCommonLocal::ProcessGameReturn( const gameReturn_t& ret )
 }
 
 extern idCVar com_forceGenericSIMD;
+extern idCVar com_deterministicMath;
 
 extern idCVar com_pause;
 
@@ -449,16 +455,23 @@ void idCommonLocal::Frame()
 {
 	try
 	{
+		// the previous frame is complete for the timeline captures
+		idTimelineProfiler::EndFrame();
+		Mem_EndFrame();
+		idStr::EndFrame();
+		idSharedBlockAllocBase::ReleaseAllEmptyBlocks( 1 );
+		
 		SCOPED_PROFILE_EVENT( "Common::Frame" );
 		
 		// This is the only place this is incremented
 		idLib::frameNumber++;
 		
 		// allow changing SIMD usage on the fly
-		if( com_forceGenericSIMD.IsModified() )
+		if( com_forceGenericSIMD.IsModified() || com_deterministicMath.IsModified() )
 		{
-			idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool() );
+			idSIMD::InitProcessor( "doom", com_forceGenericSIMD.GetBool(), com_deterministicMath.GetBool() );
 			com_forceGenericSIMD.ClearModified();
+			com_deterministicMath.ClearModified();
 		}
 		
 		// RB begin
@@ -666,8 +679,17 @@ void idCommonLocal::Frame()
 			
 			// not enough time has passed to run a frame, as might happen if
 			// we don't have vsync on, or the monitor is running at 120hz while
-			// com_engineHz is 60, so sleep a bit and check again
-			Sys_Sleep( 0 );
+			// com_engineHz is 60, so sleep a bit and check again.
+			// Sleep until just before the next frame is due instead of spinning
+			// on Sys_Sleep( 0 ), which kept a whole core busy on dedicated servers
+			// and other windowed setups without vsync
+			int sleepMilliseconds = 0;
+			if( timescale.GetFloat() > 0.0f )
+			{
+				const int frameDelay = FRAME_TO_MSEC( gameFrame + 1 ) - FRAME_TO_MSEC( gameFrame );
+				sleepMilliseconds = idMath::Ftoi( ( frameDelay - gameTimeResidual ) / timescale.GetFloat() ) - 1;
+			}
+			Sys_Sleep( Max( sleepMilliseconds, 0 ) );
 		}
 		
 		//--------------------------------------------
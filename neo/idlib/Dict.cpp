@@ -32,6 +32,81 @@ If you have questions concerning this license or the applicable additional terms
 idStrPool		idDict::globalKeys;
 idStrPool		idDict::globalValues;
 
+idDictKey* 		idDictKey::keys;
+bool			idDictKey::poolReady;
+
+idDictKey		dictKey_classname( "classname" );
+idDictKey		dictKey_name( "name" );
+idDictKey		dictKey_origin( "origin" );
+idDictKey		dictKey_rotation( "rotation" );
+idDictKey		dictKey_angle( "angle" );
+idDictKey		dictKey_model( "model" );
+idDictKey		dictKey_skin( "skin" );
+idDictKey		dictKey_spawnclass( "spawnclass" );
+idDictKey		dictKey_spawnfunc( "spawnfunc" );
+idDictKey		dictKey_scriptobject( "scriptobject" );
+idDictKey		dictKey_health( "health" );
+idDictKey		dictKey_hide( "hide" );
+idDictKey		dictKey_bind( "bind" );
+
+/*
+================
+idDictKey::idDictKey
+================
+*/
+idDictKey::idDictKey( const char* name )
+{
+	assert( name != NULL && name[0] != '\0' );
+	
+	this->name = name;
+	key = NULL;
+	hash = idFlatHashMap< const char*, int >::GenerateHash( name );
+	next = keys;
+	keys = this;
+	
+	// keys created after idDict::Init are resolved right away
+	if( poolReady )
+	{
+		Resolve();
+	}
+}
+
+/*
+================
+idDictKey::~idDictKey
+================
+*/
+idDictKey::~idDictKey()
+{
+	for( idDictKey** k = &keys; *k != NULL; k = &( *k )->next )
+	{
+		if( *k == this )
+		{
+			*k = next;
+			break;
+		}
+	}
+	if( key != NULL && poolReady )
+	{
+		idDict::globalKeys.FreeString( key );
+	}
+}
+
+/*
+================
+idDictKey::Resolve
+
+  the key keeps a reference so the pooled string outlives the dicts that use it
+================
+*/
+void idDictKey::Resolve()
+{
+	if( key == NULL )
+	{
+		key = idDict::globalKeys.AllocString( name );
+	}
+}
+
 /*
 ================
 idDict::operator=
@@ -52,12 +127,14 @@ idDict& idDict::operator=( const idDict& other )
 	Clear();
 	
 	args = other.args;
-	argHash = other.argHash;
 	
+	// the keys of the other dict can come from another pool, so the hash points at the copies
+	argHash.Reserve( args.Num() );
 	for( i = 0; i < args.Num(); i++ )
 	{
 		args[i].key = globalKeys.CopyString( args[i].key );
 		args[i].value = globalValues.CopyString( args[i].value );
+		argHash.Set( args[i].GetKey().c_str(), i );
 	}
 	
 	return *this;
@@ -109,7 +186,7 @@ void idDict::Copy( const idDict& other )
 		{
 			kv.key = globalKeys.CopyString( other.args[i].key );
 			kv.value = globalValues.CopyString( other.args[i].value );
-			argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
+			argHash.Set( kv.GetKey().c_str(), args.Append( kv ) );
 		}
 	}
 }
@@ -214,7 +291,7 @@ void idDict::SetDefaults( const idDict* dict )
 		{
 			newkv.key = globalKeys.CopyString( def->key );
 			newkv.value = globalValues.CopyString( def->value );
-			argHash.Add( argHash.GenerateKey( newkv.GetKey(), false ), args.Append( newkv ) );
+			argHash.Set( newkv.GetKey().c_str(), args.Append( newkv ) );
 		}
 	}
 }
@@ -331,7 +408,7 @@ void idDict::Set( const char* key, const char* value )
 	{
 		kv.key = globalKeys.AllocString( key );
 		kv.value = globalValues.AllocString( value );
-		argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
+		argHash.Set( kv.GetKey().c_str(), args.Append( kv ) );
 	}
 }
 
@@ -545,6 +622,48 @@ bool idDict::GetMatrix( const char* key, const char* defaultString, idMat3& out
 	return found;
 }
 
+/*
+================
+idDict::GetVector
+================
+*/
+bool idDict::GetVector( const idDictKey& key, const char* defaultString, idVec3& out ) const
+{
+	bool		found;
+	const char*	s;
+	
+	if( !defaultString )
+	{
+		defaultString = "0 0 0";
+	}
+	
+	found = GetString( key, defaultString, &s );
+	out.Zero();
+	sscanf( s, "%f %f %f", &out.x, &out.y, &out.z );
+	return found;
+}
+
+/*
+================
+idDict::GetMatrix
+================
+*/
+bool idDict::GetMatrix( const idDictKey& key, const char* defaultString, idMat3& out ) const
+{
+	const char*	s;
+	bool		found;
+	
+	if( !defaultString )
+	{
+		defaultString = "1 0 0 0 1 0 0 0 1";
+	}
+	
+	found = GetString( key, defaultString, &s );
+	out.Identity();
+	sscanf( s, "%f %f %f %f %f %f %f %f %f", &out[0].x, &out[0].y, &out[0].z, &out[1].x, &out[1].y, &out[1].z, &out[2].x, &out[2].y, &out[2].z );
+	return found;
+}
+
 /*
 ================
 WriteString
@@ -567,21 +686,16 @@ idDict::FindKey
 */
 const idKeyValue* idDict::FindKey( const char* key ) const
 {
-	int i, hash;
-	
 	if( key == NULL || key[0] == '\0' )
 	{
 		idLib::common->DWarning( "idDict::FindKey: empty key" );
 		return NULL;
 	}
 	
-	hash = argHash.GenerateKey( key, false );
-	for( i = argHash.First( hash ); i != -1; i = argHash.Next( i ) )
+	const int* index;
+	if( argHash.Get( key, &index ) )
 	{
-		if( args[i].GetKey().Icmp( key ) == 0 )
-		{
-			return &args[i];
-		}
+		return &args[*index];
 	}
 	
 	return NULL;
@@ -601,13 +715,10 @@ int idDict::FindKeyIndex( const char* key ) const
 		return 0;
 	}
 	
-	int hash = argHash.GenerateKey( key, false );
-	for( int i = argHash.First( hash ); i != -1; i = argHash.Next( i ) )
+	const int* index;
+	if( argHash.Get( key, &index ) )
 	{
-		if( args[i].GetKey().Icmp( key ) == 0 )
-		{
-			return i;
-		}
+		return *index;
 	}
 	
 	return -1;
@@ -620,18 +731,37 @@ idDict::Delete
 */
 void idDict::Delete( const char* key )
 {
-	int hash, i;
+	int i;
 	
-	hash = argHash.GenerateKey( key, false );
-	for( i = argHash.First( hash ); i != -1; i = argHash.Next( i ) )
+	const int* index;
+	if( key != NULL && argHash.Get( key, &index ) )
 	{
-		if( args[i].GetKey().Icmp( key ) == 0 )
+		const int removed = *index;
+		argHash.Remove( key );
+		globalKeys.FreeString( args[removed].key );
+		globalValues.FreeString( args[removed].value );
+		args.RemoveIndex( removed );
+		
+		// the pairs after the removed one moved down, the order of the pairs is kept because
+		// it shows in MatchPrefix and GetKeyVal. Usually only a few pairs move and their slots
+		// are looked up, walking all slots is only cheaper when most of the dictionary moved.
+		const int numMoved = args.Num() - removed;
+		if( numMoved * 8 < argHash.NumSlots() )
 		{
-			globalKeys.FreeString( args[i].key );
-			globalValues.FreeString( args[i].value );
-			args.RemoveIndex( i );
-			argHash.RemoveIndex( hash, i );
-			break;
+			for( i = removed; i < args.Num(); i++ )
+			{
+				argHash.Set( args[i].GetKey().c_str(), i );
+			}
+		}
+		else
+		{
+			for( i = 0; i < argHash.NumSlots(); i++ )
+			{
+				if( argHash.IsSlotUsed( i ) && argHash.GetSlotValue( i ) > removed )
+				{
+					argHash.GetSlotValue( i )--;
+				}
+			}
 		}
 	}
 	
@@ -1006,6 +1136,12 @@ void idDict::Init()
 {
 	globalKeys.SetCaseSensitive( false );
 	globalValues.SetCaseSensitive( true );
+	
+	idDictKey::poolReady = true;
+	for( idDictKey* key = idDictKey::keys; key != NULL; key = key->next )
+	{
+		key->Resolve();
+	}
 }
 
 /*
@@ -1015,6 +1151,13 @@ idDict::Shutdown
 */
 void idDict::Shutdown()
 {
+	// the pooled strings are freed with the pool
+	idDictKey::poolReady = false;
+	for( idDictKey* key = idDictKey::keys; key != NULL; key = key->next )
+	{
+		key->key = NULL;
+	}
+	
 	globalKeys.Clear();
 	globalValues.Clear();
 }
@@ -94,8 +94,52 @@ public:
 	}
 };
 
+/*
+================================================
+idDictKey is a key that is interned in the global key pool and hashed once.
+
+Looking up a key with it skips hashing the key string, and because the key pool
+is case-insensitive the pooled key of a dict matches it by address instead of
+by string compare. Keys declared at file scope are resolved by idDict::Init, the
+name has to stay valid for the life time of the key.
+================================================
+*/
+class idDictKey
+{
+	friend class idDict;
+	
+public:
+	explicit			idDictKey( const char* name );
+	~idDictKey();
+	
+	const char* 		c_str() const
+	{
+		return ( key != NULL ) ? key->c_str() : name;
+	}
+	unsigned int		GetHash() const
+	{
+		return hash;
+	}
+	
+private:
+	const char* 		name;
+	const idPoolStr* 	key;		// NULL until resolved
+	unsigned int		hash;
+	idDictKey* 			next;
+	
+	static idDictKey* 	keys;		// all keys, linked before any constructors run
+	static bool			poolReady;
+	
+	void				Resolve();
+	
+						idDictKey( const idDictKey& );
+	void				operator=( const idDictKey& );
+};
+
 class idDict
 {
+	friend class idDictKey;
+	
 public:
 	idDict();
 	idDict( const idDict& other );	// allow declaration with assignment
@@ -164,6 +208,18 @@ public:
 	bool				GetAngles( const char* key, const char* defaultString, idAngles& out ) const;
 	bool				GetMatrix( const char* key, const char* defaultString, idMat3& out ) const;
 	
+	// lookups with pre-interned keys
+	const char* 		GetString( const idDictKey& key, const char* defaultString = "" ) const;
+	float				GetFloat( const idDictKey& key, const char* defaultString ) const;
+	bool				GetBool( const idDictKey& key, const char* defaultString ) const;
+	float				GetFloat( const idDictKey& key, const float defaultFloat = 0.0f ) const;
+	int					GetInt( const idDictKey& key, const int defaultInt = 0 ) const;
+	bool				GetBool( const idDictKey& key, const bool defaultBool = false ) const;
+	bool				GetString( const idDictKey& key, const char* defaultString, const char** out ) const;
+	bool				GetString( const idDictKey& key, const char* defaultString, idStr& out ) const;
+	bool				GetVector( const idDictKey& key, const char* defaultString, idVec3& out ) const;
+	bool				GetMatrix( const idDictKey& key, const char* defaultString, idMat3& out ) const;
+	
 	int					GetNumKeyVals() const;
 	const idKeyValue* 	GetKeyVal( int index ) const;
 	// returns the key/value pair with the given key
@@ -172,6 +228,8 @@ public:
 	// returns the index to the key/value pair with the given key
 	// returns -1 if the key/value pair does not exist
 	int					FindKeyIndex( const char* key ) const;
+	const idKeyValue* 	FindKey( const idDictKey& key ) const;
+	int					FindKeyIndex( const idDictKey& key ) const;
 	// delete the key/value pair with the given key
 	void				Delete( const char* key );
 	// finds the next key/value pair with the given key prefix.
@@ -200,18 +258,31 @@ public:
 	
 private:
 	idList<idKeyValue>	args;
-	idHashIndex			argHash;
+	idFlatHashMap< const char*, int >	argHash;	// keys point at the pooled key strings of args
 	
 	static idStrPool	globalKeys;
 	static idStrPool	globalValues;
 };
 
+// keys looked up for most spawned entities
+extern idDictKey		dictKey_classname;
+extern idDictKey		dictKey_name;
+extern idDictKey		dictKey_origin;
+extern idDictKey		dictKey_rotation;
+extern idDictKey		dictKey_angle;
+extern idDictKey		dictKey_model;
+extern idDictKey		dictKey_skin;
+extern idDictKey		dictKey_spawnclass;
+extern idDictKey		dictKey_spawnfunc;
+extern idDictKey		dictKey_scriptobject;
+extern idDictKey		dictKey_health;
+extern idDictKey		dictKey_hide;
+extern idDictKey		dictKey_bind;
+
 
 ID_INLINE idDict::idDict()
 {
 	args.SetGranularity( 16 );
-	argHash.SetGranularity( 16 );
-	argHash.Clear( 128, 16 );
 }
 
 ID_INLINE idDict::idDict( const idDict& other )
@@ -227,14 +298,13 @@ ID_INLINE idDict::~idDict()
 ID_INLINE void idDict::SetGranularity( int granularity )
 {
 	args.SetGranularity( granularity );
-	argHash.SetGranularity( granularity );
 }
 
 ID_INLINE void idDict::SetHashSize( int hashSize )
 {
 	if( args.Num() == 0 )
 	{
-		argHash.Clear( hashSize, 16 );
+		argHash.Reserve( hashSize );
 	}
 }
 
@@ -392,6 +462,100 @@ ID_INLINE idMat3 idDict::GetMatrix( const char* key, const char* defaultString )
 	return out;
 }
 
+ID_INLINE const idKeyValue* idDict::FindKey( const idDictKey& key ) const
+{
+	const int* index;
+	if( argHash.GetHashed( key.c_str(), key.hash, &index ) )
+	{
+		return &args[*index];
+	}
+	return NULL;
+}
+
+ID_INLINE int idDict::FindKeyIndex( const idDictKey& key ) const
+{
+	const int* index;
+	if( argHash.GetHashed( key.c_str(), key.hash, &index ) )
+	{
+		return *index;
+	}
+	return -1;
+}
+
+ID_INLINE bool idDict::GetString( const idDictKey& key, const char* defaultString, const char** out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		*out = kv->GetValue();
+		return true;
+	}
+	*out = defaultString;
+	return false;
+}
+
+ID_INLINE bool idDict::GetString( const idDictKey& key, const char* defaultString, idStr& out ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		out = kv->GetValue();
+		return true;
+	}
+	out = defaultString;
+	return false;
+}
+
+ID_INLINE const char* idDict::GetString( const idDictKey& key, const char* defaultString ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return kv->GetValue();
+	}
+	return defaultString;
+}
+
+ID_INLINE float idDict::GetFloat( const idDictKey& key, const char* defaultString ) const
+{
+	return atof( GetString( key, defaultString ) );
+}
+
+ID_INLINE bool idDict::GetBool( const idDictKey& key, const char* defaultString ) const
+{
+	return ( atoi( GetString( key, defaultString ) ) != 0 );
+}
+
+ID_INLINE float idDict::GetFloat( const idDictKey& key, const float defaultFloat ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return atof( kv->GetValue() );
+	}
+	return defaultFloat;
+}
+
+ID_INLINE int idDict::GetInt( const idDictKey& key, int defaultInt ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return atoi( kv->GetValue() );
+	}
+	return defaultInt;
+}
+
+ID_INLINE bool idDict::GetBool( const idDictKey& key, const bool defaultBool ) const
+{
+	const idKeyValue* kv = FindKey( key );
+	if( kv )
+	{
+		return atoi( kv->GetValue() ) != 0;
+	}
+	return defaultBool;
+}
+
 ID_INLINE int idDict::GetNumKeyVals() const
 {
 	return args.Num();
@@ -37,8 +37,1236 @@ If you have questions concerning this license or the applicable additional terms
 //
 //===============================================================
 #include <stdlib.h>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <sys/mman.h>
+#endif
 #undef new
 
+/*
+===============================================================================
+
+	Thread caching allocator
+	
+	Allocations up to HEAP_MAX_SMALL_SIZE are rounded up to a size class. Every
+	thread keeps its own free lists per size class, so allocating and freeing on
+	the same thread doesn't take any locks. Blocks freed by another thread are
+	pushed onto a lock-free queue of the thread that allocated them, and picked
+	up again once that thread runs out of blocks. The free lists trade batches
+	of blocks with a central free list per size class, which carves new blocks
+	out of large spans that are mapped straight from the virtual memory of the
+	system. Larger allocations go straight to the system allocator.
+	
+	Mem_Free16 can be handed memory of the C runtime, for instance memory
+	allocated by a library and deleted with our operator delete. Whether a
+	pointer is ours never depends on the memory it points to: spans are aligned
+	to HEAP_SPAN_SIZE and marked in a page map, and the large allocations are
+	kept in a hash set. The cache of a thread that exits is handed back through
+	a thread local storage exit callback, so this works for threads that were
+	not started by idSysThread as well.
+	
+	Each allocation is preceded by a 16 byte header with the size class and
+	the memory tag, so the memory in use can be tracked per tag. The counters
+	per tag are updated with atomics. While a memory snapshot is active the
+	call site of every allocation is tracked as well, so the allocations made
+	since the snapshot can be listed by call site.
+	
+	Allocations with TAG_FRAME_ARENA are carved out of a double buffered
+	linear arena instead. The game flips the arena once per tic, so the
+	memory stays valid until the end of the next tic, and freeing it does
+	nothing. When the arena is full the heap is used as usual. The arena
+	allocations are counted under TAG_FRAME_ARENA like any other, and all
+	allocations of a half count as freed when the half is reused.
+	
+===============================================================================
+*/
+
+#define ID_HEAP_THREAD_CACHE			1		// set to 0 to use the system allocator for everything
+
+static const uint32 HEAP_BLOCK_MAGIC		= 0x1D4EA7B1;
+static const int HEAP_MAX_SMALL_SIZE		= 32 * 1024;
+static const int HEAP_MAX_SIZE_CLASSES		= 64;
+static const int HEAP_LARGE_CLASS			= 0xFFFF;
+static const int HEAP_SPAN_SHIFT			= 18;
+static const int HEAP_SPAN_SIZE				= 1 << HEAP_SPAN_SHIFT;	// spans are never returned to the system
+static const int HEAP_SPAN_MAP_LEAF_BITS	= 15;
+static const int HEAP_SPAN_MAP_ROOT_SIZE	= 1 << ( 48 - HEAP_SPAN_SHIFT - HEAP_SPAN_MAP_LEAF_BITS );	// 48 bit address space
+static const int HEAP_BATCH_BYTES			= 64 * 1024;	// blocks moved between a thread and the central list at once
+static const int HEAP_MAX_THREADS			= 64;
+static const int HEAP_NO_THREAD				= 0xFF;
+static const int HEAP_FRAME_ARENA_SIZE		= 2 * 1024 * 1024;	// per buffer
+
+struct heapBlockHeader_t
+{
+	uint32				magic;
+	uint16				sizeClass;
+	uint8				tag;
+	uint8				threadIndex;	// cache of the thread that allocated the block
+	uint64				size;			// usable size of the block
+};
+
+compile_time_assert( sizeof( heapBlockHeader_t ) == 16 );
+compile_time_assert( TAG_NUM_TAGS <= 256 );
+
+// a free block links to the next one through its first bytes
+struct heapFreeBlock_t
+{
+	heapFreeBlock_t* 	next;
+};
+
+struct heapFreeList_t
+{
+	heapFreeBlock_t* 	head;
+	int					count;
+};
+
+// counters of a single tag kept by a thread cache, only written by the thread that owns the cache
+struct heapCacheCounters_t
+{
+	int64				liveBytes;		// can go negative when the thread frees memory another thread allocated
+	int64				peakCheckBytes;	// liveBytes at which the peak of the tag is updated next
+	int64				numAllocs;
+	int64				numFrees;
+	int64				liveBySize[MEM_HISTOGRAM_BUCKETS];
+};
+
+struct heapThreadCache_t
+{
+	heapFreeList_t		freeLists[HEAP_MAX_SIZE_CLASSES];
+	heapCacheCounters_t	counters[TAG_NUM_TAGS];
+	void* 				remoteFrees;					// heapFreeBlock_t pushed by other threads
+	volatile bool		inUse;
+	int					threadIndex;
+};
+
+struct heapCentralList_t
+{
+	idSysMutex			mutex;
+	heapFreeBlock_t* 	head;
+	int					count;
+	int64				spanBytes;
+};
+
+struct heapRecord_t
+{
+	void* 				ptr;
+	size_t				size;		// zero for a free
+};
+
+// counters of a single tag, padded so the tags don't share cache lines. Most allocations are
+// counted in the thread caches, these take the others and are summed with the caches on demand.
+struct heapTagCounters_t
+{
+	int64				liveBytes;
+	int64				peakBytes;			// updated while a thread cache grows, when the stats are read and at the end of each frame
+	interlockedInt_t	numAllocs;
+	interlockedInt_t	numFrees;
+	interlockedInt_t	liveBySize[MEM_HISTOGRAM_BUCKETS];
+	// only used by the main thread in Mem_EndFrame
+	int64				frameStartAllocs;
+	int64				frameStartFrees;
+	int					frameAllocs;
+	int					frameFrees;
+	byte				padding[16];
+};
+
+compile_time_assert( sizeof( heapTagCounters_t ) == CACHE_LINE_SIZE );
+
+// an allocation that was made while the call sites are tracked
+struct heapCallSite_t
+{
+	void* 				ptr;		// NULL for an empty slot
+	void* 				site;
+	size_t				size;
+	int					tag;
+};
+
+static void ID_TLS_EXIT_CALLBACK Heap_ThreadExit( void* cache );
+
+struct heapState_t
+{
+	heapState_t() : threadCache( Heap_ThreadExit ) {}
+	
+	int					numSizeClasses;
+	int					classSize[HEAP_MAX_SIZE_CLASSES];
+	int					classBatch[HEAP_MAX_SIZE_CLASSES];
+	uint8				sizeToClass[HEAP_MAX_SMALL_SIZE / 16 + 1];
+	
+	heapCentralList_t	central[HEAP_MAX_SIZE_CLASSES];
+	
+	idSysMutex			threadMutex;
+	ID_TLS				threadCache;
+	heapThreadCache_t* 	threadCaches[HEAP_MAX_THREADS];
+	volatile int		numThreadCaches;
+	
+	// marks the pages of the spans, leaves are allocated on demand
+	idSysMutex			spanMapMutex;
+	byte* 				spanMap[HEAP_SPAN_MAP_ROOT_SIZE];
+	
+	// open addressed hash set of the allocations that are too large for a span
+	idSysMutex			largeMutex;
+	void** 				largeBlocks;
+	int					numLargeBlocks;		// including removed ones
+	int					maxLargeBlocks;
+	
+	// allocations recorded for the churn benchmark
+	idSysMutex			recordMutex;
+	heapRecord_t* 		records;
+	int					numRecords;
+	int					maxRecords;
+	
+	// open addressed hash table of the live allocations since the last memory snapshot
+	idSysMutex			callSiteMutex;
+	heapCallSite_t* 	callSites;
+	int					numCallSites;		// including removed ones
+	int					maxCallSites;
+};
+
+// constructed on first use, global constructors may already allocate memory
+static heapState_t* 	heap;
+static ALIGN16( byte	heapBuffer[sizeof( heapState_t )] );
+static volatile bool	heapRecording;
+static volatile bool	heapTrackCallSites;
+static heapTagCounters_t heapTagCounters[TAG_NUM_TAGS];
+
+// the two halves of the frame arena, allocated on the first flip. Only the thread that
+// flips the arena allocates from it, so apart from frameArenaHeapAllocs nothing is shared.
+static byte* 			frameArenaBase;
+static size_t			frameArenaSize;			// both halves, zero until the first flip
+static uintptr_t		frameArenaThread;		// the thread that runs the game tics
+static int				frameArenaCurrent;		// half used during this tic
+static int				frameArenaUsed;
+static int				frameArenaAllocs;
+static interlockedInt_t	frameArenaHeapAllocs;	// did not fit or came from another thread and went to the heap
+static int				frameArenaLiveBytes[2];	// per half, counted as freed when the half is reused
+static int				frameArenaLiveBySize[2][MEM_HISTOGRAM_BUCKETS];
+static memFrameArenaStats_t frameArenaLastTic;
+
+// a thread cache updates the peak of a tag each time its live bytes grew by this much
+static const int64		HEAP_PEAK_CHECK_BYTES = 256 * 1024;
+
+static void* const		HEAP_REMOVED_CALL_SITE = ( void* ) - 1;
+static void* const		HEAP_REMOVED_LARGE_BLOCK = ( void* ) - 1;
+
+// the code that called the function this is used in, the allocation functions pass it down to Heap_Alloc
+#ifdef _MSC_VER
+#include <intrin.h>
+#define HEAP_CALL_SITE()	_ReturnAddress()
+#else
+#define HEAP_CALL_SITE()	__builtin_return_address( 0 )
+#endif
+
+/*
+==================
+Heap_SystemAlloc
+==================
+*/
+static void* Heap_SystemAlloc( const size_t size, const size_t alignment = 16 )
+{
+#ifdef _WIN32
+	// this should work with MSVC and mingw, as long as __MSVCRT_VERSION__ >= 0x0700
+	return _aligned_malloc( size, alignment );
+#else // not _WIN32
+	// DG: the POSIX solution for linux etc
+	void* ret;
+	if( posix_memalign( &ret, alignment, size ) != 0 )
+	{
+		return NULL;
+	}
+	return ret;
+	// DG end
+#endif // _WIN32
+}
+
+/*
+==================
+Heap_SystemFree
+==================
+*/
+static void Heap_SystemFree( void* ptr )
+{
+#ifdef _WIN32
+	_aligned_free( ptr );
+#else // not _WIN32
+	// DG: Linux/POSIX compatibility
+	// can use normal free() for aligned memory
+	free( ptr );
+	// DG end
+#endif // _WIN32
+}
+
+/*
+==================
+Heap_SystemAllocSpan
+
+Gets span memory aligned to HEAP_SPAN_SIZE straight from the virtual memory of the system.
+Going through the C runtime would pay for the alignment with up to a whole span of heap memory
+and a block header in front of every span.
+==================
+*/
+static byte* Heap_SystemAllocSpan( const size_t size )
+{
+#ifdef _WIN32
+	// allocations are 64 KB aligned, so try the exact size first
+	byte* span = ( byte* )VirtualAlloc( NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+	if( span == NULL || ( ( uintptr_t )span & ( HEAP_SPAN_SIZE - 1 ) ) == 0 )
+	{
+		return span;
+	}
+	VirtualFree( span, 0, MEM_RELEASE );
+	
+	// reserve enough address space to contain an aligned span and only commit that
+	byte* base = ( byte* )VirtualAlloc( NULL, size + HEAP_SPAN_SIZE, MEM_RESERVE, PAGE_NOACCESS );
+	if( base == NULL )
+	{
+		return NULL;
+	}
+	span = ( byte* )( ( ( uintptr_t )base + HEAP_SPAN_SIZE - 1 ) & ~( uintptr_t )( HEAP_SPAN_SIZE - 1 ) );
+	if( VirtualAlloc( span, size, MEM_COMMIT, PAGE_READWRITE ) == NULL )
+	{
+		VirtualFree( base, 0, MEM_RELEASE );
+		return NULL;
+	}
+	return span;
+#else
+	// map enough to contain an aligned span and unmap the unaligned head and tail
+	byte* base = ( byte* )mmap( NULL, size + HEAP_SPAN_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0 );
+	if( base == ( byte* )MAP_FAILED )
+	{
+		return NULL;
+	}
+	byte* span = ( byte* )( ( ( uintptr_t )base + HEAP_SPAN_SIZE - 1 ) & ~( uintptr_t )( HEAP_SPAN_SIZE - 1 ) );
+	if( span > base )
+	{
+		munmap( base, span - base );
+	}
+	if( span + size < base + size + HEAP_SPAN_SIZE )
+	{
+		munmap( span + size, ( base + size + HEAP_SPAN_SIZE ) - ( span + size ) );
+	}
+	return span;
+#endif
+}
+
+/*
+==================
+Heap_SystemFreeSpan
+==================
+*/
+static void Heap_SystemFreeSpan( byte* span, const size_t size )
+{
+#ifdef _WIN32
+	// release the whole reservation the span was committed in
+	MEMORY_BASIC_INFORMATION info;
+	if( VirtualQuery( span, &info, sizeof( info ) ) != 0 )
+	{
+		VirtualFree( info.AllocationBase, 0, MEM_RELEASE );
+	}
+#else
+	munmap( span, size );
+#endif
+}
+
+/*
+==================
+Heap_Init
+==================
+*/
+static void Heap_Init()
+{
+	heap = new( heapBuffer ) heapState_t;
+	
+	// 16 byte steps up to 128 bytes, then four classes per power of two
+	int numClasses = 0;
+	for( int size = 16; size <= 128; size += 16 )
+	{
+		heap->classSize[numClasses++] = size;
+	}
+	for( int base = 128; base < HEAP_MAX_SMALL_SIZE; base *= 2 )
+	{
+		for( int i = 1; i <= 4; i++ )
+		{
+			heap->classSize[numClasses++] = base + i * ( base / 4 );
+		}
+	}
+	assert( numClasses <= HEAP_MAX_SIZE_CLASSES );
+	heap->numSizeClasses = numClasses;
+	
+	for( int i = 0, c = 0; i <= HEAP_MAX_SMALL_SIZE / 16; i++ )
+	{
+		while( heap->classSize[c] < i * 16 )
+		{
+			c++;
+		}
+		heap->sizeToClass[i] = ( uint8 )c;
+	}
+	
+	for( int i = 0; i < numClasses; i++ )
+	{
+		heap->classBatch[i] = idMath::ClampInt( 4, 128, HEAP_BATCH_BYTES / heap->classSize[i] );
+		heap->central[i].head = NULL;
+		heap->central[i].count = 0;
+		heap->central[i].spanBytes = 0;
+	}
+	
+	memset( heap->threadCaches, 0, sizeof( heap->threadCaches ) );
+	heap->numThreadCaches = 0;
+	memset( heap->spanMap, 0, sizeof( heap->spanMap ) );
+	heap->largeBlocks = NULL;
+	heap->numLargeBlocks = 0;
+	heap->maxLargeBlocks = 0;
+	heap->records = NULL;
+	heap->numRecords = 0;
+	heap->maxRecords = 0;
+	heap->callSites = NULL;
+	heap->numCallSites = 0;
+	heap->maxCallSites = 0;
+}
+
+/*
+==================
+Heap_GetThreadCache
+
+Returns NULL if all caches are taken, the thread then uses the system allocator.
+==================
+*/
+static heapThreadCache_t* Heap_GetThreadCache()
+{
+	heapThreadCache_t* cache = ( heapThreadCache_t* )( ptrdiff_t )heap->threadCache;
+	if( cache != NULL )
+	{
+		return cache;
+	}
+	
+	idScopedCriticalSection lock( heap->threadMutex );
+	
+	// reuse the cache of a thread that has exited
+	for( int i = 0; i < heap->numThreadCaches; i++ )
+	{
+		if( !heap->threadCaches[i]->inUse )
+		{
+			cache = heap->threadCaches[i];
+			break;
+		}
+	}
+	if( cache == NULL )
+	{
+		if( heap->numThreadCaches >= HEAP_MAX_THREADS )
+		{
+			return NULL;
+		}
+		cache = ( heapThreadCache_t* )Heap_SystemAlloc( sizeof( heapThreadCache_t ) );
+		memset( cache, 0, sizeof( heapThreadCache_t ) );
+		cache->threadIndex = heap->numThreadCaches;
+		heap->threadCaches[heap->numThreadCaches] = cache;
+		heap->numThreadCaches++;
+	}
+	cache->inUse = true;
+	heap->threadCache = ( ptrdiff_t )cache;
+	return cache;
+}
+
+/*
+==================
+Heap_SpanOwns
+
+True for the blocks in a span, doesn't touch the memory the pointer points to.
+==================
+*/
+ID_INLINE static bool Heap_SpanOwns( const void* ptr )
+{
+	const uintptr_t page = ( uintptr_t )ptr >> HEAP_SPAN_SHIFT;
+	const uintptr_t root = page >> HEAP_SPAN_MAP_LEAF_BITS;
+	if( root >= HEAP_SPAN_MAP_ROOT_SIZE )
+	{
+		return false;
+	}
+	const byte* leaf = heap->spanMap[root];
+	return leaf != NULL && leaf[page & ( ( 1 << HEAP_SPAN_MAP_LEAF_BITS ) - 1 )] != 0;
+}
+
+/*
+==================
+Heap_MarkSpan
+
+Returns false if the span is outside of the address range the page map covers.
+==================
+*/
+static bool Heap_MarkSpan( const byte* span, const int spanBytes )
+{
+	idScopedCriticalSection lock( heap->spanMapMutex );
+	for( int offset = 0; offset < spanBytes; offset += HEAP_SPAN_SIZE )
+	{
+		const uintptr_t page = ( uintptr_t )( span + offset ) >> HEAP_SPAN_SHIFT;
+		const uintptr_t root = page >> HEAP_SPAN_MAP_LEAF_BITS;
+		if( root >= HEAP_SPAN_MAP_ROOT_SIZE )
+		{
+			return false;
+		}
+		if( heap->spanMap[root] == NULL )
+		{
+			byte* leaf = ( byte* )Heap_SystemAlloc( 1 << HEAP_SPAN_MAP_LEAF_BITS );
+			if( leaf == NULL )
+			{
+				return false;
+			}
+			memset( leaf, 0, 1 << HEAP_SPAN_MAP_LEAF_BITS );
+			Sys_InterlockedExchangePointer( ( void*& )heap->spanMap[root], leaf );
+		}
+		heap->spanMap[root][page & ( ( 1 << HEAP_SPAN_MAP_LEAF_BITS ) - 1 )] = 1;
+	}
+	return true;
+}
+
+/*
+==================
+Heap_CarveSpan
+
+Cuts a new span into blocks and links them into the central list, the central list must be locked.
+==================
+*/
+static void Heap_CarveSpan( int sizeClass )
+{
+	heapCentralList_t& central = heap->central[sizeClass];
+	const int blockSize = sizeof( heapBlockHeader_t ) + heap->classSize[sizeClass];
+	
+	// whole pages of the span map, so no other memory shares a page with the span
+	int spanBytes = Max( HEAP_SPAN_SIZE / blockSize, 2 * heap->classBatch[sizeClass] ) * blockSize;
+	spanBytes = ( spanBytes + HEAP_SPAN_SIZE - 1 ) & ~( HEAP_SPAN_SIZE - 1 );
+	const int numBlocks = spanBytes / blockSize;
+	
+	byte* span = Heap_SystemAllocSpan( spanBytes );
+	if( span == NULL )
+	{
+		return;
+	}
+	if( !Heap_MarkSpan( span, spanBytes ) )
+	{
+		Heap_SystemFreeSpan( span, spanBytes );
+		return;
+	}
+	central.spanBytes += spanBytes;
+	
+	for( int i = numBlocks - 1; i >= 0; i-- )
+	{
+		heapBlockHeader_t* header = ( heapBlockHeader_t* )( span + i * blockSize );
+		header->magic = HEAP_BLOCK_MAGIC;
+		header->sizeClass = ( uint16 )sizeClass;
+		header->tag = TAG_UNSET;
+		header->threadIndex = HEAP_NO_THREAD;
+		header->size = heap->classSize[sizeClass];
+		
+		heapFreeBlock_t* block = ( heapFreeBlock_t* )( header + 1 );
+		block->next = central.head;
+		central.head = block;
+	}
+	central.count += numBlocks;
+}
+
+/*
+==================
+Heap_MoveToCentral
+==================
+*/
+static void Heap_MoveToCentral( heapThreadCache_t* cache, int sizeClass, int numBlocks )
+{
+	heapFreeList_t& list = cache->freeLists[sizeClass];
+	heapFreeBlock_t* first = list.head;
+	heapFreeBlock_t* last = first;
+	for( int i = 1; i < numBlocks; i++ )
+	{
+		last = last->next;
+	}
+	list.head = last->next;
+	list.count -= numBlocks;
+	
+	heapCentralList_t& central = heap->central[sizeClass];
+	idScopedCriticalSection lock( central.mutex );
+	last->next = central.head;
+	central.head = first;
+	central.count += numBlocks;
+}
+
+/*
+==================
+Heap_TakeRemoteFrees
+==================
+*/
+static void Heap_TakeRemoteFrees( heapThreadCache_t* cache )
+{
+	heapFreeBlock_t* remote = ( heapFreeBlock_t* )Sys_InterlockedExchangePointer( cache->remoteFrees, NULL );
+	while( remote != NULL )
+	{
+		heapFreeBlock_t* next = remote->next;
+		heapFreeList_t& list = cache->freeLists[( ( heapBlockHeader_t* )remote - 1 )->sizeClass];
+		remote->next = list.head;
+		list.head = remote;
+		list.count++;
+		remote = next;
+	}
+}
+
+/*
+==================
+Heap_ReturnRemoteFrees
+
+Hands the remote frees of a cache that no thread uses straight to the central lists.
+==================
+*/
+static void Heap_ReturnRemoteFrees( heapThreadCache_t* cache )
+{
+	heapFreeBlock_t* remote = ( heapFreeBlock_t* )Sys_InterlockedExchangePointer( cache->remoteFrees, NULL );
+	while( remote != NULL )
+	{
+		heapFreeBlock_t* next = remote->next;
+		heapCentralList_t& central = heap->central[( ( heapBlockHeader_t* )remote - 1 )->sizeClass];
+		idScopedCriticalSection lock( central.mutex );
+		remote->next = central.head;
+		central.head = remote;
+		central.count++;
+		remote = next;
+	}
+}
+
+/*
+==================
+Heap_ReleaseCache
+
+Hands the free blocks of a thread that is about to exit back to the central
+lists, so the cache can be used by another thread.
+==================
+*/
+static void Heap_ReleaseCache( heapThreadCache_t* cache )
+{
+	Heap_TakeRemoteFrees( cache );
+	for( int i = 0; i < heap->numSizeClasses; i++ )
+	{
+		if( cache->freeLists[i].count > 0 )
+		{
+			Heap_MoveToCentral( cache, i, cache->freeLists[i].count );
+		}
+	}
+	
+	// blocks of this cache that are still in use are given to the next thread that takes it over
+	{
+		idScopedCriticalSection lock( heap->threadMutex );
+		cache->inUse = false;
+	}
+	
+	// frees that came in while the cache was released, Mem_Free16 takes care of the later ones
+	Heap_ReturnRemoteFrees( cache );
+}
+
+/*
+==================
+Heap_ThreadExit
+
+Called for every thread that exits with a cache, also the ones that didn't
+release it with Mem_ReleaseThreadCache.
+==================
+*/
+static void ID_TLS_EXIT_CALLBACK Heap_ThreadExit( void* cache )
+{
+	Heap_ReleaseCache( ( heapThreadCache_t* )cache );
+}
+
+/*
+==================
+Heap_FindLargeBlock
+
+Returns the slot of the pointer or the empty slot it would go in, the large block set must be locked.
+==================
+*/
+static void** Heap_FindLargeBlock( void* ptr )
+{
+	const int mask = heap->maxLargeBlocks - 1;
+	void** removed = NULL;
+	for( int i = ( int )( ( ( uintptr_t )ptr >> 4 ) * 2654435761u ) & mask; ; i = ( i + 1 ) & mask )
+	{
+		void** slot = &heap->largeBlocks[i];
+		if( *slot == ptr )
+		{
+			return slot;
+		}
+		if( *slot == NULL )
+		{
+			return ( removed != NULL ) ? removed : slot;
+		}
+		if( *slot == HEAP_REMOVED_LARGE_BLOCK && removed == NULL )
+		{
+			removed = slot;
+		}
+	}
+}
+
+/*
+==================
+Heap_AddLargeBlock
+==================
+*/
+static bool Heap_AddLargeBlock( void* ptr )
+{
+	idScopedCriticalSection lock( heap->largeMutex );
+	
+	// keep the set at most half full, which also gets rid of the removed slots
+	if( ( heap->numLargeBlocks + 1 ) * 2 > heap->maxLargeBlocks )
+	{
+		void** oldLargeBlocks = heap->largeBlocks;
+		const int oldMaxLargeBlocks = heap->maxLargeBlocks;
+		
+		int numLive = 0;
+		for( int i = 0; i < oldMaxLargeBlocks; i++ )
+		{
+			if( oldLargeBlocks[i] != NULL && oldLargeBlocks[i] != HEAP_REMOVED_LARGE_BLOCK )
+			{
+				numLive++;
+			}
+		}
+		int maxLargeBlocks = 1024;
+		while( maxLargeBlocks < numLive * 4 )
+		{
+			maxLargeBlocks *= 2;
+		}
+		void** largeBlocks = ( void** )Heap_SystemAlloc( maxLargeBlocks * sizeof( void* ) );
+		if( largeBlocks == NULL )
+		{
+			return false;
+		}
+		memset( largeBlocks, 0, maxLargeBlocks * sizeof( void* ) );
+		heap->largeBlocks = largeBlocks;
+		heap->maxLargeBlocks = maxLargeBlocks;
+		heap->numLargeBlocks = numLive;
+		
+		for( int i = 0; i < oldMaxLargeBlocks; i++ )
+		{
+			if( oldLargeBlocks[i] != NULL && oldLargeBlocks[i] != HEAP_REMOVED_LARGE_BLOCK )
+			{
+				*Heap_FindLargeBlock( oldLargeBlocks[i] ) = oldLargeBlocks[i];
+			}
+		}
+		Heap_SystemFree( oldLargeBlocks );
+	}
+	
+	void** slot = Heap_FindLargeBlock( ptr );
+	if( *slot == NULL )
+	{
+		heap->numLargeBlocks++;
+	}
+	*slot = ptr;
+	return true;
+}
+
+/*
+==================
+Heap_RemoveLargeBlock
+
+Returns false if the pointer wasn't allocated by Mem_Alloc16.
+==================
+*/
+static bool Heap_RemoveLargeBlock( void* ptr )
+{
+	idScopedCriticalSection lock( heap->largeMutex );
+	if( heap->largeBlocks == NULL )
+	{
+		return false;
+	}
+	void** slot = Heap_FindLargeBlock( ptr );
+	if( *slot != ptr )
+	{
+		return false;
+	}
+	*slot = HEAP_REMOVED_LARGE_BLOCK;
+	return true;
+}
+
+/*
+==================
+Heap_Refill
+==================
+*/
+static void Heap_Refill( heapThreadCache_t* cache, int sizeClass )
+{
+	// first pick up the blocks other threads have freed
+	Heap_TakeRemoteFrees( cache );
+	
+	heapFreeList_t& list = cache->freeLists[sizeClass];
+	if( list.head != NULL )
+	{
+		return;
+	}
+	
+	heapCentralList_t& central = heap->central[sizeClass];
+	idScopedCriticalSection lock( central.mutex );
+	if( central.count < heap->classBatch[sizeClass] )
+	{
+		Heap_CarveSpan( sizeClass );
+	}
+	for( int i = heap->classBatch[sizeClass]; i > 0 && central.head != NULL; i-- )
+	{
+		heapFreeBlock_t* block = central.head;
+		central.head = block->next;
+		central.count--;
+		block->next = list.head;
+		list.head = block;
+		list.count++;
+	}
+}
+
+/*
+==================
+Heap_Record
+==================
+*/
+static void Heap_Record( void* ptr, size_t size )
+{
+	idScopedCriticalSection lock( heap->recordMutex );
+	if( !heapRecording )
+	{
+		return;
+	}
+	if( heap->numRecords == heap->maxRecords )
+	{
+		// not using the heap itself to store the records
+		heap->maxRecords = Max( heap->maxRecords * 2, 65536 );
+		heapRecord_t* records = ( heapRecord_t* )Heap_SystemAlloc( heap->maxRecords * sizeof( heapRecord_t ) );
+		if( heap->numRecords > 0 )
+		{
+			memcpy( records, heap->records, heap->numRecords * sizeof( heapRecord_t ) );
+		}
+		Heap_SystemFree( heap->records );
+		heap->records = records;
+	}
+	heap->records[heap->numRecords].ptr = ptr;
+	heap->records[heap->numRecords].size = size;
+	heap->numRecords++;
+}
+
+/*
+==================
+Heap_SizeBucket
+==================
+*/
+ID_INLINE static int Heap_SizeBucket( size_t size )
+{
+	int bucket = 0;
+	for( size_t s = ( size - 1 ) >> 4; s != 0 && bucket < MEM_HISTOGRAM_BUCKETS - 1; s >>= 1 )
+	{
+		bucket++;
+	}
+	return bucket;
+}
+
+/*
+==================
+Heap_UpdatePeak
+==================
+*/
+static int64 Heap_UpdatePeak( int tag, int64 liveBytes )
+{
+	heapTagCounters_t& counters = heapTagCounters[tag];
+	for( ; ; )
+	{
+		const int64 peakBytes = counters.peakBytes;
+		if( liveBytes <= peakBytes )
+		{
+			return peakBytes;
+		}
+		if( Sys_InterlockedCompareExchange64( counters.peakBytes, peakBytes, liveBytes ) == peakBytes )
+		{
+			return liveBytes;
+		}
+	}
+}
+
+/*
+==================
+Heap_SumLiveBytes
+==================
+*/
+static int64 Heap_SumLiveBytes( int tag )
+{
+	int64 liveBytes = heapTagCounters[tag].liveBytes;
+	const int numThreadCaches = ( heap != NULL ) ? heap->numThreadCaches : 0;
+	for( int c = 0; c < numThreadCaches; c++ )
+	{
+		liveBytes += heap->threadCaches[c]->counters[tag].liveBytes;
+	}
+	return liveBytes;
+}
+
+/*
+==================
+Heap_CountAlloc
+
+A thread that keeps allocating updates the peak of the tag every HEAP_PEAK_CHECK_BYTES,
+so the peaks of a level load are seen without waiting for the end of the frame.
+==================
+*/
+ID_INLINE static void Heap_CountAlloc( heapThreadCache_t* cache, int tag, size_t size )
+{
+	const int bucket = Heap_SizeBucket( size );
+	if( cache != NULL )
+	{
+		heapCacheCounters_t& counters = cache->counters[tag];
+		counters.liveBytes += size;
+		counters.numAllocs++;
+		counters.liveBySize[bucket]++;
+		if( counters.liveBytes >= counters.peakCheckBytes )
+		{
+			counters.peakCheckBytes = counters.liveBytes + HEAP_PEAK_CHECK_BYTES;
+			Heap_UpdatePeak( tag, Heap_SumLiveBytes( tag ) );
+		}
+		return;
+	}
+	
+	heapTagCounters_t& counters = heapTagCounters[tag];
+	Sys_InterlockedIncrement( counters.liveBySize[bucket] );
+	Sys_InterlockedIncrement( counters.numAllocs );
+	Sys_InterlockedAdd64( counters.liveBytes, size );
+}
+
+/*
+==================
+Heap_CountFree
+==================
+*/
+ID_INLINE static void Heap_CountFree( heapThreadCache_t* cache, int tag, size_t size )
+{
+	const int bucket = Heap_SizeBucket( size );
+	if( cache != NULL )
+	{
+		heapCacheCounters_t& counters = cache->counters[tag];
+		counters.liveBytes -= size;
+		counters.numFrees++;
+		counters.liveBySize[bucket]--;
+		counters.peakCheckBytes = Min( counters.peakCheckBytes, counters.liveBytes + HEAP_PEAK_CHECK_BYTES );
+		return;
+	}
+	
+	heapTagCounters_t& counters = heapTagCounters[tag];
+	Sys_InterlockedDecrement( counters.liveBySize[bucket] );
+	Sys_InterlockedIncrement( counters.numFrees );
+	Sys_InterlockedAdd64( counters.liveBytes, -( int64 )size );
+}
+
+/*
+==================
+Heap_SumTagCounters
+
+Adds the counts of all thread caches to the shared ones. The caches are read while
+their threads keep counting, so the sums are only exact when the threads are idle.
+==================
+*/
+static void Heap_SumTagCounters( int tag, memTagStats_t& stats )
+{
+	const heapTagCounters_t& counters = heapTagCounters[tag];
+	stats.liveBytes = counters.liveBytes;
+	stats.numAllocs = counters.numAllocs;
+	stats.numFrees = counters.numFrees;
+	int64 liveBySize[MEM_HISTOGRAM_BUCKETS];
+	for( int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++ )
+	{
+		liveBySize[i] = counters.liveBySize[i];
+	}
+	
+	const int numThreadCaches = ( heap != NULL ) ? heap->numThreadCaches : 0;
+	for( int c = 0; c < numThreadCaches; c++ )
+	{
+		const heapCacheCounters_t& cacheCounters = heap->threadCaches[c]->counters[tag];
+		stats.liveBytes += cacheCounters.liveBytes;
+		stats.numAllocs += cacheCounters.numAllocs;
+		stats.numFrees += cacheCounters.numFrees;
+		for( int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++ )
+		{
+			liveBySize[i] += cacheCounters.liveBySize[i];
+		}
+	}
+	
+	// a single cache can drift far from zero, the sum of all of them is a real count
+	for( int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++ )
+	{
+		stats.liveBySize[i] = ( int )liveBySize[i];
+	}
+}
+
+/*
+==================
+Heap_FindCallSite
+
+Returns the slot of the pointer or the empty slot it would go in, the call site table must be locked.
+==================
+*/
+static heapCallSite_t* Heap_FindCallSite( void* ptr )
+{
+	const int mask = heap->maxCallSites - 1;
+	heapCallSite_t* removed = NULL;
+	for( int i = ( int )( ( ( uintptr_t )ptr >> 4 ) * 2654435761u ) & mask; ; i = ( i + 1 ) & mask )
+	{
+		heapCallSite_t* slot = &heap->callSites[i];
+		if( slot->ptr == ptr )
+		{
+			return slot;
+		}
+		if( slot->ptr == NULL )
+		{
+			return ( removed != NULL ) ? removed : slot;
+		}
+		if( slot->ptr == HEAP_REMOVED_CALL_SITE && removed == NULL )
+		{
+			removed = slot;
+		}
+	}
+}
+
+/*
+==================
+Heap_TrackCallSite
+==================
+*/
+static void Heap_TrackCallSite( void* ptr, void* site, size_t size, int tag )
+{
+	idScopedCriticalSection lock( heap->callSiteMutex );
+	if( !heapTrackCallSites )
+	{
+		return;
+	}
+	
+	// keep the table at most half full, which also gets rid of the removed slots
+	if( ( heap->numCallSites + 1 ) * 2 > heap->maxCallSites )
+	{
+		heapCallSite_t* oldCallSites = heap->callSites;
+		const int oldMaxCallSites = heap->maxCallSites;
+		
+		int numLive = 0;
+		for( int i = 0; i < oldMaxCallSites; i++ )
+		{
+			if( oldCallSites[i].ptr != NULL && oldCallSites[i].ptr != HEAP_REMOVED_CALL_SITE )
+			{
+				numLive++;
+			}
+		}
+		heap->maxCallSites = 65536;
+		while( heap->maxCallSites < numLive * 4 )
+		{
+			heap->maxCallSites *= 2;
+		}
+		heap->callSites = ( heapCallSite_t* )Heap_SystemAlloc( heap->maxCallSites * sizeof( heapCallSite_t ) );
+		memset( heap->callSites, 0, heap->maxCallSites * sizeof( heapCallSite_t ) );
+		heap->numCallSites = numLive;
+		
+		for( int i = 0; i < oldMaxCallSites; i++ )
+		{
+			if( oldCallSites[i].ptr != NULL && oldCallSites[i].ptr != HEAP_REMOVED_CALL_SITE )
+			{
+				*Heap_FindCallSite( oldCallSites[i].ptr ) = oldCallSites[i];
+			}
+		}
+		Heap_SystemFree( oldCallSites );
+	}
+	
+	heapCallSite_t* slot = Heap_FindCallSite( ptr );
+	if( slot->ptr == NULL )
+	{
+		heap->numCallSites++;
+	}
+	slot->ptr = ptr;
+	slot->site = site;
+	slot->size = size;
+	slot->tag = tag;
+}
+
+/*
+==================
+Heap_UntrackCallSite
+==================
+*/
+static void Heap_UntrackCallSite( void* ptr )
+{
+	idScopedCriticalSection lock( heap->callSiteMutex );
+	if( heap->callSites == NULL )
+	{
+		return;
+	}
+	heapCallSite_t* slot = Heap_FindCallSite( ptr );
+	if( slot->ptr == ptr )
+	{
+		slot->ptr = HEAP_REMOVED_CALL_SITE;
+	}
+}
+
+/*
+==================
+Heap_FrameArenaAlloc
+
+Returns NULL when the arena is not set up yet, full, or the calling thread doesn't
+run the game tics. The flip isn't synchronized with allocations from other threads,
+for instance the main thread while the game runs on its own thread, so those always
+go to the heap.
+==================
+*/
+static void* Heap_FrameArenaAlloc( const size_t paddedSize )
+{
+	if( frameArenaSize == 0 || paddedSize > ( size_t )( HEAP_FRAME_ARENA_SIZE - frameArenaUsed ) || Sys_GetCurrentThreadID() != frameArenaThread )
+	{
+		Sys_InterlockedIncrement( frameArenaHeapAllocs );
+		return NULL;
+	}
+	byte* ptr = frameArenaBase + frameArenaCurrent * HEAP_FRAME_ARENA_SIZE + frameArenaUsed;
+	frameArenaUsed += ( int )paddedSize;
+	frameArenaAllocs++;
+	frameArenaLiveBytes[frameArenaCurrent] += ( int )paddedSize;
+	frameArenaLiveBySize[frameArenaCurrent][Heap_SizeBucket( paddedSize )]++;
+	Heap_CountAlloc( ( heap != NULL ) ? Heap_GetThreadCache() : NULL, TAG_FRAME_ARENA, paddedSize );
+	return ptr;
+}
+
+/*
+==================
+Heap_FrameArenaOwns
+==================
+*/
+ID_INLINE static bool Heap_FrameArenaOwns( const void* ptr )
+{
+	return ( size_t )( ( const byte* )ptr - frameArenaBase ) < frameArenaSize;
+}
+
+/*
+==================
+Mem_FlipFrameArena
+
+The calling thread becomes the one that allocates from the arena, the game tics
+never run on two threads at once.
+==================
+*/
+void Mem_FlipFrameArena()
+{
+	if( frameArenaSize == 0 )
+	{
+		frameArenaBase = ( byte* )Heap_SystemAlloc( 2 * HEAP_FRAME_ARENA_SIZE );
+		if( frameArenaBase == NULL )
+		{
+			return;
+		}
+		frameArenaSize = 2 * HEAP_FRAME_ARENA_SIZE;
+	}
+	
+	frameArenaLastTic.arenaAllocs = frameArenaAllocs;
+	frameArenaLastTic.heapAllocs = frameArenaHeapAllocs;
+	frameArenaLastTic.arenaBytes = frameArenaUsed;
+	
+	// the other half was last used two tics ago, everything in it is freed now
+	frameArenaCurrent ^= 1;
+	heapTagCounters_t& counters = heapTagCounters[TAG_FRAME_ARENA];
+	for( int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++ )
+	{
+		const int numFreed = frameArenaLiveBySize[frameArenaCurrent][i];
+		frameArenaLiveBySize[frameArenaCurrent][i] = 0;
+		Sys_InterlockedAdd( counters.liveBySize[i], -numFreed );
+		Sys_InterlockedAdd( counters.numFrees, numFreed );
+	}
+	Sys_InterlockedAdd64( counters.liveBytes, -( int64 )frameArenaLiveBytes[frameArenaCurrent] );
+	frameArenaLiveBytes[frameArenaCurrent] = 0;
+	frameArenaUsed = 0;
+	frameArenaAllocs = 0;
+	frameArenaHeapAllocs = 0;
+	frameArenaThread = Sys_GetCurrentThreadID();
+}
+
+/*
+==================
+Mem_GetFrameArenaStats
+==================
+*/
+void Mem_GetFrameArenaStats( memFrameArenaStats_t& stats )
+{
+	stats = frameArenaLastTic;
+}
+
+/*
+==================
+Heap_Alloc
+
+site is the code that called the allocation function, it is only used while the call sites are tracked.
+==================
+*/
+static void* Heap_Alloc( const size_t size, const memTag_t tag, void* site )
+{
+	if( !size )
+	{
+		return NULL;
+	}
+	const size_t paddedSize = ( size + 15 ) & ~15;
+	if( tag == TAG_FRAME_ARENA )
+	{
+		void* ptr = Heap_FrameArenaAlloc( paddedSize );
+		if( ptr != NULL )
+		{
+			return ptr;
+		}
+	}
+#if ID_HEAP_THREAD_CACHE
+	if( heap == NULL )
+	{
+		Heap_Init();
+	}
+	
+	heapThreadCache_t* cache = Heap_GetThreadCache();
+	
+	heapBlockHeader_t* header;
+	if( paddedSize <= HEAP_MAX_SMALL_SIZE && cache != NULL )
+	{
+		const int sizeClass = heap->sizeToClass[paddedSize >> 4];
+		heapFreeList_t& list = cache->freeLists[sizeClass];
+		if( list.head == NULL )
+		{
+			Heap_Refill( cache, sizeClass );
+			if( list.head == NULL )
+			{
+				return NULL;
+			}
+		}
+		heapFreeBlock_t* block = list.head;
+		list.head = block->next;
+		list.count--;
+		header = ( heapBlockHeader_t* )block - 1;
+	}
+	else
+	{
+		header = ( heapBlockHeader_t* )Heap_SystemAlloc( sizeof( heapBlockHeader_t ) + paddedSize );
+		if( header == NULL )
+		{
+			return NULL;
+		}
+		if( !Heap_AddLargeBlock( header + 1 ) )
+		{
+			Heap_SystemFree( header );
+			return NULL;
+		}
+		header->magic = HEAP_BLOCK_MAGIC;
+		header->sizeClass = HEAP_LARGE_CLASS;
+		header->size = paddedSize;
+	}
+	header->tag = ( uint8 )tag;
+	header->threadIndex = ( cache != NULL ) ? ( uint8 )cache->threadIndex : ( uint8 )HEAP_NO_THREAD;
+	
+	Heap_CountAlloc( cache, tag, header->size );
+	
+	if( heapTrackCallSites )
+	{
+		Heap_TrackCallSite( header + 1, site, header->size, tag );
+	}
+	
+	if( heapRecording )
+	{
+		Heap_Record( header + 1, size );
+	}
+	
+	return header + 1;
+#else
+	return Heap_SystemAlloc( paddedSize );
+#endif
+}
+
 /*
 ==================
 Mem_Alloc16
@@ -48,21 +1276,7 @@ Mem_Alloc16
 void* Mem_Alloc16( const size_t size, const memTag_t tag )
 // RB end
 {
-	if( !size )
-	{
-		return NULL;
-	}
-	const size_t paddedSize = ( size + 15 ) & ~15;
-#ifdef _WIN32
-	// this should work with MSVC and mingw, as long as __MSVCRT_VERSION__ >= 0x0700
-	return _aligned_malloc( paddedSize, 16 );
-#else // not _WIN32
-	// DG: the POSIX solution for linux etc
-	void* ret;
-	posix_memalign( &ret, 16, paddedSize );
-	return ret;
-	// DG end
-#endif // _WIN32
+	return Heap_Alloc( size, tag, HEAP_CALL_SITE() );
 }
 
 /*
@@ -76,14 +1290,191 @@ void Mem_Free16( void* ptr )
 	{
 		return;
 	}
-#ifdef _WIN32
-	_aligned_free( ptr );
-#else // not _WIN32
-	// DG: Linux/POSIX compatibility
-	// can use normal free() for aligned memory
-	free( ptr );
-	// DG end
-#endif // _WIN32
+#if ID_HEAP_THREAD_CACHE
+	if( heap == NULL )
+	{
+		free( ptr );
+		return;
+	}
+	
+	// most frees are blocks of a span, only look further for the others
+	if( !Heap_SpanOwns( ptr ) )
+	{
+		if( Heap_FrameArenaOwns( ptr ) )
+		{
+			return;
+		}
+		if( !Heap_RemoveLargeBlock( ptr ) )
+		{
+			// allocated by the C runtime, for instance memory from the standard library deleted with our operator delete
+			free( ptr );
+			return;
+		}
+	}
+	
+	heapBlockHeader_t* header = ( heapBlockHeader_t* )ptr - 1;
+	assert( header->magic == HEAP_BLOCK_MAGIC );
+	
+	if( heapRecording )
+	{
+		Heap_Record( ptr, 0 );
+	}
+	
+	heapThreadCache_t* cache = Heap_GetThreadCache();
+	
+	Heap_CountFree( cache, header->tag, header->size );
+	
+	if( heapTrackCallSites )
+	{
+		Heap_UntrackCallSite( ptr );
+	}
+	
+	if( header->sizeClass == HEAP_LARGE_CLASS )
+	{
+		header->magic = 0;
+		Heap_SystemFree( header );
+		return;
+	}
+	
+	heapFreeBlock_t* block = ( heapFreeBlock_t* )ptr;
+	
+	if( cache == NULL || header->threadIndex != cache->threadIndex )
+	{
+		// give the block back to the thread that allocated it
+		heapThreadCache_t* owner = heap->threadCaches[header->threadIndex];
+		void* head;
+		do
+		{
+			head = owner->remoteFrees;
+			block->next = ( heapFreeBlock_t* )head;
+		}
+		while( Sys_InterlockedCompareExchangePointer( owner->remoteFrees, head, block ) != head );
+		
+		// nobody picks the block up from a cache whose thread has exited
+		if( !owner->inUse )
+		{
+			Heap_ReturnRemoteFrees( owner );
+		}
+		return;
+	}
+	
+	heapFreeList_t& list = cache->freeLists[header->sizeClass];
+	block->next = list.head;
+	list.head = block;
+	list.count++;
+	
+	// don't let a thread that frees more than it allocates hoard blocks
+	const int batch = heap->classBatch[header->sizeClass];
+	if( list.count > 2 * batch )
+	{
+		Heap_MoveToCentral( cache, header->sizeClass, batch );
+	}
+#else
+	Heap_SystemFree( ptr );
+#endif
+}
+
+/*
+==================
+Mem_ReleaseThreadCache
+
+Called by threads that are about to exit, hands their free blocks back to the
+central lists so the cache can be used by another thread.
+==================
+*/
+void Mem_ReleaseThreadCache()
+{
+#if ID_HEAP_THREAD_CACHE
+	if( heap == NULL )
+	{
+		return;
+	}
+	heapThreadCache_t* cache = ( heapThreadCache_t* )( ptrdiff_t )heap->threadCache;
+	if( cache == NULL )
+	{
+		return;
+	}
+	heap->threadCache = 0;
+	Heap_ReleaseCache( cache );
+#endif
+}
+
+/*
+==================
+Mem_GetTagStats
+==================
+*/
+void Mem_GetTagStats( memTag_t tag, memTagStats_t& stats )
+{
+	const heapTagCounters_t& counters = heapTagCounters[tag];
+	Heap_SumTagCounters( tag, stats );
+	stats.peakBytes = Heap_UpdatePeak( tag, stats.liveBytes );
+	stats.frameAllocs = counters.frameAllocs;
+	stats.frameFrees = counters.frameFrees;
+}
+
+/*
+==================
+Mem_EndFrame
+==================
+*/
+void Mem_EndFrame()
+{
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		heapTagCounters_t& counters = heapTagCounters[i];
+		memTagStats_t stats;
+		Heap_SumTagCounters( i, stats );
+		Heap_UpdatePeak( i, stats.liveBytes );
+		counters.frameAllocs = ( int )( stats.numAllocs - counters.frameStartAllocs );
+		counters.frameFrees = ( int )( stats.numFrees - counters.frameStartFrees );
+		counters.frameStartAllocs = stats.numAllocs;
+		counters.frameStartFrees = stats.numFrees;
+	}
+}
+
+/*
+==================
+Mem_GetTagName
+==================
+*/
+const char* Mem_GetTagName( memTag_t tag )
+{
+	static const char* tagNames[] =
+	{
+#define MEM_TAG( x )	#x,
+#include "sys/sys_alloc_tags.h"
+	};
+	if( tag < 0 || tag >= TAG_NUM_TAGS )
+	{
+		return "?";
+	}
+	return tagNames[tag];
+}
+
+/*
+==================
+Mem_GetTotalBytes
+
+Memory handed out to the game, not counting the block headers and free blocks.
+==================
+*/
+int64 Mem_GetTotalBytes()
+{
+	int64 total = 0;
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		total += heapTagCounters[i].liveBytes;
+	}
+	const int numThreadCaches = ( heap != NULL ) ? heap->numThreadCaches : 0;
+	for( int c = 0; c < numThreadCaches; c++ )
+	{
+		for( int i = 0; i < TAG_NUM_TAGS; i++ )
+		{
+			total += heap->threadCaches[c]->counters[i].liveBytes;
+		}
+	}
+	return total;
 }
 
 /*
@@ -93,7 +1484,7 @@ Mem_ClearedAlloc
 */
 void* Mem_ClearedAlloc( const size_t size, const memTag_t tag )
 {
-	void* mem = Mem_Alloc( size, tag );
+	void* mem = Heap_Alloc( size, tag, HEAP_CALL_SITE() );
 	SIMDProcessor->Memset( mem, 0, size );
 	return mem;
 }
@@ -105,8 +1496,566 @@ Mem_CopyString
 */
 char* Mem_CopyString( const char* in )
 {
-	char* out = ( char* )Mem_Alloc( strlen( in ) + 1, TAG_STRING );
+	char* out = ( char* )Heap_Alloc( strlen( in ) + 1, TAG_STRING, HEAP_CALL_SITE() );
 	strcpy( out, in );
 	return out;
 }
 
+/*
+==================
+operator new
+
+Not inlined, so the call site that is tracked is the code that used new. The exception
+specification is only on the declarations in Heap.h, compilers merge it from there.
+==================
+*/
+void* operator new( size_t s )
+{
+	return Heap_Alloc( s, TAG_NEW, HEAP_CALL_SITE() );
+}
+
+void* operator new[]( size_t s )
+{
+	return Heap_Alloc( s, TAG_NEW, HEAP_CALL_SITE() );
+}
+
+void* operator new( size_t s, memTag_t tag )
+{
+	return Heap_Alloc( s, tag, HEAP_CALL_SITE() );
+}
+
+void* operator new[]( size_t s, memTag_t tag )
+{
+	return Heap_Alloc( s, tag, HEAP_CALL_SITE() );
+}
+
+/*
+================================================================================================
+
+	Allocation churn benchmark
+	
+================================================================================================
+*/
+
+/*
+========================
+RecordAllocations
+
+The recorded trace is a list of int32 operations in native byte order, a positive value
+allocates that many bytes, a negative value frees the allocation with index -value - 1.
+========================
+*/
+CONSOLE_COMMAND( recordAllocations, "starts recording all allocations, a second call writes them to a trace for testAllocChurn, usage: recordAllocations [fileName]", 0 )
+{
+	if( heap == NULL )
+	{
+		return;
+	}
+	
+	if( !heapRecording )
+	{
+		idScopedCriticalSection lock( heap->recordMutex );
+		heap->numRecords = 0;
+		heapRecording = true;
+		idLib::Printf( "recording allocations, run recordAllocations again to stop\n" );
+		return;
+	}
+	
+	heapRecording = false;
+	
+	const char* fileName = ( args.Argc() > 1 ) ? args.Argv( 1 ) : "allocations.trace";
+	
+	// turn the pointers into allocation indices, frees of memory allocated before the recording are dropped
+	idList< int > ops;
+	idList< void* > live;
+	idHashIndex liveHash( 65536, 65536 );
+	{
+		idScopedCriticalSection lock( heap->recordMutex );
+		ops.Resize( heap->numRecords );
+		for( int i = 0; i < heap->numRecords; i++ )
+		{
+			const heapRecord_t& record = heap->records[i];
+			const int key = ( int )( ( uintptr_t )record.ptr >> 4 );
+			if( record.size > 0 )
+			{
+				liveHash.Add( key, live.Append( record.ptr ) );
+				ops.Append( ( int )Min( record.size, ( size_t )INT_MAX ) );
+				continue;
+			}
+			for( int j = liveHash.First( key ); j != -1; j = liveHash.Next( j ) )
+			{
+				if( live[j] == record.ptr )
+				{
+					liveHash.Remove( key, j );
+					ops.Append( -j - 1 );
+					break;
+				}
+			}
+		}
+		Heap_SystemFree( heap->records );
+		heap->records = NULL;
+		heap->numRecords = 0;
+		heap->maxRecords = 0;
+	}
+	
+	idFile* f = fileSystem->OpenFileWrite( fileName );
+	if( f == NULL )
+	{
+		idLib::Warning( "couldn't open %s", fileName );
+		return;
+	}
+	f->Write( ops.Ptr(), ops.Num() * sizeof( int ) );
+	delete f;
+	
+	idLib::Printf( "wrote %d allocations and %d frees to %s\n", live.Num(), ops.Num() - live.Num(), fileName );
+}
+
+struct allocChurnParms_t
+{
+	const int* 		ops;
+	int				numOps;
+	int				numAllocs;
+	bool			systemAllocator;
+};
+
+/*
+========================
+AllocChurnJob
+
+Replays a trace, the allocations that are still live at the end are freed as well.
+========================
+*/
+static void AllocChurnJob( allocChurnParms_t* parms )
+{
+	void** ptrs = ( void** )Heap_SystemAlloc( parms->numAllocs * sizeof( void* ) );
+	memset( ptrs, 0, parms->numAllocs * sizeof( void* ) );
+	
+	int numAllocs = 0;
+	for( int i = 0; i < parms->numOps; i++ )
+	{
+		const int op = parms->ops[i];
+		if( op > 0 )
+		{
+			void* ptr = parms->systemAllocator ? Heap_SystemAlloc( ( op + 15 ) & ~15 ) : Mem_Alloc16( op, TAG_TEMP );
+			// touch the memory like the real user would
+			*( byte* )ptr = 0;
+			ptrs[numAllocs++] = ptr;
+		}
+		else
+		{
+			void*& ptr = ptrs[-op - 1];
+			parms->systemAllocator ? Heap_SystemFree( ptr ) : Mem_Free16( ptr );
+			ptr = NULL;
+		}
+	}
+	for( int i = 0; i < numAllocs; i++ )
+	{
+		if( ptrs[i] != NULL )
+		{
+			parms->systemAllocator ? Heap_SystemFree( ptrs[i] ) : Mem_Free16( ptrs[i] );
+		}
+	}
+	
+	Heap_SystemFree( ptrs );
+}
+
+REGISTER_PARALLEL_JOB( AllocChurnJob, "AllocChurnJob" );
+
+/*
+========================
+TestAllocChurn
+========================
+*/
+CONSOLE_COMMAND( testAllocChurn, "replays a trace written by recordAllocations on 1..N threads at once, usage: testAllocChurn [fileName] [maxThreads]", 0 )
+{
+	const char* fileName = ( args.Argc() > 1 ) ? args.Argv( 1 ) : "allocations.trace";
+	const int MAX_CHURN_THREADS = 16;
+	const int maxThreads = ( args.Argc() > 2 ) ? idMath::ClampInt( 1, MAX_CHURN_THREADS, atoi( args.Argv( 2 ) ) ) : 4;
+	const int NUM_RUNS = 4;
+	
+	idFile* f = fileSystem->OpenFileRead( fileName );
+	if( f == NULL )
+	{
+		idLib::Printf( "couldn't open %s, record a trace with recordAllocations first\n", fileName );
+		return;
+	}
+	idList< int > ops;
+	ops.SetNum( f->Length() / sizeof( int ) );
+	f->Read( ops.Ptr(), ops.Num() * sizeof( int ) );
+	delete f;
+	
+	int numAllocs = 0;
+	for( int i = 0; i < ops.Num(); i++ )
+	{
+		if( ops[i] > 0 )
+		{
+			numAllocs++;
+		}
+		else if( -ops[i] - 1 >= numAllocs )
+		{
+			idLib::Printf( "%s is not a valid allocation trace\n", fileName );
+			return;
+		}
+	}
+	
+	allocChurnParms_t parms[MAX_CHURN_THREADS];
+	idParallelJobList* jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, MAX_CHURN_THREADS, 0, NULL );
+	
+	idLib::Printf( "%d operations, %d allocations, best of %d runs\n", ops.Num(), numAllocs, NUM_RUNS );
+	idLib::Printf( "allocator  threads     ops/sec\n" );
+	for( int allocator = 0; allocator < 2; allocator++ )
+	{
+		for( int numThreads = 1; numThreads <= maxThreads; numThreads++ )
+		{
+			uint64 bestTime = 0;
+			for( int run = 0; run < NUM_RUNS; run++ )
+			{
+				for( int i = 0; i < numThreads; i++ )
+				{
+					parms[i].ops = ops.Ptr();
+					parms[i].numOps = ops.Num();
+					parms[i].numAllocs = numAllocs;
+					parms[i].systemAllocator = ( allocator == 0 );
+					jobList->AddJob( ( jobRun_t )AllocChurnJob, &parms[i] );
+				}
+				const uint64 start = Sys_Microseconds();
+				jobList->Submit( NULL, numThreads );
+				jobList->Wait();
+				const uint64 time = Sys_Microseconds() - start;
+				if( run == 0 || time < bestTime )
+				{
+					bestTime = time;
+				}
+			}
+			const double opsPerSec = ( double )ops.Num() * numThreads * 1000000.0 / Max( bestTime, ( uint64 )1 );
+			idLib::Printf( "%-9s  %7d  %10.0f\n", ( allocator == 0 ) ? "system" : "heap", numThreads, opsPerSec );
+		}
+	}
+	
+	parallelJobManager->FreeJobList( jobList );
+}
+
+/*
+================================================================================================
+
+	Memory Tag Reports
+
+================================================================================================
+*/
+
+static memTagStats_t	heapSnapshot[TAG_NUM_TAGS];
+static bool				heapSnapshotValid;
+
+/*
+========================
+Heap_FindTag
+========================
+*/
+static int Heap_FindTag( const char* name )
+{
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		if( idStr::Icmp( name, Mem_GetTagName( ( memTag_t )i ) ) == 0 || idStr::Icmp( name, va( "TAG_%s", Mem_GetTagName( ( memTag_t )i ) ) ) == 0 )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int64 heapSortBytes[TAG_NUM_TAGS];
+
+/*
+========================
+Heap_SortTagsByBytes
+
+Largest first.
+========================
+*/
+static int Heap_SortTagsByBytes( const void* a, const void* b )
+{
+	const int64 bytesA = heapSortBytes[*( const int* )a];
+	const int64 bytesB = heapSortBytes[*( const int* )b];
+	return ( bytesA < bytesB ) ? 1 : ( ( bytesA > bytesB ) ? -1 : 0 );
+}
+
+/*
+========================
+Heap_PrintCallSite
+========================
+*/
+static void Heap_PrintCallSite( void* site, int64 bytes, int allocations )
+{
+#ifndef _WIN32
+	Dl_info info;
+	if( dladdr( site, &info ) != 0 && info.dli_fname != NULL )
+	{
+		idLib::Printf( "    %10.1f KB %7d  %s+0x%zx %s\n", bytes / 1024.0f, allocations, idStr( info.dli_fname ).StripPath().c_str(),
+					   ( size_t )( ( byte* )site - ( byte* )info.dli_fbase ), ( info.dli_sname != NULL ) ? info.dli_sname : "" );
+		return;
+	}
+#endif
+	idLib::Printf( "    %10.1f KB %7d  %p\n", bytes / 1024.0f, allocations, site );
+}
+
+/*
+========================
+Heap_SortCallSites
+========================
+*/
+static int Heap_SortCallSites( const void* a, const void* b )
+{
+	const heapCallSite_t* siteA = ( const heapCallSite_t* )a;
+	const heapCallSite_t* siteB = ( const heapCallSite_t* )b;
+	if( siteA->tag != siteB->tag )
+	{
+		return siteA->tag - siteB->tag;
+	}
+	if( siteA->site != siteB->site )
+	{
+		return ( siteA->site < siteB->site ) ? -1 : 1;
+	}
+	return 0;
+}
+
+/*
+========================
+Heap_SortCallSitesBySize
+========================
+*/
+static int Heap_SortCallSitesBySize( const void* a, const void* b )
+{
+	const heapCallSite_t* siteA = ( const heapCallSite_t* )a;
+	const heapCallSite_t* siteB = ( const heapCallSite_t* )b;
+	return ( siteA->size < siteB->size ) ? 1 : ( ( siteA->size > siteB->size ) ? -1 : 0 );
+}
+
+/*
+========================
+Heap_PrintCallSites
+
+Lists the call sites of the allocations made since the snapshot that are still live.
+========================
+*/
+static void Heap_PrintCallSites( const int* tags, int numTags, int maxSitesPerTag )
+{
+	if( heap == NULL )
+	{
+		return;
+	}
+	
+	// copy the live entries so no lock is held while printing
+	heapCallSite_t* sites = NULL;
+	int numSites = 0;
+	{
+		idScopedCriticalSection lock( heap->callSiteMutex );
+		if( heap->callSites == NULL )
+		{
+			return;
+		}
+		sites = ( heapCallSite_t* )Heap_SystemAlloc( Max( heap->numCallSites, 1 ) * sizeof( heapCallSite_t ) );
+		for( int i = 0; i < heap->maxCallSites; i++ )
+		{
+			if( heap->callSites[i].ptr != NULL && heap->callSites[i].ptr != HEAP_REMOVED_CALL_SITE )
+			{
+				sites[numSites++] = heap->callSites[i];
+			}
+		}
+	}
+	
+	// merge the allocations of the same call site and tag, the size becomes the total and the pointer the count
+	qsort( sites, numSites, sizeof( sites[0] ), Heap_SortCallSites );
+	int numMerged = 0;
+	for( int i = 0; i < numSites; i++ )
+	{
+		if( numMerged > 0 && sites[numMerged - 1].tag == sites[i].tag && sites[numMerged - 1].site == sites[i].site )
+		{
+			sites[numMerged - 1].size += sites[i].size;
+			sites[numMerged - 1].ptr = ( void* )( ( uintptr_t )sites[numMerged - 1].ptr + 1 );
+			continue;
+		}
+		sites[numMerged] = sites[i];
+		sites[numMerged].ptr = ( void* )1;
+		numMerged++;
+	}
+	qsort( sites, numMerged, sizeof( sites[0] ), Heap_SortCallSitesBySize );
+	
+	for( int i = 0; i < numTags; i++ )
+	{
+		int numPrinted = 0;
+		for( int j = 0; j < numMerged && numPrinted < maxSitesPerTag; j++ )
+		{
+			if( sites[j].tag != tags[i] )
+			{
+				continue;
+			}
+			if( numPrinted == 0 )
+			{
+				idLib::Printf( "  %s:\n", Mem_GetTagName( ( memTag_t )tags[i] ) );
+			}
+			Heap_PrintCallSite( sites[j].site, sites[j].size, ( int )( uintptr_t )sites[j].ptr );
+			numPrinted++;
+		}
+	}
+	
+	Heap_SystemFree( sites );
+}
+
+/*
+========================
+memTagUsage
+========================
+*/
+CONSOLE_COMMAND( memTagUsage, "lists the memory in use per tag, usage: memTagUsage [tag]", 0 )
+{
+	memTagStats_t stats[TAG_NUM_TAGS];
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		Mem_GetTagStats( ( memTag_t )i, stats[i] );
+	}
+	
+	if( args.Argc() > 1 )
+	{
+		const int tag = Heap_FindTag( args.Argv( 1 ) );
+		if( tag == -1 )
+		{
+			idLib::Printf( "unknown tag %s\n", args.Argv( 1 ) );
+			return;
+		}
+		const memTagStats_t& s = stats[tag];
+		idLib::Printf( "%s: %.1f KB live, %.1f KB peak, %d live allocations, %d allocs %d frees last frame\n", Mem_GetTagName( ( memTag_t )tag ),
+					   s.liveBytes / 1024.0f, s.peakBytes / 1024.0f, ( int )( s.numAllocs - s.numFrees ), s.frameAllocs, s.frameFrees );
+		for( int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++ )
+		{
+			if( s.liveBySize[i] == 0 )
+			{
+				continue;
+			}
+			if( i == MEM_HISTOGRAM_BUCKETS - 1 )
+			{
+				idLib::Printf( "  > %8d bytes: %7d\n", 16 << ( i - 1 ), s.liveBySize[i] );
+			}
+			else
+			{
+				idLib::Printf( "  <= %7d bytes: %7d\n", 16 << i, s.liveBySize[i] );
+			}
+		}
+		return;
+	}
+	
+	int tags[TAG_NUM_TAGS];
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		tags[i] = i;
+		heapSortBytes[i] = stats[i].liveBytes;
+	}
+	qsort( tags, TAG_NUM_TAGS, sizeof( tags[0] ), Heap_SortTagsByBytes );
+	
+	idLib::Printf( "%-20s %12s %12s %9s %9s %9s\n", "tag", "live KB", "peak KB", "live", "allocs/f", "frees/f" );
+	int64 totalLive = 0;
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		const memTagStats_t& s = stats[tags[i]];
+		if( s.peakBytes == 0 )
+		{
+			continue;
+		}
+		idLib::Printf( "%-20s %12.1f %12.1f %9d %9d %9d\n", Mem_GetTagName( ( memTag_t )tags[i] ), s.liveBytes / 1024.0f, s.peakBytes / 1024.0f,
+					   ( int )( s.numAllocs - s.numFrees ), s.frameAllocs, s.frameFrees );
+		totalLive += s.liveBytes;
+	}
+	idLib::Printf( "%.2f MB in use\n", totalLive / ( 1024.0f * 1024.0f ) );
+}
+
+/*
+========================
+memSnapshot
+========================
+*/
+CONSOLE_COMMAND( memSnapshot, "stores the memory use per tag and tracks the call sites of new allocations until memSnapshot stop, usage: memSnapshot [stop]", 0 )
+{
+	if( heap == NULL )
+	{
+		return;
+	}
+	
+	if( args.Argc() > 1 && idStr::Icmp( args.Argv( 1 ), "stop" ) == 0 )
+	{
+		idScopedCriticalSection lock( heap->callSiteMutex );
+		heapTrackCallSites = false;
+		Heap_SystemFree( heap->callSites );
+		heap->callSites = NULL;
+		heap->numCallSites = 0;
+		heap->maxCallSites = 0;
+		heapSnapshotValid = false;
+		return;
+	}
+	
+	{
+		idScopedCriticalSection lock( heap->callSiteMutex );
+		if( heap->callSites != NULL )
+		{
+			memset( heap->callSites, 0, heap->maxCallSites * sizeof( heapCallSite_t ) );
+		}
+		heap->numCallSites = 0;
+		heapTrackCallSites = true;
+	}
+	
+	// the peaks measure the window since the snapshot
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		Mem_GetTagStats( ( memTag_t )i, heapSnapshot[i] );
+		heapTagCounters[i].peakBytes = heapSnapshot[i].liveBytes;
+		heapSnapshot[i].peakBytes = heapSnapshot[i].liveBytes;
+	}
+	heapSnapshotValid = true;
+	
+	idLib::Printf( "memory snapshot taken, %.2f MB in use\n", Mem_GetTotalBytes() / ( 1024.0f * 1024.0f ) );
+}
+
+/*
+========================
+memSnapshotDiff
+========================
+*/
+CONSOLE_COMMAND( memSnapshotDiff, "lists the change in memory use per tag since memSnapshot and the call sites of the new allocations, usage: memSnapshotDiff [sitesPerTag]", 0 )
+{
+	if( !heapSnapshotValid )
+	{
+		idLib::Printf( "no memory snapshot, run memSnapshot first\n" );
+		return;
+	}
+	const int maxSitesPerTag = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 0 ) : 5;
+	
+	memTagStats_t stats[TAG_NUM_TAGS];
+	int tags[TAG_NUM_TAGS];
+	int numTags = 0;
+	for( int i = 0; i < TAG_NUM_TAGS; i++ )
+	{
+		Mem_GetTagStats( ( memTag_t )i, stats[i] );
+		heapSortBytes[i] = stats[i].liveBytes - heapSnapshot[i].liveBytes;
+		if( stats[i].numAllocs != heapSnapshot[i].numAllocs || stats[i].numFrees != heapSnapshot[i].numFrees )
+		{
+			tags[numTags++] = i;
+		}
+	}
+	qsort( tags, numTags, sizeof( tags[0] ), Heap_SortTagsByBytes );
+	
+	idLib::Printf( "%-20s %12s %12s %9s %9s\n", "tag", "change KB", "peak KB", "allocs", "frees" );
+	int64 totalChange = 0;
+	for( int i = 0; i < numTags; i++ )
+	{
+		const memTagStats_t& s = stats[tags[i]];
+		const memTagStats_t& snapshot = heapSnapshot[tags[i]];
+		idLib::Printf( "%-20s %+12.1f %12.1f %9d %9d\n", Mem_GetTagName( ( memTag_t )tags[i] ), heapSortBytes[tags[i]] / 1024.0f,
+					   s.peakBytes / 1024.0f, ( int )( s.numAllocs - snapshot.numAllocs ), ( int )( s.numFrees - snapshot.numFrees ) );
+		totalChange += heapSortBytes[tags[i]];
+	}
+	idLib::Printf( "%+.2f MB since the snapshot\n", totalChange / ( 1024.0f * 1024.0f ) );
+	
+	if( maxSitesPerTag > 0 )
+	{
+		idLib::Printf( "live allocations since the snapshot by call site:\n" );
+		Heap_PrintCallSites( tags, numTags, maxSitesPerTag );
+	}
+}
@@ -67,13 +67,48 @@ void* 		Mem_ClearedAlloc( const size_t size, const memTag_t tag );
 char* 		Mem_CopyString( const char* in );
 // RB end
 
-ID_INLINE void* operator new( size_t s )
+// threads hand their cached free blocks back to the allocator before they exit
+void		Mem_ReleaseThreadCache();
+
+static const int MEM_HISTOGRAM_BUCKETS = 16;
+
+struct memTagStats_t
+{
+	int64		liveBytes;
+	int64		peakBytes;							// since startup or the last memSnapshot
+	int64		numAllocs;							// since startup
+	int64		numFrees;
+	int			frameAllocs;						// during the last frame
+	int			frameFrees;
+	int			liveBySize[MEM_HISTOGRAM_BUCKETS];	// live allocations of up to 16 << i bytes, the last bucket holds everything larger
+};
+
+// memory in use per tag and in total
+void		Mem_GetTagStats( memTag_t tag, memTagStats_t& stats );
+const char* Mem_GetTagName( memTag_t tag );
+int64		Mem_GetTotalBytes();
+// called once per frame to update the per frame counts
+void		Mem_EndFrame();
+
+struct memFrameArenaStats_t
+{
+	int			arenaAllocs;		// heap allocations the arena saved during the last tic
+	int			heapAllocs;			// TAG_FRAME_ARENA allocations that did not fit or came from another thread and went to the heap
+	int			arenaBytes;
+};
+
+// TAG_FRAME_ARENA memory, for example idList<int, TAG_FRAME_ARENA>, stays valid until the end of
+// the next tic and doesn't need to be freed. Never keep it in anything that outlives a tic.
+// Only the thread that calls Mem_FlipFrameArena gets arena memory, other threads get heap memory.
+void		Mem_FlipFrameArena();
+void		Mem_GetFrameArenaStats( memFrameArenaStats_t& stats );
+
+// the allocating operators are defined in Heap.cpp so the allocations are tracked with the code that used new
+void* operator new( size_t s )
 #if !defined(_MSC_VER)
 throw( std::bad_alloc ) // DG: standard signature seems to include throw(..)
 #endif
-{
-	return Mem_Alloc( s, TAG_NEW );
-}
+;
 
 ID_INLINE void operator delete( void* p )
 #if !defined(_MSC_VER)
@@ -82,13 +117,11 @@ throw() // DG: delete musn't throw
 {
 	Mem_Free( p );
 }
-ID_INLINE void* operator new[]( size_t s )
+void* operator new[]( size_t s )
 #if !defined(_MSC_VER)
 throw( std::bad_alloc ) // DG: standard signature seems to include throw(..)
 #endif
-{
-	return Mem_Alloc( s, TAG_NEW );
-}
+;
 
 ID_INLINE void operator delete[]( void* p )
 #if !defined(_MSC_VER)
@@ -98,10 +131,7 @@ throw() // DG: delete musn't throw
 	Mem_Free( p );
 }
 
-ID_INLINE void* operator new( size_t s, memTag_t tag )
-{
-	return Mem_Alloc( s, tag );
-}
+void* operator new( size_t s, memTag_t tag );
 
 ID_INLINE void operator delete( void* p, memTag_t tag )
 #if !defined(_MSC_VER)
@@ -111,10 +141,7 @@ throw() // DG: delete musn't throw
 	Mem_Free( p );
 }
 
-ID_INLINE void* operator new[]( size_t s, memTag_t tag )
-{
-	return Mem_Alloc( s, tag );
-}
+void* operator new[]( size_t s, memTag_t tag );
 
 ID_INLINE void operator delete[]( void* p, memTag_t tag ) throw() // DG: delete musn't throw
 {
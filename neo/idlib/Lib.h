@@ -277,6 +277,7 @@ public:
 #include "bv/Sphere.h"
 #include "bv/Bounds.h"
 #include "bv/Box.h"
+#include "bv/BoundsBatch.h"
 
 // geometry
 #include "geometry/RenderMatrix.h"
@@ -305,6 +306,7 @@ public:
 #include "containers/BinSearch.h"
 #include "containers/HashIndex.h"
 #include "containers/HashTable.h"
+#include "containers/FlatHashMap.h"
 #include "containers/StaticList.h"
 #include "containers/LinkList.h"
 #include "containers/Hierarchy.h"
@@ -328,9 +330,12 @@ public:
 #include "MapFile.h"
 #include "Timer.h"
 #include "Thread.h"
+#include "LockFreeQueue.h"
+#include "SharedBlockAlloc.h"
 #include "Swap.h"
 #include "Callback.h"
 #include "ParallelJobList.h"
+#include "TimelineProfiler.h"
 
 #include "SoftwareCache.h"
 
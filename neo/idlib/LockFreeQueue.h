@@ -0,0 +1,360 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __LOCKFREEQUEUE_H__
+#define __LOCKFREEQUEUE_H__
+
+/*
+================================================================================================
+
+	Bounded lock-free ring queues
+
+	Both queues have a fixed power of two capacity and never allocate, Push() returns false when
+	the queue is full and Pop() returns false when the queue is empty. Items are copied in and out
+	so they should be small, typically pointers or handles. The push and pop counters are 32 bits
+	and compared with unsigned arithmetic, so they may wrap around.
+
+	WaitPop() sleeps on an idSysWaitableInteger until an item is pushed, so a consumer thread
+	does not need to spin with Sys_Yield() while the queue is empty. The MPMC queue also has
+	WaitPush(), which sleeps the same way until an item is popped from a full queue.
+
+================================================================================================
+*/
+
+/*
+================================================
+idLockFreeQueueSPSC
+
+Single producer, single consumer queue. Exactly one thread may push and exactly one thread may
+pop, which only takes a memory barrier on each side.
+
+	idLockFreeQueueSPSC< idSaveLoadParms*, 16 > queue;
+
+	// producer thread
+	if ( !queue.Push( parms ) ) {
+		// full
+	}
+
+	// consumer thread
+	idSaveLoadParms* parms;
+	while ( queue.WaitPop( parms ) ) {
+		// process parms
+	}
+================================================
+*/
+template< typename type, int size >
+class idLockFreeQueueSPSC
+{
+public:
+	idLockFreeQueueSPSC() : head( 0 ) {}
+	
+	// producer only, returns false if the queue is full
+	bool					Push( const type& item );
+	// consumer only, returns false if the queue is empty
+	bool					Pop( type& item );
+	// consumer only, sleeps until an item is available, returns false if the timeout in milliseconds expired
+	bool					WaitPop( type& item, int timeout = idSysSignal::WAIT_INFINITE );
+	
+	// exact for the producer and the consumer, a snapshot for any other thread
+	int						Num() const
+	{
+		return ( int )( ( unsigned int ) tail.GetValue() - ( unsigned int ) head );
+	}
+	
+private:
+	idSysWaitableInteger	tail;			// number of pushed items, written by the producer
+	char					pad0[CACHE_LINE_SIZE - sizeof( idSysWaitableInteger )];
+	volatile interlockedInt_t	head;		// number of popped items, written by the consumer
+	char					pad1[CACHE_LINE_SIZE - sizeof( interlockedInt_t )];
+	type					items[size];
+	
+	compile_time_assert( CONST_ISPOWEROFTWO( size ) );
+};
+
+/*
+========================
+idLockFreeQueueSPSC::Push
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueSPSC< type, size >::Push( const type& item )
+{
+	const interlockedInt_t t = tail.GetValue();
+	if( ( unsigned int ) t - ( unsigned int ) head >= ( unsigned int ) size )
+	{
+		return false;
+	}
+	items[t & ( size - 1 )] = item;
+	// the interlocked increment publishes the item and wakes a sleeping consumer
+	tail.Increment();
+	return true;
+}
+
+/*
+========================
+idLockFreeQueueSPSC::Pop
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueSPSC< type, size >::Pop( type& item )
+{
+	const interlockedInt_t h = head;
+	if( tail.GetValue() == h )
+	{
+		return false;
+	}
+	SYS_MEMORYBARRIER;
+	item = items[h & ( size - 1 )];
+	// don't let the producer overwrite the slot before the item is read
+	SYS_MEMORYBARRIER;
+	head = h + 1;
+	return true;
+}
+
+/*
+========================
+idLockFreeQueueSPSC::WaitPop
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueSPSC< type, size >::WaitPop( type& item, int timeout )
+{
+	while( !Pop( item ) )
+	{
+		// the queue is empty as long as the push count equals the pop count
+		if( !tail.WaitWhileEqual( head, timeout ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+================================================
+idLockFreeQueueMPMC
+
+Multiple producer, multiple consumer queue. Any thread may push and pop. Every slot carries a
+sequence number that tells whether it is ready to be written or read for the current lap around
+the ring, so producers and consumers only contend on a compare-exchange of their own counter.
+A thread that is preempted between claiming a slot and publishing it can delay the threads
+behind it but never corrupts the queue.
+================================================
+*/
+template< typename type, int size >
+class idLockFreeQueueMPMC
+{
+public:
+	idLockFreeQueueMPMC();
+	
+	// any thread, returns false if the queue is full
+	bool					Push( const type& item );
+	// any thread, returns false if the queue is empty
+	bool					Pop( type& item );
+	// any thread, sleeps until an item is available, returns false if the timeout in milliseconds expired
+	bool					WaitPop( type& item, int timeout = idSysSignal::WAIT_INFINITE );
+	// any thread, sleeps until there is space for the item, returns false if the timeout in milliseconds expired
+	bool					WaitPush( const type& item, int timeout = idSysSignal::WAIT_INFINITE );
+	
+	// a snapshot, may be out of date by the time it is returned
+	int						Num() const
+	{
+		return ( int )( ( unsigned int ) enqueuePos - ( unsigned int ) dequeuePos );
+	}
+	
+private:
+	struct cell_t
+	{
+		volatile interlockedInt_t	sequence;
+		type						item;
+	};
+	
+	interlockedInt_t		enqueuePos;
+	char					pad0[CACHE_LINE_SIZE - sizeof( interlockedInt_t )];
+	interlockedInt_t		dequeuePos;
+	char					pad1[CACHE_LINE_SIZE - sizeof( interlockedInt_t )];
+	idSysWaitableInteger	pushCount;		// only used to wake threads in WaitPop()
+	char					pad2[CACHE_LINE_SIZE - sizeof( idSysWaitableInteger )];
+	idSysWaitableInteger	popCount;		// only used to wake threads in WaitPush()
+	char					pad3[CACHE_LINE_SIZE - sizeof( idSysWaitableInteger )];
+	cell_t					cells[size];
+	
+	compile_time_assert( CONST_ISPOWEROFTWO( size ) );
+};
+
+/*
+========================
+idLockFreeQueueMPMC::idLockFreeQueueMPMC
+========================
+*/
+template< typename type, int size >
+ID_INLINE idLockFreeQueueMPMC< type, size >::idLockFreeQueueMPMC() :
+	enqueuePos( 0 ),
+	dequeuePos( 0 )
+{
+	for( int i = 0; i < size; i++ )
+	{
+		cells[i].sequence = i;
+	}
+}
+
+/*
+========================
+idLockFreeQueueMPMC::Push
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueMPMC< type, size >::Push( const type& item )
+{
+	cell_t* cell;
+	interlockedInt_t pos = *( volatile interlockedInt_t* )&enqueuePos;
+	for( ; ; )
+	{
+		cell = &cells[pos & ( size - 1 )];
+		const interlockedInt_t seq = cell->sequence;
+		const int diff = ( int )( ( unsigned int ) seq - ( unsigned int ) pos );
+		if( diff == 0 )
+		{
+			// the slot is free for this lap, try to claim it
+			const interlockedInt_t prev = Sys_InterlockedCompareExchange( enqueuePos, pos, pos + 1 );
+			if( prev == pos )
+			{
+				break;
+			}
+			pos = prev;
+		}
+		else if( diff < 0 )
+		{
+			// the slot still holds an item from the previous lap
+			return false;
+		}
+		else
+		{
+			// another producer claimed the slot
+			pos = *( volatile interlockedInt_t* )&enqueuePos;
+		}
+	}
+	cell->item = item;
+	SYS_MEMORYBARRIER;
+	cell->sequence = pos + 1;
+	pushCount.Increment();
+	return true;
+}
+
+/*
+========================
+idLockFreeQueueMPMC::Pop
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueMPMC< type, size >::Pop( type& item )
+{
+	cell_t* cell;
+	interlockedInt_t pos = *( volatile interlockedInt_t* )&dequeuePos;
+	for( ; ; )
+	{
+		cell = &cells[pos & ( size - 1 )];
+		const interlockedInt_t seq = cell->sequence;
+		const int diff = ( int )( ( unsigned int ) seq - ( unsigned int )( pos + 1 ) );
+		if( diff == 0 )
+		{
+			// the slot holds an item for this lap, try to claim it
+			const interlockedInt_t prev = Sys_InterlockedCompareExchange( dequeuePos, pos, pos + 1 );
+			if( prev == pos )
+			{
+				break;
+			}
+			pos = prev;
+		}
+		else if( diff < 0 )
+		{
+			// the slot has not been written yet
+			return false;
+		}
+		else
+		{
+			// another consumer claimed the slot
+			pos = *( volatile interlockedInt_t* )&dequeuePos;
+		}
+	}
+	SYS_MEMORYBARRIER;
+	item = cell->item;
+	SYS_MEMORYBARRIER;
+	// free the slot for the next lap
+	cell->sequence = pos + size;
+	popCount.Increment();
+	return true;
+}
+
+/*
+========================
+idLockFreeQueueMPMC::WaitPop
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueMPMC< type, size >::WaitPop( type& item, int timeout )
+{
+	for( ; ; )
+	{
+		// read the count before trying so a push in between is never missed
+		const int count = pushCount.GetValue();
+		if( Pop( item ) )
+		{
+			return true;
+		}
+		if( !pushCount.WaitWhileEqual( count, timeout ) )
+		{
+			return false;
+		}
+	}
+}
+
+/*
+========================
+idLockFreeQueueMPMC::WaitPush
+========================
+*/
+template< typename type, int size >
+ID_INLINE bool idLockFreeQueueMPMC< type, size >::WaitPush( const type& item, int timeout )
+{
+	for( ; ; )
+	{
+		// read the count before trying so a pop in between is never missed
+		const int count = popCount.GetValue();
+		if( Push( item ) )
+		{
+			return true;
+		}
+		if( !popCount.WaitWhileEqual( count, timeout ) )
+		{
+			return false;
+		}
+	}
+}
+
+#endif // !__LOCKFREEQUEUE_H__
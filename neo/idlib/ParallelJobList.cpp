@@ -41,6 +41,7 @@ const char* jobNames[] =
 {
 	ASSERT_ENUM_STRING( JOBLIST_RENDERER_FRONTEND,	0 ),
 	ASSERT_ENUM_STRING( JOBLIST_RENDERER_BACKEND,	1 ),
+	ASSERT_ENUM_STRING( JOBLIST_GAME,				2 ),
 	ASSERT_ENUM_STRING( JOBLIST_UTILITY,			9 ),
 };
 
@@ -140,6 +141,7 @@ idParallelJobList_Threads
 */
 
 static idCVar jobs_longJobMicroSec( "jobs_longJobMicroSec", "10000", CVAR_INTEGER, "print a warning for jobs that take more than this number of microseconds" );
+static idCVar jobs_workStealing( "jobs_workStealing", "0", CVAR_BOOL | CVAR_NOCHEAT, "distribute jobs over per-thread deques and let idle threads steal work instead of sharing one fetch lock per job list" );
 
 
 const static int		MAX_THREADS	= 32;
@@ -165,6 +167,14 @@ struct threadJobListState_t
 	int							nextJobIndex;
 };
 
+// a contiguous range of jobs from a single job list that is handed out to the work stealing threads
+struct jobTask_t
+{
+	idParallelJobList_Threads* 	jobList;
+	int							firstJob;
+	int							endJob;
+};
+
 struct threadStats_t
 {
 	unsigned int	numExecutedJobs;
@@ -186,11 +196,12 @@ public:
 	//------------------------
 	// These are called from the one thread that manages this list.
 	//------------------------
-	ID_INLINE void			AddJob( jobRun_t function, void* data );
+	ID_INLINE jobHandle_t	AddJob( jobRun_t function, void* data, const jobHandle_t* predecessors, int numPredecessors );
 	ID_INLINE void			InsertSyncPoint( jobSyncType_t syncType );
 	void					Submit( idParallelJobList_Threads* waitForJobList_, int parallelism );
 	void					Wait();
 	bool					TryWait();
+	void					WaitForJobs( jobHandle_t firstJob, int numJobs );
 	bool					IsSubmitted() const;
 	
 	unsigned int			GetNumExecutedJobs() const
@@ -250,12 +261,31 @@ public:
 	
 	int						RunJobs( unsigned int threadNum, threadJobListState_t& state, bool singleJob );
 	
+	//------------------------
+	// Work stealing back end, see idParallelJobManagerLocal::Submit
+	//------------------------
+	void					PrepareWorkStealing( int numThreads );
+	bool					IsWorkStealing() const
+	{
+		return workStealing;
+	}
+	int						GetNumWorkStealingThreads() const
+	{
+		return numWorkStealingThreads;
+	}
+	// makes the jobs up to the next synchronization point available, returns the number of jobs released
+	int						ReleaseJobs( int firstJob, int threadNum );
+	// runs a single job that was taken from a work stealing deque
+	void					RunStolenJob( unsigned int threadNum, int jobIndex, uint64 searchTime );
+	
 private:
 	static const int		NUM_DONE_GUARDS = 4;	// cycle through 4 guards so we can cyclicly chain job lists
 	
 	bool					threaded;
 	bool					done;
 	bool					hasSignal;
+	bool					workStealing;
+	int						numWorkStealingThreads;
 	jobListId_t				listId;
 	jobListPriority_t		listPriority;
 	unsigned int			maxJobs;
@@ -271,9 +301,23 @@ private:
 		jobRun_t	function;
 		void* 		data;
 		int			executed;
+		int			signalIndex;		// index into signalJobCount this job counts towards
+		int			numPredecessors;	// jobs in this list that need to finish before this one can run
+		int			firstSuccessor;		// index into successorJobs
+		int			numSuccessors;
+		interlockedInt_t numWaiting;	// unfinished predecessors plus one for the thread that fetches the job
+	};
+	struct jobDependency_t
+	{
+		int			predecessor;
+		int			successor;
 	};
 	idList< job_t, TAG_JOBLIST >		jobList;
+	idList< jobDependency_t, TAG_JOBLIST >	dependencies;
+	idList< int, TAG_JOBLIST >			successorJobs;
 	idList< idSysInterlockedInteger, TAG_JOBLIST >	signalJobCount;
+	idList< int, TAG_JOBLIST >			signalReleaseJob;	// work stealing: first job after the sync point that waits for a signal
+	idSysInterlockedInteger				numPendingJobs;		// work stealing: jobs that have not finished executing
 	idSysInterlockedInteger				currentJob;
 	idSysInterlockedInteger				fetchLock;
 	idSysInterlockedInteger				numThreadsExecuting;
@@ -282,6 +326,18 @@ private:
 	threadStats_t						threadStats;
 	
 	int						RunJobsInternal( unsigned int threadNum, threadJobListState_t& state, bool singleJob );
+	bool					ExecuteJob( unsigned int threadNum, int jobIndex, uint64 searchTime );
+	ID_INLINE job_t& 		AllocJob( jobRun_t function, void* data, int signalIndex );
+	void					LinkSuccessors();
+	// returns false if the job still waits for a predecessor, in which case the thread finishing the last one runs it
+	bool					FetchDependentJob( int jobIndex )
+	{
+		return ( jobList[jobIndex].numPredecessors == 0 || Sys_InterlockedDecrement( jobList[jobIndex].numWaiting ) == 0 );
+	}
+	int						GetPendingCount()
+	{
+		return workStealing ? numPendingJobs.GetValue() : signalJobCount[signalJobCount.Num() - 1].GetValue();
+	}
 	
 	static void				Nop( void* data ) {}
 	
@@ -303,6 +359,8 @@ idParallelJobList_Threads::idParallelJobList_Threads( jobListId_t id, jobListPri
 	threaded( true ),
 	done( true ),
 	hasSignal( false ),
+	workStealing( false ),
+	numWorkStealingThreads( 0 ),
 	listId( id ),
 	listPriority( priority ),
 	numSyncs( 0 ),
@@ -335,12 +393,31 @@ idParallelJobList_Threads::~idParallelJobList_Threads()
 	Wait();
 }
 
+/*
+========================
+idParallelJobList_Threads::AllocJob
+========================
+*/
+ID_INLINE idParallelJobList_Threads::job_t& idParallelJobList_Threads::AllocJob( jobRun_t function, void* data, int signalIndex )
+{
+	job_t& job = jobList.Alloc();
+	job.function = function;
+	job.data = data;
+	job.executed = 0;
+	job.signalIndex = signalIndex;
+	job.numPredecessors = 0;
+	job.firstSuccessor = 0;
+	job.numSuccessors = 0;
+	job.numWaiting = 0;
+	return job;
+}
+
 /*
 ========================
 idParallelJobList_Threads::AddJob
 ========================
 */
-ID_INLINE void idParallelJobList_Threads::AddJob( jobRun_t function, void* data )
+ID_INLINE jobHandle_t idParallelJobList_Threads::AddJob( jobRun_t function, void* data, const jobHandle_t* predecessors, int numPredecessors )
 {
 	assert( done );
 #if defined( _DEBUG )
@@ -355,10 +432,20 @@ ID_INLINE void idParallelJobList_Threads::AddJob( jobRun_t function, void* data
 #endif
 	if( 1 )    // JDC: this never worked in tech5!  !jobList.IsFull() ) {
 	{
-		job_t& job = jobList.Alloc();
-		job.function = function;
-		job.data = data;
-		job.executed = 0;
+		job_t& job = AllocJob( function, data, signalJobCount.Num() );
+		for( int i = 0; i < numPredecessors; i++ )
+		{
+			if( predecessors[i] == INVALID_JOB_HANDLE )
+			{
+				continue;
+			}
+			assert( predecessors[i] >= 0 && predecessors[i] < jobList.Num() - 1 );
+			assert( jobList[predecessors[i]].function != Nop );
+			jobDependency_t& dependency = dependencies.Alloc();
+			dependency.predecessor = predecessors[i];
+			dependency.successor = jobList.Num() - 1;
+			job.numPredecessors++;
+		}
 	}
 	else
 	{
@@ -388,6 +475,7 @@ ID_INLINE void idParallelJobList_Threads::AddJob( jobRun_t function, void* data
 		}
 		idLib::Error( "Can't add job '%s', too many jobs %d", GetJobName( function ), jobList.Num() );
 	}
+	return jobList.Num() - 1;
 }
 
 /*
@@ -409,9 +497,7 @@ ID_INLINE void idParallelJobList_Threads::InsertSyncPoint( jobSyncType_t syncTyp
 				signalJobCount.Alloc();
 				signalJobCount[signalJobCount.Num() - 1].SetValue( jobList.Num() - lastSignalJob );
 				lastSignalJob = jobList.Num();
-				job_t& job = jobList.Alloc();
-				job.function = Nop;
-				job.data = & JOB_SIGNAL;
+				AllocJob( Nop, & JOB_SIGNAL, signalJobCount.Num() );
 				hasSignal = true;
 			}
 			break;
@@ -420,9 +506,7 @@ ID_INLINE void idParallelJobList_Threads::InsertSyncPoint( jobSyncType_t syncTyp
 		{
 			if( hasSignal )
 			{
-				job_t& job = jobList.Alloc();
-				job.function = Nop;
-				job.data = & JOB_SYNCHRONIZE;
+				AllocJob( Nop, & JOB_SYNCHRONIZE, signalJobCount.Num() );
 				hasSignal = false;
 				numSyncs++;
 			}
@@ -474,9 +558,9 @@ void idParallelJobList_Threads::Submit( idParallelJobList_Threads* waitForJobLis
 	signalJobCount.Alloc();
 	signalJobCount[signalJobCount.Num() - 1].SetValue( jobList.Num() - lastSignalJob );
 	
-	job_t& job = jobList.Alloc();
-	job.function = Nop;
-	job.data = & JOB_LIST_DONE;
+	AllocJob( Nop, & JOB_LIST_DONE, signalJobCount.Num() - 1 );
+	
+	LinkSuccessors();
 	
 	if( threaded )
 	{
@@ -510,8 +594,14 @@ void idParallelJobList_Threads::Wait()
 		bool waited = false;
 		uint64 waitStart = Sys_Microseconds();
 		
-		while( signalJobCount[signalJobCount.Num() - 1].GetValue() > 0 )
+		while( GetPendingCount() > 0 )
 		{
+			if( workStealing )
+			{
+				// the job list this one waits for may have been finished outside of the job threads
+				void ReleaseWaitingJobLists( int threadNum );
+				ReleaseWaitingJobLists( -1 );
+			}
 			Sys_Yield();
 			waited = true;
 		}
@@ -524,6 +614,10 @@ void idParallelJobList_Threads::Wait()
 		
 		jobList.SetNum( 0 );
 		signalJobCount.SetNum( 0 );
+		signalReleaseJob.SetNum( 0 );
+		dependencies.SetNum( 0 );
+		successorJobs.SetNum( 0 );
+		workStealing = false;
 		numSyncs = 0;
 		lastSignalJob = 0;
 		
@@ -541,7 +635,7 @@ idParallelJobList_Threads::TryWait
 */
 bool idParallelJobList_Threads::TryWait()
 {
-	if( jobList.Num() == 0 || signalJobCount[signalJobCount.Num() - 1].GetValue() <= 0 )
+	if( jobList.Num() == 0 || GetPendingCount() <= 0 )
 	{
 		Wait();
 		return true;
@@ -549,6 +643,66 @@ bool idParallelJobList_Threads::TryWait()
 	return false;
 }
 
+/*
+========================
+idParallelJobList_Threads::WaitForJobs
+========================
+*/
+void idParallelJobList_Threads::WaitForJobs( jobHandle_t firstJob, int numJobs )
+{
+	assert( !done );
+	assert( numJobs == 0 || ( firstJob >= 0 && firstJob + numJobs <= jobList.Num() ) );
+	
+	for( int i = firstJob; i < firstJob + numJobs; i++ )
+	{
+		while( *( volatile int* )&jobList[i].executed == 0 )
+		{
+			if( workStealing )
+			{
+				void ReleaseWaitingJobLists( int threadNum );
+				ReleaseWaitingJobLists( -1 );
+			}
+			Sys_Yield();
+		}
+	}
+	SYS_MEMORYBARRIER;
+}
+
+/*
+========================
+idParallelJobList_Threads::LinkSuccessors
+
+Turns the dependencies added with the jobs into a successor list per job.
+========================
+*/
+void idParallelJobList_Threads::LinkSuccessors()
+{
+	if( dependencies.Num() == 0 )
+	{
+		return;
+	}
+	
+	for( int i = 0; i < dependencies.Num(); i++ )
+	{
+		jobList[dependencies[i].predecessor].numSuccessors++;
+	}
+	int numSuccessors = 0;
+	for( int i = 0; i < jobList.Num(); i++ )
+	{
+		job_t& job = jobList[i];
+		job.firstSuccessor = numSuccessors;
+		numSuccessors += job.numSuccessors;
+		job.numSuccessors = 0;
+		job.numWaiting = job.numPredecessors + 1;
+	}
+	successorJobs.SetNum( numSuccessors );
+	for( int i = 0; i < dependencies.Num(); i++ )
+	{
+		job_t& job = jobList[dependencies[i].predecessor];
+		successorJobs[job.firstSuccessor + job.numSuccessors++] = dependencies[i].successor;
+	}
+}
+
 /*
 ========================
 idParallelJobList_Threads::IsSubmitted
@@ -736,44 +890,23 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 			return ( result | RUN_DONE );
 		}
 		
-		// execute the next job
+		// the thread finishing the last predecessor of a dependent job runs it
+		if( !FetchDependentJob( state.nextJobIndex ) )
 		{
-			uint64 jobStart = Sys_Microseconds();
-			
-			jobList[state.nextJobIndex].function( jobList[state.nextJobIndex].data );
-			jobList[state.nextJobIndex].executed = 1;
-			
-			uint64 jobEnd = Sys_Microseconds();
-			deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
-			
-#ifndef _DEBUG
-			if( jobs_longJobMicroSec.GetInteger() > 0 )
-			{
-				if( jobEnd - jobStart > jobs_longJobMicroSec.GetInteger()
-						&& GetId() != JOBLIST_UTILITY )
-				{
-					longJobTime = ( jobEnd - jobStart ) * ( 1.0f / 1000.0f );
-					longJobFunc = jobList[state.nextJobIndex].function;
-					longJobData = jobList[state.nextJobIndex].data;
-					const char* jobName = GetJobName( jobList[state.nextJobIndex].function );
-					const char* jobListName = GetJobListName( GetId() );
-					idLib::Printf( "%1.1f milliseconds for a single '%s' job from job list %s on thread %d\n", longJobTime, jobName, jobListName, threadNum );
-				}
-			}
-#endif
+			result |= RUN_PROGRESS;
+			continue;
 		}
 		
+		// execute the next job
+		assert( jobList[state.nextJobIndex].signalIndex == state.signalIndex );
+		bool lastJob = ExecuteJob( threadNum, state.nextJobIndex, 0 );
+		
 		result |= RUN_PROGRESS;
 		
-		// decrease the job count for the current signal
-		if( signalJobCount[state.signalIndex].Decrement() == 0 )
+		// if this was the very last job of the job list
+		if( lastJob )
 		{
-			// if this was the very last job of the job list
-			if( state.signalIndex == signalJobCount.Num() - 1 )
-			{
-				deferredThreadStats.endTime = Sys_Microseconds();
-				return ( result | RUN_DONE );
-			}
+			return ( result | RUN_DONE );
 		}
 		
 	}
@@ -782,6 +915,95 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 	return result;
 }
 
+/*
+========================
+idParallelJobList_Threads::ExecuteJob
+
+Runs a single job and any of its successors that became ready, returns true
+if this completed the last signal of the job list.
+========================
+*/
+bool idParallelJobList_Threads::ExecuteJob( unsigned int threadNum, int jobIndex, uint64 searchTime )
+{
+	job_t& job = jobList[jobIndex];
+	
+	uint64 jobStart = Sys_Microseconds();
+	
+	job.function( job.data );
+	job.executed = 1;
+	
+	uint64 jobEnd = Sys_Microseconds();
+	deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
+	if( idTimelineProfiler::IsCapturing() && job.function != Nop )
+	{
+		idTimelineProfiler::AddEvent( GetJobName( job.function ), GetJobListName( GetId() ), jobStart, jobEnd );
+	}
+	if( workStealing )
+	{
+		// the shared fetch path accounts for the total time in RunJobs
+		deferredThreadStats.threadTotalTime[threadNum] += jobEnd - jobStart + searchTime;
+	}
+	
+#ifndef _DEBUG
+	if( jobs_longJobMicroSec.GetInteger() > 0 )
+	{
+		if( jobEnd - jobStart > jobs_longJobMicroSec.GetInteger()
+				&& GetId() != JOBLIST_UTILITY )
+		{
+			longJobTime = ( jobEnd - jobStart ) * ( 1.0f / 1000.0f );
+			longJobFunc = job.function;
+			longJobData = job.data;
+			const char* jobName = GetJobName( job.function );
+			const char* jobListName = GetJobListName( GetId() );
+			idLib::Printf( "%1.1f milliseconds for a single '%s' job from job list %s on thread %d\n", longJobTime, jobName, jobListName, threadNum );
+		}
+	}
+#endif
+
+	// run the successors that were only waiting for this job, the job count for
+	// the signal is decreased afterwards so the successors complete before any sync
+	for( int i = 0; i < job.numSuccessors; i++ )
+	{
+		const int successor = successorJobs[job.firstSuccessor + i];
+		if( Sys_InterlockedDecrement( jobList[successor].numWaiting ) == 0 )
+		{
+			ExecuteJob( threadNum, successor, 0 );
+		}
+	}
+	
+	const int signalIndex = job.signalIndex;
+	bool lastJob = false;
+	
+	// decrease the job count for the signal
+	if( signalJobCount[signalIndex].Decrement() == 0 )
+	{
+		if( workStealing )
+		{
+			if( signalReleaseJob[signalIndex] >= 0 )
+			{
+				ReleaseJobs( signalReleaseJob[signalIndex], threadNum );
+			}
+		}
+		else if( signalIndex == signalJobCount.Num() - 1 )
+		{
+			deferredThreadStats.endTime = Sys_Microseconds();
+			lastJob = true;
+		}
+	}
+	
+	if( workStealing )
+	{
+		if( numPendingJobs.Decrement() == 0 )
+		{
+			deferredThreadStats.endTime = Sys_Microseconds();
+			doneGuards[currentDoneGuard].Decrement();
+			lastJob = true;
+		}
+	}
+	
+	return lastJob;
+}
+
 /*
 ========================
 idParallelJobList_Threads::RunJobs
@@ -819,6 +1041,139 @@ bool idParallelJobList_Threads::WaitForOtherJobList()
 	return false;
 }
 
+/*
+========================
+idParallelJobList_Threads::PrepareWorkStealing
+
+Instead of having all threads fetch jobs through the shared fetch lock, the jobs
+are handed out as ranges that are split up and stolen by the job threads. The
+signal counts are still used to keep track of the synchronization points, the
+signal and sync markers are retired when the range they are in is released.
+========================
+*/
+void idParallelJobList_Threads::PrepareWorkStealing( int numThreads )
+{
+	assert( !done );
+	
+	workStealing = true;
+	numWorkStealingThreads = numThreads;
+	
+	signalReleaseJob.SetNum( signalJobCount.Num() );
+	for( int i = 0; i < signalReleaseJob.Num(); i++ )
+	{
+		signalReleaseJob[i] = -1;
+	}
+	
+	int numJobs = 0;
+	for( int i = 0; i < jobList.Num(); i++ )
+	{
+		const job_t& job = jobList[i];
+		if( job.data == & JOB_SYNCHRONIZE )
+		{
+			assert( job.signalIndex > 0 );
+			signalReleaseJob[job.signalIndex - 1] = i + 1;
+		}
+		else if( job.data != & JOB_SIGNAL && job.data != & JOB_LIST_DONE )
+		{
+			numJobs++;
+		}
+	}
+	numPendingJobs.SetValue( numJobs );
+	
+	if( numJobs == 0 )
+	{
+		deferredThreadStats.endTime = Sys_Microseconds();
+		doneGuards[currentDoneGuard].Decrement();
+	}
+}
+
+/*
+========================
+idParallelJobList_Threads::ReleaseJobs
+========================
+*/
+int idParallelJobList_Threads::ReleaseJobs( int firstJob, int threadNum )
+{
+	assert( workStealing );
+	assert( firstJob == 0 || jobList[firstJob - 1].data == & JOB_SYNCHRONIZE );
+	
+	numThreadsExecuting.Increment();
+	
+	void PushJobTask( const jobTask_t & task, int threadNum );
+	
+	// hand out every run of jobs up to the next synchronization point, the markers
+	// are never part of a task so a thread never touches the list after its last job
+	int numReleased = 0;
+	int numMarkers = 0;
+	int markers[2];
+	jobTask_t task;
+	task.jobList = this;
+	task.firstJob = firstJob;
+	for( task.endJob = firstJob; ; task.endJob++ )
+	{
+		const void* data = jobList[task.endJob].data;
+		if( data == & JOB_SIGNAL || data == & JOB_SYNCHRONIZE || data == & JOB_LIST_DONE )
+		{
+			if( task.endJob > task.firstJob )
+			{
+				numReleased += task.endJob - task.firstJob;
+				PushJobTask( task, threadNum );
+			}
+			if( data != & JOB_SIGNAL )
+			{
+				break;
+			}
+			assert( numMarkers == 0 );
+			markers[numMarkers++] = jobList[task.endJob].signalIndex;
+			task.firstJob = task.endJob + 1;
+		}
+	}
+	
+	// the synchronization point in front of these jobs has been passed
+	if( firstJob > 0 )
+	{
+		markers[numMarkers++] = jobList[firstJob - 1].signalIndex;
+	}
+	
+	// retire the markers after the jobs are out so a signal can't complete early
+	for( int i = 0; i < numMarkers; i++ )
+	{
+		if( signalJobCount[markers[i]].Decrement() == 0 && signalReleaseJob[markers[i]] >= 0 )
+		{
+			numReleased += ReleaseJobs( signalReleaseJob[markers[i]], threadNum );
+		}
+	}
+	
+	numThreadsExecuting.Decrement();
+	
+	return numReleased;
+}
+
+/*
+========================
+idParallelJobList_Threads::RunStolenJob
+========================
+*/
+void idParallelJobList_Threads::RunStolenJob( unsigned int threadNum, int jobIndex, uint64 searchTime )
+{
+	assert( threadNum < MAX_THREADS );
+	
+	numThreadsExecuting.Increment();
+	
+	if( deferredThreadStats.startTime == 0 )
+	{
+		deferredThreadStats.startTime = Sys_Microseconds();	// first time any thread is running jobs from this list
+	}
+	
+	// the thread finishing the last predecessor of a dependent job runs it
+	if( FetchDependentJob( jobIndex ) )
+	{
+		ExecuteJob( threadNum, jobIndex, searchTime );
+	}
+	
+	numThreadsExecuting.Decrement();
+}
+
 /*
 ================================================================================================
 
@@ -854,10 +1209,21 @@ idParallelJobList::~idParallelJobList()
 idParallelJobList::AddJob
 ========================
 */
-void idParallelJobList::AddJob( jobRun_t function, void* data )
+jobHandle_t idParallelJobList::AddJob( jobRun_t function, void* data )
 {
 	assert( IsRegisteredJob( function ) );
-	jobListThreads->AddJob( function, data );
+	return jobListThreads->AddJob( function, data, NULL, 0 );
+}
+
+/*
+========================
+idParallelJobList::AddJob
+========================
+*/
+jobHandle_t idParallelJobList::AddJob( jobRun_t function, void* data, const jobHandle_t* predecessors, int numPredecessors )
+{
+	assert( IsRegisteredJob( function ) );
+	return jobListThreads->AddJob( function, data, predecessors, numPredecessors );
 }
 
 /*
@@ -908,6 +1274,19 @@ bool idParallelJobList::TryWait()
 	return done;
 }
 
+/*
+========================
+idParallelJobList::WaitForJobs
+========================
+*/
+void idParallelJobList::WaitForJobs( jobHandle_t firstJob, int numJobs )
+{
+	if( jobListThreads != NULL )
+	{
+		jobListThreads->WaitForJobs( firstJob, numJobs );
+	}
+}
+
 /*
 ========================
 idParallelJobList::Submit
@@ -1048,6 +1427,7 @@ idJobThread
 */
 
 const int JOB_THREAD_STACK_SIZE		= 256 * 1024;	// same size as the SPU local store
+const int JOB_THREAD_IDLE_ROUNDS	= 64;			// failed attempts to find work before a work stealing thread goes back to sleep
 
 struct threadJobList_t
 {
@@ -1057,6 +1437,103 @@ struct threadJobList_t
 
 static idCVar jobs_prioritize( "jobs_prioritize", "1", CVAR_BOOL | CVAR_NOCHEAT, "prioritize job lists" );
 
+/*
+================================================
+idJobTaskDeque
+
+Bounded Chase-Lev work stealing deque. Only the owning job thread pushes and
+pops tasks at the bottom, any other thread may steal tasks from the top.
+================================================
+*/
+class idJobTaskDeque
+{
+public:
+	static const int			MAX_TASKS = 256;
+	
+	idJobTaskDeque() : top( 0 ), bottom( 0 ) {}
+	
+	// owner only, returns false if the deque is full
+	bool						Push( const jobTask_t& task );
+	// owner only, takes the most recently pushed task
+	bool						Pop( jobTask_t& task );
+	// any thread, takes the oldest task
+	bool						Steal( jobTask_t& task );
+	
+private:
+	interlockedInt_t			top;
+	char						pad0[CACHE_LINE_SIZE - sizeof( interlockedInt_t )];
+	interlockedInt_t			bottom;
+	char						pad1[CACHE_LINE_SIZE - sizeof( interlockedInt_t )];
+	jobTask_t					tasks[MAX_TASKS];
+};
+
+compile_time_assert( CONST_ISPOWEROFTWO( idJobTaskDeque::MAX_TASKS ) );
+
+/*
+========================
+idJobTaskDeque::Push
+========================
+*/
+bool idJobTaskDeque::Push( const jobTask_t& task )
+{
+	interlockedInt_t b = bottom;
+	interlockedInt_t t = top;
+	if( b - t >= MAX_TASKS )
+	{
+		return false;
+	}
+	tasks[b & ( MAX_TASKS - 1 )] = task;
+	SYS_MEMORYBARRIER;
+	bottom = b + 1;
+	return true;
+}
+
+/*
+========================
+idJobTaskDeque::Pop
+========================
+*/
+bool idJobTaskDeque::Pop( jobTask_t& task )
+{
+	interlockedInt_t b = bottom - 1;
+	bottom = b;
+	SYS_MEMORYBARRIER;
+	interlockedInt_t t = top;
+	if( t > b )
+	{
+		// empty
+		bottom = b + 1;
+		return false;
+	}
+	task = tasks[b & ( MAX_TASKS - 1 )];
+	if( t == b )
+	{
+		// last task, race against the thieves
+		bool won = ( Sys_InterlockedCompareExchange( top, t, t + 1 ) == t );
+		bottom = b + 1;
+		return won;
+	}
+	return true;
+}
+
+/*
+========================
+idJobTaskDeque::Steal
+========================
+*/
+bool idJobTaskDeque::Steal( jobTask_t& task )
+{
+	interlockedInt_t t = top;
+	SYS_MEMORYBARRIER;
+	interlockedInt_t b = bottom;
+	if( t >= b )
+	{
+		return false;
+	}
+	task = tasks[t & ( MAX_TASKS - 1 )];
+	return ( Sys_InterlockedCompareExchange( top, t, t + 1 ) == t );
+}
+
 class idJobThread : public idSysThread
 {
 public:
@@ -1067,15 +1544,31 @@ public:
 	
 	void						AddJobList( idParallelJobList_Threads* jobList );
 	
+	// work stealing
+	bool						PushTask( const jobTask_t& task )
+	{
+		return taskDeque.Push( task );
+	}
+	bool						StealTask( jobTask_t& task )
+	{
+		return taskDeque.Steal( task );
+	}
+	unsigned int				RandomInt()
+	{
+		randomSeed = 1664525 * randomSeed + 1013904223;
+		return randomSeed >> 8;
+	}
+	
 private:
-	threadJobList_t				jobLists[MAX_JOBLISTS];	// cyclic buffer with job lists
-	unsigned int				firstJobList;			// index of the last job list the thread grabbed
-	unsigned int				lastJobList;			// index where the next job list to work on will be added
-	idSysMutex					addJobMutex;
+	idLockFreeQueueMPMC<threadJobList_t, MAX_JOBLISTS>	jobLists;	// job lists added by any thread
 	
 	unsigned int				threadNum;
 	
+	idJobTaskDeque				taskDeque;
+	unsigned int				randomSeed;
+	
 	virtual int					Run();
+	bool						RunStolenJobs( int maxIdleRounds );
 };
 
 /*
@@ -1084,9 +1577,8 @@ idJobThread::idJobThread
 ========================
 */
 idJobThread::idJobThread() :
-	firstJobList( 0 ),
-	lastJobList( 0 ),
-	threadNum( 0 )
+	threadNum( 0 ),
+	randomSeed( 0 )
 {
 }
 
@@ -1107,6 +1599,7 @@ idJobThread::Start
 void idJobThread::Start( core_t core, unsigned int threadNum )
 {
 	this->threadNum = threadNum;
+	this->randomSeed = threadNum * 0x9E3779B9 + 1;
 	// DG: change threadname from "JobListProcessor_%d" to "JLProc_%d", because Linux
 	// has a 15 (+ \0) char limit for threadnames.
 	// furthermore: va is not thread safe, use snPrintf instead
@@ -1123,18 +1616,14 @@ idJobThread::AddJobList
 */
 void idJobThread::AddJobList( idParallelJobList_Threads* jobList )
 {
-	// must lock because multiple threads may try to add new job lists at the same time
-	addJobMutex.Lock();
-	// wait until there is space available because in rare cases multiple versions of the same job lists may still be queued
-	while( lastJobList - firstJobList >= MAX_JOBLISTS )
-	{
-		Sys_Yield();
-	}
-	assert( lastJobList - firstJobList < MAX_JOBLISTS );
-	jobLists[lastJobList & ( MAX_JOBLISTS - 1 )].jobList = jobList;
-	jobLists[lastJobList & ( MAX_JOBLISTS - 1 )].version = jobList->GetVersion();
-	lastJobList++;
-	addJobMutex.Unlock();
+	threadJobList_t threadJobList;
+	threadJobList.jobList = jobList;
+	threadJobList.version = jobList->GetVersion();
+	
+	// multiple threads may add job lists at the same time, wait until there is space available
+	// because in rare cases multiple versions of the same job lists may still be queued,
+	// sleep until the job thread pops a job list instead of spinning on the full queue
+	jobLists.WaitPush( threadJobList );
 }
 
 /*
@@ -1152,18 +1641,23 @@ int idJobThread::Run()
 	{
 	
 		// fetch any new job lists and add them to the local list
-		if( numJobLists < MAX_JOBLISTS && firstJobList < lastJobList )
+		threadJobList_t threadJobList;
+		if( numJobLists < MAX_JOBLISTS && jobLists.Pop( threadJobList ) )
 		{
-			threadJobListState[numJobLists].jobList = jobLists[firstJobList & ( MAX_JOBLISTS - 1 )].jobList;
-			threadJobListState[numJobLists].version = jobLists[firstJobList & ( MAX_JOBLISTS - 1 )].version;
+			threadJobListState[numJobLists].jobList = threadJobList.jobList;
+			threadJobListState[numJobLists].version = threadJobList.version;
 			threadJobListState[numJobLists].signalIndex = 0;
 			threadJobListState[numJobLists].lastJobIndex = 0;
 			threadJobListState[numJobLists].nextJobIndex = -1;
 			numJobLists++;
-			firstJobList++;
 		}
 		if( numJobLists == 0 )
 		{
+			// keep going as long as there is anything to take from the work stealing deques
+			if( RunStolenJobs( jobs_workStealing.GetBool() ? JOB_THREAD_IDLE_ROUNDS : 1 ) )
+			{
+				continue;
+			}
 			break;
 		}
 		
@@ -1264,8 +1758,9 @@ extern void Sys_CPUCount( int& logicalNum, int& coreNum, int& packageNum );
 //
 // Hyperthreading is not dead yet.  Intel's Core i7 Processor is quad-core with HT for 8 logicals.
 
-// DOOM3: We don't have that many jobs, so just set this fairly low so we don't spin up a ton of idle threads
-#define MAX_JOB_THREADS		2
+// DOOM3: We don't have that many jobs, so by default only a couple of threads are started,
+// more are started on demand when "jobs_numThreads" or the job list parallelism asks for them
+#define MAX_JOB_THREADS		32
 #define NUM_JOB_THREADS		"2"
 #define JOB_THREAD_CORES	{	CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
 								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
@@ -1300,13 +1795,33 @@ public:
 	
 	void						Submit( idParallelJobList_Threads* jobList, int parallelism );
 	
+	// work stealing
+	void						PushTask( const jobTask_t& task, int threadNum );
+	bool						GetTask( unsigned int threadNum, jobTask_t& task );
+	void						ReleaseWaitingJobLists( int threadNum );
+	
 private:
 	idJobThread						threads[MAX_JOB_THREADS];
 	unsigned int					maxThreads;
+	volatile int					numStartedThreads;
+	idSysMutex						startThreadsMutex;
 	int								numPhysicalCpuCores;
 	int								numLogicalCpuCores;
 	int								numCpuPackages;
 	idStaticList< idParallelJobList*, MAX_JOBLISTS >	jobLists;
+	
+	// tasks handed out by threads other than the job threads, the job threads move them onto their own deques
+	idList< jobTask_t, TAG_JOBLIST >	injectedTasks;
+	idSysInterlockedInteger			numInjectedTasks;
+	idSysMutex						injectedTasksMutex;
+	
+	// work stealing job lists that are waiting for another job list to finish before their jobs are released
+	idStaticList< idParallelJobList_Threads*, MAX_JOBLISTS >	waitingJobLists;
+	idSysInterlockedInteger			numWaitingJobLists;
+	idSysMutex						waitingJobListsMutex;
+	
+	void						StartThreads( int numThreads );
+	void						SignalThreads( int numThreads, int skipThread );
 };
 
 idParallelJobManagerLocal parallelJobManagerLocal;
@@ -1322,6 +1837,26 @@ void SubmitJobList( idParallelJobList_Threads* jobList, int parallelism )
 	parallelJobManagerLocal.Submit( jobList, parallelism );
 }
 
+/*
+========================
+PushJobTask
+========================
+*/
+void PushJobTask( const jobTask_t& task, int threadNum )
+{
+	parallelJobManagerLocal.PushTask( task, threadNum );
+}
+
+/*
+========================
+ReleaseWaitingJobLists
+========================
+*/
+void ReleaseWaitingJobLists( int threadNum )
+{
+	parallelJobManagerLocal.ReleaseWaitingJobLists( threadNum );
+}
+
 /*
 ========================
 idParallelJobManagerLocal::Init
@@ -1329,17 +1864,42 @@ idParallelJobManagerLocal::Init
 */
 void idParallelJobManagerLocal::Init()
 {
+	// on consoles this will have specific cores for the threads, but on PC they will all be CORE_ANY
+	numStartedThreads = 0;
+	maxThreads = idMath::ClampInt( 0, MAX_JOB_THREADS, jobs_numThreads.GetInteger() );
+	jobs_numThreads.ClearModified();
+	
+	StartThreads( maxThreads );
+	
+	Sys_CPUCount( numPhysicalCpuCores, numLogicalCpuCores, numCpuPackages );
+}
+
+/*
+========================
+idParallelJobManagerLocal::StartThreads
+========================
+*/
+void idParallelJobManagerLocal::StartThreads( int numThreads )
+{
+	if( numThreads <= numStartedThreads )
+	{
+		return;
+	}
+	
 	// on consoles this will have specific cores for the threads, but on PC they will all be CORE_ANY
 	core_t cores[] = JOB_THREAD_CORES;
 	assert( sizeof( cores ) / sizeof( cores[0] ) >= MAX_JOB_THREADS );
 	
-	for( int i = 0; i < MAX_JOB_THREADS; i++ )
+	// job lists may be submitted from several threads
+	idScopedCriticalSection lock( startThreadsMutex );
+	
+	numThreads = Min( numThreads, MAX_JOB_THREADS );
+	for( int i = numStartedThreads; i < numThreads; i++ )
 	{
 		threads[i].Start( cores[i], i );
 	}
-	maxThreads = jobs_numThreads.GetInteger();
-	
-	Sys_CPUCount( numPhysicalCpuCores, numLogicalCpuCores, numCpuPackages );
+	SYS_MEMORYBARRIER;
+	numStartedThreads = Max( numStartedThreads, numThreads );
 }
 
 /*
@@ -1349,7 +1909,7 @@ idParallelJobManagerLocal::Shutdown
 */
 void idParallelJobManagerLocal::Shutdown()
 {
-	for( int i = 0; i < MAX_JOB_THREADS; i++ )
+	for( int i = 0; i < numStartedThreads; i++ )
 	{
 		threads[i].StopThread();
 	}
@@ -1386,7 +1946,7 @@ void idParallelJobManagerLocal::FreeJobList( idParallelJobList* jobList )
 		return;
 	}
 	// wait for all job threads to finish because job list deletion is not thread safe
-	for( unsigned int i = 0; i < maxThreads; i++ )
+	for( int i = 0; i < numStartedThreads; i++ )
 	{
 		threads[i].WaitForThread();
 	}
@@ -1472,11 +2032,13 @@ void idParallelJobManagerLocal::Submit( idParallelJobList_Threads* jobList, int
 	}
 	else if( parallelism == JOBLIST_PARALLELISM_MAX_CORES )
 	{
-		numThreads = numLogicalCpuCores;
+		numThreads = Min( numLogicalCpuCores, MAX_JOB_THREADS );
 	}
 	else if( parallelism == JOBLIST_PARALLELISM_MAX_THREADS )
 	{
-		numThreads = MAX_JOB_THREADS;
+		// MAX_JOB_THREADS is far above the core count of most machines, don't start
+		// threads just because a list was submitted this way
+		numThreads = Min( Max( numLogicalCpuCores, ( int )maxThreads ), MAX_JOB_THREADS );
 	}
 	else if( parallelism > MAX_JOB_THREADS )
 	{
@@ -1494,9 +2056,290 @@ void idParallelJobManagerLocal::Submit( idParallelJobList_Threads* jobList, int
 		return;
 	}
 	
+	StartThreads( numThreads );
+	
+	if( jobs_workStealing.GetBool() )
+	{
+		jobList->PrepareWorkStealing( numThreads );
+		if( jobList->WaitForOtherJobList() )
+		{
+			// the jobs are released by whoever notices the other job list is done
+			idScopedCriticalSection lock( waitingJobListsMutex );
+			waitingJobLists.Append( jobList );
+			numWaitingJobLists.Increment();
+		}
+		else
+		{
+			jobList->ReleaseJobs( 0, -1 );
+		}
+		SignalThreads( numThreads, -1 );
+		return;
+	}
+	
 	for( int i = 0; i < numThreads; i++ )
 	{
 		threads[i].AddJobList( jobList );
 		threads[i].SignalWork();
 	}
 }
+
+/*
+========================
+idParallelJobManagerLocal::SignalThreads
+========================
+*/
+void idParallelJobManagerLocal::SignalThreads( int numThreads, int skipThread )
+{
+	for( int i = 0; i < numThreads; i++ )
+	{
+		if( i != skipThread )
+		{
+			threads[i].SignalWork();
+		}
+	}
+}
+
+/*
+========================
+idParallelJobManagerLocal::PushTask
+
+Called from a job thread the task goes onto the thread's own deque where
+it can be stolen by the other threads, otherwise it is queued up for the
+job threads to pick up.
+========================
+*/
+void idParallelJobManagerLocal::PushTask( const jobTask_t& task, int threadNum )
+{
+	if( threadNum >= 0 && threads[threadNum].PushTask( task ) )
+	{
+		// wake up the other threads if there is something to steal
+		if( task.endJob - task.firstJob > 1 )
+		{
+			SignalThreads( task.jobList->GetNumWorkStealingThreads(), threadNum );
+		}
+		return;
+	}
+	idScopedCriticalSection lock( injectedTasksMutex );
+	injectedTasks.Append( task );
+	numInjectedTasks.Increment();
+}
+
+/*
+========================
+idParallelJobManagerLocal::GetTask
+========================
+*/
+bool idParallelJobManagerLocal::GetTask( unsigned int threadNum, jobTask_t& task )
+{
+	if( numInjectedTasks.GetValue() > 0 )
+	{
+		idScopedCriticalSection lock( injectedTasksMutex );
+		if( injectedTasks.Num() > 0 )
+		{
+			task = injectedTasks[0];
+			injectedTasks.RemoveIndex( 0 );
+			numInjectedTasks.Decrement();
+			return true;
+		}
+	}
+	
+	// try to steal from the other threads starting at a random victim
+	const int numThreads = numStartedThreads;
+	if( numThreads <= 1 )
+	{
+		return false;
+	}
+	const int firstVictim = threads[threadNum].RandomInt() % numThreads;
+	for( int i = 0; i < numThreads; i++ )
+	{
+		const int victim = ( firstVictim + i ) % numThreads;
+		if( victim != ( int ) threadNum && threads[victim].StealTask( task ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+========================
+idParallelJobManagerLocal::ReleaseWaitingJobLists
+========================
+*/
+void idParallelJobManagerLocal::ReleaseWaitingJobLists( int threadNum )
+{
+	if( numWaitingJobLists.GetValue() == 0 )
+	{
+		return;
+	}
+	// someone else is already taking care of it
+	if( !waitingJobListsMutex.Lock( false ) )
+	{
+		return;
+	}
+	for( int i = waitingJobLists.Num() - 1; i >= 0; i-- )
+	{
+		idParallelJobList_Threads* jobList = waitingJobLists[i];
+		if( !jobList->WaitForOtherJobList() )
+		{
+			waitingJobLists.RemoveIndex( i );
+			numWaitingJobLists.Decrement();
+			jobList->ReleaseJobs( 0, threadNum );
+			SignalThreads( jobList->GetNumWorkStealingThreads(), threadNum );
+		}
+	}
+	waitingJobListsMutex.Unlock();
+}
+
+/*
+================================================================================================
+
+idJobThread work stealing
+
+================================================================================================
+*/
+
+/*
+========================
+idJobThread::RunStolenJobs
+
+Runs jobs from the thread's own deque first and steals from the other threads
+when it runs dry. The own deque is always drained before returning. Returns
+true if any jobs were executed.
+========================
+*/
+bool idJobThread::RunStolenJobs( int maxIdleRounds )
+{
+	bool executedJobs = false;
+	uint64 searchStart = Sys_Microseconds();
+	
+	for( int idleRounds = 0; idleRounds < maxIdleRounds && !IsTerminating(); )
+	{
+		jobTask_t task;
+		if( !taskDeque.Pop( task ) && !parallelJobManagerLocal.GetTask( threadNum, task ) )
+		{
+			parallelJobManagerLocal.ReleaseWaitingJobLists( threadNum );
+			if( ++idleRounds < maxIdleRounds )
+			{
+				Sys_Yield();
+			}
+			continue;
+		}
+		idleRounds = 0;
+		
+		// keep splitting the range in half so the other threads have something to steal
+		while( task.endJob - task.firstJob > 1 )
+		{
+			jobTask_t upperHalf = task;
+			upperHalf.firstJob = ( task.firstJob + task.endJob ) >> 1;
+			if( !taskDeque.Push( upperHalf ) )
+			{
+				break;
+			}
+			task.endJob = upperHalf.firstJob;
+		}
+		
+		// the time spent looking for work counts as wasted time of the job list
+		uint64 searchTime = Sys_Microseconds() - searchStart;
+		for( int i = task.firstJob; i < task.endJob; i++ )
+		{
+			task.jobList->RunStolenJob( threadNum, i, searchTime );
+			searchTime = 0;
+		}
+		searchStart = Sys_Microseconds();
+		executedJobs = true;
+	}
+	return executedJobs;
+}
+
+/*
+================================================================================================
+
+	Job manager benchmark
+	
+================================================================================================
+*/
+
+struct jobBenchmarkParms_t
+{
+	int		numIterations;
+	float	result;
+};
+
+/*
+========================
+JobBenchmark
+========================
+*/
+static void JobBenchmark( jobBenchmarkParms_t* parms )
+{
+	float x = 1.0f;
+	for( int i = 0; i < parms->numIterations; i++ )
+	{
+		x = x * 0.999f + idMath::Sqrt( x + i );
+	}
+	parms->result = x;
+}
+
+REGISTER_PARALLEL_JOB( JobBenchmark, "JobBenchmark" );
+
+/*
+========================
+TestParallelJobs
+========================
+*/
+CONSOLE_COMMAND( testParallelJobs, "benchmarks the job manager with 1..N job threads, usage: testParallelJobs [numJobs] [iterationsPerJob] [maxThreads]", 0 )
+{
+	const int numJobs = ( args.Argc() > 1 ) ? Max( 1, atoi( args.Argv( 1 ) ) ) : 2048;
+	const int numIterations = ( args.Argc() > 2 ) ? Max( 1, atoi( args.Argv( 2 ) ) ) : 1000;
+	const int maxThreads = ( args.Argc() > 3 ) ? idMath::ClampInt( 1, MAX_JOB_THREADS, atoi( args.Argv( 3 ) ) ) : MAX_JOB_THREADS;
+	const int NUM_RUNS = 8;
+	
+	jobBenchmarkParms_t* parms = new( TAG_JOBLIST ) jobBenchmarkParms_t[numJobs];
+	for( int i = 0; i < numJobs; i++ )
+	{
+		parms[i].numIterations = numIterations;
+		parms[i].result = 0.0f;
+	}
+	
+	idParallelJobList* jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, numJobs, 0, NULL );
+	
+	const bool oldWorkStealing = jobs_workStealing.GetBool();
+	
+	idLib::Printf( "%d jobs with %d iterations each, best of %d runs\n", numJobs, numIterations, NUM_RUNS );
+	idLib::Printf( "mode     threads     jobs/sec   wasted usec\n" );
+	for( int mode = 0; mode < 2; mode++ )
+	{
+		jobs_workStealing.SetBool( mode != 0 );
+		
+		for( int numThreads = 1; numThreads <= maxThreads; numThreads++ )
+		{
+			uint64 bestTime = 0;
+			uint64 bestWasted = 0;
+			for( int run = 0; run < NUM_RUNS; run++ )
+			{
+				for( int i = 0; i < numJobs; i++ )
+				{
+					jobList->AddJob( ( jobRun_t )JobBenchmark, &parms[i] );
+				}
+				
+				uint64 start = Sys_Microseconds();
+				jobList->Submit( NULL, numThreads );
+				jobList->Wait();
+				uint64 time = Sys_Microseconds() - start;
+				
+				if( run == 0 || time < bestTime )
+				{
+					bestTime = time;
+					bestWasted = jobList->GetTotalWastedTimeMicroSec();
+				}
+			}
+			idLib::Printf( "%-8s %7d %12.0f %13lld\n", ( mode != 0 ) ? "stealing" : "shared", numThreads, numJobs * 1000000.0 / Max( bestTime, ( uint64 ) 1 ), bestWasted );
+		}
+	}
+	
+	jobs_workStealing.SetBool( oldWorkStealing );
+	
+	parallelJobManager->FreeJobList( jobList );
+	delete[] parms;
+}
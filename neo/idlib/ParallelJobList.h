@@ -33,6 +33,10 @@ class idColor;
 
 typedef void ( * jobRun_t )( void* );
 
+// index of a job in the job list it was added to
+typedef int jobHandle_t;
+const jobHandle_t INVALID_JOB_HANDLE = -1;
+
 enum jobSyncType_t
 {
 	SYNC_NONE,
@@ -45,6 +49,7 @@ enum jobListId_t
 {
 	JOBLIST_RENDERER_FRONTEND	= 0,
 	JOBLIST_RENDERER_BACKEND	= 1,
+	JOBLIST_GAME				= 2,
 	JOBLIST_UTILITY				= 9,			// won't print over-time warnings
 	
 	MAX_JOBLISTS				= 32			// the editor may cause quite a few to be allocated
@@ -64,7 +69,7 @@ enum jobListParallelism_t
 {
 	JOBLIST_PARALLELISM_DEFAULT			= -1,	// use "jobs_numThreads" number of threads
 	JOBLIST_PARALLELISM_MAX_CORES		= -2,	// use a thread for each logical core (includes hyperthreads)
-	JOBLIST_PARALLELISM_MAX_THREADS		= -3	// use the maximum number of job threads, which can help if there is IO to overlap
+	JOBLIST_PARALLELISM_MAX_THREADS		= -3	// use all logical cores or "jobs_numThreads" threads, whichever is more, which can help if there is IO to overlap
 };
 
 #define assert_spu_local_store( ptr )
@@ -86,7 +91,10 @@ class idParallelJobList
 	friend class idParallelJobManagerLocal;
 public:
 
-	void					AddJob( jobRun_t function, void* data );
+	jobHandle_t				AddJob( jobRun_t function, void* data );
+	// Add a job that will not start before the given jobs have finished. The predecessors must
+	// have been added to this job list before, invalid handles are ignored.
+	jobHandle_t				AddJob( jobRun_t function, void* data, const jobHandle_t* predecessors, int numPredecessors );
 	CellSpursJob128* 		AddJobSPURS();
 	void					InsertSyncPoint( jobSyncType_t syncType );
 	
@@ -96,6 +104,8 @@ public:
 	void					Wait();
 	// Try to wait for the jobs in this list to finish but either way return immediately. Returns true if all jobs are done.
 	bool					TryWait();
+	// Wait for a range of jobs in this list to finish while the other jobs keep running.
+	void					WaitForJobs( jobHandle_t firstJob, int numJobs );
 	// returns true if the job list has been submitted.
 	bool					IsSubmitted() const;
 	
@@ -0,0 +1,125 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#pragma hdrstop
+#include "precompiled.h"
+
+/*
+================================================================================================
+
+	Shared Block Allocators
+
+================================================================================================
+*/
+
+static idSharedBlockAllocBase* sharedBlockAllocs;
+
+/*
+========================
+SharedBlockAllocMutex
+
+Pools can be global objects, so the mutex is constructed on first use.
+========================
+*/
+static idSysMutex& SharedBlockAllocMutex()
+{
+	static idSysMutex mutex;
+	return mutex;
+}
+
+/*
+========================
+idSharedBlockAllocBase::idSharedBlockAllocBase
+========================
+*/
+idSharedBlockAllocBase::idSharedBlockAllocBase( const char* name_ ) :
+	name( name_ )
+{
+	idScopedCriticalSection lock( SharedBlockAllocMutex() );
+	nextPool = sharedBlockAllocs;
+	sharedBlockAllocs = this;
+}
+
+/*
+========================
+idSharedBlockAllocBase::~idSharedBlockAllocBase
+========================
+*/
+idSharedBlockAllocBase::~idSharedBlockAllocBase()
+{
+	idScopedCriticalSection lock( SharedBlockAllocMutex() );
+	for( idSharedBlockAllocBase** pool = &sharedBlockAllocs; *pool != NULL; pool = &( *pool )->nextPool )
+	{
+		if( *pool == this )
+		{
+			*pool = nextPool;
+			break;
+		}
+	}
+}
+
+/*
+========================
+idSharedBlockAllocBase::ReleaseAllEmptyBlocks
+========================
+*/
+void idSharedBlockAllocBase::ReleaseAllEmptyBlocks( int maxBlocksPerPool )
+{
+	idScopedCriticalSection lock( SharedBlockAllocMutex() );
+	for( idSharedBlockAllocBase* pool = sharedBlockAllocs; pool != NULL; pool = pool->nextPool )
+	{
+		pool->ReleaseEmptyBlocks( maxBlocksPerPool );
+	}
+}
+
+/*
+========================
+idSharedBlockAllocBase::PrintAll
+========================
+*/
+void idSharedBlockAllocBase::PrintAll()
+{
+	idScopedCriticalSection lock( SharedBlockAllocMutex() );
+	idLib::Printf( "%-24s %6s %7s %6s %8s %8s %8s %9s %6s\n", "pool", "size", "blocks", "empty", "total", "live", "cached", "KB", "frag" );
+	for( idSharedBlockAllocBase* pool = sharedBlockAllocs; pool != NULL; pool = pool->nextPool )
+	{
+		blockAllocStats_t stats;
+		pool->GetStats( stats );
+		idLib::Printf( "%-24s %6d %7d %6d %8d %8d %8d %9.1f %5.1f%%\n", stats.name, stats.elementSize, stats.blocks, stats.emptyBlocks,
+					   stats.total, stats.live, stats.cached, stats.total * stats.elementSize / 1024.0f, stats.fragmentation * 100.0f );
+	}
+}
+
+/*
+========================
+listBlockAllocs
+========================
+*/
+CONSOLE_COMMAND( listBlockAllocs, "lists the occupancy and fragmentation of the shared block allocators", 0 )
+{
+	idSharedBlockAllocBase::PrintAll();
+}
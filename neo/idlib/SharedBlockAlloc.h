@@ -0,0 +1,641 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __SHAREDBLOCKALLOC_H__
+#define __SHAREDBLOCKALLOC_H__
+
+/*
+===============================================================================
+
+	Block based allocator for fixed size objects that can be used by
+	several threads at once.
+
+===============================================================================
+*/
+
+#define BLOCK_ALLOC_MAGAZINE_SIZE	32
+#define BLOCK_ALLOC_FREE_BUCKETS	32		// one per power of two of the free count, the last one holds the empty blocks
+
+struct blockAllocStats_t
+{
+	const char* 	name;
+	int				elementSize;
+	int				blocks;
+	int				emptyBlocks;
+	int				total;			// elements in all blocks
+	int				live;			// elements handed out
+	int				cached;			// free elements in the per thread magazines
+	float			fragmentation;	// fraction of the elements in partially used blocks that is free
+};
+
+/*
+================================================
+idSharedBlockAllocBase keeps a list of all idSharedBlockAlloc instances so
+they can be reported on and compacted together.
+================================================
+*/
+class idSharedBlockAllocBase
+{
+public:
+	idSharedBlockAllocBase( const char* name );
+	virtual					~idSharedBlockAllocBase();
+	
+	virtual void			GetStats( blockAllocStats_t& stats ) = 0;
+	virtual int				ReleaseEmptyBlocks( int maxBlocks ) = 0;
+	
+	// releases at most maxBlocksPerPool empty blocks of every pool, cheap enough to be called every frame
+	static void				ReleaseAllEmptyBlocks( int maxBlocksPerPool );
+	static void				PrintAll();
+	
+protected:
+	const char* 			name;
+	
+private:
+	idSharedBlockAllocBase* nextPool;
+};
+
+/*
+================================================
+idSharedBlockAlloc is a thread safe block-based allocator for fixed-size objects.
+
+Each thread allocates from and frees to its own magazine of up to
+BLOCK_ALLOC_MAGAZINE_SIZE elements, so only one in every half magazine of
+operations takes the lock of the central free lists. The central lists are
+kept per block, new elements are handed out from the most used blocks, and
+blocks that become empty can be given back with ReleaseEmptyBlocks. The blocks
+with free elements are bucketed by the power of two of their free count, so
+finding the most used one doesn't depend on the number of blocks.
+
+The magazine of a thread that exits is only freed by Shutdown, so the
+allocator is meant for long living threads like the job workers.
+
+All objects are properly constructed and destructed.
+================================================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag = TAG_BLOCKALLOC>
+class idSharedBlockAlloc : public idSharedBlockAllocBase
+{
+public:
+	ID_INLINE			idSharedBlockAlloc( const char* name, bool clear = false );
+	ID_INLINE			~idSharedBlockAlloc();
+	
+	// returns total size of allocated memory
+	size_t				Allocated() const
+	{
+		return numBlocks * _blockSize_ * sizeof( _type_ );
+	}
+	
+	// returns total size of allocated memory including size of (*this)
+	size_t				Size() const
+	{
+		return sizeof( *this ) + Allocated();
+	}
+	
+	// no other thread may use the allocator during a Shutdown
+	ID_INLINE void		Shutdown();
+	
+	ID_INLINE _type_* 	Alloc();
+	ID_INLINE void		Free( _type_ *element );
+	
+	// keeps one empty block around so a pool at its high water mark doesn't allocate and release blocks all the time
+	ID_INLINE int		ReleaseEmptyBlocks( int maxBlocks );
+	ID_INLINE void		GetStats( blockAllocStats_t& stats );
+	
+	int					GetTotalCount() const
+	{
+		return numBlocks * _blockSize_;
+	}
+	ID_INLINE int		GetAllocCount();
+	
+private:
+	union element_t
+	{
+		_type_* 		data;	// this is a hack to make sure the save game system marks _type_ as saveable
+		element_t* 		next;
+		byte			buffer[( CONST_MAX( sizeof( _type_ ), sizeof( element_t* ) ) + ( BLOCK_ALLOC_ALIGNMENT - 1 ) ) & ~( BLOCK_ALLOC_ALIGNMENT - 1 )];
+	};
+	
+	struct idBlock
+	{
+		element_t		elements[_blockSize_];
+		element_t* 		free;		// free elements of this block in the central list
+		int				freeCount;
+		int				bucket;		// -1 when the block has no free elements
+		idBlock* 		prevInBucket;
+		idBlock* 		nextInBucket;
+	};
+	
+	struct magazine_t
+	{
+		element_t* 		elements[BLOCK_ALLOC_MAGAZINE_SIZE];
+		int				count;
+		int				allocs;		// only changed by the owning thread
+		int				frees;
+		magazine_t* 	next;
+	};
+	
+	idSysMutex			mutex;		// guards everything but the contents of the magazines
+	idBlock** 			blocks;		// sorted by address
+	int					numBlocks;
+	int					maxBlocks;
+	idBlock* 			freeBuckets[BLOCK_ALLOC_FREE_BUCKETS];
+	unsigned int		freeBucketMask;	// the buckets that aren't empty
+	magazine_t* 		magazines;
+	ID_TLS				threadMagazine;
+	bool				clearAllocs;
+	
+	ID_INLINE magazine_t* GetMagazine();
+	ID_INLINE int		FindBlock( const element_t* element ) const;
+	ID_INLINE void		UpdateBucket( idBlock* block );
+	ID_INLINE void		UnlinkBlock( idBlock* block );
+	ID_INLINE static int LowestBit( unsigned int mask );
+	ID_INLINE void		Refill( magazine_t* magazine );
+	ID_INLINE void		Drain( magazine_t* magazine, int num );
+	ID_INLINE void		AllocNewBlock();
+};
+
+/*
+========================
+idSharedBlockAlloc::idSharedBlockAlloc
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE idSharedBlockAlloc<_type_, _blockSize_, memTag>::idSharedBlockAlloc( const char* name, bool clear ) :
+	idSharedBlockAllocBase( name ),
+	blocks( NULL ),
+	numBlocks( 0 ),
+	maxBlocks( 0 ),
+	freeBucketMask( 0 ),
+	magazines( NULL ),
+	clearAllocs( clear )
+{
+	memset( freeBuckets, 0, sizeof( freeBuckets ) );
+}
+
+/*
+========================
+idSharedBlockAlloc::~idSharedBlockAlloc
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE idSharedBlockAlloc<_type_, _blockSize_, memTag>::~idSharedBlockAlloc()
+{
+	Shutdown();
+	while( magazines != NULL )
+	{
+		magazine_t* magazine = magazines;
+		magazines = magazines->next;
+		Mem_Free( magazine );
+	}
+}
+
+/*
+========================
+idSharedBlockAlloc::Alloc
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE _type_* idSharedBlockAlloc<_type_, _blockSize_, memTag>::Alloc()
+{
+#ifdef FORCE_DISCRETE_BLOCK_ALLOCS
+	// for debugging tools
+	return new _type_;
+#else
+	magazine_t* magazine = GetMagazine();
+	if( magazine->count == 0 )
+	{
+		Refill( magazine );
+	}
+	
+	element_t* element = magazine->elements[--magazine->count];
+	element->next = NULL;
+	magazine->allocs++;
+	
+	_type_ * t = ( _type_* ) element->buffer;
+	if( clearAllocs )
+	{
+		memset( t, 0, sizeof( _type_ ) );
+	}
+	new( t ) _type_;
+	return t;
+#endif
+}
+
+/*
+========================
+idSharedBlockAlloc::Free
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::Free( _type_ * t )
+{
+#ifdef FORCE_DISCRETE_BLOCK_ALLOCS
+	// for debugging tools
+	delete t;
+#else
+	if( t == NULL )
+	{
+		return;
+	}
+	
+	t->~_type_();
+	
+	magazine_t* magazine = GetMagazine();
+	if( magazine->count == BLOCK_ALLOC_MAGAZINE_SIZE )
+	{
+		Drain( magazine, BLOCK_ALLOC_MAGAZINE_SIZE / 2 );
+	}
+	magazine->elements[magazine->count++] = ( element_t* )( t );
+	magazine->frees++;
+#endif
+}
+
+/*
+========================
+idSharedBlockAlloc::Shutdown
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::Shutdown()
+{
+	idScopedCriticalSection lock( mutex );
+	for( int i = 0; i < numBlocks; i++ )
+	{
+		Mem_Free( blocks[i] );
+	}
+	Mem_Free( blocks );
+	blocks = NULL;
+	numBlocks = maxBlocks = 0;
+	memset( freeBuckets, 0, sizeof( freeBuckets ) );
+	freeBucketMask = 0;
+	
+	// the magazines stay registered with their threads, they are only emptied
+	for( magazine_t* magazine = magazines; magazine != NULL; magazine = magazine->next )
+	{
+		magazine->count = 0;
+		magazine->allocs = magazine->frees = 0;
+	}
+}
+
+/*
+========================
+idSharedBlockAlloc::ReleaseEmptyBlocks
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE int idSharedBlockAlloc<_type_, _blockSize_, memTag>::ReleaseEmptyBlocks( int maxRelease )
+{
+	idScopedCriticalSection lock( mutex );
+	
+	idBlock* emptyBlock = freeBuckets[BLOCK_ALLOC_FREE_BUCKETS - 1];
+	if( emptyBlock == NULL )
+	{
+		return 0;
+	}
+	
+	int numReleased = 0;
+	for( emptyBlock = emptyBlock->nextInBucket; emptyBlock != NULL && numReleased < maxRelease; numReleased++ )
+	{
+		idBlock* next = emptyBlock->nextInBucket;
+		UnlinkBlock( emptyBlock );
+		const int i = FindBlock( emptyBlock->elements );
+		numBlocks--;
+		memmove( blocks + i, blocks + i + 1, ( numBlocks - i ) * sizeof( blocks[0] ) );
+		Mem_Free( emptyBlock );
+		emptyBlock = next;
+	}
+	return numReleased;
+}
+
+/*
+========================
+idSharedBlockAlloc::GetAllocCount
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE int idSharedBlockAlloc<_type_, _blockSize_, memTag>::GetAllocCount()
+{
+	idScopedCriticalSection lock( mutex );
+	int count = 0;
+	for( magazine_t* magazine = magazines; magazine != NULL; magazine = magazine->next )
+	{
+		count += magazine->allocs - magazine->frees;
+	}
+	return count;
+}
+
+/*
+========================
+idSharedBlockAlloc::GetStats
+
+The magazine counts are read while their threads may change them, so the numbers are approximate.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::GetStats( blockAllocStats_t& stats )
+{
+	idScopedCriticalSection lock( mutex );
+	
+	stats.name = name;
+	stats.elementSize = sizeof( element_t );
+	stats.blocks = numBlocks;
+	stats.emptyBlocks = 0;
+	stats.total = numBlocks * _blockSize_;
+	stats.live = 0;
+	stats.cached = 0;
+	for( magazine_t* magazine = magazines; magazine != NULL; magazine = magazine->next )
+	{
+		stats.live += magazine->allocs - magazine->frees;
+		stats.cached += magazine->count;
+	}
+	
+	int partialElements = 0;
+	int partialFree = 0;
+	for( int i = 0; i < numBlocks; i++ )
+	{
+		const int freeCount = blocks[i]->freeCount;
+		if( freeCount == _blockSize_ )
+		{
+			stats.emptyBlocks++;
+		}
+		else if( freeCount > 0 )
+		{
+			partialElements += _blockSize_;
+			partialFree += freeCount;
+		}
+	}
+	stats.fragmentation = ( partialElements > 0 ) ? ( float )partialFree / partialElements : 0.0f;
+}
+
+/*
+========================
+idSharedBlockAlloc::GetMagazine
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE typename idSharedBlockAlloc<_type_, _blockSize_, memTag>::magazine_t* idSharedBlockAlloc<_type_, _blockSize_, memTag>::GetMagazine()
+{
+	magazine_t* magazine = ( magazine_t* )( ptrdiff_t )threadMagazine;
+	if( magazine == NULL )
+	{
+		magazine = ( magazine_t* )Mem_ClearedAlloc( sizeof( magazine_t ), memTag );
+		{
+			idScopedCriticalSection lock( mutex );
+			magazine->next = magazines;
+			magazines = magazine;
+		}
+		threadMagazine = ( ptrdiff_t )magazine;
+	}
+	return magazine;
+}
+
+/*
+========================
+idSharedBlockAlloc::FindBlock
+
+Returns the index of the block that holds the element, the mutex must be locked.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE int idSharedBlockAlloc<_type_, _blockSize_, memTag>::FindBlock( const element_t* element ) const
+{
+	int low = 0;
+	int high = numBlocks - 1;
+	while( low < high )
+	{
+		const int mid = ( low + high + 1 ) >> 1;
+		if( ( const void* )blocks[mid] <= ( const void* )element )
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+	// if this assert fires, the element wasn't allocated here
+	assert( element >= blocks[low]->elements && element < blocks[low]->elements + _blockSize_ );
+	return low;
+}
+
+/*
+========================
+idSharedBlockAlloc::UnlinkBlock
+
+The mutex must be locked.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::UnlinkBlock( idBlock* block )
+{
+	if( block->bucket < 0 )
+	{
+		return;
+	}
+	if( block->prevInBucket != NULL )
+	{
+		block->prevInBucket->nextInBucket = block->nextInBucket;
+	}
+	else
+	{
+		freeBuckets[block->bucket] = block->nextInBucket;
+		if( block->nextInBucket == NULL )
+		{
+			freeBucketMask &= ~( 1u << block->bucket );
+		}
+	}
+	if( block->nextInBucket != NULL )
+	{
+		block->nextInBucket->prevInBucket = block->prevInBucket;
+	}
+	block->bucket = -1;
+}
+
+/*
+========================
+idSharedBlockAlloc::UpdateBucket
+
+Moves the block to the bucket of its free count, the mutex must be locked.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::UpdateBucket( idBlock* block )
+{
+	int bucket;
+	if( block->freeCount == 0 )
+	{
+		bucket = -1;
+	}
+	else if( block->freeCount == _blockSize_ )
+	{
+		bucket = BLOCK_ALLOC_FREE_BUCKETS - 1;
+	}
+	else
+	{
+		bucket = idMath::ILog2( block->freeCount );
+	}
+	if( bucket == block->bucket )
+	{
+		return;
+	}
+	
+	UnlinkBlock( block );
+	if( bucket < 0 )
+	{
+		return;
+	}
+	block->bucket = bucket;
+	block->prevInBucket = NULL;
+	block->nextInBucket = freeBuckets[bucket];
+	if( block->nextInBucket != NULL )
+	{
+		block->nextInBucket->prevInBucket = block;
+	}
+	freeBuckets[bucket] = block;
+	freeBucketMask |= 1u << bucket;
+}
+
+/*
+========================
+idSharedBlockAlloc::LowestBit
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE int idSharedBlockAlloc<_type_, _blockSize_, memTag>::LowestBit( unsigned int mask )
+{
+	assert( mask != 0 );
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward( &index, mask );
+	return ( int )index;
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+/*
+========================
+idSharedBlockAlloc::Refill
+
+Fills half of the magazine from the blocks with the fewest free elements, so the
+other blocks get a chance to become empty. The fewest is only exact to the power
+of two bucket, the empty blocks are used last.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::Refill( magazine_t* magazine )
+{
+	idScopedCriticalSection lock( mutex );
+	while( magazine->count < BLOCK_ALLOC_MAGAZINE_SIZE / 2 )
+	{
+		if( freeBucketMask == 0 )
+		{
+			AllocNewBlock();
+			continue;
+		}
+		idBlock* best = freeBuckets[LowestBit( freeBucketMask )];
+		while( best->free != NULL && magazine->count < BLOCK_ALLOC_MAGAZINE_SIZE / 2 )
+		{
+			magazine->elements[magazine->count++] = best->free;
+			best->free = best->free->next;
+			best->freeCount--;
+		}
+		UpdateBucket( best );
+	}
+}
+
+/*
+========================
+idSharedBlockAlloc::Drain
+
+Returns the oldest elements of the magazine to their blocks.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::Drain( magazine_t* magazine, int num )
+{
+	idScopedCriticalSection lock( mutex );
+	for( int i = 0; i < num; i++ )
+	{
+		element_t* element = magazine->elements[i];
+		idBlock* block = blocks[FindBlock( element )];
+		element->next = block->free;
+		block->free = element;
+		block->freeCount++;
+		UpdateBucket( block );
+	}
+	magazine->count -= num;
+	memmove( magazine->elements, magazine->elements + num, magazine->count * sizeof( magazine->elements[0] ) );
+}
+
+/*
+========================
+idSharedBlockAlloc::AllocNewBlock
+
+The mutex must be locked.
+========================
+*/
+template<class _type_, int _blockSize_, memTag_t memTag>
+ID_INLINE void idSharedBlockAlloc<_type_, _blockSize_, memTag>::AllocNewBlock()
+{
+	idBlock* block = ( idBlock* )Mem_Alloc( sizeof( idBlock ), memTag );
+	block->free = NULL;
+	for( int i = _blockSize_ - 1; i >= 0; i-- )
+	{
+		block->elements[i].next = block->free;
+		block->free = &block->elements[i];
+		
+		assert( ( ( ( uintptr_t )block->free ) & ( BLOCK_ALLOC_ALIGNMENT - 1 ) ) == 0 );
+	}
+	block->freeCount = _blockSize_;
+	block->bucket = -1;
+	UpdateBucket( block );
+	
+	if( numBlocks == maxBlocks )
+	{
+		maxBlocks = Max( maxBlocks * 2, 16 );
+		idBlock** newBlocks = ( idBlock** )Mem_Alloc( maxBlocks * sizeof( blocks[0] ), memTag );
+		if( blocks != NULL )
+		{
+			memcpy( newBlocks, blocks, numBlocks * sizeof( blocks[0] ) );
+			Mem_Free( blocks );
+		}
+		blocks = newBlocks;
+	}
+	
+	int index = numBlocks;
+	while( index > 0 && ( void* )blocks[index - 1] > ( void* )block )
+	{
+		blocks[index] = blocks[index - 1];
+		index--;
+	}
+	blocks[index] = block;
+	numBlocks++;
+}
+
+#endif // !__SHAREDBLOCKALLOC_H__
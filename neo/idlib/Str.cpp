@@ -34,6 +34,11 @@ If you have questions concerning this license or the applicable additional terms
 static idDynamicBlockAlloc < char, 1 << 18, 128, TAG_STRING >	stringDataAllocator;
 #endif
 
+// heap reallocations of string data, the frame counts are only touched by EndFrame
+static interlockedInt_t	strNumReallocs;
+static int				strFrameStartReallocs;
+static int				strFrameReallocs;
+
 idVec4	g_color_table[16] =
 {
 	idVec4( 0.0f, 0.0f, 0.0f, 1.0f ),
@@ -95,6 +100,8 @@ void idStr::ReAllocate( int amount, bool keepold )
 	}
 	SetAlloced( newsize );
 	
+	Sys_InterlockedIncrement( strNumReallocs );
+	
 #ifdef USE_STRING_DATA_ALLOCATOR
 	newbuffer = stringDataAllocator.Alloc( GetAlloced() );
 #else
@@ -719,18 +726,72 @@ perform a threadsafe sprintf to the string
 void idStr::Format( const char* fmt, ... )
 {
 	va_list argptr;
-	char text[MAX_PRINT_MSG];
 	
 	va_start( argptr, fmt );
-	int len = idStr::vsnPrintf( text, sizeof( text ) - 1, fmt, argptr );
+	FormatArgs( fmt, argptr );
 	va_end( argptr );
+}
+
+/*
+========================
+idStr::FormatArgs
+
+The text is formatted on the stack so the arguments may point into the string itself,
+it only touches the heap when the string has to grow. Formatting into an idStrStatic
+never allocates.
+========================
+*/
+void idStr::FormatArgs( const char* fmt, va_list argptr )
+{
+	char text[MAX_PRINT_MSG];
+	
+	int len = idStr::vsnPrintf( text, sizeof( text ) - 1, fmt, argptr );
 	text[ sizeof( text ) - 1 ] = '\0';
 	
-	if( ( size_t )len >= sizeof( text ) - 1 )
+	if( len < 0 )
 	{
 		idLib::common->FatalError( "Tried to set a large buffer using %s", fmt );
 	}
-	*this = text;
+	
+	EnsureAlloced( len + 1, false );
+	memcpy( data, text, len + 1 );
+	this->len = len;
+}
+
+/*
+========================
+idStr::AppendFormat
+
+sprintf to the end of the string, instead of appending a va() or a temporary idStr
+========================
+*/
+void idStr::AppendFormat( const char* fmt, ... )
+{
+	va_list argptr;
+	
+	va_start( argptr, fmt );
+	AppendFormatArgs( fmt, argptr );
+	va_end( argptr );
+}
+
+/*
+========================
+idStr::AppendFormatArgs
+========================
+*/
+void idStr::AppendFormatArgs( const char* fmt, va_list argptr )
+{
+	char text[MAX_PRINT_MSG];
+	
+	int len = idStr::vsnPrintf( text, sizeof( text ) - 1, fmt, argptr );
+	text[ sizeof( text ) - 1 ] = '\0';
+	
+	if( len < 0 )
+	{
+		idLib::common->FatalError( "Tried to append a large buffer using %s", fmt );
+	}
+	
+	Append( text, len );
 }
 
 /*
@@ -2446,6 +2507,40 @@ void idStr::ShowMemoryUsage_f( const idCmdArgs& args )
 #endif
 }
 
+/*
+================
+idStr::EndFrame
+================
+*/
+void idStr::EndFrame()
+{
+	const int numReallocs = strNumReallocs;
+	strFrameReallocs = numReallocs - strFrameStartReallocs;
+	strFrameStartReallocs = numReallocs;
+}
+
+/*
+================
+idStr::GetFrameReallocs
+
+returns the number of string reallocations in the last complete frame
+================
+*/
+int idStr::GetFrameReallocs()
+{
+	return strFrameReallocs;
+}
+
+/*
+================
+idStr::GetTotalReallocs
+================
+*/
+int idStr::GetTotalReallocs()
+{
+	return strNumReallocs;
+}
+
 /*
 ================
 idStr::FormatNumber
@@ -116,7 +116,8 @@ const int C_COLOR_BLACK				= '9';
 
 // make idStr a multiple of 16 bytes long
 // don't make too large to keep memory requirements to a minimum
-const int STR_ALLOC_BASE			= 20;
+// 32 characters on 64 bit, which covers most decl and file names without a heap buffer
+const int STR_ALLOC_BASE			= 48 - 2 * sizeof( int ) - sizeof( char* );
 const int STR_ALLOC_GRAN			= 32;
 
 typedef enum
@@ -131,6 +132,7 @@ class idStr
 public:
 	idStr();
 	idStr( const idStr& text );
+	idStr( idStr&& text );
 	idStr( const idStr& text, int start, int end );
 	idStr( const char* text );
 	idStr( const char* text, int start, int end );
@@ -150,12 +152,17 @@ public:
 	char& 				operator[]( int index );
 	
 	void				operator=( const idStr& text );
+	void				operator=( idStr&& text );
 	void				operator=( const char* text );
 	
 	friend idStr		operator+( const idStr& a, const idStr& b );
 	friend idStr		operator+( const idStr& a, const char* b );
 	friend idStr		operator+( const char* a, const idStr& b );
 	
+	// appends to the buffer of a temporary, so chained additions only grow one buffer
+	friend idStr		operator+( idStr&& a, const idStr& b );
+	friend idStr		operator+( idStr&& a, const char* b );
+	
 	friend idStr		operator+( const idStr& a, const float b );
 	friend idStr		operator+( const idStr& a, const int b );
 	friend idStr		operator+( const idStr& a, const unsigned b );
@@ -249,6 +256,9 @@ public:
 	idStr				Right( int len ) const;							// return the rightmost 'len' characters
 	idStr				Mid( int start, int len ) const;				// return 'len' characters starting at 'start'
 	void				Format( VERIFY_FORMAT_STRING const char* fmt, ... );					// perform a threadsafe sprintf to the string
+	void				FormatArgs( const char* fmt, va_list argptr );
+	void				AppendFormat( VERIFY_FORMAT_STRING const char* fmt, ... );			// sprintf to the end of the string
+	void				AppendFormatArgs( const char* fmt, va_list argptr );
 	static idStr		FormatInt( const int num, bool isCash = false );			// formats an integer as a value with commas
 	static idStr		FormatCash( const int num )
 	{
@@ -351,13 +361,18 @@ public:
 	static void			PurgeMemory();
 	static void			ShowMemoryUsage_f( const idCmdArgs& args );
 	
+	// heap reallocations of string data, EndFrame is called once per frame by the main thread
+	static void			EndFrame();
+	static int			GetFrameReallocs();
+	static int			GetTotalReallocs();
+	
 	int					DynamicMemoryUsed() const;
 	static idStr		FormatNumber( int number );
 	
 protected:
 	int					len;
-	char* 				data;
 	int					allocedAndFlag;	// top bit is used to store a flag that indicates if the string data is static or not
+	char* 				data;
 	char				baseBuffer[ STR_ALLOC_BASE ];
 	
 	void				EnsureAlloced( int amount, bool keepold = true );	// ensure string data buffer is large anough
@@ -488,6 +503,12 @@ ID_INLINE idStr::idStr( const idStr& text )
 	len = l;
 }
 
+ID_INLINE idStr::idStr( idStr&& text )
+{
+	Construct();
+	operator=( static_cast< idStr&& >( text ) );
+}
+
 ID_INLINE idStr::idStr( const idStr& text, int start, int end )
 {
 	Construct();
@@ -682,6 +703,29 @@ ID_INLINE void idStr::operator=( const idStr& text )
 	len = l;
 }
 
+/*
+========================
+idStr::operator=
+
+Takes over the heap buffer of text, static and base buffers are copied.
+========================
+*/
+ID_INLINE void idStr::operator=( idStr&& text )
+{
+	if( this == &text || IsStatic() || text.IsStatic() || text.data == text.baseBuffer )
+	{
+		operator=( static_cast< const idStr& >( text ) );
+		return;
+	}
+	
+	FreeData();
+	data = text.data;
+	len = text.len;
+	SetAlloced( text.GetAlloced() );
+	
+	text.Construct();
+}
+
 ID_INLINE idStr operator+( const idStr& a, const idStr& b )
 {
 	idStr result( a );
@@ -696,6 +740,18 @@ ID_INLINE idStr operator+( const idStr& a, const char* b )
 	return result;
 }
 
+ID_INLINE idStr operator+( idStr&& a, const idStr& b )
+{
+	a.Append( b );
+	return static_cast< idStr&& >( a );
+}
+
+ID_INLINE idStr operator+( idStr&& a, const char* b )
+{
+	a.Append( b );
+	return static_cast< idStr&& >( a );
+}
+
 ID_INLINE idStr operator+( const char* a, const idStr& b )
 {
 	idStr result( a );
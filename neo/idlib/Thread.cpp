@@ -34,6 +34,61 @@ Contains the vartious ThreadingClass implementations.
 ================================================================================================
 */
 
+/*
+================================================================================================
+
+	idSysWaitableInteger
+
+================================================================================================
+*/
+
+static const int WAITABLE_SPIN_COUNT = 64;		// polls of the value before going to sleep
+
+/*
+========================
+idSysWaitableInteger::WaitWhileEqual
+========================
+*/
+bool idSysWaitableInteger::WaitWhileEqual( int compare, int timeout )
+{
+	// short handoffs usually complete before it is worth going to sleep
+	for( int i = 0; i < WAITABLE_SPIN_COUNT; i++ )
+	{
+		if( GetValue() != compare )
+		{
+			SYS_MEMORYBARRIER;
+			return true;
+		}
+	}
+	if( timeout == 0 )
+	{
+		return false;
+	}
+	
+	const int startTime = ( timeout > 0 ) ? Sys_Milliseconds() : 0;
+	bool result = true;
+	
+	Sys_InterlockedIncrement( waiters );
+	while( GetValue() == compare )
+	{
+		int remaining = idSysSignal::WAIT_INFINITE;
+		if( timeout > 0 )
+		{
+			remaining = timeout - ( Sys_Milliseconds() - startTime );
+			if( remaining <= 0 )
+			{
+				result = false;
+				break;
+			}
+		}
+		Sys_WaitOnAddress( value, compare, remaining );
+	}
+	Sys_InterlockedDecrement( waiters );
+	
+	SYS_MEMORYBARRIER;
+	return result;
+}
+
 /*
 ================================================================================================
 
@@ -51,9 +106,7 @@ idSysThread::idSysThread() :
 	threadHandle( 0 ),
 	isWorker( false ),
 	isRunning( false ),
-	isTerminating( false ),
-	moreWorkToDo( false ),
-	signalWorkerDone( true )
+	isTerminating( false )
 {
 }
 
@@ -114,8 +167,6 @@ bool idSysThread::StartWorkerThread( const char* name_, core_t core, xthreadPrio
 	
 	bool result = StartThread( name_, core, priority, stackSize );
 	
-	signalWorkerDone.Wait( idSysSignal::WAIT_INFINITE );
-	
 	return result;
 }
 
@@ -132,12 +183,8 @@ void idSysThread::StopThread( bool wait )
 	}
 	if( isWorker )
 	{
-		signalMutex.Lock();
-		moreWorkToDo = true;
-		signalWorkerDone.Clear();
 		isTerminating = true;
-		signalMoreWorkToDo.Raise();
-		signalMutex.Unlock();
+		workSignalled.Increment();
 	}
 	else
 	{
@@ -158,7 +205,17 @@ void idSysThread::WaitForThread()
 {
 	if( isWorker )
 	{
-		signalWorkerDone.Wait( idSysSignal::WAIT_INFINITE );
+		for( ; ; )
+		{
+			const int completed = workCompleted.GetValue();
+			if( completed == workSignalled.GetValue() )
+			{
+				break;
+			}
+			workCompleted.WaitWhileEqual( completed );
+		}
+		// make the results of the worker visible to this thread
+		SYS_MEMORYBARRIER;
 	}
 	else if( isRunning )
 	{
@@ -176,11 +233,8 @@ void idSysThread::SignalWork()
 {
 	if( isWorker )
 	{
-		signalMutex.Lock();
-		moreWorkToDo = true;
-		signalWorkerDone.Clear();
-		signalMoreWorkToDo.Raise();
-		signalMutex.Unlock();
+		// the interlocked increment also publishes the work set up by this thread
+		workSignalled.Increment();
 	}
 }
 
@@ -193,9 +247,9 @@ bool idSysThread::IsWorkDone()
 {
 	if( isWorker )
 	{
-		// a timeout of 0 will return immediately with true if signaled
-		if( signalWorkerDone.Wait( 0 ) )
+		if( workCompleted.GetValue() == workSignalled.GetValue() )
 		{
+			SYS_MEMORYBARRIER;
 			return true;
 		}
 	}
@@ -211,35 +265,45 @@ int idSysThread::ThreadProc( idSysThread* thread )
 {
 	int retVal = 0;
 	
+	idTimelineProfiler::SetThreadName( thread->GetName() );
+	
+	// the denormal modes are per thread
+	idSIMD::ApplyThreadFPUMode();
+	
 	try
 	{
 		if( thread->isWorker )
 		{
+			// a restarted worker continues from the count the previous one caught up with
+			int handled = thread->workCompleted.GetValue();
 			for( ; ; )
 			{
-				thread->signalMutex.Lock();
-				if( thread->moreWorkToDo )
-				{
-					thread->moreWorkToDo = false;
-					thread->signalMoreWorkToDo.Clear();
-					thread->signalMutex.Unlock();
-				}
-				else
+				const int signalled = thread->workSignalled.GetValue();
+				if( signalled == handled )
 				{
-					thread->signalWorkerDone.Raise();
-					thread->signalMutex.Unlock();
-					thread->signalMoreWorkToDo.Wait( idSysSignal::WAIT_INFINITE );
+					// all work is done, release the waiting threads and sleep until more work is signalled
+					thread->workCompleted.Exchange( handled );
+					thread->workSignalled.WaitWhileEqual( handled );
 					continue;
 				}
+				// any number of SignalWork() calls since the last run are handled by a single run
+				handled = signalled;
+				SYS_MEMORYBARRIER;
 				
 				if( thread->isTerminating )
 				{
 					break;
 				}
 				
+				// pick up a change of com_deterministicMath
+				idSIMD::ApplyThreadFPUMode();
+				
 				retVal = thread->Run();
 			}
-			thread->signalWorkerDone.Raise();
+			// clear the running state before signaling, otherwise a StopThread() that
+			// gets in before this thread is scheduled again waits for a signal that never comes
+			thread->isRunning = false;
+			thread->workCompleted.Exchange( handled );
 		}
 		else
 		{
@@ -256,6 +320,8 @@ int idSysThread::ThreadProc( idSysThread* thread )
 	
 	thread->isRunning = false;
 	
+	Mem_ReleaseThreadCache();
+	
 	return retVal;
 }
 
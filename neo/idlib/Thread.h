@@ -182,6 +182,81 @@ private:
 	interlockedInt_t	value;
 };
 
+/*
+================================================
+idSysWaitableInteger is an atomic integer that threads can sleep on until it changes.
+It replaces spinning on an interlocked integer with Sys_Yield(). A waiting thread spins for a
+short while and then sleeps in the kernel (a futex on Linux), and a thread that changes the
+value only enters the kernel to wake others when somebody is actually waiting.
+
+	// producer
+	data = ...;
+	ready.Increment();
+
+	// consumer
+	while ( ready.GetValue() == lastSeen ) {
+		ready.WaitWhileEqual( lastSeen );
+	}
+
+All modifying functions act as a full memory barrier.
+================================================
+*/
+class idSysWaitableInteger
+{
+public:
+	idSysWaitableInteger() : value( 0 ), waiters( 0 ) {}
+	
+	// atomically increments the integer, wakes all waiting threads and returns the new value
+	int					Increment()
+	{
+		int v = Sys_InterlockedIncrement( value );
+		Wake();
+		return v;
+	}
+	
+	// atomically adds a value to the integer, wakes all waiting threads and returns the new value
+	int					Add( int v )
+	{
+		int r = Sys_InterlockedAdd( value, ( interlockedInt_t ) v );
+		Wake();
+		return r;
+	}
+	
+	// atomically sets a new value, wakes all waiting threads and returns the previous value
+	int					Exchange( int v )
+	{
+		int r = Sys_InterlockedExchange( value, ( interlockedInt_t ) v );
+		Wake();
+		return r;
+	}
+	
+	// returns the current value of the integer
+	int					GetValue() const
+	{
+		return *( volatile const interlockedInt_t* )&value;
+	}
+	
+	// sleeps as long as the value equals 'compare', returns false if the timeout in milliseconds expired
+	bool				WaitWhileEqual( int compare, int timeout = idSysSignal::WAIT_INFINITE );
+	
+private:
+	interlockedInt_t	value;
+	interlockedInt_t	waiters;
+	
+	void				Wake()
+	{
+		// the interlocked operation on the value is a full barrier, so either the waiter
+		// sees the new value or this sees the waiter
+		if( *( volatile interlockedInt_t* )&waiters > 0 )
+		{
+			Sys_WakeByAddress( value, true );
+		}
+	}
+	
+	idSysWaitableInteger( const idSysWaitableInteger& s ) {}
+	void				operator=( const idSysWaitableInteger& s ) {}
+};
+
 /*
 ================================================
 idSysInterlockedPointer is a C++ wrapper around the low level system interlocked pointer
@@ -268,6 +343,9 @@ finished already. When the worker thread is done, the main thread can safely use
 from the worker thread.
 
 Note that worker threads are useful on all platforms but they do not map to the SPUs on the PS3.
+
+The work handoff uses two idSysWaitableIntegers that count the signalled and the completed work,
+so a waiting thread sleeps instead of spinning and SignalWork() never takes a lock.
 ================================================
 */
 class idSysThread
@@ -336,10 +414,8 @@ private:
 	bool			isWorker;
 	bool			isRunning;
 	volatile bool	isTerminating;
-	volatile bool	moreWorkToDo;
-	idSysSignal		signalWorkerDone;
-	idSysSignal		signalMoreWorkToDo;
-	idSysMutex		signalMutex;
+	idSysWaitableInteger	workSignalled;		// incremented for every SignalWork()
+	idSysWaitableInteger	workCompleted;		// set to the signalled count the worker caught up with
 	
 	static int		ThreadProc( idSysThread* thread );
 	
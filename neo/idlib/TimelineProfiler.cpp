@@ -0,0 +1,441 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+static const int MAX_TIMELINE_THREADS		= 64;
+static const int MAX_TIMELINE_EVENTS		= 1 << 15;	// per thread, must be a power of two
+static const int MAX_TIMELINE_SCOPE_DEPTH	= 32;
+static const int TIMELINE_WRITE_MARGIN		= 64;		// events the owning thread may be writing while a capture is saved
+static const int MAX_TIMELINE_NAMES			= 1 << 12;	// per thread, must be a power of two
+static const int TIMELINE_NAME_POOL_SIZE	= 128 * 1024;
+
+compile_time_assert( CONST_ISPOWEROFTWO( MAX_TIMELINE_EVENTS ) );
+compile_time_assert( CONST_ISPOWEROFTWO( MAX_TIMELINE_NAMES ) );
+
+struct timelineEvent_t
+{
+	const char* 	name;
+	const char* 	category;
+	uint64			startTime;
+	uint64			endTime;
+};
+
+struct timelineThread_t
+{
+	char				name[64];
+	int					scopeDepth;
+	const char* 		scopeNames[MAX_TIMELINE_SCOPE_DEPTH];
+	uint64				scopeStartTimes[MAX_TIMELINE_SCOPE_DEPTH];	// zero if the scope started outside a capture
+	timelineEvent_t* 	events;										// ring buffer, allocated with the first event
+	volatile int		numEvents;									// only written by the owning thread
+	
+	// copies of the event names made during the current capture, allocated with the first event
+	int					nameCapture;								// the capture the names were copied for
+	int* 				nameHash;									// offset + 1 of the names in the pool, zero for an empty slot
+	int					numNames;
+	char* 				namePool;
+	int					namePoolUsed;
+};
+
+static timelineThread_t* 		timelineThreads[MAX_TIMELINE_THREADS];
+static idSysInterlockedInteger	numTimelineThreads;
+static ID_TLS					currentTimelineThread;
+static ID_TLS					currentTimelineThreadName;	// threads only get a slot once they record during a capture
+
+static int						captureCount;
+static int						captureFramesLeft;
+static uint64					captureStartTime;
+static uint64					captureFrameStartTime;
+static idStr					captureFileName;
+
+volatile bool idTimelineProfiler::capturing = false;
+
+/*
+========================
+GetTimelineThread
+========================
+*/
+static timelineThread_t* GetTimelineThread( bool create )
+{
+	timelineThread_t* thread = ( timelineThread_t* )( ptrdiff_t )currentTimelineThread;
+	if( thread != NULL || !create )
+	{
+		return thread;
+	}
+	
+	const int index = numTimelineThreads.Increment() - 1;
+	if( index >= MAX_TIMELINE_THREADS )
+	{
+		return NULL;
+	}
+	
+	// not using Mem_ClearedAlloc, the SIMD processor may not be initialized yet
+	thread = ( timelineThread_t* )Mem_Alloc( sizeof( timelineThread_t ), TAG_DEBUG );
+	memset( thread, 0, sizeof( timelineThread_t ) );
+	const char* name = ( const char* )( ptrdiff_t )currentTimelineThreadName;
+	if( name != NULL )
+	{
+		idStr::Copynz( thread->name, name, sizeof( thread->name ) );
+	}
+	else
+	{
+		idStr::snPrintf( thread->name, sizeof( thread->name ), "thread %d", index );
+	}
+	timelineThreads[index] = thread;
+	currentTimelineThread = ( ptrdiff_t )thread;
+	return thread;
+}
+
+/*
+========================
+CopyTimelineName
+
+Event names often belong to decls or models that can be freed before the capture is written,
+so each thread keeps a copy of the names it recorded during the capture. Only the owning thread
+uses the table, the copies are dropped when the thread first records during the next capture.
+========================
+*/
+static const char* CopyTimelineName( timelineThread_t* thread, const char* name )
+{
+	if( thread->nameHash == NULL )
+	{
+		thread->nameHash = ( int* )Mem_Alloc( MAX_TIMELINE_NAMES * sizeof( int ), TAG_DEBUG );
+		thread->namePool = ( char* )Mem_Alloc( TIMELINE_NAME_POOL_SIZE, TAG_DEBUG );
+		thread->nameCapture = captureCount - 1;
+	}
+	if( thread->nameCapture != captureCount )
+	{
+		memset( thread->nameHash, 0, MAX_TIMELINE_NAMES * sizeof( int ) );
+		thread->numNames = 0;
+		thread->namePoolUsed = 0;
+		thread->nameCapture = captureCount;
+	}
+	
+	int i = idStr::Hash( name ) & ( MAX_TIMELINE_NAMES - 1 );
+	for( ; thread->nameHash[i] != 0; i = ( i + 1 ) & ( MAX_TIMELINE_NAMES - 1 ) )
+	{
+		const char* copy = thread->namePool + thread->nameHash[i] - 1;
+		if( idStr::Cmp( copy, name ) == 0 )
+		{
+			return copy;
+		}
+	}
+	
+	const int length = idStr::Length( name ) + 1;
+	if( ( thread->numNames + 1 ) * 2 > MAX_TIMELINE_NAMES || thread->namePoolUsed + length > TIMELINE_NAME_POOL_SIZE )
+	{
+		return "(out of timeline name memory)";
+	}
+	char* copy = thread->namePool + thread->namePoolUsed;
+	memcpy( copy, name, length );
+	thread->nameHash[i] = thread->namePoolUsed + 1;
+	thread->namePoolUsed += length;
+	thread->numNames++;
+	return copy;
+}
+
+/*
+========================
+AddTimelineEvent
+========================
+*/
+static void AddTimelineEvent( timelineThread_t* thread, const char* name, const char* category, uint64 startTime, uint64 endTime )
+{
+	if( thread->events == NULL )
+	{
+		thread->events = ( timelineEvent_t* )Mem_Alloc( MAX_TIMELINE_EVENTS * sizeof( timelineEvent_t ), TAG_DEBUG );
+	}
+	
+	timelineEvent_t& event = thread->events[thread->numEvents & ( MAX_TIMELINE_EVENTS - 1 )];
+	event.name = name;
+	event.category = category;
+	event.startTime = startTime;
+	event.endTime = endTime;
+	
+	// make sure the event is complete before it can be seen by the thread saving the capture
+	SYS_MEMORYBARRIER;
+	thread->numEvents = thread->numEvents + 1;
+}
+
+/*
+========================
+idTimelineProfiler::BeginEvent
+========================
+*/
+void idTimelineProfiler::BeginEvent( const char* name )
+{
+	timelineThread_t* thread = GetTimelineThread( capturing );
+	if( thread == NULL )
+	{
+		return;
+	}
+	
+	// keep track of the scopes outside of captures as well so the nesting stays valid
+	if( thread->scopeDepth < MAX_TIMELINE_SCOPE_DEPTH )
+	{
+		if( capturing )
+		{
+			thread->scopeNames[thread->scopeDepth] = CopyTimelineName( thread, name );
+			thread->scopeStartTimes[thread->scopeDepth] = Sys_Microseconds();
+		}
+		else
+		{
+			thread->scopeNames[thread->scopeDepth] = NULL;
+			thread->scopeStartTimes[thread->scopeDepth] = 0;
+		}
+	}
+	thread->scopeDepth++;
+}
+
+/*
+========================
+idTimelineProfiler::EndEvent
+========================
+*/
+void idTimelineProfiler::EndEvent()
+{
+	timelineThread_t* thread = GetTimelineThread( false );
+	if( thread == NULL || thread->scopeDepth == 0 )
+	{
+		// the scope started before this thread was known to the profiler
+		return;
+	}
+	
+	const int depth = --thread->scopeDepth;
+	if( depth < MAX_TIMELINE_SCOPE_DEPTH && thread->scopeStartTimes[depth] != 0 && capturing )
+	{
+		AddTimelineEvent( thread, thread->scopeNames[depth], "scope", thread->scopeStartTimes[depth], Sys_Microseconds() );
+	}
+}
+
+/*
+========================
+idTimelineProfiler::AddEvent
+========================
+*/
+void idTimelineProfiler::AddEvent( const char* name, const char* category, uint64 startTime, uint64 endTime )
+{
+	if( !capturing )
+	{
+		return;
+	}
+	timelineThread_t* thread = GetTimelineThread( true );
+	if( thread == NULL )
+	{
+		return;
+	}
+	AddTimelineEvent( thread, CopyTimelineName( thread, name ), category, startTime, endTime );
+}
+
+/*
+========================
+idTimelineProfiler::SetThreadName
+========================
+*/
+void idTimelineProfiler::SetThreadName( const char* name )
+{
+	currentTimelineThreadName = ( ptrdiff_t )name;
+	
+	timelineThread_t* thread = GetTimelineThread( false );
+	if( thread != NULL )
+	{
+		idStr::Copynz( thread->name, name, sizeof( thread->name ) );
+	}
+}
+
+/*
+========================
+idTimelineProfiler::StartCapture
+========================
+*/
+void idTimelineProfiler::StartCapture( int numFrames, const char* fileName )
+{
+	if( capturing )
+	{
+		idLib::Printf( "already capturing the timeline to %s\n", captureFileName.c_str() );
+		return;
+	}
+	
+	// this is called on the main thread
+	SetThreadName( "main" );
+	
+	captureFramesLeft = numFrames;
+	captureFileName = fileName;
+	captureFileName.DefaultFileExtension( ".json" );
+	captureStartTime = Sys_Microseconds();
+	captureFrameStartTime = captureStartTime;
+	captureCount++;
+	
+	SYS_MEMORYBARRIER;
+	capturing = true;
+}
+
+/*
+========================
+WriteTimelineString
+
+Writes a JSON string, the names are treated as Latin-1.
+========================
+*/
+static void WriteTimelineString( idFile* f, const char* string )
+{
+	char buffer[1024];
+	int length = 0;
+	buffer[length++] = '"';
+	for( const byte* c = ( const byte* )string; *c != 0; c++ )
+	{
+		// leave room for an escape and the closing quote
+		if( length > ( int )sizeof( buffer ) - 8 )
+		{
+			f->Write( buffer, length );
+			length = 0;
+		}
+		if( *c == '"' || *c == '\\' )
+		{
+			buffer[length++] = '\\';
+			buffer[length++] = *c;
+		}
+		else if( *c < 0x20 || *c >= 0x7F )
+		{
+			length += idStr::snPrintf( buffer + length, 7, "\\u%04x", *c );
+		}
+		else
+		{
+			buffer[length++] = *c;
+		}
+	}
+	buffer[length++] = '"';
+	f->Write( buffer, length );
+}
+
+/*
+========================
+WriteTimelineCapture
+========================
+*/
+static void WriteTimelineCapture( const char* fileName )
+{
+	idFile* f = fileSystem->OpenFileWrite( fileName );
+	if( f == NULL )
+	{
+		idLib::Warning( "couldn't open %s", fileName );
+		return;
+	}
+	
+	int numWritten = 0;
+	const int numThreads = Min( numTimelineThreads.GetValue(), MAX_TIMELINE_THREADS );
+	
+	f->Printf( "{\"traceEvents\":[\n" );
+	for( int i = 0; i < numThreads; i++ )
+	{
+		const timelineThread_t* thread = timelineThreads[i];
+		if( thread == NULL )
+		{
+			continue;
+		}
+		
+		f->Printf( "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", ( numWritten++ > 0 ) ? ",\n" : "", i );
+		WriteTimelineString( f, thread->name );
+		f->Printf( "}}" );
+		
+		if( thread->events == NULL )
+		{
+			continue;
+		}
+		
+		// skip the oldest events which may already be overwritten by events after the capture
+		const int lastEvent = thread->numEvents;
+		const int firstEvent = Max( 0, lastEvent - ( MAX_TIMELINE_EVENTS - TIMELINE_WRITE_MARGIN ) );
+		if( firstEvent > 0 && thread->events[firstEvent & ( MAX_TIMELINE_EVENTS - 1 )].startTime > captureStartTime )
+		{
+			idLib::Warning( "timeline events of %s overflowed, capture fewer frames", thread->name );
+		}
+		
+		for( int j = firstEvent; j < lastEvent; j++ )
+		{
+			const timelineEvent_t& event = thread->events[j & ( MAX_TIMELINE_EVENTS - 1 )];
+			if( event.startTime < captureStartTime )
+			{
+				continue;
+			}
+			f->Printf( ",\n{\"name\":" );
+			WriteTimelineString( f, event.name );
+			f->Printf( ",\"cat\":" );
+			WriteTimelineString( f, event.category );
+			f->Printf( ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%d,\"dur\":%d}", i, ( int )( event.startTime - captureStartTime ), ( int )( event.endTime - event.startTime ) );
+			numWritten++;
+		}
+	}
+	f->Printf( "\n]}\n" );
+	
+	idLib::Printf( "wrote %d timeline events of %d threads to %s\n", numWritten, numThreads, f->GetFullPath() );
+	
+	delete f;
+}
+
+/*
+========================
+idTimelineProfiler::EndFrame
+========================
+*/
+void idTimelineProfiler::EndFrame()
+{
+	if( !capturing )
+	{
+		return;
+	}
+	
+	const uint64 frameEndTime = Sys_Microseconds();
+	AddEvent( "frame", "frame", captureFrameStartTime, frameEndTime );
+	captureFrameStartTime = frameEndTime;
+	
+	if( --captureFramesLeft > 0 )
+	{
+		return;
+	}
+	
+	capturing = false;
+	SYS_MEMORYBARRIER;
+	
+	WriteTimelineCapture( captureFileName );
+}
+
+/*
+========================
+TimelineCapture
+========================
+*/
+CONSOLE_COMMAND( timelineCapture, "captures the jobs and profile scopes of the next frames as a Chrome trace, usage: timelineCapture [numFrames] [fileName]", 0 )
+{
+	const int numFrames = ( args.Argc() > 1 ) ? Max( 1, atoi( args.Argv( 1 ) ) ) : 4;
+	const char* fileName = ( args.Argc() > 2 ) ? args.Argv( 2 ) : "timeline.json";
+	
+	idTimelineProfiler::StartCapture( numFrames, fileName );
+}
@@ -0,0 +1,75 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __TIMELINEPROFILER_H__
+#define __TIMELINEPROFILER_H__
+
+/*
+===============================================================================
+
+	Timeline profiler.
+	
+	Records the profile scopes and the jobs executed on each thread into a
+	per-thread ring buffer while a capture is running. Only the owning thread
+	writes to a ring buffer, so recording does not take any locks. The captured
+	frames are written out in the Chrome tracing JSON format, which can be
+	loaded in chrome://tracing or Perfetto.
+	
+	Event names are copied by the recording thread, so the names of decls and
+	models that are freed before the capture is saved are fine. Categories are
+	not copied and must stay valid, string literals and job list names are fine.
+	
+===============================================================================
+*/
+
+class idTimelineProfiler
+{
+public:
+	// begins and ends a nested scope on the calling thread
+	static void				BeginEvent( const char* name );
+	static void				EndEvent();
+	// adds an event that has already finished on the calling thread
+	static void				AddEvent( const char* name, const char* category, uint64 startTime, uint64 endTime );
+	// names the calling thread in the captures, the name must stay valid while the thread runs
+	static void				SetThreadName( const char* name );
+	
+	// starts capturing the given number of frames which are then written to the file
+	static void				StartCapture( int numFrames, const char* fileName );
+	// called once at the end of each frame by the main thread
+	static void				EndFrame();
+	
+	static bool				IsCapturing()
+	{
+		return capturing;
+	}
+	
+private:
+	static volatile bool	capturing;
+};
+
+#endif /* !__TIMELINEPROFILER_H__ */
@@ -0,0 +1,752 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#pragma hdrstop
+#include "precompiled.h"
+
+/*
+============
+BoundsBatch_ClearRange
+
+  Sets the bounds in the range [start, end) to cleared bounds.
+============
+*/
+static void BoundsBatch_ClearRange( float* data, const int capacity, const int start, const int end )
+{
+	for( int i = 0; i < 3; i++ )
+	{
+		float* mins = data + ( 0 + i ) * capacity;
+		float* maxs = data + ( 3 + i ) * capacity;
+		for( int j = start; j < end; j++ )
+		{
+			mins[j] = idMath::INFINITY;
+			maxs[j] = -idMath::INFINITY;
+		}
+	}
+}
+
+/*
+============
+idBoundsBatch::Resize
+============
+*/
+void idBoundsBatch::Resize( int newCapacity )
+{
+	newCapacity = ( newCapacity + 3 ) & ~3;
+	if( newCapacity < num )
+	{
+		newCapacity = ( num + 3 ) & ~3;
+	}
+	if( newCapacity == capacity )
+	{
+		return;
+	}
+	
+	float* newData = NULL;
+	if( newCapacity > 0 )
+	{
+		newData = ( float* ) Mem_Alloc16( newCapacity * 6 * sizeof( float ), memTag );
+		for( int i = 0; i < 6; i++ )
+		{
+			memcpy( newData + i * newCapacity, data + i * capacity, num * sizeof( float ) );
+		}
+		BoundsBatch_ClearRange( newData, newCapacity, num, newCapacity );
+	}
+	
+	Mem_Free16( data );
+	data = newData;
+	capacity = newCapacity;
+}
+
+/*
+============
+idBoundsBatch::Clear
+============
+*/
+void idBoundsBatch::Clear()
+{
+	if( data != NULL )
+	{
+		BoundsBatch_ClearRange( data, capacity, 0, num );
+	}
+	num = 0;
+}
+
+/*
+============
+idBoundsBatch::Free
+============
+*/
+void idBoundsBatch::Free()
+{
+	Mem_Free16( data );
+	data = NULL;
+	num = 0;
+	capacity = 0;
+}
+
+/*
+============
+idBoundsBatch::SetNum
+============
+*/
+void idBoundsBatch::SetNum( int newNum )
+{
+	assert( newNum >= 0 );
+	if( newNum > capacity )
+	{
+		Resize( newNum + granularity - 1 - ( newNum + granularity - 1 ) % granularity );
+	}
+	if( newNum < num )
+	{
+		BoundsBatch_ClearRange( data, capacity, newNum, num );
+	}
+	num = newNum;
+}
+
+/*
+============
+idBoundsBatch::RemoveIndexFast
+============
+*/
+void idBoundsBatch::RemoveIndexFast( int index )
+{
+	assert( index >= 0 && index < num );
+	const int last = num - 1;
+	if( index != last )
+	{
+		for( int i = 0; i < 6; i++ )
+		{
+			data[i * capacity + index] = data[i * capacity + last];
+		}
+	}
+	BoundsBatch_ClearRange( data, capacity, last, num );
+	num--;
+}
+
+/*
+============
+idBoundsBatch::Union
+============
+*/
+idBounds idBoundsBatch::Union() const
+{
+	idBounds bounds;
+	
+#if defined(USE_INTRINSICS)
+	
+	__m128 minX = _mm_set1_ps( idMath::INFINITY );
+	__m128 minY = minX;
+	__m128 minZ = minX;
+	__m128 maxX = _mm_set1_ps( -idMath::INFINITY );
+	__m128 maxY = maxX;
+	__m128 maxZ = maxX;
+	
+	const float* mnx = Stream( 0, 0 );
+	const float* mny = Stream( 1, 0 );
+	const float* mnz = Stream( 2, 0 );
+	const float* mxx = Stream( 0, 1 );
+	const float* mxy = Stream( 1, 1 );
+	const float* mxz = Stream( 2, 1 );
+	
+	for( int i = 0; i < num; i += 4 )
+	{
+		minX = _mm_min_ps( minX, _mm_load_ps( mnx + i ) );
+		minY = _mm_min_ps( minY, _mm_load_ps( mny + i ) );
+		minZ = _mm_min_ps( minZ, _mm_load_ps( mnz + i ) );
+		maxX = _mm_max_ps( maxX, _mm_load_ps( mxx + i ) );
+		maxY = _mm_max_ps( maxY, _mm_load_ps( mxy + i ) );
+		maxZ = _mm_max_ps( maxZ, _mm_load_ps( mxz + i ) );
+	}
+	
+	// transpose so each component ends up in its own lane and reduce the four lanes
+	__m128 r0 = _mm_unpacklo_ps( minX, minZ );	// x0 z0 x1 z1
+	__m128 r1 = _mm_unpackhi_ps( minX, minZ );	// x2 z2 x3 z3
+	__m128 r2 = _mm_unpacklo_ps( minY, minY );	// y0 y0 y1 y1
+	__m128 r3 = _mm_unpackhi_ps( minY, minY );	// y2 y2 y3 y3
+	__m128 mins = _mm_min_ps( _mm_min_ps( _mm_unpacklo_ps( r0, r2 ), _mm_unpackhi_ps( r0, r2 ) ),
+							  _mm_min_ps( _mm_unpacklo_ps( r1, r3 ), _mm_unpackhi_ps( r1, r3 ) ) );
+							  
+	r0 = _mm_unpacklo_ps( maxX, maxZ );
+	r1 = _mm_unpackhi_ps( maxX, maxZ );
+	r2 = _mm_unpacklo_ps( maxY, maxY );
+	r3 = _mm_unpackhi_ps( maxY, maxY );
+	__m128 maxs = _mm_max_ps( _mm_max_ps( _mm_unpacklo_ps( r0, r2 ), _mm_unpackhi_ps( r0, r2 ) ),
+							  _mm_max_ps( _mm_unpacklo_ps( r1, r3 ), _mm_unpackhi_ps( r1, r3 ) ) );
+							  
+	ALIGNTYPE16 float result[8];
+	_mm_store_ps( result + 0, mins );
+	_mm_store_ps( result + 4, maxs );
+	bounds[0].Set( result[0], result[1], result[2] );
+	bounds[1].Set( result[4], result[5], result[6] );
+	
+#else
+	
+	bounds.Clear();
+	for( int i = 0; i < num; i++ )
+	{
+		bounds.AddBounds( Get( i ) );
+	}
+	
+#endif
+	
+	return bounds;
+}
+
+/*
+============
+idBoundsBatch::IntersectsBounds
+============
+*/
+int idBoundsBatch::IntersectsBounds( const idBounds& bounds, int* indexes ) const
+{
+	int count = 0;
+	
+#if defined(USE_INTRINSICS)
+	
+	const __m128 bminX = _mm_load1_ps( &bounds[0].x );
+	const __m128 bminY = _mm_load1_ps( &bounds[0].y );
+	const __m128 bminZ = _mm_load1_ps( &bounds[0].z );
+	const __m128 bmaxX = _mm_load1_ps( &bounds[1].x );
+	const __m128 bmaxY = _mm_load1_ps( &bounds[1].y );
+	const __m128 bmaxZ = _mm_load1_ps( &bounds[1].z );
+	
+	const float* mnx = Stream( 0, 0 );
+	const float* mny = Stream( 1, 0 );
+	const float* mnz = Stream( 2, 0 );
+	const float* mxx = Stream( 0, 1 );
+	const float* mxy = Stream( 1, 1 );
+	const float* mxz = Stream( 2, 1 );
+	
+	for( int i = 0; i < num; i += 4 )
+	{
+		__m128 dx = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( mnx + i ), bmaxX ), _mm_cmpge_ps( _mm_load_ps( mxx + i ), bminX ) );
+		__m128 dy = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( mny + i ), bmaxY ), _mm_cmpge_ps( _mm_load_ps( mxy + i ), bminY ) );
+		__m128 dz = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( mnz + i ), bmaxZ ), _mm_cmpge_ps( _mm_load_ps( mxz + i ), bminZ ) );
+		
+		int mask = _mm_movemask_ps( _mm_and_ps( _mm_and_ps( dx, dy ), dz ) );
+		if( mask == 0 )
+		{
+			continue;
+		}
+		for( int j = 0; mask != 0; j++, mask >>= 1 )
+		{
+			if( mask & 1 )
+			{
+				indexes[count++] = i + j;
+			}
+		}
+	}
+	
+#else
+	
+	for( int i = 0; i < num; i++ )
+	{
+		if( bounds.IntersectsBounds( Get( i ) ) )
+		{
+			indexes[count++] = i;
+		}
+	}
+	
+#endif
+	
+	return count;
+}
+
+/*
+============
+idBoundsBatch::FirstIntersectsBounds
+============
+*/
+int idBoundsBatch::FirstIntersectsBounds( const idBounds& bounds ) const
+{
+#if defined(USE_INTRINSICS)
+	
+	const __m128 bminX = _mm_load1_ps( &bounds[0].x );
+	const __m128 bminY = _mm_load1_ps( &bounds[0].y );
+	const __m128 bminZ = _mm_load1_ps( &bounds[0].z );
+	const __m128 bmaxX = _mm_load1_ps( &bounds[1].x );
+	const __m128 bmaxY = _mm_load1_ps( &bounds[1].y );
+	const __m128 bmaxZ = _mm_load1_ps( &bounds[1].z );
+	
+	const float* mnx = Stream( 0, 0 );
+	const float* mny = Stream( 1, 0 );
+	const float* mnz = Stream( 2, 0 );
+	const float* mxx = Stream( 0, 1 );
+	const float* mxy = Stream( 1, 1 );
+	const float* mxz = Stream( 2, 1 );
+	
+	for( int i = 0; i < num; i += 4 )
+	{
+		__m128 dx = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( mnx + i ), bmaxX ), _mm_cmpge_ps( _mm_load_ps( mxx + i ), bminX ) );
+		__m128 dy = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( mny + i ), bmaxY ), _mm_cmpge_ps( _mm_load_ps( mxy + i ), bminY ) );
+		__m128 dz = _mm_and_ps( _mm_cmple_ps( _mm_load_ps( mnz + i ), bmaxZ ), _mm_cmpge_ps( _mm_load_ps( mxz + i ), bminZ ) );
+		
+		int mask = _mm_movemask_ps( _mm_and_ps( _mm_and_ps( dx, dy ), dz ) );
+		if( mask == 0 )
+		{
+			continue;
+		}
+		for( int j = 0; ; j++, mask >>= 1 )
+		{
+			if( mask & 1 )
+			{
+				return i + j;
+			}
+		}
+	}
+	
+#else
+	
+	for( int i = 0; i < num; i++ )
+	{
+		if( bounds.IntersectsBounds( Get( i ) ) )
+		{
+			return i;
+		}
+	}
+	
+#endif
+	
+	return -1;
+}
+
+/*
+============
+BoundsBatch_SphereIntersectsBounds
+
+  Compares the squared distance from the sphere origin to the closest point on the bounds.
+============
+*/
+static ID_INLINE bool BoundsBatch_SphereIntersectsBounds( const idSphere& sphere, const idBounds& bounds )
+{
+	float distSqr = 0.0f;
+	for( int i = 0; i < 3; i++ )
+	{
+		float d = Max( bounds[0][i] - sphere[i], 0.0f ) + Max( sphere[i] - bounds[1][i], 0.0f );
+		distSqr += d * d;
+	}
+	return ( distSqr <= sphere.GetRadius() * sphere.GetRadius() );
+}
+
+/*
+============
+idBoundsBatch::IntersectsSphere
+============
+*/
+int idBoundsBatch::IntersectsSphere( const idSphere& sphere, int* indexes ) const
+{
+	int count = 0;
+	
+#if defined(USE_INTRINSICS)
+	
+	const __m128 vector_float_zero = _mm_setzero_ps();
+	const __m128 cx = _mm_set1_ps( sphere[0] );
+	const __m128 cy = _mm_set1_ps( sphere[1] );
+	const __m128 cz = _mm_set1_ps( sphere[2] );
+	const __m128 radiusSqr = _mm_set1_ps( sphere.GetRadius() * sphere.GetRadius() );
+	
+	const float* mnx = Stream( 0, 0 );
+	const float* mny = Stream( 1, 0 );
+	const float* mnz = Stream( 2, 0 );
+	const float* mxx = Stream( 0, 1 );
+	const float* mxy = Stream( 1, 1 );
+	const float* mxz = Stream( 2, 1 );
+	
+	for( int i = 0; i < num; i += 4 )
+	{
+		__m128 dx = _mm_add_ps( _mm_max_ps( _mm_sub_ps( _mm_load_ps( mnx + i ), cx ), vector_float_zero ), _mm_max_ps( _mm_sub_ps( cx, _mm_load_ps( mxx + i ) ), vector_float_zero ) );
+		__m128 dy = _mm_add_ps( _mm_max_ps( _mm_sub_ps( _mm_load_ps( mny + i ), cy ), vector_float_zero ), _mm_max_ps( _mm_sub_ps( cy, _mm_load_ps( mxy + i ) ), vector_float_zero ) );
+		__m128 dz = _mm_add_ps( _mm_max_ps( _mm_sub_ps( _mm_load_ps( mnz + i ), cz ), vector_float_zero ), _mm_max_ps( _mm_sub_ps( cz, _mm_load_ps( mxz + i ) ), vector_float_zero ) );
+		
+		__m128 distSqr = _mm_madd_ps( dz, dz, _mm_madd_ps( dy, dy, _mm_mul_ps( dx, dx ) ) );
+		
+		int mask = _mm_movemask_ps( _mm_cmple_ps( distSqr, radiusSqr ) );
+		if( mask == 0 )
+		{
+			continue;
+		}
+		for( int j = 0; mask != 0; j++, mask >>= 1 )
+		{
+			if( mask & 1 )
+			{
+				indexes[count++] = i + j;
+			}
+		}
+	}
+	
+#else
+	
+	for( int i = 0; i < num; i++ )
+	{
+		if( BoundsBatch_SphereIntersectsBounds( sphere, Get( i ) ) )
+		{
+			indexes[count++] = i;
+		}
+	}
+	
+#endif
+	
+	return count;
+}
+
+/*
+============
+idBoundsBatch::FromTransformedBounds
+
+  Same as idBounds::FromTransformedBounds for every bounds, with the same order of operations
+  so the results are bit exact. The batch may be the same as the local bounds batch.
+============
+*/
+void idBoundsBatch::FromTransformedBounds( const idBoundsBatch& localBounds, const idVec3* origins, const idMat3* axes )
+{
+	const int count = localBounds.num;
+	
+	if( count > capacity )
+	{
+		Resize( count + granularity - 1 - ( count + granularity - 1 ) % granularity );
+	}
+	if( count < num )
+	{
+		BoundsBatch_ClearRange( data, capacity, count, num );
+	}
+	num = count;
+	
+	if( count == 0 )
+	{
+		return;
+	}
+	
+#if defined(USE_INTRINSICS)
+	
+	const __m128 vector_float_half = _mm_set1_ps( 0.5f );
+	const __m128 vector_float_abs_mask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+	
+	const float* lmnx = localBounds.Stream( 0, 0 );
+	const float* lmny = localBounds.Stream( 1, 0 );
+	const float* lmnz = localBounds.Stream( 2, 0 );
+	const float* lmxx = localBounds.Stream( 0, 1 );
+	const float* lmxy = localBounds.Stream( 1, 1 );
+	const float* lmxz = localBounds.Stream( 2, 1 );
+	
+	float* mnx = Stream( 0, 0 );
+	float* mny = Stream( 1, 0 );
+	float* mnz = Stream( 2, 0 );
+	float* mxx = Stream( 0, 1 );
+	float* mxy = Stream( 1, 1 );
+	float* mxz = Stream( 2, 1 );
+	
+	for( int i = 0; i < count; i += 4 )
+	{
+		// the padding lanes repeat the last transform and are cleared again below
+		const int i0 = i;
+		const int i1 = Min( i + 1, count - 1 );
+		const int i2 = Min( i + 2, count - 1 );
+		const int i3 = Min( i + 3, count - 1 );
+		
+		const idMat3& m0 = axes[i0];
+		const idMat3& m1 = axes[i1];
+		const idMat3& m2 = axes[i2];
+		const idMat3& m3 = axes[i3];
+		
+		const __m128 a00 = _mm_set_ps( m3[0][0], m2[0][0], m1[0][0], m0[0][0] );
+		const __m128 a01 = _mm_set_ps( m3[0][1], m2[0][1], m1[0][1], m0[0][1] );
+		const __m128 a02 = _mm_set_ps( m3[0][2], m2[0][2], m1[0][2], m0[0][2] );
+		const __m128 a10 = _mm_set_ps( m3[1][0], m2[1][0], m1[1][0], m0[1][0] );
+		const __m128 a11 = _mm_set_ps( m3[1][1], m2[1][1], m1[1][1], m0[1][1] );
+		const __m128 a12 = _mm_set_ps( m3[1][2], m2[1][2], m1[1][2], m0[1][2] );
+		const __m128 a20 = _mm_set_ps( m3[2][0], m2[2][0], m1[2][0], m0[2][0] );
+		const __m128 a21 = _mm_set_ps( m3[2][1], m2[2][1], m1[2][1], m0[2][1] );
+		const __m128 a22 = _mm_set_ps( m3[2][2], m2[2][2], m1[2][2], m0[2][2] );
+		
+		const __m128 ox = _mm_set_ps( origins[i3].x, origins[i2].x, origins[i1].x, origins[i0].x );
+		const __m128 oy = _mm_set_ps( origins[i3].y, origins[i2].y, origins[i1].y, origins[i0].y );
+		const __m128 oz = _mm_set_ps( origins[i3].z, origins[i2].z, origins[i1].z, origins[i0].z );
+		
+		const __m128 maxX = _mm_load_ps( lmxx + i );
+		const __m128 maxY = _mm_load_ps( lmxy + i );
+		const __m128 maxZ = _mm_load_ps( lmxz + i );
+		
+		const __m128 cx = _mm_mul_ps( _mm_add_ps( _mm_load_ps( lmnx + i ), maxX ), vector_float_half );
+		const __m128 cy = _mm_mul_ps( _mm_add_ps( _mm_load_ps( lmny + i ), maxY ), vector_float_half );
+		const __m128 cz = _mm_mul_ps( _mm_add_ps( _mm_load_ps( lmnz + i ), maxZ ), vector_float_half );
+		
+		const __m128 ex = _mm_sub_ps( maxX, cx );
+		const __m128 ey = _mm_sub_ps( maxY, cy );
+		const __m128 ez = _mm_sub_ps( maxZ, cz );
+		
+		const __m128 rx = _mm_add_ps( _mm_add_ps( _mm_and_ps( _mm_mul_ps( ex, a00 ), vector_float_abs_mask ),
+								_mm_and_ps( _mm_mul_ps( ey, a10 ), vector_float_abs_mask ) ),
+								_mm_and_ps( _mm_mul_ps( ez, a20 ), vector_float_abs_mask ) );
+		const __m128 ry = _mm_add_ps( _mm_add_ps( _mm_and_ps( _mm_mul_ps( ex, a01 ), vector_float_abs_mask ),
+								_mm_and_ps( _mm_mul_ps( ey, a11 ), vector_float_abs_mask ) ),
+								_mm_and_ps( _mm_mul_ps( ez, a21 ), vector_float_abs_mask ) );
+		const __m128 rz = _mm_add_ps( _mm_add_ps( _mm_and_ps( _mm_mul_ps( ex, a02 ), vector_float_abs_mask ),
+								_mm_and_ps( _mm_mul_ps( ey, a12 ), vector_float_abs_mask ) ),
+								_mm_and_ps( _mm_mul_ps( ez, a22 ), vector_float_abs_mask ) );
+								
+		const __m128 wx = _mm_add_ps( ox, _mm_madd_ps( a20, cz, _mm_madd_ps( a10, cy, _mm_mul_ps( a00, cx ) ) ) );
+		const __m128 wy = _mm_add_ps( oy, _mm_madd_ps( a21, cz, _mm_madd_ps( a11, cy, _mm_mul_ps( a01, cx ) ) ) );
+		const __m128 wz = _mm_add_ps( oz, _mm_madd_ps( a22, cz, _mm_madd_ps( a12, cy, _mm_mul_ps( a02, cx ) ) ) );
+		
+		_mm_store_ps( mnx + i, _mm_sub_ps( wx, rx ) );
+		_mm_store_ps( mny + i, _mm_sub_ps( wy, ry ) );
+		_mm_store_ps( mnz + i, _mm_sub_ps( wz, rz ) );
+		_mm_store_ps( mxx + i, _mm_add_ps( wx, rx ) );
+		_mm_store_ps( mxy + i, _mm_add_ps( wy, ry ) );
+		_mm_store_ps( mxz + i, _mm_add_ps( wz, rz ) );
+	}
+	
+	BoundsBatch_ClearRange( data, capacity, count, ( count + 3 ) & ~3 );
+	
+#else
+	
+	for( int i = 0; i < count; i++ )
+	{
+		idBounds bounds;
+		bounds.FromTransformedBounds( localBounds.Get( i ), origins[i], axes[i] );
+		Set( i, bounds );
+	}
+	
+#endif
+}
+
+/*
+============
+idBoundsBatch::Test_f
+
+  Compares the batch kernels against looping over idBounds and reports the time per bounds.
+  Without arguments a range of batch sizes is tested, otherwise the arguments are the batch sizes.
+============
+*/
+#define TEST_BATCH_NUM_TESTS		8
+#define TEST_BATCH_NUM_QUERIES		64
+
+void idBoundsBatch::Test_f( const idCmdArgs& args )
+{
+	static const int defaultSizes[] = { 16, 64, 256, 1024, 4096, 16384 };
+	idList<int> sizes;
+	
+	if( args.Argc() > 1 )
+	{
+		for( int i = 1; i < args.Argc(); i++ )
+		{
+			int n = atoi( args.Argv( i ) );
+			if( n > 0 )
+			{
+				sizes.Append( n );
+			}
+		}
+	}
+	else
+	{
+		for( int i = 0; i < sizeof( defaultSizes ) / sizeof( defaultSizes[0] ); i++ )
+		{
+			sizes.Append( defaultSizes[i] );
+		}
+	}
+	
+	idRandom rnd( 0 );
+	idBounds queries[TEST_BATCH_NUM_QUERIES];
+	idSphere spheres[TEST_BATCH_NUM_QUERIES];
+	for( int q = 0; q < TEST_BATCH_NUM_QUERIES; q++ )
+	{
+		idVec3 center( rnd.CRandomFloat() * 4096.0f, rnd.CRandomFloat() * 4096.0f, rnd.CRandomFloat() * 1024.0f );
+		queries[q] = idBounds( center ).Expand( 64.0f + rnd.RandomFloat() * 512.0f );
+		spheres[q] = idSphere( center, 64.0f + rnd.RandomFloat() * 512.0f );
+	}
+	
+	for( int s = 0; s < sizes.Num(); s++ )
+	{
+		const int n = sizes[s];
+		
+		idList<idBounds> local, world1;
+		idList<idVec3> origins;
+		idList<idMat3> axes;
+		idList<int> indexes1, indexes2;
+		idBoundsBatch localBatch, world2;
+		
+		local.SetNum( n );
+		world1.SetNum( n );
+		origins.SetNum( n );
+		axes.SetNum( n );
+		indexes1.SetNum( n );
+		indexes2.SetNum( n );
+		
+		for( int i = 0; i < n; i++ )
+		{
+			idVec3 size( 4.0f + rnd.RandomFloat() * 128.0f, 4.0f + rnd.RandomFloat() * 128.0f, 4.0f + rnd.RandomFloat() * 128.0f );
+			local[i] = idBounds( -size, size );
+			origins[i].Set( rnd.CRandomFloat() * 4096.0f, rnd.CRandomFloat() * 4096.0f, rnd.CRandomFloat() * 1024.0f );
+			axes[i] = idAngles( rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f, rnd.CRandomFloat() * 180.0f ).ToMat3();
+			localBatch.Append( local[i] );
+		}
+		
+		idTimer timer;
+		double best1, best2;
+		bool ok;
+		
+		// transform
+		best1 = best2 = idMath::INFINITY;
+		for( int t = 0; t < TEST_BATCH_NUM_TESTS; t++ )
+		{
+			timer.Clear();
+			timer.Start();
+			for( int i = 0; i < n; i++ )
+			{
+				world1[i].FromTransformedBounds( local[i], origins[i], axes[i] );
+			}
+			timer.Stop();
+			best1 = Min( best1, timer.Milliseconds() );
+			
+			timer.Clear();
+			timer.Start();
+			world2.FromTransformedBounds( localBatch, origins.Ptr(), axes.Ptr() );
+			timer.Stop();
+			best2 = Min( best2, timer.Milliseconds() );
+		}
+		ok = ( world2.Num() == n );
+		for( int i = 0; i < n && ok; i++ )
+		{
+			ok = world1[i].Compare( world2.Get( i ) );
+		}
+		idLib::Printf( "transform %6d: scalar %7.2f ns, batch %7.2f ns, %5.2fx %s\n", n,
+					   best1 * 1e6 / n, best2 * 1e6 / n, best1 / best2, ok ? "ok" : S_COLOR_RED"X" );
+					   
+		// union
+		idBounds union1, union2;
+		best1 = best2 = idMath::INFINITY;
+		for( int t = 0; t < TEST_BATCH_NUM_TESTS; t++ )
+		{
+			timer.Clear();
+			timer.Start();
+			union1.Clear();
+			for( int i = 0; i < n; i++ )
+			{
+				union1.AddBounds( world1[i] );
+			}
+			timer.Stop();
+			best1 = Min( best1, timer.Milliseconds() );
+			
+			timer.Clear();
+			timer.Start();
+			union2 = world2.Union();
+			timer.Stop();
+			best2 = Min( best2, timer.Milliseconds() );
+		}
+		ok = union1.Compare( union2 );
+		idLib::Printf( "union     %6d: scalar %7.2f ns, batch %7.2f ns, %5.2fx %s\n", n,
+					   best1 * 1e6 / n, best2 * 1e6 / n, best1 / best2, ok ? "ok" : S_COLOR_RED"X" );
+					   
+		// bounds and sphere intersection
+		for( int test = 0; test < 2; test++ )
+		{
+			int total1 = 0, total2 = 0;
+			ok = true;
+			best1 = best2 = idMath::INFINITY;
+			for( int t = 0; t < TEST_BATCH_NUM_TESTS; t++ )
+			{
+				total1 = total2 = 0;
+				
+				timer.Clear();
+				timer.Start();
+				for( int q = 0; q < TEST_BATCH_NUM_QUERIES; q++ )
+				{
+					int count = 0;
+					for( int i = 0; i < n; i++ )
+					{
+						if( test == 0 ? queries[q].IntersectsBounds( world1[i] ) : BoundsBatch_SphereIntersectsBounds( spheres[q], world1[i] ) )
+						{
+							indexes1[count++] = i;
+						}
+					}
+					total1 += count;
+				}
+				timer.Stop();
+				best1 = Min( best1, timer.Milliseconds() );
+				
+				timer.Clear();
+				timer.Start();
+				for( int q = 0; q < TEST_BATCH_NUM_QUERIES; q++ )
+				{
+					total2 += ( test == 0 ) ? world2.IntersectsBounds( queries[q], indexes2.Ptr() ) : world2.IntersectsSphere( spheres[q], indexes2.Ptr() );
+				}
+				timer.Stop();
+				best2 = Min( best2, timer.Milliseconds() );
+			}
+			
+			// compare the index lists for every query
+			for( int q = 0; q < TEST_BATCH_NUM_QUERIES && ok; q++ )
+			{
+				int count1 = 0;
+				for( int i = 0; i < n; i++ )
+				{
+					if( test == 0 ? queries[q].IntersectsBounds( world1[i] ) : BoundsBatch_SphereIntersectsBounds( spheres[q], world1[i] ) )
+					{
+						indexes1[count1++] = i;
+					}
+				}
+				int count2 = ( test == 0 ) ? world2.IntersectsBounds( queries[q], indexes2.Ptr() ) : world2.IntersectsSphere( spheres[q], indexes2.Ptr() );
+				ok = ( count1 == count2 && memcmp( indexes1.Ptr(), indexes2.Ptr(), count1 * sizeof( int ) ) == 0 );
+				if( ok && test == 0 )
+				{
+					ok = ( world2.FirstIntersectsBounds( queries[q] ) == ( count1 > 0 ? indexes1[0] : -1 ) );
+				}
+			}
+			
+			const double numTests = ( double ) n * TEST_BATCH_NUM_QUERIES;
+			idLib::Printf( "%s %6d: scalar %7.2f ns, batch %7.2f ns, %5.2fx %s (%d hits)\n", test == 0 ? "bounds   " : "sphere   ", n,
+						   best1 * 1e6 / numTests, best2 * 1e6 / numTests, best1 / best2, ok ? "ok" : S_COLOR_RED"X", total2 );
+		}
+		
+		// removal keeps the padding cleared so the queries still match
+		for( int i = n - 1; i >= 0; i -= 3 )
+		{
+			world1.RemoveIndexFast( i );
+			world2.RemoveIndexFast( i );
+		}
+		ok = ( world1.Num() == world2.Num() );
+		for( int i = 0; i < world1.Num() && ok; i++ )
+		{
+			ok = world1[i].Compare( world2.Get( i ) );
+		}
+		for( int q = 0; q < TEST_BATCH_NUM_QUERIES && ok; q++ )
+		{
+			int count1 = 0;
+			for( int i = 0; i < world1.Num(); i++ )
+			{
+				count1 += queries[q].IntersectsBounds( world1[i] );
+			}
+			ok = ( count1 == world2.IntersectsBounds( queries[q], indexes2.Ptr() ) );
+		}
+		if( !ok )
+		{
+			idLib::Printf( S_COLOR_RED"remove    %6d: X\n", n );
+		}
+	}
+}
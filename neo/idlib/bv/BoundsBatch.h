@@ -0,0 +1,171 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __BV_BOUNDSBATCH_H__
+#define __BV_BOUNDSBATCH_H__
+
+/*
+===============================================================================
+
+	Bounds batch
+
+	Structure of arrays storage for a set of axis aligned bounding boxes, so
+	that a query box can be tested against four boxes at a time.
+
+	The six component streams are padded to a multiple of four with cleared
+	bounds, so the padding never intersects anything and never contributes
+	to a union. Removal moves the last bounds into the freed slot, so an
+	index is only stable until the next RemoveIndexFast.
+
+===============================================================================
+*/
+
+class idBoundsBatch
+{
+public:
+	idBoundsBatch();
+	~idBoundsBatch();
+	
+	void			Clear();									// remove all bounds but keep the memory
+	void			Free();										// remove all bounds and free the memory
+	void			SetNum( int newNum );						// new bounds are cleared
+	void			SetGranularity( int newGranularity );
+	void			SetMemTag( memTag_t tag );
+	
+	int				Num() const;
+	size_t			Allocated() const;
+	
+	int				Append( const idBounds& bounds );			// returns the index of the new bounds
+	void			Set( int index, const idBounds& bounds );
+	idBounds		Get( int index ) const;
+	void			RemoveIndexFast( int index );				// replaces the bounds with the last bounds
+	
+	// union of all bounds, cleared when empty
+	idBounds		Union() const;
+	
+	// writes the indexes of all bounds that intersect the given bounds, includes touching, returns the count
+	// the index list must have room for Num() entries
+	int				IntersectsBounds( const idBounds& bounds, int* indexes ) const;
+	// index of the first bounds that intersects the given bounds or -1
+	int				FirstIntersectsBounds( const idBounds& bounds ) const;
+	// writes the indexes of all bounds that intersect the sphere, includes touching, returns the count
+	int				IntersectsSphere( const idSphere& sphere, int* indexes ) const;
+	
+	// replaces the contents with the most tight world bounds for each of the local bounds
+	void			FromTransformedBounds( const idBoundsBatch& localBounds, const idVec3* origins, const idMat3* axes );
+	
+	static void		Test_f( const class idCmdArgs& args );
+	
+private:
+	float* 			data;				// six streams of capacity floats
+	int				num;
+	int				capacity;			// always a multiple of four
+	int				granularity;
+	memTag_t		memTag;
+	
+	void			Resize( int newCapacity );
+	float* 			Stream( int axis, int side ) const;
+	
+	idBoundsBatch( const idBoundsBatch& );
+	void			operator=( const idBoundsBatch& );
+};
+
+ID_INLINE idBoundsBatch::idBoundsBatch()
+{
+	data = NULL;
+	num = 0;
+	capacity = 0;
+	granularity = 16;
+	memTag = TAG_IDLIB;
+}
+
+ID_INLINE idBoundsBatch::~idBoundsBatch()
+{
+	Free();
+}
+
+ID_INLINE void idBoundsBatch::SetGranularity( int newGranularity )
+{
+	assert( newGranularity > 0 );
+	granularity = ( newGranularity + 3 ) & ~3;
+}
+
+ID_INLINE void idBoundsBatch::SetMemTag( memTag_t tag )
+{
+	memTag = tag;
+}
+
+ID_INLINE int idBoundsBatch::Num() const
+{
+	return num;
+}
+
+ID_INLINE size_t idBoundsBatch::Allocated() const
+{
+	return capacity * 6 * sizeof( float );
+}
+
+ID_INLINE float* idBoundsBatch::Stream( int axis, int side ) const
+{
+	return data + ( side * 3 + axis ) * capacity;
+}
+
+ID_INLINE void idBoundsBatch::Set( int index, const idBounds& bounds )
+{
+	assert( index >= 0 && index < num );
+	for( int i = 0; i < 3; i++ )
+	{
+		data[( 0 + i ) * capacity + index] = bounds[0][i];
+		data[( 3 + i ) * capacity + index] = bounds[1][i];
+	}
+}
+
+ID_INLINE idBounds idBoundsBatch::Get( int index ) const
+{
+	assert( index >= 0 && index < num );
+	idBounds bounds;
+	for( int i = 0; i < 3; i++ )
+	{
+		bounds[0][i] = data[( 0 + i ) * capacity + index];
+		bounds[1][i] = data[( 3 + i ) * capacity + index];
+	}
+	return bounds;
+}
+
+ID_INLINE int idBoundsBatch::Append( const idBounds& bounds )
+{
+	if( num >= capacity )
+	{
+		Resize( capacity + granularity );
+	}
+	num++;
+	Set( num - 1, bounds );
+	return num - 1;
+}
+
+#endif /* !__BV_BOUNDSBATCH_H__ */
@@ -0,0 +1,179 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#pragma hdrstop
+#include "precompiled.h"
+
+/*
+================================================================================================
+
+	Hash Map Benchmark
+
+================================================================================================
+*/
+
+struct hashMapWorkload_t
+{
+	const char* 	name;
+	const char* 	keyFormat;
+	int				numKeys;
+};
+
+// the string keyed lookups of idDict, the decl manager and idGameLocal::FindEntity
+static const hashMapWorkload_t hashMapWorkloads[] =
+{
+	{ "dict keys",		"spawnarg_%d",						32 },
+	{ "decl names",		"textures/base_wall/lfwall%d_d",	8192 },
+	{ "entity names",	"monster_zombie_commando_%d",		2048 },
+};
+
+/*
+========================
+HashMap_BestTime
+
+Runs a lookup loop a few times and returns the fastest in microseconds.
+========================
+*/
+template< class _lookup_ >
+static uint64 HashMap_BestTime( const _lookup_ & lookup, const idStrList& queries, int& found )
+{
+	const int NUM_RUNS = 5;
+	uint64 bestTime = 0;
+	for( int run = 0; run < NUM_RUNS; run++ )
+	{
+		found = 0;
+		const uint64 start = Sys_Microseconds();
+		for( int i = 0; i < queries.Num(); i++ )
+		{
+			found += lookup( queries[i].c_str() );
+		}
+		const uint64 time = Sys_Microseconds() - start;
+		if( run == 0 || time < bestTime )
+		{
+			bestTime = time;
+		}
+	}
+	return bestTime;
+}
+
+class idHashIndexLookup
+{
+public:
+	idHashIndexLookup( const idHashIndex& hash_, const idStrList& keys_ ) : hash( hash_ ), keys( keys_ ) {}
+	int operator()( const char* key ) const
+	{
+		for( int i = hash.First( hash.GenerateKey( key, false ) ); i != -1; i = hash.Next( i ) )
+		{
+			if( keys[i].Icmp( key ) == 0 )
+			{
+				return 1;
+			}
+		}
+		return 0;
+	}
+	const idHashIndex& 	hash;
+	const idStrList& 	keys;
+};
+
+class idHashTableLookup
+{
+public:
+	idHashTableLookup( const idHashTable<int>& table_ ) : table( table_ ) {}
+	int operator()( const char* key ) const
+	{
+		return table.Get( key ) ? 1 : 0;
+	}
+	const idHashTable<int>& 	table;
+};
+
+class idFlatHashMapLookup
+{
+public:
+	idFlatHashMapLookup( const idFlatHashMap< const char*, int >& map_ ) : map( map_ ) {}
+	int operator()( const char* key ) const
+	{
+		return map.Get( key ) ? 1 : 0;
+	}
+	const idFlatHashMap< const char*, int >& 	map;
+};
+
+/*
+========================
+testHashMaps
+========================
+*/
+CONSOLE_COMMAND( testHashMaps, "compares string lookups in idHashIndex, idHashTable and idFlatHashMap, usage: testHashMaps [numLookups]", 0 )
+{
+	const int numLookups = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 1000000;
+	idRandom random( 0 );
+	
+	idLib::Printf( "%d lookups per test, half of them misses, best of 5 runs\n", numLookups );
+	idLib::Printf( "%-14s %8s %12s %12s %12s\n", "workload", "keys", "idHashIndex", "idHashTable", "idFlatHashMap" );
+	for( int w = 0; w < sizeof( hashMapWorkloads ) / sizeof( hashMapWorkloads[0] ); w++ )
+	{
+		const hashMapWorkload_t& workload = hashMapWorkloads[w];
+		
+		idStrList keys;
+		keys.SetNum( workload.numKeys );
+		for( int i = 0; i < workload.numKeys; i++ )
+		{
+			keys[i] = va( workload.keyFormat, i );
+		}
+		
+		// every other query misses, with a key that looks like the others
+		idStrList queries;
+		queries.SetNum( numLookups );
+		for( int i = 0; i < numLookups; i++ )
+		{
+			const int key = random.RandomInt( workload.numKeys );
+			queries[i] = ( i & 1 ) ? va( workload.keyFormat, workload.numKeys + key ) : keys[key].c_str();
+		}
+		
+		idHashIndex hashIndex;
+		idHashTable<int> hashTable;
+		idFlatHashMap< const char*, int > flatMap;
+		for( int i = 0; i < workload.numKeys; i++ )
+		{
+			hashIndex.Add( hashIndex.GenerateKey( keys[i], false ), i );
+			hashTable.Set( keys[i], i );
+			flatMap.Set( keys[i].c_str(), i );
+		}
+		
+		int found[3];
+		const uint64 hashIndexTime = HashMap_BestTime( idHashIndexLookup( hashIndex, keys ), queries, found[0] );
+		const uint64 hashTableTime = HashMap_BestTime( idHashTableLookup( hashTable ), queries, found[1] );
+		const uint64 flatMapTime = HashMap_BestTime( idFlatHashMapLookup( flatMap ), queries, found[2] );
+		if( found[0] != found[1] || found[0] != found[2] )
+		{
+			idLib::Printf( "%s: lookups disagree, %d %d %d found\n", workload.name, found[0], found[1], found[2] );
+		}
+		
+		idLib::Printf( "%-14s %8d %10.1fms %10.1fms %10.1fms\n", workload.name, workload.numKeys,
+					   hashIndexTime / 1000.0f, hashTableTime / 1000.0f, flatMapTime / 1000.0f );
+	}
+}
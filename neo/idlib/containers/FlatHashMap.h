@@ -0,0 +1,733 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __FLATHASHMAP_H__
+#define __FLATHASHMAP_H__
+
+/*
+===============================================================================
+
+	Open addressing hash map.
+
+	The keys and values are stored in one array of slots. A separate array
+	holds a control byte per slot with 7 bits of the hash of the key, so a
+	lookup compares 16 control bytes at once and usually touches a single
+	slot. Does not allocate memory until the first key/value pair is added.
+
+===============================================================================
+*/
+
+/*
+================================================
+idFlatHashTraitsT provides the hash and comparison of a key type. Integer
+keys are used as is, the map mixes the bits of every hash.
+================================================
+*/
+template< typename _key_ >
+class idFlatHashTraitsT
+{
+public:
+	static unsigned int	GetHash( const _key_ & key )
+	{
+		return ( unsigned int )key;
+	}
+	static bool			Equals( const _key_ & key1, const _key_ & key2 )
+	{
+		return key1 == key2;
+	}
+};
+
+// strings are case insensitive, the same as in idDict and the decl manager
+template<>
+class idFlatHashTraitsT< idStr >
+{
+public:
+	static unsigned int	GetHash( const idStr& key )
+	{
+		return ( unsigned int )idStr::IHash( key.c_str() );
+	}
+	static bool			Equals( const idStr& key1, const idStr& key2 )
+	{
+		return key1.Icmp( key2 ) == 0;
+	}
+};
+
+// the map only stores the pointer, the string must stay valid while it is in the map
+template<>
+class idFlatHashTraitsT< const char* >
+{
+public:
+	static unsigned int	GetHash( const char* const& key )
+	{
+		return ( unsigned int )idStr::IHash( key );
+	}
+	static bool			Equals( const char* const& key1, const char* const& key2 )
+	{
+		// pooled and interned strings usually compare equal by address
+		return key1 == key2 || idStr::Icmp( key1, key2 ) == 0;
+	}
+};
+
+/*
+================================================
+idFlatHashMap is a Swiss table style hash map with SSE2 probing of the control bytes.
+
+Adding or removing pairs moves no other pairs, but a rehash when the map grows does,
+so pointers to values are only valid until the next Set.
+================================================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ = TAG_IDLIB_HASH >
+class idFlatHashMap
+{
+public:
+	idFlatHashMap();
+	idFlatHashMap( const idFlatHashMap& other );
+	~idFlatHashMap();
+	
+	// returns total size of allocated memory
+	size_t			Allocated() const;
+	// returns total size of allocated memory including size of hash map type
+	size_t			Size() const;
+	
+	// adds the pair or replaces the value of an existing key
+	_value_& 		Set( const _key_ & key, const _value_ & value );
+	
+	bool			Get( const _key_ & key, _value_** value = NULL );
+	bool			Get( const _key_ & key, const _value_** value = NULL ) const;
+	
+	// lookup with a hash from GenerateHash that was computed once up front
+	static unsigned int	GenerateHash( const _key_ & key );
+	bool			GetHashed( const _key_ & key, unsigned int hash, const _value_** value = NULL ) const;
+	
+	bool			Remove( const _key_ & key );
+	
+	// makes room for num pairs without rehashing
+	void			Reserve( int num );
+	// removes all pairs but keeps the memory
+	void			Clear();
+	// removes all pairs and frees the memory
+	void			Free();
+	
+	int				Num() const;
+	
+	// the pairs can be iterated over by slot, most slots are empty
+	int				NumSlots() const;
+	bool			IsSlotUsed( int slot ) const;
+	const _key_ & 	GetSlotKey( int slot ) const;
+	_value_& 		GetSlotValue( int slot ) const;
+	
+	idFlatHashMap& 	operator=( const idFlatHashMap& other );
+	
+private:
+	static const int	GROUP_SIZE = 16;
+	static const int	MIN_CAPACITY = 16;
+	static const int8	CTRL_EMPTY = -128;
+	static const int8	CTRL_DELETED = -2;
+	
+	struct slot_t
+	{
+		_key_		key;
+		_value_		value;
+	};
+	
+	int8* 			ctrl;		// capacity + GROUP_SIZE bytes, the last group mirrors the first
+	slot_t* 		slots;
+	int				capacity;	// power of two
+	int				num;
+	int				numDeleted;
+	
+	static unsigned int	MixHash( unsigned int hash );
+	static unsigned int	MatchMask( const int8* group, int8 value );
+	static unsigned int	FreeMask( const int8* group );
+	static int		LowestBit( unsigned int mask );
+	
+	int				FindSlot( const _key_ & key, unsigned int hash ) const;
+	int				FindFreeSlot( unsigned int hash ) const;
+	void			SetCtrl( int slot, int8 value );
+	void			Rehash( int newCapacity );
+	void			DestroySlots();
+};
+
+/*
+========================
+idFlatHashMap::idFlatHashMap
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE idFlatHashMap< _key_, _value_, _tag_ >::idFlatHashMap() :
+	ctrl( NULL ),
+	slots( NULL ),
+	capacity( 0 ),
+	num( 0 ),
+	numDeleted( 0 )
+{
+}
+
+/*
+========================
+idFlatHashMap::idFlatHashMap
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE idFlatHashMap< _key_, _value_, _tag_ >::idFlatHashMap( const idFlatHashMap& other ) :
+	ctrl( NULL ),
+	slots( NULL ),
+	capacity( 0 ),
+	num( 0 ),
+	numDeleted( 0 )
+{
+	*this = other;
+}
+
+/*
+========================
+idFlatHashMap::~idFlatHashMap
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE idFlatHashMap< _key_, _value_, _tag_ >::~idFlatHashMap()
+{
+	Free();
+}
+
+/*
+========================
+idFlatHashMap::Allocated
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE size_t idFlatHashMap< _key_, _value_, _tag_ >::Allocated() const
+{
+	return ( capacity > 0 ) ? capacity * sizeof( slot_t ) + ( capacity + GROUP_SIZE ) * sizeof( ctrl[0] ) : 0;
+}
+
+/*
+========================
+idFlatHashMap::Size
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE size_t idFlatHashMap< _key_, _value_, _tag_ >::Size() const
+{
+	return sizeof( *this ) + Allocated();
+}
+
+/*
+========================
+idFlatHashMap::Set
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE _value_& idFlatHashMap< _key_, _value_, _tag_ >::Set( const _key_ & key, const _value_ & value )
+{
+	unsigned int hash = MixHash( idFlatHashTraitsT< _key_ >::GetHash( key ) );
+	int slot = FindSlot( key, hash );
+	if( slot >= 0 )
+	{
+		slots[slot].value = value;
+		return slots[slot].value;
+	}
+	
+	// keep the load including removed slots below 7/8
+	if( ( num + numDeleted + 1 ) * 8 > capacity * 7 )
+	{
+		Rehash( ( ( num + 1 ) * 2 > capacity ) ? Max( capacity * 2, ( int )MIN_CAPACITY ) : capacity );
+	}
+	
+	slot = FindFreeSlot( hash );
+	if( ctrl[slot] == CTRL_DELETED )
+	{
+		numDeleted--;
+	}
+	SetCtrl( slot, ( int8 )( hash & 0x7F ) );
+	new( &slots[slot].key ) _key_( key );
+	new( &slots[slot].value ) _value_( value );
+	num++;
+	return slots[slot].value;
+}
+
+/*
+========================
+idFlatHashMap::Get
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE bool idFlatHashMap< _key_, _value_, _tag_ >::Get( const _key_ & key, _value_** value )
+{
+	const int slot = FindSlot( key, MixHash( idFlatHashTraitsT< _key_ >::GetHash( key ) ) );
+	if( slot < 0 )
+	{
+		if( value != NULL )
+		{
+			*value = NULL;
+		}
+		return false;
+	}
+	if( value != NULL )
+	{
+		*value = &slots[slot].value;
+	}
+	return true;
+}
+
+/*
+========================
+idFlatHashMap::Get
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE bool idFlatHashMap< _key_, _value_, _tag_ >::Get( const _key_ & key, const _value_** value ) const
+{
+	const int slot = FindSlot( key, MixHash( idFlatHashTraitsT< _key_ >::GetHash( key ) ) );
+	if( slot < 0 )
+	{
+		if( value != NULL )
+		{
+			*value = NULL;
+		}
+		return false;
+	}
+	if( value != NULL )
+	{
+		*value = &slots[slot].value;
+	}
+	return true;
+}
+
+/*
+========================
+idFlatHashMap::GenerateHash
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE unsigned int idFlatHashMap< _key_, _value_, _tag_ >::GenerateHash( const _key_ & key )
+{
+	return MixHash( idFlatHashTraitsT< _key_ >::GetHash( key ) );
+}
+
+/*
+========================
+idFlatHashMap::GetHashed
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE bool idFlatHashMap< _key_, _value_, _tag_ >::GetHashed( const _key_ & key, unsigned int hash, const _value_** value ) const
+{
+	assert( hash == GenerateHash( key ) );
+	const int slot = FindSlot( key, hash );
+	if( slot < 0 )
+	{
+		if( value != NULL )
+		{
+			*value = NULL;
+		}
+		return false;
+	}
+	if( value != NULL )
+	{
+		*value = &slots[slot].value;
+	}
+	return true;
+}
+
+/*
+========================
+idFlatHashMap::Remove
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE bool idFlatHashMap< _key_, _value_, _tag_ >::Remove( const _key_ & key )
+{
+	const int slot = FindSlot( key, MixHash( idFlatHashTraitsT< _key_ >::GetHash( key ) ) );
+	if( slot < 0 )
+	{
+		return false;
+	}
+	slots[slot].key.~_key_();
+	slots[slot].value.~_value_();
+	
+	// probes don't stop at removed slots, they become free again on the next rehash
+	SetCtrl( slot, CTRL_DELETED );
+	numDeleted++;
+	num--;
+	return true;
+}
+
+/*
+========================
+idFlatHashMap::Reserve
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE void idFlatHashMap< _key_, _value_, _tag_ >::Reserve( int numPairs )
+{
+	int newCapacity = MIN_CAPACITY;
+	while( numPairs * 8 > newCapacity * 7 )
+	{
+		newCapacity *= 2;
+	}
+	if( newCapacity > capacity )
+	{
+		Rehash( newCapacity );
+	}
+}
+
+/*
+========================
+idFlatHashMap::Clear
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE void idFlatHashMap< _key_, _value_, _tag_ >::Clear()
+{
+	if( capacity == 0 )
+	{
+		return;
+	}
+	DestroySlots();
+	memset( ctrl, CTRL_EMPTY, capacity + GROUP_SIZE );
+	num = 0;
+	numDeleted = 0;
+}
+
+/*
+========================
+idFlatHashMap::Free
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE void idFlatHashMap< _key_, _value_, _tag_ >::Free()
+{
+	if( capacity == 0 )
+	{
+		return;
+	}
+	DestroySlots();
+	Mem_Free( ctrl );
+	Mem_Free( slots );
+	ctrl = NULL;
+	slots = NULL;
+	capacity = 0;
+	num = 0;
+	numDeleted = 0;
+}
+
+/*
+========================
+idFlatHashMap::Num
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE int idFlatHashMap< _key_, _value_, _tag_ >::Num() const
+{
+	return num;
+}
+
+/*
+========================
+idFlatHashMap::NumSlots
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE int idFlatHashMap< _key_, _value_, _tag_ >::NumSlots() const
+{
+	return capacity;
+}
+
+/*
+========================
+idFlatHashMap::IsSlotUsed
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE bool idFlatHashMap< _key_, _value_, _tag_ >::IsSlotUsed( int slot ) const
+{
+	assert( slot >= 0 && slot < capacity );
+	return ctrl[slot] >= 0;
+}
+
+/*
+========================
+idFlatHashMap::GetSlotKey
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE const _key_ & idFlatHashMap< _key_, _value_, _tag_ >::GetSlotKey( int slot ) const
+{
+	assert( IsSlotUsed( slot ) );
+	return slots[slot].key;
+}
+
+/*
+========================
+idFlatHashMap::GetSlotValue
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE _value_& idFlatHashMap< _key_, _value_, _tag_ >::GetSlotValue( int slot ) const
+{
+	assert( IsSlotUsed( slot ) );
+	return slots[slot].value;
+}
+
+/*
+========================
+idFlatHashMap::operator=
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE idFlatHashMap< _key_, _value_, _tag_ >& idFlatHashMap< _key_, _value_, _tag_ >::operator=( const idFlatHashMap& other )
+{
+	if( this == &other )
+	{
+		return *this;
+	}
+	Clear();
+	Reserve( other.num );
+	for( int i = 0; i < other.capacity; i++ )
+	{
+		if( other.ctrl[i] >= 0 )
+		{
+			Set( other.slots[i].key, other.slots[i].value );
+		}
+	}
+	return *this;
+}
+
+/*
+========================
+idFlatHashMap::MixHash
+
+The key hashes are often weak in the low bits, like idStr::Hash.
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE unsigned int idFlatHashMap< _key_, _value_, _tag_ >::MixHash( unsigned int hash )
+{
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+/*
+========================
+idFlatHashMap::MatchMask
+
+Returns a bit for each of the 16 control bytes that equals the value.
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE unsigned int idFlatHashMap< _key_, _value_, _tag_ >::MatchMask( const int8* group, int8 value )
+{
+#if defined(USE_INTRINSICS)
+	const __m128i bytes = _mm_loadu_si128( ( const __m128i* )group );
+	return ( unsigned int )_mm_movemask_epi8( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( value ) ) );
+#else
+	unsigned int mask = 0;
+	for( int i = 0; i < GROUP_SIZE; i++ )
+	{
+		mask |= ( unsigned int )( group[i] == value ) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+========================
+idFlatHashMap::FreeMask
+
+Returns a bit for each of the 16 control bytes that is empty or removed.
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE unsigned int idFlatHashMap< _key_, _value_, _tag_ >::FreeMask( const int8* group )
+{
+#if defined(USE_INTRINSICS)
+	// the free control bytes are the only ones with the sign bit set
+	return ( unsigned int )_mm_movemask_epi8( _mm_loadu_si128( ( const __m128i* )group ) );
+#else
+	unsigned int mask = 0;
+	for( int i = 0; i < GROUP_SIZE; i++ )
+	{
+		mask |= ( unsigned int )( group[i] < 0 ) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+========================
+idFlatHashMap::LowestBit
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE int idFlatHashMap< _key_, _value_, _tag_ >::LowestBit( unsigned int mask )
+{
+	assert( mask != 0 );
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward( &index, mask );
+	return ( int )index;
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+/*
+========================
+idFlatHashMap::FindSlot
+
+Returns -1 if the key is not in the map.
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE int idFlatHashMap< _key_, _value_, _tag_ >::FindSlot( const _key_ & key, unsigned int hash ) const
+{
+	if( num == 0 )
+	{
+		return -1;
+	}
+	const int mask = capacity - 1;
+	const int8 tag = ( int8 )( hash & 0x7F );
+	int pos = ( int )( hash >> 7 ) & mask;
+	for( int step = GROUP_SIZE; ; step += GROUP_SIZE )
+	{
+		for( unsigned int match = MatchMask( &ctrl[pos], tag ); match != 0; match &= match - 1 )
+		{
+			const int slot = ( pos + LowestBit( match ) ) & mask;
+			if( idFlatHashTraitsT< _key_ >::Equals( slots[slot].key, key ) )
+			{
+				return slot;
+			}
+		}
+		if( MatchMask( &ctrl[pos], CTRL_EMPTY ) != 0 )
+		{
+			return -1;
+		}
+		// triangular probing visits every group once when the capacity is a power of two
+		pos = ( pos + step ) & mask;
+	}
+}
+
+/*
+========================
+idFlatHashMap::FindFreeSlot
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE int idFlatHashMap< _key_, _value_, _tag_ >::FindFreeSlot( unsigned int hash ) const
+{
+	const int mask = capacity - 1;
+	int pos = ( int )( hash >> 7 ) & mask;
+	for( int step = GROUP_SIZE; ; step += GROUP_SIZE )
+	{
+		const unsigned int free = FreeMask( &ctrl[pos] );
+		if( free != 0 )
+		{
+			return ( pos + LowestBit( free ) ) & mask;
+		}
+		pos = ( pos + step ) & mask;
+	}
+}
+
+/*
+========================
+idFlatHashMap::SetCtrl
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE void idFlatHashMap< _key_, _value_, _tag_ >::SetCtrl( int slot, int8 value )
+{
+	ctrl[slot] = value;
+	if( slot < GROUP_SIZE )
+	{
+		ctrl[capacity + slot] = value;
+	}
+}
+
+/*
+========================
+idFlatHashMap::Rehash
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE void idFlatHashMap< _key_, _value_, _tag_ >::Rehash( int newCapacity )
+{
+	assert( idMath::IsPowerOfTwo( newCapacity ) && newCapacity >= MIN_CAPACITY );
+	
+	int8* oldCtrl = ctrl;
+	slot_t* oldSlots = slots;
+	const int oldCapacity = capacity;
+	
+	ctrl = ( int8* )Mem_Alloc( newCapacity + GROUP_SIZE, _tag_ );
+	slots = ( slot_t* )Mem_Alloc( newCapacity * sizeof( slot_t ), _tag_ );
+	memset( ctrl, CTRL_EMPTY, newCapacity + GROUP_SIZE );
+	capacity = newCapacity;
+	numDeleted = 0;
+	
+	for( int i = 0; i < oldCapacity; i++ )
+	{
+		if( oldCtrl[i] < 0 )
+		{
+			continue;
+		}
+		const unsigned int hash = MixHash( idFlatHashTraitsT< _key_ >::GetHash( oldSlots[i].key ) );
+		const int slot = FindFreeSlot( hash );
+		SetCtrl( slot, ( int8 )( hash & 0x7F ) );
+		new( &slots[slot].key ) _key_( oldSlots[i].key );
+		new( &slots[slot].value ) _value_( oldSlots[i].value );
+		oldSlots[i].key.~_key_();
+		oldSlots[i].value.~_value_();
+	}
+	
+	Mem_Free( oldCtrl );
+	Mem_Free( oldSlots );
+}
+
+/*
+========================
+idFlatHashMap::DestroySlots
+========================
+*/
+template< typename _key_, class _value_, memTag_t _tag_ >
+ID_INLINE void idFlatHashMap< _key_, _value_, _tag_ >::DestroySlots()
+{
+	for( int i = 0; i < capacity; i++ )
+	{
+		if( ctrl[i] >= 0 )
+		{
+			slots[i].key.~_key_();
+			slots[i].value.~_value_();
+		}
+	}
+}
+
+#endif // !__FLATHASHMAP_H__
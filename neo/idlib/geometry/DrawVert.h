@@ -112,13 +112,18 @@ ID_INLINE halfFloat_t F32toF16( float a )
 ===============================================================================
 */
 
+class idDrawVertCompact;
+
 class idDrawVert
 {
 	friend class idSwap;
 	friend class idShadowVertSkinned;
 	friend class idRenderModelStatic;
+	friend class idDrawVertCompact;
 	
 	friend void TransformVertsAndTangents( idDrawVert* targetVerts, const int numVerts, const idDrawVert* baseVerts, const idJointMat* joints );
+	friend void PackDrawVertsCompact( idDrawVertCompact* compactVerts, const idDrawVert* verts, const int numVerts, const idBounds& bounds );
+	friend void UnpackDrawVertsCompact( idDrawVert* verts, const idDrawVertCompact* compactVerts, const int numVerts, const idBounds& bounds );
 	
 public:
 	idVec3				xyz;			// 12 bytes
@@ -821,4 +826,174 @@ ID_INLINE void idShadowVertSkinned::Clear()
 	xyzw.Zero();
 }
 
+/*
+===============================================================================
+
+	Compact Draw Vertex.
+
+	Half the size of an idDrawVert. The position is quantized to 16 bits relative to the
+	bounds of the surface, the normal and tangent are octahedral vectors with 8 bits per
+	component, and the texture coordinates are the same half-floats as in idDrawVert.
+	There are no vertex colors or skinning weights, so skinned surfaces can't use it.
+	
+	Every surface is quantized to its own bounds, so the position error along an axis
+	is at most half a step, ( bounds[1] - bounds[0] ) / ( 2 * 65535 ), plus the float
+	rounding of the unpacked position. That is 1/64th of a unit for a surface that is
+	2048 units across. Normals and tangents stay within about 1.2 degrees of the
+	idDrawVert bytes, COMPACT_NORMAL_MIN_DOT leaves some room over that.
+
+===============================================================================
+*/
+
+#define COMPACT_POSITION_MAX		65535.0f
+#define COMPACT_NORMAL_MIN_DOT		0.999f		// about 2.5 degrees
+
+/*
+========================
+OctahedralEncode
+
+Maps a unit vector onto the octahedron and stores the two remaining coordinates as bytes.
+========================
+*/
+ID_INLINE void OctahedralEncode( float x, float y, float z, byte* oct )
+{
+	const float invLength = 1.0f / Max( idMath::Fabs( x ) + idMath::Fabs( y ) + idMath::Fabs( z ), idMath::FLT_SMALLEST_NON_DENORMAL );
+	float px = x * invLength;
+	float py = y * invLength;
+	if( z < 0.0f )
+	{
+		// fold the lower hemisphere over the diagonals
+		const float fx = ( 1.0f - idMath::Fabs( py ) ) * ( ( px >= 0.0f ) ? 1.0f : -1.0f );
+		const float fy = ( 1.0f - idMath::Fabs( px ) ) * ( ( py >= 0.0f ) ? 1.0f : -1.0f );
+		px = fx;
+		py = fy;
+	}
+	oct[0] = VERTEX_FLOAT_TO_BYTE( px );
+	oct[1] = VERTEX_FLOAT_TO_BYTE( py );
+}
+
+/*
+========================
+OctahedralDecode
+========================
+*/
+ID_INLINE const idVec3 OctahedralDecode( const byte* oct )
+{
+	idVec3 v( VERTEX_BYTE_TO_FLOAT( oct[0] ), VERTEX_BYTE_TO_FLOAT( oct[1] ), 0.0f );
+	v.z = 1.0f - idMath::Fabs( v.x ) - idMath::Fabs( v.y );
+	const float t = Max( -v.z, 0.0f );
+	v.x += ( v.x >= 0.0f ) ? -t : t;
+	v.y += ( v.y >= 0.0f ) ? -t : t;
+	v.Normalize();
+	return v;
+}
+
+class idDrawVertCompact
+{
+public:
+	unsigned short		xyz[3];			// 6 bytes -- position relative to the surface bounds
+	byte				biTangentSign;	// 1 byte -- same as idDrawVert::tangent[3]
+	byte				pad;			// 1 byte
+	halfFloat_t			st[2];			// 4 bytes
+	byte				normal[2];		// 2 bytes -- octahedral
+	byte				tangent[2];		// 2 bytes -- octahedral
+	
+	void				Pack( const idDrawVert& vert, const idVec3& boundsMin, const idVec3& quantizeScale );
+	void				Unpack( idDrawVert& vert, const idVec3& boundsMin, const idVec3& dequantizeScale ) const;
+	
+	// scales from the bounds to the 16 bit positions and back
+	static void			GetQuantizeScale( const idBounds& bounds, idVec3& quantizeScale, idVec3& dequantizeScale );
+	
+	// largest distance between a position and its quantized position for a surface with these bounds
+	static float		GetMaxPositionError( const idBounds& bounds );
+};
+
+#define DRAWVERT_COMPACT_SIZE				16
+#define DRAWVERT_COMPACT_XYZ_OFFSET			(0)
+#define DRAWVERT_COMPACT_ST_OFFSET			(8)
+#define DRAWVERT_COMPACT_NORMAL_OFFSET		(12)
+#define DRAWVERT_COMPACT_TANGENT_OFFSET		(14)
+
+assert_sizeof( idDrawVertCompact, DRAWVERT_COMPACT_SIZE );
+assert_offsetof( idDrawVertCompact, xyz, DRAWVERT_COMPACT_XYZ_OFFSET );
+assert_offsetof( idDrawVertCompact, st, DRAWVERT_COMPACT_ST_OFFSET );
+assert_offsetof( idDrawVertCompact, normal, DRAWVERT_COMPACT_NORMAL_OFFSET );
+assert_offsetof( idDrawVertCompact, tangent, DRAWVERT_COMPACT_TANGENT_OFFSET );
+
+/*
+========================
+idDrawVertCompact::GetQuantizeScale
+========================
+*/
+ID_INLINE void idDrawVertCompact::GetQuantizeScale( const idBounds& bounds, idVec3& quantizeScale, idVec3& dequantizeScale )
+{
+	for( int i = 0; i < 3; i++ )
+	{
+		const float size = bounds[1][i] - bounds[0][i];
+		quantizeScale[i] = ( size > 0.0f ) ? COMPACT_POSITION_MAX / size : 0.0f;
+		dequantizeScale[i] = size * ( 1.0f / COMPACT_POSITION_MAX );
+	}
+}
+
+/*
+========================
+idDrawVertCompact::GetMaxPositionError
+========================
+*/
+ID_INLINE float idDrawVertCompact::GetMaxPositionError( const idBounds& bounds )
+{
+	const idVec3 size = bounds[1] - bounds[0];
+	float magnitude = 0.0f;
+	for( int i = 0; i < 3; i++ )
+	{
+		magnitude = Max( magnitude, Max( idMath::Fabs( bounds[0][i] ), idMath::Fabs( bounds[1][i] ) ) );
+	}
+	// the unpacked position is min + q * scale in floats, which rounds a few ulps
+	return Max( Max( size.x, size.y ), size.z ) * ( 0.5f / COMPACT_POSITION_MAX ) + magnitude * ( 4.0f * idMath::FLT_EPSILON );
+}
+
+/*
+========================
+idDrawVertCompact::Pack
+========================
+*/
+ID_INLINE void idDrawVertCompact::Pack( const idDrawVert& vert, const idVec3& boundsMin, const idVec3& quantizeScale )
+{
+	for( int i = 0; i < 3; i++ )
+	{
+		const float q = ( vert.xyz[i] - boundsMin[i] ) * quantizeScale[i] + 0.5f;
+		xyz[i] = ( unsigned short )( int )Min( Max( q, 0.0f ), COMPACT_POSITION_MAX );
+	}
+	biTangentSign = vert.tangent[3];
+	pad = 0;
+	st[0] = vert.st[0];
+	st[1] = vert.st[1];
+	OctahedralEncode( VERTEX_BYTE_TO_FLOAT( vert.normal[0] ), VERTEX_BYTE_TO_FLOAT( vert.normal[1] ), VERTEX_BYTE_TO_FLOAT( vert.normal[2] ), normal );
+	OctahedralEncode( VERTEX_BYTE_TO_FLOAT( vert.tangent[0] ), VERTEX_BYTE_TO_FLOAT( vert.tangent[1] ), VERTEX_BYTE_TO_FLOAT( vert.tangent[2] ), tangent );
+}
+
+/*
+========================
+idDrawVertCompact::Unpack
+========================
+*/
+ID_INLINE void idDrawVertCompact::Unpack( idDrawVert& vert, const idVec3& boundsMin, const idVec3& dequantizeScale ) const
+{
+	vert.Clear();
+	for( int i = 0; i < 3; i++ )
+	{
+		vert.xyz[i] = boundsMin[i] + xyz[i] * dequantizeScale[i];
+	}
+	vert.st[0] = st[0];
+	vert.st[1] = st[1];
+	const idVec3 n = OctahedralDecode( normal );
+	const idVec3 t = OctahedralDecode( tangent );
+	for( int i = 0; i < 3; i++ )
+	{
+		vert.normal[i] = VERTEX_FLOAT_TO_BYTE( n[i] );
+		vert.tangent[i] = VERTEX_FLOAT_TO_BYTE( t[i] );
+	}
+	vert.tangent[3] = biTangentSign;
+}
+
 #endif /* !__DRAWVERT_H__ */
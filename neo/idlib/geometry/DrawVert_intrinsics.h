@@ -51,6 +51,18 @@ static const __m128 vector_float_last_one						= {   0.0f,	  0.0f,   0.0f,   1.0
 static const __m128 vector_float_1_over_255						= { 1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f };
 static const __m128 vector_float_1_over_4						= { 1.0f / 4.0f, 1.0f / 4.0f, 1.0f / 4.0f, 1.0f / 4.0f };
 
+static const __m128i vector_int_byte_mask						= _mm_set1_epi32( 0xFF );
+static const __m128 vector_float_sign_mask						= __m128c( _mm_set1_epi32( IEEE_FLT_SIGN_MASK ) );
+static const __m128 vector_float_zero							= { 0.0f, 0.0f, 0.0f, 0.0f };
+static const __m128 vector_float_one							= { 1.0f, 1.0f, 1.0f, 1.0f };
+static const __m128 vector_float_half							= { 0.5f, 0.5f, 0.5f, 0.5f };
+static const __m128 vector_float_neg_one						= { -1.0f, -1.0f, -1.0f, -1.0f };
+static const __m128 vector_float_255							= { 255.0f, 255.0f, 255.0f, 255.0f };
+static const __m128 vector_float_2_over_255						= { 2.0f / 255.0f, 2.0f / 255.0f, 2.0f / 255.0f, 2.0f / 255.0f };
+static const __m128 vector_float_255_over_2						= { 255.0f / 2.0f, 255.0f / 2.0f, 255.0f / 2.0f, 255.0f / 2.0f };
+static const __m128 vector_float_compact_position_max			= { COMPACT_POSITION_MAX, COMPACT_POSITION_MAX, COMPACT_POSITION_MAX, COMPACT_POSITION_MAX };
+static const __m128 vector_float_smallest_non_denorm			= { 1.1754944e-038f, 1.1754944e-038f, 1.1754944e-038f, 1.1754944e-038f };
+
 #endif
 
 /*
@@ -204,4 +216,255 @@ ID_INLINE_EXTERN idVec3 Scalar_LoadSkinnedDrawVertPosition( const idDrawVert& ve
 	return accum * idVec4( vert.xyz.x, vert.xyz.y, vert.xyz.z, 1.0f );
 }
 
+/*
+====================
+VertexBytesToFloats
+
+Converts the first three bytes of four packed vectors to the range [-1, 1].
+====================
+*/
+#if defined(USE_INTRINSICS)
+ID_INLINE_EXTERN void VertexBytesToFloats( __m128i packed, __m128& x, __m128& y, __m128& z )
+{
+	x = _mm_cvtepi32_ps( _mm_and_si128( packed, vector_int_byte_mask ) );
+	y = _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( packed, 8 ), vector_int_byte_mask ) );
+	z = _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( packed, 16 ), vector_int_byte_mask ) );
+	
+	x = _mm_madd_ps( x, vector_float_2_over_255, vector_float_neg_one );
+	y = _mm_madd_ps( y, vector_float_2_over_255, vector_float_neg_one );
+	z = _mm_madd_ps( z, vector_float_2_over_255, vector_float_neg_one );
+}
+
+/*
+====================
+VertexFloatsToBytes
+
+Same as VERTEX_FLOAT_TO_BYTE for four values.
+====================
+*/
+ID_INLINE_EXTERN __m128i VertexFloatsToBytes( __m128 x )
+{
+	x = _mm_madd_ps( _mm_add_ps( x, vector_float_one ), vector_float_255_over_2, vector_float_half );
+	x = _mm_min_ps( _mm_max_ps( x, vector_float_zero ), vector_float_255 );
+	return _mm_cvttps_epi32( x );
+}
+
+/*
+====================
+OctahedralEncode4
+
+Same as OctahedralEncode for four vectors, returns the two bytes of each vector in the low 16 bits.
+====================
+*/
+ID_INLINE_EXTERN __m128i OctahedralEncode4( __m128 x, __m128 y, __m128 z )
+{
+	__m128 length = _mm_add_ps( _mm_add_ps( _mm_andnot_ps( vector_float_sign_mask, x ), _mm_andnot_ps( vector_float_sign_mask, y ) ), _mm_andnot_ps( vector_float_sign_mask, z ) );
+	__m128 invLength = _mm_div_ps( vector_float_one, _mm_max_ps( length, vector_float_smallest_non_denorm ) );
+	
+	__m128 px = _mm_mul_ps( x, invLength );
+	__m128 py = _mm_mul_ps( y, invLength );
+	
+	// fold the lower hemisphere over the diagonals
+	__m128 signX = _mm_and_ps( _mm_cmplt_ps( px, vector_float_zero ), vector_float_sign_mask );
+	__m128 signY = _mm_and_ps( _mm_cmplt_ps( py, vector_float_zero ), vector_float_sign_mask );
+	__m128 fx = _mm_or_ps( _mm_sub_ps( vector_float_one, _mm_andnot_ps( vector_float_sign_mask, py ) ), signX );
+	__m128 fy = _mm_or_ps( _mm_sub_ps( vector_float_one, _mm_andnot_ps( vector_float_sign_mask, px ) ), signY );
+	
+	__m128 lower = _mm_cmplt_ps( z, vector_float_zero );
+	px = _mm_sel_ps( px, fx, lower );
+	py = _mm_sel_ps( py, fy, lower );
+	
+	return _mm_or_si128( VertexFloatsToBytes( px ), _mm_slli_epi32( VertexFloatsToBytes( py ), 8 ) );
+}
+
+/*
+====================
+OctahedralDecode4
+
+Same as OctahedralDecode for four vectors, the two bytes of each vector are taken from the low 16 bits.
+====================
+*/
+ID_INLINE_EXTERN void OctahedralDecode4( __m128i oct, __m128& x, __m128& y, __m128& z )
+{
+	x = _mm_cvtepi32_ps( _mm_and_si128( oct, vector_int_byte_mask ) );
+	y = _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( oct, 8 ), vector_int_byte_mask ) );
+	x = _mm_madd_ps( x, vector_float_2_over_255, vector_float_neg_one );
+	y = _mm_madd_ps( y, vector_float_2_over_255, vector_float_neg_one );
+	
+	z = _mm_sub_ps( _mm_sub_ps( vector_float_one, _mm_andnot_ps( vector_float_sign_mask, x ) ), _mm_andnot_ps( vector_float_sign_mask, y ) );
+	
+	// unfold the lower hemisphere
+	__m128 t = _mm_max_ps( _mm_sub_ps( vector_float_zero, z ), vector_float_zero );
+	x = _mm_sub_ps( x, _mm_or_ps( t, _mm_and_ps( x, vector_float_sign_mask ) ) );
+	y = _mm_sub_ps( y, _mm_or_ps( t, _mm_and_ps( y, vector_float_sign_mask ) ) );
+	
+	__m128 invLength = _mm_div_ps( vector_float_one, _mm_sqrt_ps( _mm_madd_ps( x, x, _mm_madd_ps( y, y, _mm_mul_ps( z, z ) ) ) ) );
+	x = _mm_mul_ps( x, invLength );
+	y = _mm_mul_ps( y, invLength );
+	z = _mm_mul_ps( z, invLength );
+}
+#endif
+
+/*
+====================
+PackDrawVertsCompact
+
+Packs the vertices of a surface with the given bounds into the compact vertex format.
+====================
+*/
+ID_INLINE_EXTERN void PackDrawVertsCompact( idDrawVertCompact* compactVerts, const idDrawVert* verts, const int numVerts, const idBounds& bounds )
+{
+	idVec3 quantizeScale;
+	idVec3 dequantizeScale;
+	idDrawVertCompact::GetQuantizeScale( bounds, quantizeScale, dequantizeScale );
+	
+	int i = 0;
+	
+#if defined(USE_INTRINSICS)
+	
+	const __m128 minX = _mm_set1_ps( bounds[0].x );
+	const __m128 minY = _mm_set1_ps( bounds[0].y );
+	const __m128 minZ = _mm_set1_ps( bounds[0].z );
+	const __m128 scaleX = _mm_set1_ps( quantizeScale.x );
+	const __m128 scaleY = _mm_set1_ps( quantizeScale.y );
+	const __m128 scaleZ = _mm_set1_ps( quantizeScale.z );
+	
+	for( ; i + 4 <= numVerts; i += 4 )
+	{
+		const idDrawVert& v0 = verts[i + 0];
+		const idDrawVert& v1 = verts[i + 1];
+		const idDrawVert& v2 = verts[i + 2];
+		const idDrawVert& v3 = verts[i + 3];
+		
+		__m128 x = _mm_setr_ps( v0.xyz.x, v1.xyz.x, v2.xyz.x, v3.xyz.x );
+		__m128 y = _mm_setr_ps( v0.xyz.y, v1.xyz.y, v2.xyz.y, v3.xyz.y );
+		__m128 z = _mm_setr_ps( v0.xyz.z, v1.xyz.z, v2.xyz.z, v3.xyz.z );
+		
+		x = _mm_madd_ps( _mm_sub_ps( x, minX ), scaleX, vector_float_half );
+		y = _mm_madd_ps( _mm_sub_ps( y, minY ), scaleY, vector_float_half );
+		z = _mm_madd_ps( _mm_sub_ps( z, minZ ), scaleZ, vector_float_half );
+		
+		ALIGNTYPE16 int qx[4];
+		ALIGNTYPE16 int qy[4];
+		ALIGNTYPE16 int qz[4];
+		_mm_store_si128( ( __m128i* )qx, _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( x, vector_float_zero ), vector_float_compact_position_max ) ) );
+		_mm_store_si128( ( __m128i* )qy, _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( y, vector_float_zero ), vector_float_compact_position_max ) ) );
+		_mm_store_si128( ( __m128i* )qz, _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( z, vector_float_zero ), vector_float_compact_position_max ) ) );
+		
+		__m128 nx, ny, nz;
+		__m128 tx, ty, tz;
+		VertexBytesToFloats( _mm_setr_epi32( *( const int* )v0.normal, *( const int* )v1.normal, *( const int* )v2.normal, *( const int* )v3.normal ), nx, ny, nz );
+		VertexBytesToFloats( _mm_setr_epi32( *( const int* )v0.tangent, *( const int* )v1.tangent, *( const int* )v2.tangent, *( const int* )v3.tangent ), tx, ty, tz );
+		
+		// the octahedral normal and tangent are next to each other in the compact vertex
+		ALIGNTYPE16 unsigned int normalTangent[4];
+		_mm_store_si128( ( __m128i* )normalTangent, _mm_or_si128( OctahedralEncode4( nx, ny, nz ), _mm_slli_epi32( OctahedralEncode4( tx, ty, tz ), 16 ) ) );
+		
+		for( int j = 0; j < 4; j++ )
+		{
+			const idDrawVert& v = verts[i + j];
+			idDrawVertCompact& c = compactVerts[i + j];
+			c.xyz[0] = ( unsigned short )qx[j];
+			c.xyz[1] = ( unsigned short )qy[j];
+			c.xyz[2] = ( unsigned short )qz[j];
+			c.biTangentSign = v.tangent[3];
+			c.pad = 0;
+			c.st[0] = v.st[0];
+			c.st[1] = v.st[1];
+			*( unsigned int* )c.normal = normalTangent[j];
+		}
+	}
+	
+#endif
+	
+	for( ; i < numVerts; i++ )
+	{
+		compactVerts[i].Pack( verts[i], bounds[0], quantizeScale );
+	}
+}
+
+/*
+====================
+UnpackDrawVertsCompact
+
+Unpacks compact vertices that were packed with the given bounds, vertex colors and skinning weights are cleared.
+====================
+*/
+ID_INLINE_EXTERN void UnpackDrawVertsCompact( idDrawVert* verts, const idDrawVertCompact* compactVerts, const int numVerts, const idBounds& bounds )
+{
+	idVec3 quantizeScale;
+	idVec3 dequantizeScale;
+	idDrawVertCompact::GetQuantizeScale( bounds, quantizeScale, dequantizeScale );
+	
+	int i = 0;
+	
+#if defined(USE_INTRINSICS)
+	
+	const __m128 minX = _mm_set1_ps( bounds[0].x );
+	const __m128 minY = _mm_set1_ps( bounds[0].y );
+	const __m128 minZ = _mm_set1_ps( bounds[0].z );
+	const __m128 scaleX = _mm_set1_ps( dequantizeScale.x );
+	const __m128 scaleY = _mm_set1_ps( dequantizeScale.y );
+	const __m128 scaleZ = _mm_set1_ps( dequantizeScale.z );
+	
+	for( ; i + 4 <= numVerts; i += 4 )
+	{
+		const idDrawVertCompact& c0 = compactVerts[i + 0];
+		const idDrawVertCompact& c1 = compactVerts[i + 1];
+		const idDrawVertCompact& c2 = compactVerts[i + 2];
+		const idDrawVertCompact& c3 = compactVerts[i + 3];
+		
+		__m128 x = _mm_cvtepi32_ps( _mm_setr_epi32( c0.xyz[0], c1.xyz[0], c2.xyz[0], c3.xyz[0] ) );
+		__m128 y = _mm_cvtepi32_ps( _mm_setr_epi32( c0.xyz[1], c1.xyz[1], c2.xyz[1], c3.xyz[1] ) );
+		__m128 z = _mm_cvtepi32_ps( _mm_setr_epi32( c0.xyz[2], c1.xyz[2], c2.xyz[2], c3.xyz[2] ) );
+		
+		x = _mm_madd_ps( x, scaleX, minX );
+		y = _mm_madd_ps( y, scaleY, minY );
+		z = _mm_madd_ps( z, scaleZ, minZ );
+		
+		__m128i normalTangent = _mm_setr_epi32( *( const int* )c0.normal, *( const int* )c1.normal, *( const int* )c2.normal, *( const int* )c3.normal );
+		
+		__m128 nx, ny, nz;
+		__m128 tx, ty, tz;
+		OctahedralDecode4( normalTangent, nx, ny, nz );
+		OctahedralDecode4( _mm_srli_epi32( normalTangent, 16 ), tx, ty, tz );
+		
+		__m128i normal = _mm_or_si128( _mm_or_si128( VertexFloatsToBytes( nx ), _mm_slli_epi32( VertexFloatsToBytes( ny ), 8 ) ), _mm_slli_epi32( VertexFloatsToBytes( nz ), 16 ) );
+		__m128i tangent = _mm_or_si128( _mm_or_si128( VertexFloatsToBytes( tx ), _mm_slli_epi32( VertexFloatsToBytes( ty ), 8 ) ), _mm_slli_epi32( VertexFloatsToBytes( tz ), 16 ) );
+		
+		ALIGNTYPE16 float px[4];
+		ALIGNTYPE16 float py[4];
+		ALIGNTYPE16 float pz[4];
+		ALIGNTYPE16 unsigned int normals[4];
+		ALIGNTYPE16 unsigned int tangents[4];
+		_mm_store_ps( px, x );
+		_mm_store_ps( py, y );
+		_mm_store_ps( pz, z );
+		_mm_store_si128( ( __m128i* )normals, normal );
+		_mm_store_si128( ( __m128i* )tangents, tangent );
+		
+		for( int j = 0; j < 4; j++ )
+		{
+			const idDrawVertCompact& c = compactVerts[i + j];
+			idDrawVert& v = verts[i + j];
+			v.xyz.x = px[j];
+			v.xyz.y = py[j];
+			v.xyz.z = pz[j];
+			v.st[0] = c.st[0];
+			v.st[1] = c.st[1];
+			*( unsigned int* )v.normal = normals[j];
+			*( unsigned int* )v.tangent = tangents[j] | ( ( unsigned int )c.biTangentSign << 24 );
+			*( unsigned int* )v.color = 0;
+			*( unsigned int* )v.color2 = 0;
+		}
+	}
+	
+#endif
+	
+	for( ; i < numVerts; i++ )
+	{
+		compactVerts[i].Unpack( verts[i], bounds[0], dequantizeScale );
+	}
+}
+
 #endif /* !__DRAWVERT_INTRINSICS_H__ */
@@ -105,6 +105,7 @@ SIMD constants
 #if defined(USE_INTRINSICS)
 static const __m128i vector_int_1							= _mm_set1_epi32( 1 );
 static const __m128i vector_int_4							= _mm_set1_epi32( 4 );
+static const __m128i vector_int_63							= _mm_set1_epi32( 63 );
 static const __m128i vector_int_0123						= _mm_set_epi32( 3, 2, 1, 0 );
 static const __m128 vector_float_mask0						= __m128c( _mm_set1_epi32( 1 << 0 ) );
 static const __m128 vector_float_mask1						= __m128c( _mm_set1_epi32( 1 << 1 ) );
@@ -1946,6 +1947,125 @@ bool idRenderMatrix::CullBoundsToMVPbits( const idRenderMatrix& mvp, const idBou
 #endif
 }
 
+/*
+========================
+idRenderMatrix::CullBoundsToMVPbitsBatch
+
+Culls 'numBounds' bounds, stored in blocks of CULL_BOUNDS_BLOCK_SIZE, to the given Model View
+Projection (MVP) matrix. For each bounds 'outBits' receives the same bits as CullBoundsToMVPbits,
+so a non-zero value means the bounds is culled. Returns the number of bounds that are not culled.
+
+Instead of transforming all eight corners of each bounds, the six clip planes are extracted
+from the matrix once, and every plane is only tested against the corner of the bounds that is
+furthest in front of that plane. Four bounds are culled at a time.
+========================
+*/
+int idRenderMatrix::CullBoundsToMVPbitsBatch( const idRenderMatrix& mvp, const cullBoundsBlock_t* blocks, int numBounds, byte* outBits, bool zeroToOne )
+{
+	const float minMul = zeroToOne ? 0.0f : -1.0f;
+#if defined( CLIP_SPACE_D3D )	// the D3D clip space Z is in the range [0,1] so always compare Z vs zero whether 'zeroToOne' is true or false
+	const float minZMul = 0.0f;
+#else
+	const float minZMul = minMul;
+#endif
+	
+	// the clip planes in the same order as the bits from CullBoundsToMVPbits, a point is inside a plane when the distance is positive
+	ALIGNTYPE16 float planes[6][4];
+	for( int i = 0; i < 4; i++ )
+	{
+		planes[0][i] = mvp[0][i] - minMul * mvp[3][i];
+		planes[1][i] = mvp[3][i] - mvp[0][i];
+		planes[2][i] = mvp[1][i] - minMul * mvp[3][i];
+		planes[3][i] = mvp[3][i] - mvp[1][i];
+		planes[4][i] = mvp[2][i] - minZMul * mvp[3][i];	// NOTE: using minZ
+		planes[5][i] = mvp[3][i] - mvp[2][i];
+	}
+	
+	int numVisible = 0;
+	
+#if defined(USE_INTRINSICS)
+	
+	const __m128 masks[6] = { vector_float_mask0, vector_float_mask1, vector_float_mask2, vector_float_mask3, vector_float_mask4, vector_float_mask5 };
+	
+	__m128 px[6];
+	__m128 py[6];
+	__m128 pz[6];
+	__m128 pd[6];
+	for( int i = 0; i < 6; i++ )
+	{
+		__m128 p = _mm_load_ps( planes[i] );
+		px[i] = _mm_splat_ps( p, 0 );
+		py[i] = _mm_splat_ps( p, 1 );
+		pz[i] = _mm_splat_ps( p, 2 );
+		pd[i] = _mm_splat_ps( p, 3 );
+	}
+	
+	for( int b = 0; b * CULL_BOUNDS_BLOCK_SIZE < numBounds; b++ )
+	{
+		const cullBoundsBlock_t& block = blocks[b];
+		
+		__m128 minX = _mm_loadu_ps( block.minX );
+		__m128 minY = _mm_loadu_ps( block.minY );
+		__m128 minZ = _mm_loadu_ps( block.minZ );
+		__m128 maxX = _mm_loadu_ps( block.maxX );
+		__m128 maxY = _mm_loadu_ps( block.maxY );
+		__m128 maxZ = _mm_loadu_ps( block.maxZ );
+		
+		__m128 cullBits = vector_float_zero;
+		for( int i = 0; i < 6; i++ )
+		{
+			// distance of the corner furthest in front of the plane
+			__m128 d = _mm_add_ps( pd[i], _mm_max_ps( _mm_mul_ps( px[i], minX ), _mm_mul_ps( px[i], maxX ) ) );
+			d = _mm_add_ps( d, _mm_max_ps( _mm_mul_ps( py[i], minY ), _mm_mul_ps( py[i], maxY ) ) );
+			d = _mm_add_ps( d, _mm_max_ps( _mm_mul_ps( pz[i], minZ ), _mm_mul_ps( pz[i], maxZ ) ) );
+			cullBits = _mm_or_ps( cullBits, _mm_and_ps( _mm_cmpgt_ps( d, vector_float_zero ), masks[i] ) );
+		}
+		
+		__m128i bits = _mm_xor_si128( __m128c( cullBits ), vector_int_63 );
+		bits = _mm_packs_epi32( bits, bits );
+		bits = _mm_packus_epi16( bits, bits );
+		
+		ALIGNTYPE16 byte blockBits[16];
+		_mm_store_si128( ( __m128i* )blockBits, bits );
+		
+		const int first = b * CULL_BOUNDS_BLOCK_SIZE;
+		const int count = Min( numBounds - first, CULL_BOUNDS_BLOCK_SIZE );
+		for( int i = 0; i < count; i++ )
+		{
+			outBits[first + i] = blockBits[i];
+			numVisible += ( blockBits[i] == 0 );
+		}
+	}
+	
+#else
+	
+	for( int j = 0; j < numBounds; j++ )
+	{
+		const cullBoundsBlock_t& block = blocks[j / CULL_BOUNDS_BLOCK_SIZE];
+		const int lane = j & ( CULL_BOUNDS_BLOCK_SIZE - 1 );
+		
+		int bits = 0;
+		for( int i = 0; i < 6; i++ )
+		{
+			// distance of the corner furthest in front of the plane
+			const float d = planes[i][3] + Max( planes[i][0] * block.minX[lane], planes[i][0] * block.maxX[lane] )
+							+ Max( planes[i][1] * block.minY[lane], planes[i][1] * block.maxY[lane] )
+							+ Max( planes[i][2] * block.minZ[lane], planes[i][2] * block.maxZ[lane] );
+			if( d > 0.0f )
+			{
+				bits |= ( 1 << i );
+			}
+		}
+		
+		outBits[j] = ( byte )( bits ^ 63 );
+		numVisible += ( bits == 63 );
+	}
+	
+#endif
+	
+	return numVisible;
+}
+
 /*
 ========================
 idRenderMatrix::CullExtrudedBoundsToMVPbits
@@ -4675,3 +4795,60 @@ frustumCull_t idRenderMatrix::CullFrustumCornersToPlane( const frustumCorners_t&
 	
 #endif
 }
+
+/*
+========================
+idRenderMatrix::CullFrustumCornersToPlanes
+
+Returns true if the corners are completely in front of any of the planes, which is the same as
+CullFrustumCornersToPlane returning FRUSTUM_CULL_FRONT for one of the planes, but with the corners
+only loaded once for all the planes.
+========================
+*/
+bool idRenderMatrix::CullFrustumCornersToPlanes( const frustumCorners_t& corners, const idPlane* planes, int numPlanes )
+{
+	assert_16_byte_aligned( &corners );
+	
+#if defined(USE_INTRINSICS)
+	
+	__m128 x0 = _mm_load_ps( corners.x + 0 );
+	__m128 y0 = _mm_load_ps( corners.y + 0 );
+	__m128 z0 = _mm_load_ps( corners.z + 0 );
+	
+	__m128 x1 = _mm_load_ps( corners.x + 4 );
+	__m128 y1 = _mm_load_ps( corners.y + 4 );
+	__m128 z1 = _mm_load_ps( corners.z + 4 );
+	
+	for( int i = 0; i < numPlanes; i++ )
+	{
+		__m128 vp = _mm_loadu_ps( planes[i].ToFloatPtr() );
+		
+		__m128 p0 = _mm_splat_ps( vp, 0 );
+		__m128 p1 = _mm_splat_ps( vp, 1 );
+		__m128 p2 = _mm_splat_ps( vp, 2 );
+		__m128 p3 = _mm_splat_ps( vp, 3 );
+		
+		__m128 d0 = _mm_madd_ps( x0, p0, _mm_madd_ps( y0, p1, _mm_madd_ps( z0, p2, p3 ) ) );
+		__m128 d1 = _mm_madd_ps( x1, p0, _mm_madd_ps( y1, p1, _mm_madd_ps( z1, p2, p3 ) ) );
+		
+		// no sign bits set means all corners are in front of the plane
+		if( _mm_movemask_ps( _mm_or_ps( d0, d1 ) ) == 0 )
+		{
+			return true;
+		}
+	}
+	return false;
+	
+#else
+	
+	for( int i = 0; i < numPlanes; i++ )
+	{
+		if( CullFrustumCornersToPlane( corners, planes[i] ) == FRUSTUM_CULL_FRONT )
+		{
+			return true;
+		}
+	}
+	return false;
+	
+#endif
+}
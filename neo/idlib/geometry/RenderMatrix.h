@@ -38,6 +38,19 @@ struct frustumCorners_t
 	float	z[NUM_FRUSTUM_CORNERS];
 };
 
+// Bounds stored as a structure of arrays in blocks of four for batched culling.
+static const int CULL_BOUNDS_BLOCK_SIZE	= 4;
+
+struct cullBoundsBlock_t
+{
+	float	minX[CULL_BOUNDS_BLOCK_SIZE];
+	float	minY[CULL_BOUNDS_BLOCK_SIZE];
+	float	minZ[CULL_BOUNDS_BLOCK_SIZE];
+	float	maxX[CULL_BOUNDS_BLOCK_SIZE];
+	float	maxY[CULL_BOUNDS_BLOCK_SIZE];
+	float	maxZ[CULL_BOUNDS_BLOCK_SIZE];
+};
+
 enum frustumCull_t
 {
 	FRUSTUM_CULL_FRONT		= 1,
@@ -146,6 +159,10 @@ public:
 	static bool				CullExtrudedBoundsToMVP( const idRenderMatrix& mvp, const idBounds& bounds, const idVec3& extrudeDirection, const idPlane& clipPlane, bool zeroToOne = false );
 	static bool				CullExtrudedBoundsToMVPbits( const idRenderMatrix& mvp, const idBounds& bounds, const idVec3& extrudeDirection, const idPlane& clipPlane, byte* outBits, bool zeroToOne = false );
 	
+	// Cull a batch of bounds to a single MVP matrix, 'outBits' receives the same bits as CullBoundsToMVPbits for each bounds.
+	static void				SetCullBounds( cullBoundsBlock_t* blocks, int index, const idBounds& bounds );
+	static int				CullBoundsToMVPbitsBatch( const idRenderMatrix& mvp, const cullBoundsBlock_t* blocks, int numBounds, byte* outBits, bool zeroToOne = false );
+	
 	// Calculate the projected bounds.
 	static void				ProjectedBounds( idBounds& projected, const idRenderMatrix& mvp, const idBounds& bounds, bool windowSpace = true );
 	static void				ProjectedNearClippedBounds( idBounds& projected, const idRenderMatrix& mvp, const idBounds& bounds, bool windowSpace = true );
@@ -160,6 +177,7 @@ public:
 	static void				GetFrustumPlanes( idPlane planes[6], const idRenderMatrix& frustum, bool zeroToOne, bool normalize );
 	static void				GetFrustumCorners( frustumCorners_t& corners, const idRenderMatrix& frustumTransform, const idBounds& frustumBounds );
 	static frustumCull_t	CullFrustumCornersToPlane( const frustumCorners_t& corners, const idPlane& plane );
+	static bool				CullFrustumCornersToPlanes( const frustumCorners_t& corners, const idPlane* planes, int numPlanes );
 	
 private:
 	float					m[16];
@@ -550,6 +568,23 @@ ID_INLINE bool idRenderMatrix::CullBoundsToMVP( const idRenderMatrix& mvp, const
 	return CullBoundsToMVPbits( mvp, bounds, &bits, zeroToOne );
 }
 
+/*
+========================
+idRenderMatrix::SetCullBounds
+========================
+*/
+ID_INLINE void idRenderMatrix::SetCullBounds( cullBoundsBlock_t* blocks, int index, const idBounds& bounds )
+{
+	cullBoundsBlock_t& block = blocks[index / CULL_BOUNDS_BLOCK_SIZE];
+	const int lane = index & ( CULL_BOUNDS_BLOCK_SIZE - 1 );
+	block.minX[lane] = bounds[0][0];
+	block.minY[lane] = bounds[0][1];
+	block.minZ[lane] = bounds[0][2];
+	block.maxX[lane] = bounds[1][0];
+	block.maxY[lane] = bounds[1][1];
+	block.maxZ[lane] = bounds[1][2];
+}
+
 /*
 ========================
 idRenderMatrix::CullExtrudedBoundsToMVP
@@ -1085,7 +1085,8 @@ static bool LDLT_Factor_SIMD( idMatX& mat, idVecX& invDiag, const int n )
 		_mm_store_ss( mptr + i, t0 );
 		_mm_store_ss( diag + i, t0 );
 		
-		__m128 d = _mm_rcp32_ps( t0 );
+		// the reciprocal estimate differs between CPUs
+		__m128 d = idSIMD::IsDeterministic() ? _mm_div_ps( SIMD_SP_one, t0 ) : _mm_rcp32_ps( t0 );
 		_mm_store_ss( invDiagPtr + i, d );
 		
 		if( i + 1 >= n )
@@ -2252,6 +2253,7 @@ idLCP_Square::Solve
 */
 bool idLCP_Square::Solve( const idMatX& o_m, idVecX& o_x, const idVecX& o_b, const idVecX& o_lo, const idVecX& o_hi, const int* o_boxIndex )
 {
+	numIterations = 0;
 
 	// true when the matrix rows are 16 byte padded
 	padded = ( ( o_m.GetNumRows() + 3 )&~3 ) == o_m.GetNumColumns();
@@ -2421,7 +2423,7 @@ bool idLCP_Square::Solve( const idMatX& o_m, idVecX& o_x, const idVecX& o_b, con
 		
 		// drive the current variable into a valid region
 		int n = 0;
-		for( ; n < maxIterations; n++ )
+		for( ; n < maxIterations; n++, numIterations++ )
 		{
 		
 			// direction to move
@@ -3032,6 +3034,7 @@ idLCP_Symmetric::Solve
 */
 bool idLCP_Symmetric::Solve( const idMatX& o_m, idVecX& o_x, const idVecX& o_b, const idVecX& o_lo, const idVecX& o_hi, const int* o_boxIndex )
 {
+	numIterations = 0;
 
 	// true when the matrix rows are 16 byte padded
 	padded = ( ( o_m.GetNumRows() + 3 )&~3 ) == o_m.GetNumColumns();
@@ -3205,7 +3208,7 @@ bool idLCP_Symmetric::Solve( const idMatX& o_m, idVecX& o_x, const idVecX& o_b,
 		
 		// drive the current variable into a valid region
 		int n = 0;
-		for( ; n < maxIterations; n++ )
+		for( ; n < maxIterations; n++, numIterations++ )
 		{
 		
 			// direction to move
@@ -3356,6 +3359,249 @@ bool idLCP_Symmetric::Solve( const idMatX& o_m, idVecX& o_x, const idVecX& o_b,
 	return true;
 }
 
+/*
+================================================================================================
+
+	idLCP_GaussSeidel
+
+================================================================================================
+*/
+
+const float LCP_GS_DELTA_EPSILON		= 1e-4f;	// relative change of the solution at which a block stops iterating
+const float LCP_GS_DIAGONAL_EPSILON		= 1e-10f;
+
+/*
+================================================
+idLCP_GaussSeidel
+
+Projected Gauss-Seidel iteration, 'A' must be a symmetric positive semi-definite matrix.
+
+The contents of 'x' on input are used as the initial guess, so handing in the solution of
+the previous frame makes the solver converge in a few sweeps. Only the non-zero entries
+of 'A' are stored. Variables that are not coupled through 'A' or the box index are split
+into independent blocks, and each block stops iterating as soon as it converges.
+================================================
+*/
+class idLCP_GaussSeidel : public idLCP
+{
+public:
+	virtual bool	Solve( const idMatX& A, idVecX& x, const idVecX& b, const idVecX& lo, const idVecX& hi, const int* boxIndex );
+	
+private:
+	static int		FindBlock( int* blockParent, int i );
+	static void		MergeBlocks( int* blockParent, int i, int j );
+};
+
+/*
+========================
+idLCP_GaussSeidel::FindBlock
+========================
+*/
+int idLCP_GaussSeidel::FindBlock( int* blockParent, int i )
+{
+	while( blockParent[i] != i )
+	{
+		blockParent[i] = blockParent[blockParent[i]];
+		i = blockParent[i];
+	}
+	return i;
+}
+
+/*
+========================
+idLCP_GaussSeidel::MergeBlocks
+========================
+*/
+void idLCP_GaussSeidel::MergeBlocks( int* blockParent, int i, int j )
+{
+	i = FindBlock( blockParent, i );
+	j = FindBlock( blockParent, j );
+	if( i != j )
+	{
+		blockParent[Max( i, j )] = Min( i, j );
+	}
+}
+
+/*
+========================
+idLCP_GaussSeidel::Solve
+========================
+*/
+bool idLCP_GaussSeidel::Solve( const idMatX& A, idVecX& x, const idVecX& b, const idVecX& lo, const idVecX& hi, const int* boxIndex )
+{
+	const int n = A.GetNumRows();
+	
+	assert( ( ( n + 3 ) & ~3 ) == A.GetNumColumns() || n == A.GetNumColumns() );
+	assert( x.GetSize() == n );
+	assert( b.GetSize() == n );
+	assert( lo.GetSize() == n );
+	assert( hi.GetSize() == n );
+	
+	numIterations = 0;
+	
+	if( n == 0 )
+	{
+		return true;
+	}
+	
+	// count the non-zero entries off the diagonal
+	int numNonZero = 0;
+	for( int i = 0; i < n; i++ )
+	{
+		const float* row = A[i];
+		for( int j = 0; j < n; j++ )
+		{
+			if( row[j] != 0.0f && j != i )
+			{
+				numNonZero++;
+			}
+		}
+	}
+	
+	int* rowStart = ( int* ) _alloca16( ( n + 1 ) * sizeof( int ) );
+	int* columns = ( int* ) _alloca16( ( numNonZero + 1 ) * sizeof( int ) );
+	float* values = ( float* ) _alloca16( ( numNonZero + 1 ) * sizeof( float ) );
+	float* invDiagonal = ( float* ) _alloca16( n * sizeof( float ) );
+	int* blockParent = ( int* ) _alloca16( n * sizeof( int ) );
+	
+	for( int i = 0; i < n; i++ )
+	{
+		blockParent[i] = i;
+	}
+	
+	// store the rows sparse and merge the blocks of coupled variables
+	for( int i = 0, k = 0; i < n; i++ )
+	{
+		const float* row = A[i];
+		rowStart[i] = k;
+		for( int j = 0; j < n; j++ )
+		{
+			if( row[j] != 0.0f && j != i )
+			{
+				columns[k] = j;
+				values[k] = row[j];
+				k++;
+				MergeBlocks( blockParent, i, j );
+			}
+		}
+		rowStart[i + 1] = k;
+		
+		invDiagonal[i] = ( row[i] > LCP_GS_DIAGONAL_EPSILON ) ? 1.0f / row[i] : 0.0f;
+		
+		if( boxIndex != NULL && boxIndex[i] >= 0 )
+		{
+			MergeBlocks( blockParent, i, boxIndex[i] );
+		}
+	}
+	
+	// sort the variables by block, keeping the original order within each block
+	int* blockNum = ( int* ) _alloca16( n * sizeof( int ) );
+	int* blockStart = ( int* ) _alloca16( ( n + 1 ) * sizeof( int ) );
+	int* blockVars = ( int* ) _alloca16( n * sizeof( int ) );
+	int numBlocks = 0;
+	
+	for( int i = 0; i < n; i++ )
+	{
+		const int root = FindBlock( blockParent, i );
+		blockNum[i] = ( root == i ) ? numBlocks++ : blockNum[root];
+	}
+	memset( blockStart, 0, ( numBlocks + 1 ) * sizeof( int ) );
+	for( int i = 0; i < n; i++ )
+	{
+		blockStart[blockNum[i] + 1]++;
+	}
+	for( int i = 0; i < numBlocks; i++ )
+	{
+		blockStart[i + 1] += blockStart[i];
+	}
+	for( int i = 0; i < n; i++ )
+	{
+		blockVars[blockStart[blockNum[i]]++] = i;
+	}
+	for( int i = numBlocks; i > 0; i-- )
+	{
+		blockStart[i] = blockStart[i - 1];
+	}
+	blockStart[0] = 0;
+	
+	// clamp the initial guess, variables without a usable diagonal exert no force
+	for( int i = 0; i < n; i++ )
+	{
+		if( invDiagonal[i] == 0.0f || IEEE_FLT_IS_INF_NAN( x[i] ) )
+		{
+			x[i] = 0.0f;
+		}
+		else if( boxIndex == NULL || boxIndex[i] < 0 )
+		{
+			x[i] = idMath::ClampFloat( lo[i], hi[i], x[i] );
+		}
+	}
+	
+	for( int block = 0; block < numBlocks; block++ )
+	{
+		int sweep = 0;
+		while( sweep < maxIterations )
+		{
+			float maxDelta = 0.0f;
+			float maxValue = 0.0f;
+			
+			for( int k = blockStart[block]; k < blockStart[block + 1]; k++ )
+			{
+				const int i = blockVars[k];
+				if( invDiagonal[i] == 0.0f )
+				{
+					continue;
+				}
+				
+				float s = b[i];
+				for( int e = rowStart[i]; e < rowStart[i + 1]; e++ )
+				{
+					s -= values[e] * x[columns[e]];
+				}
+				
+				float low = lo[i];
+				float high = hi[i];
+				if( boxIndex != NULL && boxIndex[i] >= 0 )
+				{
+					const float f = x[boxIndex[i]];
+					if( low != -idMath::INFINITY )
+					{
+						low = - idMath::Fabs( low * f );
+					}
+					if( high != idMath::INFINITY )
+					{
+						high = idMath::Fabs( high * f );
+					}
+				}
+				
+				const float v = idMath::ClampFloat( low, high, s * invDiagonal[i] );
+				maxDelta = Max( maxDelta, idMath::Fabs( v - x[i] ) );
+				maxValue = Max( maxValue, idMath::Fabs( v ) );
+				x[i] = v;
+			}
+			
+			sweep++;
+			
+			if( maxDelta <= LCP_GS_DELTA_EPSILON * Max( maxValue, 1.0f ) )
+			{
+				break;
+			}
+		}
+		numIterations = Max( numIterations, sweep );
+	}
+	
+	for( int i = 0; i < n; i++ )
+	{
+		if( IEEE_FLT_IS_INF_NAN( x[i] ) )
+		{
+			x.Zero();
+			return false;
+		}
+	}
+	
+	return true;
+}
+
 /*
 ================================================================================================
 
@@ -3364,6 +3610,17 @@ bool idLCP_Symmetric::Solve( const idMatX& o_m, idVecX& o_x, const idVecX& o_b,
 ================================================================================================
 */
 
+/*
+========================
+idLCP::idLCP
+========================
+*/
+idLCP::idLCP()
+{
+	maxIterations = 0;
+	numIterations = 0;
+}
+
 /*
 ========================
 idLCP::AllocSquare
@@ -3388,6 +3645,18 @@ idLCP* idLCP::AllocSymmetric()
 	return lcp;
 }
 
+/*
+========================
+idLCP::AllocGaussSeidel
+========================
+*/
+idLCP* idLCP::AllocGaussSeidel()
+{
+	idLCP* lcp = new idLCP_GaussSeidel;
+	lcp->SetMaxIterations( 64 );
+	return lcp;
+}
+
 /*
 ========================
 idLCP::~idLCP
@@ -3417,6 +3686,16 @@ int idLCP::GetMaxIterations()
 	return maxIterations;
 }
 
+/*
+========================
+idLCP::GetNumIterations
+========================
+*/
+int idLCP::GetNumIterations() const
+{
+	return numIterations;
+}
+
 /*
 ========================
 idLCP::Test_f
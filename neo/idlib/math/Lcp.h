@@ -55,6 +55,9 @@ If boxIndex != NULL and boxIndex[i] != -1, then
 
 Before calculating any of the bounded x[i] with boxIndex[i] != -1, the solver calculates all
 unbounded x[i] and all x[i] with boxIndex[i] == -1.
+
+The Gauss-Seidel solver is iterative and uses the contents of 'x' as the initial guess. The
+pivoting solvers ignore the contents of 'x'.
 ================================================
 */
 class idLCP
@@ -62,7 +65,9 @@ class idLCP
 public:
 	static idLCP* 	AllocSquare();		// 'A' must be a square matrix
 	static idLCP* 	AllocSymmetric();	// 'A' must be a symmetric matrix
+	static idLCP* 	AllocGaussSeidel();	// 'A' must be a symmetric positive semi-definite matrix, 'x' is the initial guess
 	
+					idLCP();
 	virtual			~idLCP();
 	
 	virtual bool	Solve( const idMatX& A, idVecX& x, const idVecX& b, const idVecX& lo,
@@ -71,10 +76,14 @@ public:
 	virtual void	SetMaxIterations( int max );
 	virtual int		GetMaxIterations();
 	
+	// pivots for the pivoting solvers, sweeps of the slowest block for Gauss-Seidel
+	int				GetNumIterations() const;
+	
 	static void		Test_f( const idCmdArgs& args );
 	
 protected:
 	int				maxIterations;
+	int				numIterations;
 };
 
 #endif // !__MATH_LCP_H__
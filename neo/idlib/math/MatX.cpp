@@ -42,6 +42,187 @@ float* 	idMatX::tempPtr = ( float* )( ( ( intptr_t ) idMatX::temp + 15 ) & ~15 )
 // RB end
 int		idMatX::tempIndex = 0;
 
+#ifdef MATX_SIMD
+
+/*
+============
+HorizontalSum2_SIMD
+
+  Returns the horizontal sums of two vectors in the two components of the result.
+============
+*/
+static ID_INLINE __m128d HorizontalSum2_SIMD( const __m128d s0, const __m128d s1 )
+{
+	return _mm_add_pd( _mm_unpacklo_pd( s0, s1 ), _mm_unpackhi_pd( s0, s1 ) );
+}
+
+/*
+============
+MultiplyAdd_SIMD
+
+  Returns s + a * b with the four float products widened to double and folded into the two components.
+============
+*/
+static ID_INLINE __m128d MultiplyAdd_SIMD( const __m128 a, const __m128 b, const __m128d s )
+{
+	__m128 p = _mm_mul_ps( a, b );
+	return _mm_add_pd( s, _mm_add_pd( _mm_cvtps_pd( p ), _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) ) );
+}
+
+/*
+============
+DotProduct_SIMD
+
+  Dot product of the first n elements of a and b, the pointers do not need to be aligned.
+  The sum is kept in double like the generic code so long dot products do not lose precision.
+============
+*/
+static ID_INLINE double DotProduct_SIMD( const float* a, const float* b, const int n )
+{
+	__m128d s0 = _mm_setzero_pd();
+	__m128d s1 = _mm_setzero_pd();
+	int k = 0;
+	for( ; k + 8 <= n; k += 8 )
+	{
+		s0 = MultiplyAdd_SIMD( _mm_loadu_ps( a + k + 0 ), _mm_loadu_ps( b + k + 0 ), s0 );
+		s1 = MultiplyAdd_SIMD( _mm_loadu_ps( a + k + 4 ), _mm_loadu_ps( b + k + 4 ), s1 );
+	}
+	if( k + 4 <= n )
+	{
+		s0 = MultiplyAdd_SIMD( _mm_loadu_ps( a + k ), _mm_loadu_ps( b + k ), s0 );
+		k += 4;
+	}
+	s0 = _mm_add_pd( s0, s1 );
+	double sum = _mm_cvtsd_f64( _mm_add_sd( s0, _mm_unpackhi_pd( s0, s0 ) ) );
+	for( ; k < n; k++ )
+	{
+		sum += a[k] * b[k];
+	}
+	return sum;
+}
+
+/*
+============
+DotProduct2x4_SIMD
+
+  Dot products of the first n elements of the rows a0 and a1 with the rows b0, b1, b2 and b3.
+  The 2x4 register tile loads every element of the b rows once for both a rows.
+  Each tile of products is widened once and accumulated in double.
+============
+*/
+static ID_INLINE void DotProduct2x4_SIMD( double dot0[4], double dot1[4], const float* a0, const float* a1,
+		const float* b0, const float* b1, const float* b2, const float* b3, const int n )
+{
+	__m128d s00 = _mm_setzero_pd();
+	__m128d s01 = _mm_setzero_pd();
+	__m128d s02 = _mm_setzero_pd();
+	__m128d s03 = _mm_setzero_pd();
+	__m128d s10 = _mm_setzero_pd();
+	__m128d s11 = _mm_setzero_pd();
+	__m128d s12 = _mm_setzero_pd();
+	__m128d s13 = _mm_setzero_pd();
+	
+	int k = 0;
+	for( ; k + 4 <= n; k += 4 )
+	{
+		__m128 va0 = _mm_loadu_ps( a0 + k );
+		__m128 va1 = _mm_loadu_ps( a1 + k );
+		__m128 vb;
+		
+		vb = _mm_loadu_ps( b0 + k );
+		s00 = MultiplyAdd_SIMD( va0, vb, s00 );
+		s10 = MultiplyAdd_SIMD( va1, vb, s10 );
+		vb = _mm_loadu_ps( b1 + k );
+		s01 = MultiplyAdd_SIMD( va0, vb, s01 );
+		s11 = MultiplyAdd_SIMD( va1, vb, s11 );
+		vb = _mm_loadu_ps( b2 + k );
+		s02 = MultiplyAdd_SIMD( va0, vb, s02 );
+		s12 = MultiplyAdd_SIMD( va1, vb, s12 );
+		vb = _mm_loadu_ps( b3 + k );
+		s03 = MultiplyAdd_SIMD( va0, vb, s03 );
+		s13 = MultiplyAdd_SIMD( va1, vb, s13 );
+	}
+	
+	_mm_storeu_pd( dot0 + 0, HorizontalSum2_SIMD( s00, s01 ) );
+	_mm_storeu_pd( dot0 + 2, HorizontalSum2_SIMD( s02, s03 ) );
+	_mm_storeu_pd( dot1 + 0, HorizontalSum2_SIMD( s10, s11 ) );
+	_mm_storeu_pd( dot1 + 2, HorizontalSum2_SIMD( s12, s13 ) );
+	
+	for( ; k < n; k++ )
+	{
+		dot0[0] += a0[k] * b0[k];
+		dot0[1] += a0[k] * b1[k];
+		dot0[2] += a0[k] * b2[k];
+		dot0[3] += a0[k] * b3[k];
+		dot1[0] += a1[k] * b0[k];
+		dot1[1] += a1[k] * b1[k];
+		dot1[2] += a1[k] * b2[k];
+		dot1[3] += a1[k] * b3[k];
+	}
+}
+
+/*
+============
+MultiplySub_SIMD
+
+  dst[k] -= s * src[k] for the first n elements, the pointers do not need to be aligned.
+============
+*/
+static ID_INLINE void MultiplySub_SIMD( float* dst, const float s, const float* src, const int n )
+{
+	__m128 vs = _mm_set1_ps( s );
+	int k = 0;
+	for( ; k + 4 <= n; k += 4 )
+	{
+		_mm_storeu_ps( dst + k, _mm_sub_ps( _mm_loadu_ps( dst + k ), _mm_mul_ps( vs, _mm_loadu_ps( src + k ) ) ) );
+	}
+	for( ; k < n; k++ )
+	{
+		dst[k] -= s * src[k];
+	}
+}
+
+/*
+============
+MultiplySub4_SIMD
+
+  dst[k] -= s[0] * src0[k] + s[1] * src1[k] + s[2] * src2[k] + s[3] * src3[k] for the first n elements.
+  The destination is kept in double and is loaded and stored once for the four source rows.
+============
+*/
+static ID_INLINE void MultiplySub4_SIMD( double* dst, const float s[4], const float* src0, const float* src1, const float* src2, const float* src3, const int n )
+{
+	__m128 vs0 = _mm_set1_ps( s[0] );
+	__m128 vs1 = _mm_set1_ps( s[1] );
+	__m128 vs2 = _mm_set1_ps( s[2] );
+	__m128 vs3 = _mm_set1_ps( s[3] );
+	int k = 0;
+	for( ; k + 4 <= n; k += 4 )
+	{
+		__m128 p0 = _mm_mul_ps( vs0, _mm_loadu_ps( src0 + k ) );
+		__m128 p1 = _mm_mul_ps( vs1, _mm_loadu_ps( src1 + k ) );
+		__m128 p2 = _mm_mul_ps( vs2, _mm_loadu_ps( src2 + k ) );
+		__m128 p3 = _mm_mul_ps( vs3, _mm_loadu_ps( src3 + k ) );
+		__m128d lo = _mm_add_pd( _mm_add_pd( _mm_cvtps_pd( p0 ), _mm_cvtps_pd( p1 ) ), _mm_add_pd( _mm_cvtps_pd( p2 ), _mm_cvtps_pd( p3 ) ) );
+		p0 = _mm_movehl_ps( p0, p0 );
+		p1 = _mm_movehl_ps( p1, p1 );
+		p2 = _mm_movehl_ps( p2, p2 );
+		p3 = _mm_movehl_ps( p3, p3 );
+		__m128d hi = _mm_add_pd( _mm_add_pd( _mm_cvtps_pd( p0 ), _mm_cvtps_pd( p1 ) ), _mm_add_pd( _mm_cvtps_pd( p2 ), _mm_cvtps_pd( p3 ) ) );
+		_mm_storeu_pd( dst + k + 0, _mm_sub_pd( _mm_loadu_pd( dst + k + 0 ), lo ) );
+		_mm_storeu_pd( dst + k + 2, _mm_sub_pd( _mm_loadu_pd( dst + k + 2 ), hi ) );
+	}
+	for( ; k < n; k++ )
+	{
+		dst[k] -= s[0] * src0[k];
+		dst[k] -= s[1] * src1[k];
+		dst[k] -= s[2] * src2[k];
+		dst[k] -= s[3] * src3[k];
+	}
+}
+
+#endif
+
 
 /*
 ============
@@ -1270,19 +1451,13 @@ void idMatX::Inverse_Solve( idVecX& x, const idVecX& b ) const
 
 /*
 ============
-idMatX::LU_Factor
-
-  in-place factorization: LU
-  L is a triangular matrix stored in the lower triangle.
-  L has ones on the diagonal that are not stored.
-  U is a triangular matrix stored in the upper triangle.
-  If index != NULL partial pivoting is used for numerical stability.
-  If index != NULL it must point to an array of numRow integers and is used to keep track of the row permutation.
-  If det != NULL the determinant of the matrix is calculated and stored.
+LU_Factor_Generic
 ============
 */
-bool idMatX::LU_Factor( int* index, float* det )
+static bool LU_Factor_Generic( idMatX& mat, int* index, float* det )
 {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
 	int i, j, k, newi, min;
 	double s, t, d, w;
 	
@@ -1301,14 +1476,14 @@ bool idMatX::LU_Factor( int* index, float* det )
 	{
 	
 		newi = i;
-		s = idMath::Fabs( ( *this )[i][i] );
+		s = idMath::Fabs( mat[i][i] );
 		
 		if( index )
 		{
 			// find the largest absolute pivot
 			for( j = i + 1; j < numRows; j++ )
 			{
-				t = idMath::Fabs( ( *this )[j][i] );
+				t = idMath::Fabs( mat[j][i] );
 				if( t > s )
 				{
 					newi = j;
@@ -1335,18 +1510,18 @@ bool idMatX::LU_Factor( int* index, float* det )
 			// swap rows
 			for( j = 0; j < numColumns; j++ )
 			{
-				t = ( *this )[newi][j];
-				( *this )[newi][j] = ( *this )[i][j];
-				( *this )[i][j] = t;
+				t = mat[newi][j];
+				mat[newi][j] = mat[i][j];
+				mat[i][j] = t;
 			}
 		}
 		
 		if( i < numRows )
 		{
-			d = 1.0f / ( *this )[i][i];
+			d = 1.0f / mat[i][i];
 			for( j = i + 1; j < numRows; j++ )
 			{
-				( *this )[j][i] *= d;
+				mat[j][i] *= d;
 			}
 		}
 		
@@ -1354,12 +1529,148 @@ bool idMatX::LU_Factor( int* index, float* det )
 		{
 			for( j = i + 1; j < numRows; j++ )
 			{
-				d = ( *this )[j][i];
+				d = mat[j][i];
 				for( k = i + 1; k < numColumns; k++ )
 				{
-					( *this )[j][k] -= d * ( *this )[i][k];
+					mat[j][k] -= d * mat[i][k];
+				}
+			}
+		}
+	}
+	
+	if( det )
+	{
+		for( i = 0; i < numRows; i++ )
+		{
+			w *= mat[i][i];
+		}
+		*det = w;
+	}
+	
+	return true;
+}
+
+#ifdef MATX_SIMD
+
+/*
+============
+LU_Factor_SIMD
+
+  Left looking so every element of L and U is a single sum that is accumulated in double like the
+  generic code, instead of being rounded to float after every rank one update.
+  Column i of U is gathered so the dot products with the rows of L are contiguous, and the
+  rows of U are subtracted four at a time so the double row is loaded once per four rows.
+============
+*/
+static bool LU_Factor_SIMD( idMatX& mat, int* index, float* det )
+{
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
+	int i, j, k, newi, min;
+	float s, t, d, w;
+	
+	// if partial pivoting should be used
+	if( index )
+	{
+		for( i = 0; i < numRows; i++ )
+		{
+			index[i] = i;
+		}
+	}
+	
+	float* column = ( float* ) _alloca16( numRows * sizeof( float ) );
+	double* sum = ( double* ) _alloca16( numColumns * sizeof( double ) );
+	
+	w = 1.0f;
+	min = Min( numRows, numColumns );
+	for( i = 0; i < min; i++ )
+	{
+		// finish column i of the rows that are not factored yet
+		for( k = 0; k < i; k++ )
+		{
+			column[k] = mat[k][i];
+		}
+		for( j = i; j < numRows; j++ )
+		{
+			float* row = mat[j];
+			row[i] = row[i] - DotProduct_SIMD( row, column, i );
+		}
+		
+		float* pivotRow = mat[i];
+		
+		newi = i;
+		s = idMath::Fabs( pivotRow[i] );
+		
+		if( index )
+		{
+			// find the largest absolute pivot
+			for( j = i + 1; j < numRows; j++ )
+			{
+				t = idMath::Fabs( mat[j][i] );
+				if( t > s )
+				{
+					newi = j;
+					s = t;
+				}
+			}
+		}
+		
+		if( s == 0.0f )
+		{
+			return false;
+		}
+		
+		if( newi != i && index )
+		{
+		
+			w = -w;
+			
+			// swap index elements
+			k = index[i];
+			index[i] = index[newi];
+			index[newi] = k;
+			
+			// swap rows
+			float* swapRow = mat[newi];
+			for( j = 0; j < numColumns; j++ )
+			{
+				t = swapRow[j];
+				swapRow[j] = pivotRow[j];
+				pivotRow[j] = t;
+			}
+		}
+		
+		// finish row i of U
+		const int count = numColumns - i - 1;
+		if( count > 0 )
+		{
+			for( k = 0; k < count; k++ )
+			{
+				sum[k] = pivotRow[i + 1 + k];
+			}
+			for( j = 0; j + 4 <= i; j += 4 )
+			{
+				MultiplySub4_SIMD( sum, pivotRow + j, mat[j + 0] + i + 1, mat[j + 1] + i + 1, mat[j + 2] + i + 1, mat[j + 3] + i + 1, count );
+			}
+			for( ; j < i; j++ )
+			{
+				const float l = pivotRow[j];
+				const float* src = mat[j] + i + 1;
+				for( k = 0; k < count; k++ )
+				{
+					sum[k] -= l * src[k];
 				}
 			}
+			for( k = 0; k < count; k++ )
+			{
+				pivotRow[i + 1 + k] = sum[k];
+			}
+		}
+		
+		d = 1.0f / pivotRow[i];
+		for( j = i + 1; j < numRows; j++ )
+		{
+			mat[j][i] *= d;
 		}
 	}
 	
@@ -1367,7 +1678,7 @@ bool idMatX::LU_Factor( int* index, float* det )
 	{
 		for( i = 0; i < numRows; i++ )
 		{
-			w *= ( *this )[i][i];
+			w *= mat[i][i];
 		}
 		*det = w;
 	}
@@ -1375,6 +1686,30 @@ bool idMatX::LU_Factor( int* index, float* det )
 	return true;
 }
 
+#endif
+
+/*
+============
+idMatX::LU_Factor
+
+  in-place factorization: LU
+  L is a triangular matrix stored in the lower triangle.
+  L has ones on the diagonal that are not stored.
+  U is a triangular matrix stored in the upper triangle.
+  If index != NULL partial pivoting is used for numerical stability.
+  If index != NULL it must point to an array of numRow integers and is used to keep track of the row permutation.
+  If det != NULL the determinant of the matrix is calculated and stored.
+============
+*/
+bool idMatX::LU_Factor( int* index, float* det )
+{
+#ifdef MATX_SIMD
+	return LU_Factor_SIMD( *this, index, det );
+#else
+	return LU_Factor_Generic( *this, index, det );
+#endif
+}
+
 /*
 ============
 idMatX::LU_UpdateRankOne
@@ -1789,13 +2124,13 @@ bool idMatX::LU_UpdateDecrement( const idVecX& v, const idVecX& w, const idVecX&
 
 /*
 ============
-idMatX::LU_Solve
-
-  Solve Ax = b with A factored in-place as: LU
+LU_Solve_Generic
 ============
 */
-void idMatX::LU_Solve( idVecX& x, const idVecX& b, const int* index ) const
+static void LU_Solve_Generic( const idMatX& mat, idVecX& x, const idVecX& b, const int* index )
 {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
 	int i, j;
 	double sum;
 	
@@ -1814,7 +2149,7 @@ void idMatX::LU_Solve( idVecX& x, const idVecX& b, const int* index ) const
 		}
 		for( j = 0; j < i; j++ )
 		{
-			sum -= ( *this )[i][j] * x[j];
+			sum -= mat[i][j] * x[j];
 		}
 		x[i] = sum;
 	}
@@ -1825,12 +2160,59 @@ void idMatX::LU_Solve( idVecX& x, const idVecX& b, const int* index ) const
 		sum = x[i];
 		for( j = i + 1; j < numRows; j++ )
 		{
-			sum -= ( *this )[i][j] * x[j];
+			sum -= mat[i][j] * x[j];
 		}
-		x[i] = sum / ( *this )[i][i];
+		x[i] = sum / mat[i][i];
+	}
+}
+
+#ifdef MATX_SIMD
+
+/*
+============
+LU_Solve_SIMD
+============
+*/
+static void LU_Solve_SIMD( const idMatX& mat, idVecX& x, const idVecX& b, const int* index )
+{
+	const int numRows = mat.GetNumRows();
+	float* xptr = x.ToFloatPtr();
+	
+	assert( x.GetSize() == mat.GetNumColumns() && b.GetSize() == numRows );
+	
+	// solve L
+	for( int i = 0; i < numRows; i++ )
+	{
+		const float sum = ( index != NULL ) ? b[index[i]] : b[i];
+		xptr[i] = sum - DotProduct_SIMD( mat[i], xptr, i );
+	}
+	
+	// solve U
+	for( int i = numRows - 1; i >= 0; i-- )
+	{
+		const float* row = mat[i];
+		xptr[i] = ( xptr[i] - DotProduct_SIMD( row + i + 1, xptr + i + 1, numRows - i - 1 ) ) / row[i];
 	}
 }
 
+#endif
+
+/*
+============
+idMatX::LU_Solve
+
+  Solve Ax = b with A factored in-place as: LU
+============
+*/
+void idMatX::LU_Solve( idVecX& x, const idVecX& b, const int* index ) const
+{
+#ifdef MATX_SIMD
+	LU_Solve_SIMD( *this, x, b, index );
+#else
+	LU_Solve_Generic( *this, x, b, index );
+#endif
+}
+
 /*
 ============
 idMatX::LU_Inverse
@@ -2958,16 +3340,13 @@ void idMatX::SVD_MultiplyFactors( idMatX& m, const idVecX& w, const idMatX& V )
 
 /*
 ============
-idMatX::Cholesky_Factor
-
-  in-place Cholesky factorization: LL'
-  L is a triangular matrix stored in the lower triangle.
-  The upper triangle is not cleared.
-  The initial matrix has to be symmetric positive definite.
+Cholesky_Factor_Generic
 ============
 */
-bool idMatX::Cholesky_Factor()
+static bool Cholesky_Factor_Generic( idMatX& mat )
 {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
 	int i, j, k;
 	float* invSqrt;
 	double sum;
@@ -2982,18 +3361,18 @@ bool idMatX::Cholesky_Factor()
 		for( j = 0; j < i; j++ )
 		{
 		
-			sum = ( *this )[i][j];
+			sum = mat[i][j];
 			for( k = 0; k < j; k++ )
 			{
-				sum -= ( *this )[i][k] * ( *this )[j][k];
+				sum -= mat[i][k] * mat[j][k];
 			}
-			( *this )[i][j] = sum * invSqrt[j];
+			mat[i][j] = sum * invSqrt[j];
 		}
 		
-		sum = ( *this )[i][i];
+		sum = mat[i][i];
 		for( k = 0; k < i; k++ )
 		{
-			sum -= ( *this )[i][k] * ( *this )[i][k];
+			sum -= mat[i][k] * mat[i][k];
 		}
 		
 		if( sum <= 0.0f )
@@ -3002,27 +3381,142 @@ bool idMatX::Cholesky_Factor()
 		}
 		
 		invSqrt[i] = idMath::InvSqrt( sum );
-		( *this )[i][i] = invSqrt[i] * sum;
+		mat[i][i] = invSqrt[i] * sum;
 	}
 	return true;
 }
 
+#ifdef MATX_SIMD
+
 /*
 ============
-idMatX::Cholesky_UpdateRankOne
+Cholesky_Tile_SIMD
 
-  Updates the in-place Cholesky factorization to obtain the factors for the matrix: LL' + alpha * v * v'
-  If offset > 0 only the lower right corner starting at (offset, offset) is updated.
+  Finishes four elements of a row of L given the dot products with the preceding part of the rows j to j+3.
 ============
 */
-bool idMatX::Cholesky_UpdateRankOne( const idVecX& v, float alpha, int offset )
+static ID_INLINE void Cholesky_Tile_SIMD( float* r, const double dot[4], const float* b1, const float* b2, const float* b3, const float* invSqrt, const int j )
 {
-	int i, j;
-	float* y;
-	double diag, invDiag, diagSqr, newDiag, newDiagSqr, beta, p, d;
+	r[j + 0] = ( r[j + 0] - dot[0] ) * invSqrt[j + 0];
+	r[j + 1] = ( r[j + 1] - dot[1] - r[j + 0] * b1[j + 0] ) * invSqrt[j + 1];
+	r[j + 2] = ( r[j + 2] - dot[2] - r[j + 0] * b2[j + 0] - r[j + 1] * b2[j + 1] ) * invSqrt[j + 2];
+	r[j + 3] = ( r[j + 3] - dot[3] - r[j + 0] * b3[j + 0] - r[j + 1] * b3[j + 1] - r[j + 2] * b3[j + 2] ) * invSqrt[j + 3];
+}
+
+/*
+============
+Cholesky_Factor_SIMD
+
+  Factors two rows at a time against blocks of four rows of L.
+  The last row of an odd sized matrix is paired with a scratch copy of itself.
+============
+*/
+static bool Cholesky_Factor_SIMD( idMatX& mat )
+{
+	const int numRows = mat.GetNumRows();
+	double dot0[4], dot1[4];
+	double sum;
 	
-	assert( numRows == numColumns );
-	assert( v.GetSize() >= numRows );
+	assert( numRows == mat.GetNumColumns() );
+	
+	float* invSqrt = ( float* ) _alloca16( numRows * sizeof( float ) );
+	float* scratch = ( float* ) _alloca16( numRows * sizeof( float ) );
+	
+	for( int i = 0; i < numRows; i += 2 )
+	{
+		float* r0 = mat[i];
+		float* r1 = scratch;
+		if( i + 1 < numRows )
+		{
+			r1 = mat[i + 1];
+		}
+		else
+		{
+			memcpy( scratch, r0, numRows * sizeof( float ) );
+		}
+		
+		int j = 0;
+		for( ; j + 4 <= i; j += 4 )
+		{
+			const float* b0 = mat[j + 0];
+			const float* b1 = mat[j + 1];
+			const float* b2 = mat[j + 2];
+			const float* b3 = mat[j + 3];
+			
+			DotProduct2x4_SIMD( dot0, dot1, r0, r1, b0, b1, b2, b3, j );
+			Cholesky_Tile_SIMD( r0, dot0, b1, b2, b3, invSqrt, j );
+			Cholesky_Tile_SIMD( r1, dot1, b1, b2, b3, invSqrt, j );
+		}
+		for( ; j < i; j++ )
+		{
+			const float* b = mat[j];
+			r0[j] = ( r0[j] - DotProduct_SIMD( r0, b, j ) ) * invSqrt[j];
+			r1[j] = ( r1[j] - DotProduct_SIMD( r1, b, j ) ) * invSqrt[j];
+		}
+		
+		sum = r0[i] - DotProduct_SIMD( r0, r0, i );
+		if( sum <= 0.0f )
+		{
+			return false;
+		}
+		invSqrt[i] = idMath::InvSqrt( sum );
+		r0[i] = invSqrt[i] * sum;
+		
+		if( r1 == scratch )
+		{
+			break;
+		}
+		
+		r1[i] = ( r1[i] - DotProduct_SIMD( r1, r0, i ) ) * invSqrt[i];
+		
+		sum = r1[i + 1] - DotProduct_SIMD( r1, r1, i + 1 );
+		if( sum <= 0.0f )
+		{
+			return false;
+		}
+		invSqrt[i + 1] = idMath::InvSqrt( sum );
+		r1[i + 1] = invSqrt[i + 1] * sum;
+	}
+	return true;
+}
+
+#endif
+
+/*
+============
+idMatX::Cholesky_Factor
+
+  in-place Cholesky factorization: LL'
+  L is a triangular matrix stored in the lower triangle.
+  The upper triangle is not cleared.
+  The initial matrix has to be symmetric positive definite.
+============
+*/
+bool idMatX::Cholesky_Factor()
+{
+#ifdef MATX_SIMD
+	return Cholesky_Factor_SIMD( *this );
+#else
+	return Cholesky_Factor_Generic( *this );
+#endif
+}
+
+/*
+============
+idMatX::Cholesky_UpdateRankOne
+
+  Updates the in-place Cholesky factorization to obtain the factors for the matrix: LL' + alpha * v * v'
+  If offset > 0 only the lower right corner starting at (offset, offset) is updated.
+============
+*/
+bool idMatX::Cholesky_UpdateRankOne( const idVecX& v, float alpha, int offset )
+{
+	int i, j;
+	float* y;
+	double diag, invDiag, diagSqr, newDiag, newDiagSqr, beta, p, d;
+	
+	assert( numRows == numColumns );
+	assert( v.GetSize() >= numRows );
 	assert( offset >= 0 && offset < numRows );
 	
 	y = ( float* ) _alloca16( v.GetSize() * sizeof( float ) );
@@ -3366,13 +3860,13 @@ bool idMatX::Cholesky_UpdateDecrement( const idVecX& v, int r )
 
 /*
 ============
-idMatX::Cholesky_Solve
-
-  Solve Ax = b with A factored in-place as: LL'
+Cholesky_Solve_Generic
 ============
 */
-void idMatX::Cholesky_Solve( idVecX& x, const idVecX& b ) const
+static void Cholesky_Solve_Generic( const idMatX& mat, idVecX& x, const idVecX& b )
 {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
 	int i, j;
 	double sum;
 	
@@ -3385,9 +3879,9 @@ void idMatX::Cholesky_Solve( idVecX& x, const idVecX& b ) const
 		sum = b[i];
 		for( j = 0; j < i; j++ )
 		{
-			sum -= ( *this )[i][j] * x[j];
+			sum -= mat[i][j] * x[j];
 		}
-		x[i] = sum / ( *this )[i][i];
+		x[i] = sum / mat[i][i];
 	}
 	
 	// solve Lt
@@ -3396,12 +3890,63 @@ void idMatX::Cholesky_Solve( idVecX& x, const idVecX& b ) const
 		sum = x[i];
 		for( j = i + 1; j < numRows; j++ )
 		{
-			sum -= ( *this )[j][i] * x[j];
+			sum -= mat[j][i] * x[j];
 		}
-		x[i] = sum / ( *this )[i][i];
+		x[i] = sum / mat[i][i];
+	}
+}
+
+#ifdef MATX_SIMD
+
+/*
+============
+Cholesky_Solve_SIMD
+
+  The transposed solve subtracts every solved element from the preceding ones so L is read row by row.
+============
+*/
+static void Cholesky_Solve_SIMD( const idMatX& mat, idVecX& x, const idVecX& b )
+{
+	const int numRows = mat.GetNumRows();
+	float* xptr = x.ToFloatPtr();
+	
+	assert( numRows == mat.GetNumColumns() );
+	assert( x.GetSize() >= numRows && b.GetSize() >= numRows );
+	
+	// solve L
+	for( int i = 0; i < numRows; i++ )
+	{
+		const float* row = mat[i];
+		xptr[i] = ( b[i] - DotProduct_SIMD( row, xptr, i ) ) / row[i];
+	}
+	
+	// solve Lt
+	for( int i = numRows - 1; i >= 0; i-- )
+	{
+		const float* row = mat[i];
+		xptr[i] /= row[i];
+		MultiplySub_SIMD( xptr, xptr[i], row, i );
 	}
 }
 
+#endif
+
+/*
+============
+idMatX::Cholesky_Solve
+
+  Solve Ax = b with A factored in-place as: LL'
+============
+*/
+void idMatX::Cholesky_Solve( idVecX& x, const idVecX& b ) const
+{
+#ifdef MATX_SIMD
+	Cholesky_Solve_SIMD( *this, x, b );
+#else
+	Cholesky_Solve_Generic( *this, x, b );
+#endif
+}
+
 /*
 ============
 idMatX::Cholesky_Inverse
@@ -3466,18 +4011,13 @@ void idMatX::Cholesky_MultiplyFactors( idMatX& m ) const
 
 /*
 ============
-idMatX::LDLT_Factor
-
-  in-place factorization: LDL'
-  L is a triangular matrix stored in the lower triangle.
-  L has ones on the diagonal that are not stored.
-  D is a diagonal matrix stored on the diagonal.
-  The upper triangle is not cleared.
-  The initial matrix has to be symmetric.
+LDLT_Factor_Generic
 ============
 */
-bool idMatX::LDLT_Factor()
+static bool LDLT_Factor_Generic( idMatX& mat )
 {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
 	int i, j, k;
 	float* v;
 	double d, sum;
@@ -3489,11 +4029,11 @@ bool idMatX::LDLT_Factor()
 	for( i = 0; i < numRows; i++ )
 	{
 	
-		sum = ( *this )[i][i];
+		sum = mat[i][i];
 		for( j = 0; j < i; j++ )
 		{
-			d = ( *this )[i][j];
-			v[j] = ( *this )[j][j] * d;
+			d = mat[i][j];
+			v[j] = mat[j][j] * d;
 			sum -= v[j] * d;
 		}
 		
@@ -3502,23 +4042,160 @@ bool idMatX::LDLT_Factor()
 			return false;
 		}
 		
-		( *this )[i][i] = sum;
+		mat[i][i] = sum;
 		d = 1.0f / sum;
 		
 		for( j = i + 1; j < numRows; j++ )
 		{
-			sum = ( *this )[j][i];
+			sum = mat[j][i];
 			for( k = 0; k < i; k++ )
 			{
-				sum -= ( *this )[j][k] * v[k];
+				sum -= mat[j][k] * v[k];
 			}
-			( *this )[j][i] = sum * d;
+			mat[j][i] = sum * d;
+		}
+	}
+	
+	return true;
+}
+
+#ifdef MATX_SIMD
+
+/*
+============
+LDLT_Tile_SIMD
+
+  Finishes four elements of a row of L given the dot products of w = L * D with the preceding part of the rows j to j+3.
+  The elements of L are scaled from the double sums so they are only rounded once.
+============
+*/
+static ID_INLINE void LDLT_Tile_SIMD( float* r, float* w, const double dot[4], const float* b1, const float* b2, const float* b3, const double* invDiag, const int j )
+{
+	double sum;
+	
+	sum = r[j + 0] - dot[0];
+	w[j + 0] = sum;
+	r[j + 0] = sum * invDiag[j + 0];
+	sum = r[j + 1] - dot[1] - w[j + 0] * b1[j + 0];
+	w[j + 1] = sum;
+	r[j + 1] = sum * invDiag[j + 1];
+	sum = r[j + 2] - dot[2] - w[j + 0] * b2[j + 0] - w[j + 1] * b2[j + 1];
+	w[j + 2] = sum;
+	r[j + 2] = sum * invDiag[j + 2];
+	sum = r[j + 3] - dot[3] - w[j + 0] * b3[j + 0] - w[j + 1] * b3[j + 1] - w[j + 2] * b3[j + 2];
+	w[j + 3] = sum;
+	r[j + 3] = sum * invDiag[j + 3];
+}
+
+/*
+============
+LDLT_Factor_SIMD
+
+  Factors two rows at a time against blocks of four rows of L.
+  The last row of an odd sized matrix is paired with a scratch copy of itself.
+============
+*/
+static bool LDLT_Factor_SIMD( idMatX& mat )
+{
+	const int numRows = mat.GetNumRows();
+	double dot0[4], dot1[4];
+	double sum;
+	
+	assert( numRows == mat.GetNumColumns() );
+	
+	double* invDiag = ( double* ) _alloca16( numRows * sizeof( double ) );
+	float* w0 = ( float* ) _alloca16( numRows * sizeof( float ) );
+	float* w1 = ( float* ) _alloca16( numRows * sizeof( float ) );
+	float* scratch = ( float* ) _alloca16( numRows * sizeof( float ) );
+	
+	for( int i = 0; i < numRows; i += 2 )
+	{
+		float* r0 = mat[i];
+		float* r1 = scratch;
+		if( i + 1 < numRows )
+		{
+			r1 = mat[i + 1];
+		}
+		else
+		{
+			memcpy( scratch, r0, numRows * sizeof( float ) );
+		}
+		
+		int j = 0;
+		for( ; j + 4 <= i; j += 4 )
+		{
+			const float* b0 = mat[j + 0];
+			const float* b1 = mat[j + 1];
+			const float* b2 = mat[j + 2];
+			const float* b3 = mat[j + 3];
+			
+			DotProduct2x4_SIMD( dot0, dot1, w0, w1, b0, b1, b2, b3, j );
+			LDLT_Tile_SIMD( r0, w0, dot0, b1, b2, b3, invDiag, j );
+			LDLT_Tile_SIMD( r1, w1, dot1, b1, b2, b3, invDiag, j );
+		}
+		for( ; j < i; j++ )
+		{
+			const float* b = mat[j];
+			sum = r0[j] - DotProduct_SIMD( w0, b, j );
+			w0[j] = sum;
+			r0[j] = sum * invDiag[j];
+			sum = r1[j] - DotProduct_SIMD( w1, b, j );
+			w1[j] = sum;
+			r1[j] = sum * invDiag[j];
+		}
+		
+		sum = r0[i] - DotProduct_SIMD( w0, r0, i );
+		if( sum == 0.0f )
+		{
+			return false;
+		}
+		r0[i] = sum;
+		invDiag[i] = 1.0f / sum;
+		
+		if( r1 == scratch )
+		{
+			break;
+		}
+		
+		sum = r1[i] - DotProduct_SIMD( w1, r0, i );
+		w1[i] = sum;
+		r1[i] = sum * invDiag[i];
+		
+		sum = r1[i + 1] - DotProduct_SIMD( w1, r1, i + 1 );
+		if( sum == 0.0f )
+		{
+			return false;
 		}
+		r1[i + 1] = sum;
+		invDiag[i + 1] = 1.0f / sum;
 	}
 	
 	return true;
 }
 
+#endif
+
+/*
+============
+idMatX::LDLT_Factor
+
+  in-place factorization: LDL'
+  L is a triangular matrix stored in the lower triangle.
+  L has ones on the diagonal that are not stored.
+  D is a diagonal matrix stored on the diagonal.
+  The upper triangle is not cleared.
+  The initial matrix has to be symmetric.
+============
+*/
+bool idMatX::LDLT_Factor()
+{
+#ifdef MATX_SIMD
+	return LDLT_Factor_SIMD( *this );
+#else
+	return LDLT_Factor_Generic( *this );
+#endif
+}
+
 /*
 ============
 idMatX::LDLT_UpdateRankOne
@@ -3897,13 +4574,13 @@ bool idMatX::LDLT_UpdateDecrement( const idVecX& v, int r )
 
 /*
 ============
-idMatX::LDLT_Solve
-
-  Solve Ax = b with A factored in-place as: LDL'
+LDLT_Solve_Generic
 ============
 */
-void idMatX::LDLT_Solve( idVecX& x, const idVecX& b ) const
+static void LDLT_Solve_Generic( const idMatX& mat, idVecX& x, const idVecX& b )
 {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
 	int i, j;
 	double sum;
 	
@@ -3916,7 +4593,7 @@ void idMatX::LDLT_Solve( idVecX& x, const idVecX& b ) const
 		sum = b[i];
 		for( j = 0; j < i; j++ )
 		{
-			sum -= ( *this )[i][j] * x[j];
+			sum -= mat[i][j] * x[j];
 		}
 		x[i] = sum;
 	}
@@ -3924,7 +4601,7 @@ void idMatX::LDLT_Solve( idVecX& x, const idVecX& b ) const
 	// solve D
 	for( i = 0; i < numRows; i++ )
 	{
-		x[i] /= ( *this )[i][i];
+		x[i] /= mat[i][i];
 	}
 	
 	// solve Lt
@@ -3933,12 +4610,66 @@ void idMatX::LDLT_Solve( idVecX& x, const idVecX& b ) const
 		sum = x[i];
 		for( j = i + 1; j < numRows; j++ )
 		{
-			sum -= ( *this )[j][i] * x[j];
+			sum -= mat[j][i] * x[j];
 		}
 		x[i] = sum;
 	}
 }
 
+#ifdef MATX_SIMD
+
+/*
+============
+LDLT_Solve_SIMD
+
+  The transposed solve subtracts every solved element from the preceding ones so L is read row by row.
+============
+*/
+static void LDLT_Solve_SIMD( const idMatX& mat, idVecX& x, const idVecX& b )
+{
+	const int numRows = mat.GetNumRows();
+	float* xptr = x.ToFloatPtr();
+	
+	assert( numRows == mat.GetNumColumns() );
+	assert( x.GetSize() >= numRows && b.GetSize() >= numRows );
+	
+	// solve L
+	for( int i = 0; i < numRows; i++ )
+	{
+		xptr[i] = b[i] - DotProduct_SIMD( mat[i], xptr, i );
+	}
+	
+	// solve D
+	for( int i = 0; i < numRows; i++ )
+	{
+		xptr[i] /= mat[i][i];
+	}
+	
+	// solve Lt
+	for( int i = numRows - 1; i > 0; i-- )
+	{
+		MultiplySub_SIMD( xptr, xptr[i], mat[i], i );
+	}
+}
+
+#endif
+
+/*
+============
+idMatX::LDLT_Solve
+
+  Solve Ax = b with A factored in-place as: LDL'
+============
+*/
+void idMatX::LDLT_Solve( idVecX& x, const idVecX& b ) const
+{
+#ifdef MATX_SIMD
+	LDLT_Solve_SIMD( *this, x, b );
+#else
+	LDLT_Solve_Generic( *this, x, b );
+#endif
+}
+
 /*
 ============
 idMatX::LDLT_Inverse
@@ -6163,3 +6894,386 @@ void idMatX::Test()
 		idLib::common->Warning( "idMatX::Eigen_Solve failed" );
 	}
 }
+
+/*
+================================================================================================
+
+	factorization benchmark
+
+================================================================================================
+*/
+
+#define TEST_FACTOR_EPSILON		1e-3f
+#define TEST_FACTOR_NUM_TESTS	5
+#define TEST_FACTOR_FLOPS		2000000.0
+
+typedef enum
+{
+	MATX_TEST_LU_FACTOR,
+	MATX_TEST_CHOLESKY_FACTOR,
+	MATX_TEST_LDLT_FACTOR,
+	MATX_TEST_LU_SOLVE,
+	MATX_TEST_CHOLESKY_SOLVE,
+	MATX_TEST_LDLT_SOLVE,
+	MATX_TEST_NUM
+} matxTest_t;
+
+static const char* matxTestNames[MATX_TEST_NUM] =
+{
+	"LU_Factor",
+	"Cholesky_Factor",
+	"LDLT_Factor",
+	"LU_Solve",
+	"Cholesky_Solve",
+	"LDLT_Solve"
+};
+
+/*
+============
+MatX_TestFlops
+============
+*/
+static double MatX_TestFlops( const matxTest_t test, const int n )
+{
+	switch( test )
+	{
+		case MATX_TEST_LU_FACTOR:
+			return 2.0 * n * n * n / 3.0;
+		case MATX_TEST_CHOLESKY_FACTOR:
+		case MATX_TEST_LDLT_FACTOR:
+			return ( double ) n * n * n / 3.0;
+		default:
+			return 2.0 * n * n;
+	}
+}
+
+/*
+============
+MatX_RunTest
+
+  Runs one factorization or solve numRuns times, the input is copied into the output matrix before every factorization.
+============
+*/
+static void MatX_RunTest( const matxTest_t test, const bool simd, const idMatX& input, idMatX& output, idVecX& x, const idVecX& b, int* index, const int numRuns )
+{
+	for( int i = 0; i < numRuns; i++ )
+	{
+		switch( test )
+		{
+			case MATX_TEST_LU_FACTOR:
+				output = input;
+#ifdef MATX_SIMD
+				if( simd )
+				{
+					LU_Factor_SIMD( output, index, NULL );
+					break;
+				}
+#endif
+				LU_Factor_Generic( output, index, NULL );
+				break;
+			case MATX_TEST_CHOLESKY_FACTOR:
+				output = input;
+#ifdef MATX_SIMD
+				if( simd )
+				{
+					Cholesky_Factor_SIMD( output );
+					break;
+				}
+#endif
+				Cholesky_Factor_Generic( output );
+				break;
+			case MATX_TEST_LDLT_FACTOR:
+				output = input;
+#ifdef MATX_SIMD
+				if( simd )
+				{
+					LDLT_Factor_SIMD( output );
+					break;
+				}
+#endif
+				LDLT_Factor_Generic( output );
+				break;
+			case MATX_TEST_LU_SOLVE:
+#ifdef MATX_SIMD
+				if( simd )
+				{
+					LU_Solve_SIMD( input, x, b, index );
+					break;
+				}
+#endif
+				LU_Solve_Generic( input, x, b, index );
+				break;
+			case MATX_TEST_CHOLESKY_SOLVE:
+#ifdef MATX_SIMD
+				if( simd )
+				{
+					Cholesky_Solve_SIMD( input, x, b );
+					break;
+				}
+#endif
+				Cholesky_Solve_Generic( input, x, b );
+				break;
+			case MATX_TEST_LDLT_SOLVE:
+#ifdef MATX_SIMD
+				if( simd )
+				{
+					LDLT_Solve_SIMD( input, x, b );
+					break;
+				}
+#endif
+				LDLT_Solve_Generic( input, x, b );
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/*
+============
+MatX_TimeTest
+
+  Returns the best time in milliseconds of a single run, without the time spent copying the input matrix.
+============
+*/
+static double MatX_TimeTest( const matxTest_t test, const bool simd, const idMatX& input, idMatX& output, idVecX& x, const idVecX& b, int* index, const int numRuns )
+{
+	idTimer timer;
+	double best = idMath::INFINITY;
+	double copy = idMath::INFINITY;
+	
+	for( int i = 0; i < TEST_FACTOR_NUM_TESTS; i++ )
+	{
+		timer.Clear();
+		timer.Start();
+		MatX_RunTest( test, simd, input, output, x, b, index, numRuns );
+		timer.Stop();
+		best = Min( best, timer.Milliseconds() );
+		
+		if( test <= MATX_TEST_LDLT_FACTOR )
+		{
+			timer.Clear();
+			timer.Start();
+			for( int j = 0; j < numRuns; j++ )
+			{
+				output = input;
+			}
+			timer.Stop();
+			copy = Min( copy, timer.Milliseconds() );
+		}
+	}
+	
+	if( test <= MATX_TEST_LDLT_FACTOR )
+	{
+		best = Max( best - copy, best * 0.01 );
+	}
+	
+	return best / numRuns;
+}
+
+/*
+============
+MatX_MaxRelativeError
+============
+*/
+static float MatX_MaxRelativeError( const float* a, const float* b, const int count )
+{
+	float maxError = 0.0f;
+	float maxValue = idMath::FLT_SMALLEST_NON_DENORMAL;
+	for( int i = 0; i < count; i++ )
+	{
+		maxError = Max( maxError, idMath::Fabs( a[i] - b[i] ) );
+		maxValue = Max( maxValue, idMath::Fabs( a[i] ) );
+	}
+	return maxError / maxValue;
+}
+
+/*
+============
+MatX_FactorResidual
+
+  Returns the largest error of the multiplied factors relative to the largest element of the original matrix.
+============
+*/
+static float MatX_FactorResidual( const matxTest_t test, const idMatX& original, const idMatX& factors, const int* index )
+{
+	idMatX m;
+	if( test == MATX_TEST_LU_FACTOR )
+	{
+		factors.LU_MultiplyFactors( m, index );
+	}
+	else
+	{
+		factors.LDLT_MultiplyFactors( m );
+	}
+	return MatX_MaxRelativeError( original.ToFloatPtr(), m.ToFloatPtr(), original.GetNumRows() * original.GetNumColumns() );
+}
+
+/*
+============
+MatX_TestIllConditioned
+
+  Factors a symmetric indefinite matrix with the rows and columns scaled over eight orders of magnitude.
+  Cholesky has to reject it on both paths, the SIMD LU and LDLT factors have to reproduce the matrix
+  within the residual of the generic factors.
+============
+*/
+static void MatX_TestIllConditioned( const int n, const int seed )
+{
+	idMatX src, original, m1, m2;
+	idVecX b, x;
+	
+	src.Random( n, n, seed, -1.0f, 1.0f );
+	original.SetSize( n, n );
+	const float scaleStep = idMath::Pow( 1e-4f, 1.0f / n );
+	float rowScale = 1.0f;
+	for( int i = 0; i < n; i++ )
+	{
+		float columnScale = 1.0f;
+		for( int j = 0; j < n; j++ )
+		{
+			original[i][j] = ( src[i][j] + src[j][i] ) * rowScale * columnScale;
+			columnScale *= scaleStep;
+		}
+		rowScale *= scaleStep;
+	}
+	
+	int* index1 = ( int* ) _alloca16( n * sizeof( int ) );
+	int* index2 = ( int* ) _alloca16( n * sizeof( int ) );
+	
+	for( int t = MATX_TEST_LU_FACTOR; t <= MATX_TEST_LDLT_FACTOR; t++ )
+	{
+		const matxTest_t test = ( matxTest_t ) t;
+		
+		if( test == MATX_TEST_CHOLESKY_FACTOR )
+		{
+			m1 = original;
+			const bool generic = Cholesky_Factor_Generic( m1 );
+			m2 = original;
+#ifdef MATX_SIMD
+			const bool simd = Cholesky_Factor_SIMD( m2 );
+#else
+			const bool simd = Cholesky_Factor_Generic( m2 );
+#endif
+			idLib::Printf( "%-16s %4d: indefinite matrix rejected by generic %s, by SIMD %s %s\n", matxTestNames[t], n,
+						   generic ? "no" : "yes", simd ? "no" : "yes", ( !generic && !simd ) ? "ok" : S_COLOR_RED"X" );
+			continue;
+		}
+		
+		MatX_RunTest( test, false, original, m1, x, b, index1, 1 );
+		MatX_RunTest( test, true, original, m2, x, b, index2, 1 );
+		
+		const float errorGeneric = MatX_FactorResidual( test, original, m1, index1 );
+		const float errorSIMD = MatX_FactorResidual( test, original, m2, index2 );
+		
+		idLib::Printf( "%-16s %4d: ill-conditioned residual generic %e, SIMD %e %s\n", matxTestNames[t], n, errorGeneric, errorSIMD,
+					   ( errorSIMD <= errorGeneric * 2.0f + n * idMath::FLT_EPSILON ) ? "ok" : S_COLOR_RED"X" );
+	}
+}
+
+/*
+============
+idMatX::Test_f
+
+  Reports GFLOP/s of the SIMD factorization and solve routines against the generic implementation
+  and checks the results against each other, then checks the factors of an ill-conditioned
+  indefinite matrix. Without arguments the matrix sizes produced by the articulated figure and
+  LCP code are tested, otherwise the arguments are the matrix sizes.
+============
+*/
+void idMatX::Test_f( const idCmdArgs& args )
+{
+	static const int defaultSizes[] = { 6, 12, 18, 24, 36, 48, 64, 96, 128, 160, 200 };
+	idList<int> sizes;
+	
+	if( args.Argc() > 1 )
+	{
+		for( int i = 1; i < args.Argc(); i++ )
+		{
+			int n = atoi( args.Argv( i ) );
+			if( n > 0 )
+			{
+				sizes.Append( n );
+			}
+		}
+	}
+	else
+	{
+		for( int i = 0; i < sizeof( defaultSizes ) / sizeof( defaultSizes[0] ); i++ )
+		{
+			sizes.Append( defaultSizes[i] );
+		}
+	}
+	
+#ifndef MATX_SIMD
+	idLib::Printf( "idMatX is compiled without SIMD, both columns use the generic code\n" );
+#endif
+	
+	for( int s = 0; s < sizes.Num(); s++ )
+	{
+		const int n = sizes[s];
+		idMatX src, original, m1, m2;
+		idVecX b, x1, x2;
+		
+		// symmetric positive definite so all three factorizations apply
+		src.Random( n, n, s, -1.0f, 1.0f );
+		original.SetSize( n, n );
+		src.TransposeMultiply( original, src );
+		for( int i = 0; i < n; i++ )
+		{
+			original[i][i] += n;
+		}
+		b.Random( n, s, -1.0f, 1.0f );
+		x1.SetSize( n );
+		x2.SetSize( n );
+		
+		int* index1 = ( int* ) _alloca16( n * sizeof( int ) );
+		int* index2 = ( int* ) _alloca16( n * sizeof( int ) );
+		
+		for( int t = 0; t < MATX_TEST_NUM; t++ )
+		{
+			const matxTest_t test = ( matxTest_t ) t;
+			const double flops = MatX_TestFlops( test, n );
+			const int numRuns = Max( 1, idMath::Ftoi( TEST_FACTOR_FLOPS / flops ) );
+			float error;
+			double msecGeneric, msecSIMD;
+			
+			if( test <= MATX_TEST_LDLT_FACTOR )
+			{
+				msecGeneric = MatX_TimeTest( test, false, original, m1, x1, b, index1, numRuns );
+				msecSIMD = MatX_TimeTest( test, true, original, m2, x2, b, index2, numRuns );
+				error = MatX_MaxRelativeError( m1.ToFloatPtr(), m2.ToFloatPtr(), n * n );
+				if( test == MATX_TEST_LU_FACTOR && memcmp( index1, index2, n * sizeof( int ) ) != 0 )
+				{
+					error = idMath::INFINITY;
+				}
+			}
+			else
+			{
+				// solve with the generic factorization so only the solve itself is compared
+				m1 = original;
+				if( test == MATX_TEST_LU_SOLVE )
+				{
+					LU_Factor_Generic( m1, index1, NULL );
+				}
+				else if( test == MATX_TEST_CHOLESKY_SOLVE )
+				{
+					Cholesky_Factor_Generic( m1 );
+				}
+				else
+				{
+					LDLT_Factor_Generic( m1 );
+				}
+				msecGeneric = MatX_TimeTest( test, false, m1, m2, x1, b, index1, numRuns );
+				msecSIMD = MatX_TimeTest( test, true, m1, m2, x2, b, index1, numRuns );
+				error = MatX_MaxRelativeError( x1.ToFloatPtr(), x2.ToFloatPtr(), n );
+			}
+			
+			idLib::Printf( "%-16s %4d: generic %7.3f GFLOP/s, SIMD %7.3f GFLOP/s, %5.2fx %s\n", matxTestNames[t], n,
+						   flops / ( msecGeneric * 1e6 ), flops / ( msecSIMD * 1e6 ), msecGeneric / msecSIMD,
+						   ( error < TEST_FACTOR_EPSILON ) ? "ok" : S_COLOR_RED"X" );
+		}
+		
+		MatX_TestIllConditioned( n, s );
+	}
+}
@@ -254,6 +254,7 @@ public:
 	void			Eigen_SortDecreasing( idVecX& eigenValues );
 	
 	static void		Test();
+	static void		Test_f( const class idCmdArgs& args );
 	
 private:
 	int				numRows;				// number of rows
@@ -36,10 +36,29 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Simd_Generic.h"
 #include "Simd_SSE.h"
+#include "Simd_AVX2.h"
 
 idSIMDProcessor*		processor = NULL;			// pointer to SIMD processor
 idSIMDProcessor* 	generic = NULL;				// pointer to generic SIMD implementation
 idSIMDProcessor* 	SIMDProcessor = NULL;
+static bool			deterministicMath = false;		// bit reproducible results on every CPU
+
+// the MXCSR is per thread, so the other threads pick the denormal modes up in ApplyThreadFPUMode
+static bool			fpuFlushToZero = false;
+static bool			fpuDenormalsAreZero = false;
+static interlockedInt_t	fpuModeGeneration = 0;			// changes whenever the modes above change
+static ID_TLS		fpuModeApplied;					// generation applied by this thread
+
+/*
+================
+HasAVX2
+================
+*/
+static bool HasAVX2( cpuid_t cpuid )
+{
+	const int required = CPUID_AVX | CPUID_AVX2 | CPUID_FMA3;
+	return ( cpuid & required ) == required;
+}
 
 /*
 ================
@@ -57,16 +76,22 @@ void idSIMD::Init()
 /*
 ============
 idSIMD::InitProcessor
+
+In deterministic mode the generic processor is used, because the SSE and AVX2
+processors use the reciprocal estimates and fused multiply-adds which give
+different results on different CPUs. Flush-To-Zero and Denormals-Are-Zero are
+turned off so the denormal handling does not depend on the CPU either. The modes
+are set on the calling thread here and on the other threads by ApplyThreadFPUMode.
 ============
 */
-void idSIMD::InitProcessor( const char* module, bool forceGeneric )
+void idSIMD::InitProcessor( const char* module, bool forceGeneric, bool deterministic )
 {
 	cpuid_t cpuid;
 	idSIMDProcessor* newProcessor;
 	
 	cpuid = idLib::sys->GetProcessorId();
 	
-	if( forceGeneric )
+	if( forceGeneric || deterministic )
 	{
 	
 		newProcessor = generic;
@@ -78,7 +103,11 @@ void idSIMD::InitProcessor( const char* module, bool forceGeneric )
 		if( processor == NULL )
 		{
 #if defined(USE_INTRINSICS)
-			if( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) )
+			if( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && HasAVX2( cpuid ) )
+			{
+				processor = new( TAG_MATH ) idSIMD_AVX2;
+			}
+			else if( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) )
 			{
 				processor = new( TAG_MATH ) idSIMD_SSE;
 			}
@@ -99,19 +128,65 @@ void idSIMD::InitProcessor( const char* module, bool forceGeneric )
 		idLib::common->Printf( "%s using %s for SIMD processing\n", module, SIMDProcessor->GetName() );
 	}
 	
-	if( cpuid & CPUID_FTZ )
+	if( deterministic != deterministicMath )
+	{
+		deterministicMath = deterministic;
+		idLib::common->Printf( "%s %s deterministic math\n", module, deterministic ? "enabled" : "disabled" );
+	}
+	
+	const bool flushToZero = !deterministic && ( cpuid & CPUID_FTZ ) != 0;
+	const bool denormalsAreZero = !deterministic && ( cpuid & CPUID_DAZ ) != 0;
+	if( fpuModeGeneration == 0 || flushToZero != fpuFlushToZero || denormalsAreZero != fpuDenormalsAreZero )
+	{
+		fpuFlushToZero = flushToZero;
+		fpuDenormalsAreZero = denormalsAreZero;
+		Sys_InterlockedIncrement( fpuModeGeneration );
+	}
+	ApplyThreadFPUMode();
+	
+	if( flushToZero )
 	{
-		idLib::sys->FPU_SetFTZ( true );
 		idLib::common->Printf( "enabled Flush-To-Zero mode\n" );
 	}
 	
-	if( cpuid & CPUID_DAZ )
+	if( denormalsAreZero )
 	{
-		idLib::sys->FPU_SetDAZ( true );
 		idLib::common->Printf( "enabled Denormals-Are-Zero mode\n" );
 	}
 }
 
+/*
+============
+idSIMD::ApplyThreadFPUMode
+
+Sets the denormal modes chosen by the last InitProcessor on the calling thread, cheap
+when they are already set. Called by every idSysThread when it starts and before each
+run of a worker, so the job threads are updated when a job list is submitted.
+============
+*/
+void idSIMD::ApplyThreadFPUMode()
+{
+	const int generation = fpuModeGeneration;
+	if( generation == 0 || ( ptrdiff_t )fpuModeApplied == generation )
+	{
+		return;
+	}
+	SYS_MEMORYBARRIER;
+	idLib::sys->FPU_SetFTZ( fpuFlushToZero );
+	idLib::sys->FPU_SetDAZ( fpuDenormalsAreZero );
+	fpuModeApplied = generation;
+}
+
+/*
+============
+idSIMD::IsDeterministic
+============
+*/
+bool idSIMD::IsDeterministic()
+{
+	return deterministicMath;
+}
+
 /*
 ================
 idSIMD::Shutdown
@@ -183,8 +258,23 @@ double ticksPerNanosecond;
 #define StopRecordTime( end )				\
 	end = mach_absolute_time();
 
-#else // not _MSC_VER and _M_IX86 or __APPLE__
-// FIXME: meaningful values/functions here for Linux?
+#elif defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#if defined(_MSC_VER)
+#define ReadTimeStampCounter()				__rdtsc()
+#else
+#define ReadTimeStampCounter()				__builtin_ia32_rdtsc()
+#endif
+
+#define TIME_TYPE uint64
+
+#define StartRecordTime( start )			\
+	start = ReadTimeStampCounter();
+
+#define StopRecordTime( end )				\
+	end = ReadTimeStampCounter();
+
+#else // not x86 or __APPLE__
 #define TIME_TYPE int
 
 #define StartRecordTime( start )			\
@@ -235,7 +325,8 @@ GetBaseClocks
 */
 void GetBaseClocks()
 {
-	int i, start, end, bestClocks;
+	int i;
+	TIME_TYPE start, end, bestClocks;
 	
 	bestClocks = 0;
 	for( i = 0; i < NUMTESTS; i++ )
@@ -886,6 +977,82 @@ void TestTransformJoints()
 	PrintClocks( va( "   simd->TransformJoints() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestTransformJointsBatch
+============
+*/
+void TestTransformJointsBatch()
+{
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	idTempArray< idJointMat > joints( COUNT + 1 );
+	idTempArray< idJointMat > joints1( COUNT + 1 );
+	idTempArray< idJointMat > joints2( COUNT + 1 );
+	idTempArray< int > parents( COUNT + 1 );
+	idTempArray< int > indexes( COUNT );
+	const char* result;
+	
+	idRandom srnd( RANDOM_SEED );
+	
+	for( i = 0; i <= COUNT; i++ )
+	{
+		idAngles angles;
+		angles[0] = srnd.CRandomFloat() * 180.0f;
+		angles[1] = srnd.CRandomFloat() * 180.0f;
+		angles[2] = srnd.CRandomFloat() * 180.0f;
+		joints[i].SetRotation( angles.ToMat3() );
+		idVec3 v;
+		v[0] = srnd.CRandomFloat() * 2.0f;
+		v[1] = srnd.CRandomFloat() * 2.0f;
+		v[2] = srnd.CRandomFloat() * 2.0f;
+		joints[i].SetTranslation( v );
+		// all joints hang off the first few so they are independent of each other
+		parents[i] = ( i > 4 ) ? ( i & 3 ) : -1;
+	}
+	for( i = 0; i < COUNT - 4; i++ )
+	{
+		indexes[i] = COUNT - i;
+	}
+	
+	bestClocksGeneric = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		for( j = 0; j <= COUNT; j++ )
+		{
+			joints1[j] = joints[j];
+		}
+		StartRecordTime( start );
+		p_generic->TransformJointsBatch( joints1.Ptr(), parents.Ptr(), indexes.Ptr(), COUNT - 4 );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->TransformJointsBatch()", COUNT - 4, bestClocksGeneric );
+	
+	bestClocksSIMD = 0;
+	for( i = 0; i < NUMTESTS; i++ )
+	{
+		for( j = 0; j <= COUNT; j++ )
+		{
+			joints2[j] = joints[j];
+		}
+		StartRecordTime( start );
+		p_simd->TransformJointsBatch( joints2.Ptr(), parents.Ptr(), indexes.Ptr(), COUNT - 4 );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+	
+	for( i = 0; i <= COUNT; i++ )
+	{
+		if( !joints1[i].Compare( joints2[i], 1e-3f ) )
+		{
+			break;
+		}
+	}
+	result = ( i > COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->TransformJointsBatch() %s", result ), COUNT - 4, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestUntransformJoints
@@ -1365,9 +1532,38 @@ void TestMath()
 	PrintClocks( "     idAngles::ToMat3()", 1, bestClocks );
 }
 
+/*
+============
+TestProcessor
+
+validates and times p_simd against p_generic
+============
+*/
+void TestProcessor()
+{
+	idLib::common->Printf( "====================================\n" );
+	idLib::common->Printf( "using %s for SIMD processing\n", p_simd->GetName() );
+	
+	TestMinMax();
+	TestMemcpy();
+	TestMemset();
+	
+	idLib::common->Printf( "====================================\n" );
+	
+	TestBlendJoints();
+	TestBlendJointsFast();
+	TestConvertJointQuatsToJointMats();
+	TestConvertJointMatsToJointQuats();
+	TestTransformJoints();
+	TestTransformJointsBatch();
+	TestUntransformJoints();
+}
+
 /*
 ============
 idSIMD::Test_f
+
+without arguments every processor the CPU supports is tested side by side
 ============
 */
 void idSIMD::Test_f( const idCmdArgs& args )
@@ -1379,12 +1575,13 @@ void idSIMD::Test_f( const idCmdArgs& args )
 #endif
 	// RB end
 	
-	p_simd = processor;
+	idStaticList< idSIMDProcessor*, 4 > testProcessors;
+	cpuid_t cpuid = idLib::sys->GetProcessorId();
+	
 	p_generic = generic;
 	
 	if( idStr::Length( args.Argv( 1 ) ) != 0 )
 	{
-		cpuid_t cpuid = idLib::sys->GetProcessorId();
 		idStr argString = args.Args();
 		
 		argString.Replace( " ", "" );
@@ -1397,44 +1594,61 @@ void idSIMD::Test_f( const idCmdArgs& args )
 				common->Printf( "CPU does not support MMX & SSE\n" );
 				return;
 			}
-			p_simd = new( TAG_MATH ) idSIMD_SSE;
+			testProcessors.Append( new( TAG_MATH ) idSIMD_SSE );
+		}
+		else if( idStr::Icmp( argString, "AVX2" ) == 0 )
+		{
+			if( !HasAVX2( cpuid ) )
+			{
+				common->Printf( "CPU does not support AVX2 & FMA\n" );
+				return;
+			}
+			testProcessors.Append( new( TAG_MATH ) idSIMD_AVX2 );
 		}
 		else
 #endif
 		{
-			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
+			common->Printf( "invalid argument, use: SSE, AVX2\n" );
+			return;
+		}
+	}
+	else
+	{
+#if defined(USE_INTRINSICS)
+		if( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) )
+		{
+			testProcessors.Append( new( TAG_MATH ) idSIMD_SSE );
+			
+			if( HasAVX2( cpuid ) )
+			{
+				testProcessors.Append( new( TAG_MATH ) idSIMD_AVX2 );
+			}
+		}
+#endif
+		if( testProcessors.Num() == 0 )
+		{
+			common->Printf( "CPU has no SIMD processor besides generic\n" );
 			return;
 		}
 	}
 	
 	idLib::common->SetRefreshOnPrint( true );
 	
-	idLib::common->Printf( "using %s for SIMD processing\n", p_simd->GetName() );
-	
 	GetBaseClocks();
 	
 	TestMath();
-	TestMinMax();
-	TestMemcpy();
-	TestMemset();
-	
-	idLib::common->Printf( "====================================\n" );
 	
-	TestBlendJoints();
-	TestBlendJointsFast();
-	TestConvertJointQuatsToJointMats();
-	TestConvertJointMatsToJointQuats();
-	TestTransformJoints();
-	TestUntransformJoints();
+	for( int i = 0; i < testProcessors.Num(); i++ )
+	{
+		p_simd = testProcessors[i];
+		TestProcessor();
+	}
 	
 	idLib::common->Printf( "====================================\n" );
 	
 	idLib::common->SetRefreshOnPrint( false );
 	
-	if( p_simd != processor )
-	{
-		delete p_simd;
-	}
+	testProcessors.DeleteContents( true );
 	p_simd = NULL;
 	p_generic = NULL;
 	
@@ -44,7 +44,9 @@ class idSIMD
 {
 public:
 	static void			Init();
-	static void			InitProcessor( const char* module, bool forceGeneric );
+	static void			InitProcessor( const char* module, bool forceGeneric, bool deterministic = false );
+	static bool			IsDeterministic();
+	static void			ApplyThreadFPUMode();
 	static void			Shutdown();
 	static void			Test_f( const class idCmdArgs& args );
 };
@@ -112,6 +114,8 @@ public:
 	virtual void VPCALL ConvertJointMatsToJointQuats( idJointQuat* jointQuats, const idJointMat* jointMats, const int numJoints ) = 0;
 	virtual void VPCALL TransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint ) = 0;
 	virtual void VPCALL UntransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint ) = 0;
+	// transforms a set of joints that don't depend on each other, like all joints at the same hierarchy depth
+	virtual void VPCALL TransformJointsBatch( idJointMat* jointMats, const int* parents, const int* jointIndexes, const int numJoints ) = 0;
 };
 
 // pointer to SIMD processor
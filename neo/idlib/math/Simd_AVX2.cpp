@@ -0,0 +1,821 @@
+/*
+===========================================================================
+
+Doom 3 BFG Edition GPL Source Code
+Copyright (C) 1993-2012 id Software LLC, a ZeniMax Media company.
+Copyright (C) 2012 Robert Beckebans
+
+This file is part of the Doom 3 BFG Edition GPL Source Code ("Doom 3 BFG Edition Source Code").
+
+Doom 3 BFG Edition Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 BFG Edition Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 BFG Edition Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 BFG Edition Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 BFG Edition Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#pragma hdrstop
+#include "precompiled.h"
+#include "Simd_Generic.h"
+#include "Simd_SSE.h"
+#include "Simd_AVX2.h"
+
+//===============================================================
+//
+//	AVX2 & FMA implementation of idSIMDProcessor
+//
+//===============================================================
+
+#if defined(USE_INTRINSICS)
+
+#include <immintrin.h>
+
+#ifndef M_PI
+#define M_PI	3.14159265358979323846f
+#endif
+
+// The rest of the engine is built for SSE2 only, so GCC and Clang have to be told
+// per function that they may emit AVX2 and FMA instructions. MSVC accepts the
+// intrinsics anywhere. These functions are only ever called after the CPUID check.
+#if defined(__GNUC__) || defined(__clang__)
+#define ID_AVX2_TARGET		__attribute__( ( target( "avx,avx2,fma" ) ) )
+#else
+#define ID_AVX2_TARGET
+#endif
+
+/*
+============
+LoadLanes
+
+loads two unrelated 4 float vectors into the low and high lane
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256 LoadLanes( const float* lo, const float* hi )
+{
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( lo ) ), _mm_loadu_ps( hi ), 1 );
+}
+
+/*
+============
+StoreLanes
+============
+*/
+ID_AVX2_TARGET static ID_INLINE void StoreLanes( float* lo, float* hi, const __m256 v )
+{
+	_mm_storeu_ps( lo, _mm256_castps256_ps128( v ) );
+	_mm_storeu_ps( hi, _mm256_extractf128_ps( v, 1 ) );
+}
+
+/*
+============
+BroadcastLanes
+
+copies a 4 float vector into both lanes
+============
+*/
+ID_AVX2_TARGET static ID_INLINE __m256 BroadcastLanes( const __m128 v )
+{
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( v ), v, 1 );
+}
+
+/*
+============
+HorizontalMin
+============
+*/
+ID_AVX2_TARGET static ID_INLINE float HorizontalMin( const __m256 v )
+{
+	__m128 m = _mm_min_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	m = _mm_min_ps( m, _mm_movehl_ps( m, m ) );
+	m = _mm_min_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	return _mm_cvtss_f32( m );
+}
+
+/*
+============
+HorizontalMax
+============
+*/
+ID_AVX2_TARGET static ID_INLINE float HorizontalMax( const __m256 v )
+{
+	__m128 m = _mm_max_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	m = _mm_max_ps( m, _mm_movehl_ps( m, m ) );
+	m = _mm_max_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	return _mm_cvtss_f32( m );
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char* idSIMD_AVX2::GetName() const
+{
+	return "MMX & SSE & AVX2 & FMA";
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( float& min, float& max, const float* src, const int count )
+{
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		const __m256 v = _mm256_loadu_ps( src + i );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+	
+	min = HorizontalMin( vmin );
+	max = HorizontalMax( vmax );
+	
+	for( ; i < count; i++ )
+	{
+		if( src[i] < min )
+		{
+			min = src[i];
+		}
+		if( src[i] > max )
+		{
+			max = src[i];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec2& min, idVec2& max, const idVec2* src, const int count )
+{
+	const float* srcPtr = src->ToFloatPtr();
+	
+	// four vectors per register, the lanes alternate x y x y
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 )
+	{
+		const __m256 v = _mm256_loadu_ps( srcPtr + i * 2 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+	
+	__m128 mn = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 mx = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	mn = _mm_min_ps( mn, _mm_movehl_ps( mn, mn ) );
+	mx = _mm_max_ps( mx, _mm_movehl_ps( mx, mx ) );
+	
+	ALIGN16( float tmp[8] );
+	_mm_store_ps( tmp + 0, mn );
+	_mm_store_ps( tmp + 4, mx );
+	min.Set( tmp[0], tmp[1] );
+	max.Set( tmp[4], tmp[5] );
+	
+	for( ; i < count; i++ )
+	{
+		const idVec2& v = src[i];
+		if( v[0] < min[0] )
+		{
+			min[0] = v[0];
+		}
+		if( v[0] > max[0] )
+		{
+			max[0] = v[0];
+		}
+		if( v[1] < min[1] )
+		{
+			min[1] = v[1];
+		}
+		if( v[1] > max[1] )
+		{
+			max[1] = v[1];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3& min, idVec3& max, const idVec3* src, const int count )
+{
+	const float* srcPtr = src->ToFloatPtr();
+	const int numFloats = count * 3;
+	
+	// eight vectors are three registers, float k of the block is component k % 3
+	__m256 vmin0 = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmin1 = vmin0;
+	__m256 vmin2 = vmin0;
+	__m256 vmax0 = _mm256_set1_ps( -idMath::INFINITY );
+	__m256 vmax1 = vmax0;
+	__m256 vmax2 = vmax0;
+	
+	int i = 0;
+	for( ; i + 24 <= numFloats; i += 24 )
+	{
+		const __m256 v0 = _mm256_loadu_ps( srcPtr + i + 0 );
+		const __m256 v1 = _mm256_loadu_ps( srcPtr + i + 8 );
+		const __m256 v2 = _mm256_loadu_ps( srcPtr + i + 16 );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmin2 = _mm256_min_ps( vmin2, v2 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+		vmax2 = _mm256_max_ps( vmax2, v2 );
+	}
+	
+	float mins[24];
+	float maxs[24];
+	_mm256_storeu_ps( mins + 0, vmin0 );
+	_mm256_storeu_ps( mins + 8, vmin1 );
+	_mm256_storeu_ps( mins + 16, vmin2 );
+	_mm256_storeu_ps( maxs + 0, vmax0 );
+	_mm256_storeu_ps( maxs + 8, vmax1 );
+	_mm256_storeu_ps( maxs + 16, vmax2 );
+	
+	min[0] = min[1] = min[2] = idMath::INFINITY;
+	max[0] = max[1] = max[2] = -idMath::INFINITY;
+	
+	for( int j = 0; j < 24; j++ )
+	{
+		const int c = j % 3;
+		if( mins[j] < min[c] )
+		{
+			min[c] = mins[j];
+		}
+		if( maxs[j] > max[c] )
+		{
+			max[c] = maxs[j];
+		}
+	}
+	
+	for( ; i < numFloats; i++ )
+	{
+		const int c = i % 3;
+		if( srcPtr[i] < min[c] )
+		{
+			min[c] = srcPtr[i];
+		}
+		if( srcPtr[i] > max[c] )
+		{
+			max[c] = srcPtr[i];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3& min, idVec3& max, const idDrawVert* src, const int count )
+{
+	// two vertices per register, the fourth float of each lane is ignored
+	__m256 vmin0 = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmin1 = vmin0;
+	__m256 vmax0 = _mm256_set1_ps( -idMath::INFINITY );
+	__m256 vmax1 = vmax0;
+	
+	int i = 0;
+	for( ; i + 4 <= count; i += 4 )
+	{
+		const __m256 v0 = LoadLanes( src[i + 0].xyz.ToFloatPtr(), src[i + 1].xyz.ToFloatPtr() );
+		const __m256 v1 = LoadLanes( src[i + 2].xyz.ToFloatPtr(), src[i + 3].xyz.ToFloatPtr() );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+	}
+	
+	vmin0 = _mm256_min_ps( vmin0, vmin1 );
+	vmax0 = _mm256_max_ps( vmax0, vmax1 );
+	
+	ALIGN16( float tmp[8] );
+	_mm_store_ps( tmp + 0, _mm_min_ps( _mm256_castps256_ps128( vmin0 ), _mm256_extractf128_ps( vmin0, 1 ) ) );
+	_mm_store_ps( tmp + 4, _mm_max_ps( _mm256_castps256_ps128( vmax0 ), _mm256_extractf128_ps( vmax0, 1 ) ) );
+	min.Set( tmp[0], tmp[1], tmp[2] );
+	max.Set( tmp[4], tmp[5], tmp[6] );
+	
+	for( ; i < count; i++ )
+	{
+		const idVec3& v = src[i].xyz;
+		for( int c = 0; c < 3; c++ )
+		{
+			if( v[c] < min[c] )
+			{
+				min[c] = v[c];
+			}
+			if( v[c] > max[c] )
+			{
+				max[c] = v[c];
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3& min, idVec3& max, const idDrawVert* src, const triIndex_t* indexes, const int count )
+{
+	compile_time_assert( DRAWVERT_SIZE == 8 * sizeof( float ) );
+	
+	const float* xyzPtr = src->xyz.ToFloatPtr();
+	
+	// gather eight indexed vertices per iteration
+	__m256 vminx = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vminy = vminx;
+	__m256 vminz = vminx;
+	__m256 vmaxx = _mm256_set1_ps( -idMath::INFINITY );
+	__m256 vmaxy = vmaxx;
+	__m256 vmaxz = vmaxx;
+	
+	int i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256i offsets;
+		if( sizeof( triIndex_t ) == 2 )
+		{
+			offsets = _mm256_cvtepu16_epi32( _mm_loadu_si128( ( const __m128i* )( indexes + i ) ) );
+		}
+		else
+		{
+			offsets = _mm256_loadu_si256( ( const __m256i* )( indexes + i ) );
+		}
+		offsets = _mm256_slli_epi32( offsets, 3 );		// DRAWVERT_SIZE / sizeof( float )
+		
+		const __m256 x = _mm256_i32gather_ps( xyzPtr + 0, offsets, 4 );
+		const __m256 y = _mm256_i32gather_ps( xyzPtr + 1, offsets, 4 );
+		const __m256 z = _mm256_i32gather_ps( xyzPtr + 2, offsets, 4 );
+		
+		vminx = _mm256_min_ps( vminx, x );
+		vminy = _mm256_min_ps( vminy, y );
+		vminz = _mm256_min_ps( vminz, z );
+		vmaxx = _mm256_max_ps( vmaxx, x );
+		vmaxy = _mm256_max_ps( vmaxy, y );
+		vmaxz = _mm256_max_ps( vmaxz, z );
+	}
+	
+	min.Set( HorizontalMin( vminx ), HorizontalMin( vminy ), HorizontalMin( vminz ) );
+	max.Set( HorizontalMax( vmaxx ), HorizontalMax( vmaxy ), HorizontalMax( vmaxz ) );
+	
+	for( ; i < count; i++ )
+	{
+		const idVec3& v = src[indexes[i]].xyz;
+		for( int c = 0; c < 3; c++ )
+		{
+			if( v[c] < min[c] )
+			{
+				min[c] = v[c];
+			}
+			if( v[c] > max[c] )
+			{
+				max[c] = v[c];
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+
+The SSE slerp with eight joints per iteration. Joint k and joint k + 4 share a register,
+the low and high lanes are transposed independently.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat* joints, const idJointQuat* blendJoints, const float lerp, const int* index, const int numJoints )
+{
+	if( lerp <= 0.0f || lerp >= 1.0f || numJoints < 8 )
+	{
+		idSIMD_SSE::BlendJoints( joints, blendJoints, lerp, index, numJoints );
+		return;
+	}
+	
+	const __m256 vlerp = _mm256_set1_ps( lerp );
+	
+	const __m256 vector_float_one		= _mm256_set1_ps( 1.0f );
+	const __m256 vector_float_sign_bit	= _mm256_castsi256_ps( _mm256_set1_epi32( 0x80000000 ) );
+	const __m256 vector_float_rsqrt_c0	= _mm256_set1_ps( -3.0f );
+	const __m256 vector_float_rsqrt_c1	= _mm256_set1_ps( -0.5f );
+	const __m256 vector_float_tiny		= _mm256_set1_ps( 1e-10f );
+	const __m256 vector_float_half_pi	= _mm256_set1_ps( M_PI * 0.5f );
+	
+	const __m256 vector_float_sin_c0	= _mm256_set1_ps( -2.39e-08f );
+	const __m256 vector_float_sin_c1	= _mm256_set1_ps( 2.7526e-06f );
+	const __m256 vector_float_sin_c2	= _mm256_set1_ps( -1.98409e-04f );
+	const __m256 vector_float_sin_c3	= _mm256_set1_ps( 8.3333315e-03f );
+	const __m256 vector_float_sin_c4	= _mm256_set1_ps( -1.666666664e-01f );
+	
+	const __m256 vector_float_atan_c0	= _mm256_set1_ps( 0.0028662257f );
+	const __m256 vector_float_atan_c1	= _mm256_set1_ps( -0.0161657367f );
+	const __m256 vector_float_atan_c2	= _mm256_set1_ps( 0.0429096138f );
+	const __m256 vector_float_atan_c3	= _mm256_set1_ps( -0.0752896400f );
+	const __m256 vector_float_atan_c4	= _mm256_set1_ps( 0.1065626393f );
+	const __m256 vector_float_atan_c5	= _mm256_set1_ps( -0.1420889944f );
+	const __m256 vector_float_atan_c6	= _mm256_set1_ps( 0.1999355085f );
+	const __m256 vector_float_atan_c7	= _mm256_set1_ps( -0.3333314528f );
+	
+	int i = 0;
+	for( ; i + 7 < numJoints; i += 8 )
+	{
+		const int n0 = index[i + 0];
+		const int n1 = index[i + 1];
+		const int n2 = index[i + 2];
+		const int n3 = index[i + 3];
+		const int n4 = index[i + 4];
+		const int n5 = index[i + 5];
+		const int n6 = index[i + 6];
+		const int n7 = index[i + 7];
+		
+		__m256 jqa = LoadLanes( joints[n0].q.ToFloatPtr(), joints[n4].q.ToFloatPtr() );
+		__m256 jqb = LoadLanes( joints[n1].q.ToFloatPtr(), joints[n5].q.ToFloatPtr() );
+		__m256 jqc = LoadLanes( joints[n2].q.ToFloatPtr(), joints[n6].q.ToFloatPtr() );
+		__m256 jqd = LoadLanes( joints[n3].q.ToFloatPtr(), joints[n7].q.ToFloatPtr() );
+		
+		__m256 jta = LoadLanes( joints[n0].t.ToFloatPtr(), joints[n4].t.ToFloatPtr() );
+		__m256 jtb = LoadLanes( joints[n1].t.ToFloatPtr(), joints[n5].t.ToFloatPtr() );
+		__m256 jtc = LoadLanes( joints[n2].t.ToFloatPtr(), joints[n6].t.ToFloatPtr() );
+		__m256 jtd = LoadLanes( joints[n3].t.ToFloatPtr(), joints[n7].t.ToFloatPtr() );
+		
+		__m256 bqa = LoadLanes( blendJoints[n0].q.ToFloatPtr(), blendJoints[n4].q.ToFloatPtr() );
+		__m256 bqb = LoadLanes( blendJoints[n1].q.ToFloatPtr(), blendJoints[n5].q.ToFloatPtr() );
+		__m256 bqc = LoadLanes( blendJoints[n2].q.ToFloatPtr(), blendJoints[n6].q.ToFloatPtr() );
+		__m256 bqd = LoadLanes( blendJoints[n3].q.ToFloatPtr(), blendJoints[n7].q.ToFloatPtr() );
+		
+		__m256 bta = LoadLanes( blendJoints[n0].t.ToFloatPtr(), blendJoints[n4].t.ToFloatPtr() );
+		__m256 btb = LoadLanes( blendJoints[n1].t.ToFloatPtr(), blendJoints[n5].t.ToFloatPtr() );
+		__m256 btc = LoadLanes( blendJoints[n2].t.ToFloatPtr(), blendJoints[n6].t.ToFloatPtr() );
+		__m256 btd = LoadLanes( blendJoints[n3].t.ToFloatPtr(), blendJoints[n7].t.ToFloatPtr() );
+		
+		jta = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bta, jta ), jta );
+		jtb = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( btb, jtb ), jtb );
+		jtc = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( btc, jtc ), jtc );
+		jtd = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( btd, jtd ), jtd );
+		
+		StoreLanes( joints[n0].t.ToFloatPtr(), joints[n4].t.ToFloatPtr(), jta );
+		StoreLanes( joints[n1].t.ToFloatPtr(), joints[n5].t.ToFloatPtr(), jtb );
+		StoreLanes( joints[n2].t.ToFloatPtr(), joints[n6].t.ToFloatPtr(), jtc );
+		StoreLanes( joints[n3].t.ToFloatPtr(), joints[n7].t.ToFloatPtr(), jtd );
+		
+		__m256 jqr = _mm256_unpacklo_ps( jqa, jqc );
+		__m256 jqs = _mm256_unpackhi_ps( jqa, jqc );
+		__m256 jqt = _mm256_unpacklo_ps( jqb, jqd );
+		__m256 jqu = _mm256_unpackhi_ps( jqb, jqd );
+		
+		__m256 bqr = _mm256_unpacklo_ps( bqa, bqc );
+		__m256 bqs = _mm256_unpackhi_ps( bqa, bqc );
+		__m256 bqt = _mm256_unpacklo_ps( bqb, bqd );
+		__m256 bqu = _mm256_unpackhi_ps( bqb, bqd );
+		
+		__m256 jqx = _mm256_unpacklo_ps( jqr, jqt );
+		__m256 jqy = _mm256_unpackhi_ps( jqr, jqt );
+		__m256 jqz = _mm256_unpacklo_ps( jqs, jqu );
+		__m256 jqw = _mm256_unpackhi_ps( jqs, jqu );
+		
+		__m256 bqx = _mm256_unpacklo_ps( bqr, bqt );
+		__m256 bqy = _mm256_unpackhi_ps( bqr, bqt );
+		__m256 bqz = _mm256_unpacklo_ps( bqs, bqu );
+		__m256 bqw = _mm256_unpackhi_ps( bqs, bqu );
+		
+		__m256 cosom = _mm256_mul_ps( jqx, bqx );
+		cosom = _mm256_fmadd_ps( jqy, bqy, cosom );
+		cosom = _mm256_fmadd_ps( jqz, bqz, cosom );
+		cosom = _mm256_fmadd_ps( jqw, bqw, cosom );
+		
+		__m256 sign = _mm256_and_ps( cosom, vector_float_sign_bit );
+		cosom = _mm256_xor_ps( cosom, sign );
+		__m256 ss = _mm256_fnmadd_ps( cosom, cosom, vector_float_one );
+		
+		ss = _mm256_max_ps( ss, vector_float_tiny );
+		
+		__m256 rs = _mm256_rsqrt_ps( ss );
+		__m256 sq = _mm256_mul_ps( rs, rs );
+		__m256 sh = _mm256_mul_ps( rs, vector_float_rsqrt_c1 );
+		__m256 sx = _mm256_fmadd_ps( ss, sq, vector_float_rsqrt_c0 );
+		__m256 sinom = _mm256_mul_ps( sh, sx );						// sinom = sqrt( ss );
+		
+		ss = _mm256_mul_ps( ss, sinom );
+		
+		__m256 min = _mm256_min_ps( ss, cosom );
+		__m256 max = _mm256_max_ps( ss, cosom );
+		__m256 mask = _mm256_cmp_ps( min, cosom, _CMP_EQ_OQ );
+		__m256 masksign = _mm256_and_ps( mask, vector_float_sign_bit );
+		__m256 maskPI = _mm256_and_ps( mask, vector_float_half_pi );
+		
+		__m256 rcpa = _mm256_rcp_ps( max );
+		__m256 rcpb = _mm256_mul_ps( max, rcpa );
+		__m256 rcpd = _mm256_add_ps( rcpa, rcpa );
+		__m256 rcp = _mm256_fnmadd_ps( rcpb, rcpa, rcpd );			// 1 / y or 1 / x
+		__m256 ata = _mm256_mul_ps( min, rcp );						// x / y or y / x
+		
+		__m256 atb = _mm256_xor_ps( ata, masksign );				// -x / y or y / x
+		__m256 atc = _mm256_mul_ps( atb, atb );
+		__m256 atd = _mm256_fmadd_ps( atc, vector_float_atan_c0, vector_float_atan_c1 );
+		
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c2 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c3 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c4 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c5 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c6 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_atan_c7 );
+		atd = _mm256_fmadd_ps( atd, atc, vector_float_one );
+		
+		__m256 omega_a = _mm256_fmadd_ps( atd, atb, maskPI );
+		__m256 omega_b = _mm256_mul_ps( vlerp, omega_a );
+		omega_a = _mm256_sub_ps( omega_a, omega_b );
+		
+		__m256 sinsa = _mm256_mul_ps( omega_a, omega_a );
+		__m256 sinsb = _mm256_mul_ps( omega_b, omega_b );
+		__m256 sina = _mm256_fmadd_ps( sinsa, vector_float_sin_c0, vector_float_sin_c1 );
+		__m256 sinb = _mm256_fmadd_ps( sinsb, vector_float_sin_c0, vector_float_sin_c1 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c2 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c2 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c3 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c3 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_sin_c4 );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_sin_c4 );
+		sina = _mm256_fmadd_ps( sina, sinsa, vector_float_one );
+		sinb = _mm256_fmadd_ps( sinb, sinsb, vector_float_one );
+		sina = _mm256_mul_ps( sina, omega_a );
+		sinb = _mm256_mul_ps( sinb, omega_b );
+		__m256 scalea = _mm256_mul_ps( sina, sinom );
+		__m256 scaleb = _mm256_mul_ps( sinb, sinom );
+		
+		scaleb = _mm256_xor_ps( scaleb, sign );
+		
+		jqx = _mm256_fmadd_ps( bqx, scaleb, _mm256_mul_ps( jqx, scalea ) );
+		jqy = _mm256_fmadd_ps( bqy, scaleb, _mm256_mul_ps( jqy, scalea ) );
+		jqz = _mm256_fmadd_ps( bqz, scaleb, _mm256_mul_ps( jqz, scalea ) );
+		jqw = _mm256_fmadd_ps( bqw, scaleb, _mm256_mul_ps( jqw, scalea ) );
+		
+		__m256 tp0 = _mm256_unpacklo_ps( jqx, jqz );
+		__m256 tp1 = _mm256_unpackhi_ps( jqx, jqz );
+		__m256 tp2 = _mm256_unpacklo_ps( jqy, jqw );
+		__m256 tp3 = _mm256_unpackhi_ps( jqy, jqw );
+		
+		__m256 p0 = _mm256_unpacklo_ps( tp0, tp2 );
+		__m256 p1 = _mm256_unpackhi_ps( tp0, tp2 );
+		__m256 p2 = _mm256_unpacklo_ps( tp1, tp3 );
+		__m256 p3 = _mm256_unpackhi_ps( tp1, tp3 );
+		
+		StoreLanes( joints[n0].q.ToFloatPtr(), joints[n4].q.ToFloatPtr(), p0 );
+		StoreLanes( joints[n1].q.ToFloatPtr(), joints[n5].q.ToFloatPtr(), p1 );
+		StoreLanes( joints[n2].q.ToFloatPtr(), joints[n6].q.ToFloatPtr(), p2 );
+		StoreLanes( joints[n3].q.ToFloatPtr(), joints[n7].q.ToFloatPtr(), p3 );
+	}
+	
+	if( i < numJoints )
+	{
+		idSIMD_SSE::BlendJoints( joints, blendJoints, lerp, index + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ConvertJointQuatsToJointMats
+
+Two joints per register, all shuffles stay within a lane so the SSE sequence carries over.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::ConvertJointQuatsToJointMats( idJointMat* jointMats, const idJointQuat* jointQuats, const int numJoints )
+{
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+	assert( sizeof( idJointMat ) == JOINTMAT_SIZE );
+	
+	const float* jointQuatPtr = ( float* )jointQuats;
+	float* jointMatPtr = ( float* )jointMats;
+	
+	const __m256 vector_float_first_sign_bit		= _mm256_castsi256_ps( _mm256_setr_epi32( 0x80000000, 0, 0, 0, 0x80000000, 0, 0, 0 ) );
+	const __m256 vector_float_last_three_sign_bits	= _mm256_castsi256_ps( _mm256_setr_epi32( 0, 0x80000000, 0x80000000, 0x80000000, 0, 0x80000000, 0x80000000, 0x80000000 ) );
+	const __m256 vector_float_first_pos_half		= _mm256_setr_ps(  0.5f, 0.0f, 0.0f, 0.0f,  0.5f, 0.0f, 0.0f, 0.0f );	// +.5 0 0 0
+	const __m256 vector_float_first_neg_half		= _mm256_setr_ps( -0.5f, 0.0f, 0.0f, 0.0f, -0.5f, 0.0f, 0.0f, 0.0f );	// -.5 0 0 0
+	const __m256 vector_float_quat2mat_mad1			= _mm256_setr_ps( -1.0f, -1.0f, +1.0f, -1.0f, -1.0f, -1.0f, +1.0f, -1.0f );	//  - - + -
+	const __m256 vector_float_quat2mat_mad2			= _mm256_setr_ps( -1.0f, +1.0f, -1.0f, -1.0f, -1.0f, +1.0f, -1.0f, -1.0f );	//  - + - -
+	const __m256 vector_float_quat2mat_mad3			= _mm256_setr_ps( +1.0f, -1.0f, -1.0f, +1.0f, +1.0f, -1.0f, -1.0f, +1.0f );	//  + - - +
+	
+	int i = 0;
+	for( ; i + 1 < numJoints; i += 2 )
+	{
+		const __m256 j0 = _mm256_loadu_ps( &jointQuatPtr[i * 8 + 0 * 8] );						// q0 t0
+		const __m256 j1 = _mm256_loadu_ps( &jointQuatPtr[i * 8 + 1 * 8] );						// q1 t1
+		
+		__m256 q = _mm256_permute2f128_ps( j0, j1, 0x20 );										// q0 q1
+		__m256 t = _mm256_permute2f128_ps( j0, j1, 0x31 );										// t0 t1
+		
+		__m256 d = _mm256_add_ps( q, q );
+		
+		__m256 sa = _mm256_permute_ps( q, _MM_SHUFFLE( 1, 0, 0, 1 ) );							//   y,   x,   x,   y
+		__m256 sb = _mm256_permute_ps( d, _MM_SHUFFLE( 2, 2, 1, 1 ) );							//  y2,  y2,  z2,  z2
+		__m256 sc = _mm256_permute_ps( q, _MM_SHUFFLE( 3, 3, 3, 2 ) );							//   z,   w,   w,   w
+		__m256 sd = _mm256_permute_ps( d, _MM_SHUFFLE( 0, 1, 2, 2 ) );							//  z2,  z2,  y2,  x2
+		
+		sa = _mm256_xor_ps( sa, vector_float_first_sign_bit );
+		sc = _mm256_xor_ps( sc, vector_float_last_three_sign_bits );							// flip stupid inverse quaternions
+		
+		__m256 ma = _mm256_fmadd_ps( sa, sb, vector_float_first_pos_half );					//  .5 - yy2,  xy2,  xz2,  yz2		//  .5 0 0 0
+		__m256 mb = _mm256_fmadd_ps( sc, sd, vector_float_first_neg_half );					// -.5 + zz2,  wz2,  wy2,  wx2		// -.5 0 0 0
+		__m256 mc = _mm256_fnmadd_ps( q, d, vector_float_first_pos_half );					//  .5 - xx2, -yy2, -zz2, -ww2		//  .5 0 0 0
+		
+		__m256 mf = _mm256_shuffle_ps( ma, mc, _MM_SHUFFLE( 0, 0, 1, 1 ) );					//       xy2,  xy2, .5 - xx2, .5 - xx2	// 01, 01, 10, 10
+		__m256 md = _mm256_shuffle_ps( mf, ma, _MM_SHUFFLE( 3, 2, 0, 2 ) );					//  .5 - xx2,  xy2,  xz2,  yz2			// 10, 01, 02, 03
+		__m256 me = _mm256_shuffle_ps( ma, mb, _MM_SHUFFLE( 3, 2, 1, 0 ) );					//  .5 - yy2,  xy2,  wy2,  wx2			// 00, 01, 12, 13
+		
+		__m256 ra = _mm256_fmadd_ps( mb, vector_float_quat2mat_mad1, ma );					// 1 - yy2 - zz2, xy2 - wz2, xz2 + wy2,					// - - + -
+		__m256 rb = _mm256_fmadd_ps( mb, vector_float_quat2mat_mad2, md );					// 1 - xx2 - zz2, xy2 + wz2,          , yz2 - wx2		// - + - -
+		__m256 rc = _mm256_fmadd_ps( me, vector_float_quat2mat_mad3, md );					// 1 - xx2 - yy2,          , xz2 - wy2, yz2 + wx2		// + - - +
+		
+		__m256 ta = _mm256_shuffle_ps( ra, t, _MM_SHUFFLE( 0, 0, 2, 2 ) );
+		__m256 tb = _mm256_shuffle_ps( rb, t, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+		__m256 tc = _mm256_shuffle_ps( rc, t, _MM_SHUFFLE( 2, 2, 0, 0 ) );
+		
+		ra = _mm256_shuffle_ps( ra, ta, _MM_SHUFFLE( 2, 0, 1, 0 ) );							// 00 01 02 10
+		rb = _mm256_shuffle_ps( rb, tb, _MM_SHUFFLE( 2, 0, 0, 1 ) );							// 01 00 03 11
+		rc = _mm256_shuffle_ps( rc, tc, _MM_SHUFFLE( 2, 0, 3, 2 ) );							// 02 03 00 12
+		
+		_mm256_storeu_ps( &jointMatPtr[i * 12 + 0], _mm256_permute2f128_ps( ra, rb, 0x20 ) );	// joint 0 rows a and b
+		_mm256_storeu_ps( &jointMatPtr[i * 12 + 8], _mm256_permute2f128_ps( rc, ra, 0x30 ) );	// joint 0 row c, joint 1 row a
+		_mm256_storeu_ps( &jointMatPtr[i * 12 + 16], _mm256_permute2f128_ps( rb, rc, 0x31 ) );	// joint 1 rows b and c
+	}
+	
+	if( i < numJoints )
+	{
+		idSIMD_SSE::ConvertJointQuatsToJointMats( jointMats + i, jointQuats + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformJoints
+
+Rows a and b of each matrix share a register, row c uses the 4-wide FMA.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::TransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint )
+{
+	const __m256 vector_float_mask_keep_last2	= _mm256_castsi256_ps( _mm256_setr_epi32( 0, 0, 0, -1, 0, 0, 0, -1 ) );
+	const __m128 vector_float_mask_keep_last	= _mm256_castps256_ps128( vector_float_mask_keep_last2 );
+	
+	const float* __restrict firstMatrix = jointMats->ToFloatPtr() + ( firstJoint + firstJoint + firstJoint - 3 ) * 4;
+	
+	__m256 pmab = _mm256_loadu_ps( firstMatrix + 0 );
+	__m128 pmc = _mm_load_ps( firstMatrix + 8 );
+	
+	for( int joint = firstJoint; joint <= lastJoint; joint++ )
+	{
+		const int parent = parents[joint];
+		const float* __restrict parentMatrix = jointMats->ToFloatPtr() + ( parent + parent + parent ) * 4;
+		float* __restrict childMatrix = jointMats->ToFloatPtr() + ( joint + joint + joint ) * 4;
+		
+		if( parent != joint - 1 )
+		{
+			pmab = _mm256_loadu_ps( parentMatrix + 0 );
+			pmc = _mm_load_ps( parentMatrix + 8 );
+		}
+		
+		const __m128 cma = _mm_load_ps( childMatrix + 0 );
+		const __m128 cmb = _mm_load_ps( childMatrix + 4 );
+		const __m128 cmc = _mm_load_ps( childMatrix + 8 );
+		
+		__m256 rab = _mm256_and_ps( pmab, vector_float_mask_keep_last2 );
+		__m128 rc = _mm_and_ps( pmc, vector_float_mask_keep_last );
+		
+		rab = _mm256_fmadd_ps( _mm256_permute_ps( pmab, _MM_SHUFFLE( 0, 0, 0, 0 ) ), BroadcastLanes( cma ), rab );
+		rc = _mm_fmadd_ps( _mm_permute_ps( pmc, _MM_SHUFFLE( 0, 0, 0, 0 ) ), cma, rc );
+		
+		rab = _mm256_fmadd_ps( _mm256_permute_ps( pmab, _MM_SHUFFLE( 1, 1, 1, 1 ) ), BroadcastLanes( cmb ), rab );
+		rc = _mm_fmadd_ps( _mm_permute_ps( pmc, _MM_SHUFFLE( 1, 1, 1, 1 ) ), cmb, rc );
+		
+		rab = _mm256_fmadd_ps( _mm256_permute_ps( pmab, _MM_SHUFFLE( 2, 2, 2, 2 ) ), BroadcastLanes( cmc ), rab );
+		rc = _mm_fmadd_ps( _mm_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cmc, rc );
+		
+		_mm256_storeu_ps( childMatrix + 0, rab );
+		_mm_store_ps( childMatrix + 8, rc );
+		
+		pmab = rab;
+		pmc = rc;
+	}
+}
+
+/*
+============
+idSIMD_AVX2::UntransformJoints
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::UntransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint )
+{
+	const __m128 vector_float_mask_keep_last	= _mm_castsi128_ps( _mm_setr_epi32( 0, 0, 0, -1 ) );
+	const __m256i vector_int_splat_01			= _mm256_setr_epi32( 0, 0, 0, 0, 1, 1, 1, 1 );
+	
+	for( int joint = lastJoint; joint >= firstJoint; joint-- )
+	{
+		assert( parents[joint] < joint );
+		const int parent = parents[joint];
+		const float* __restrict parentMatrix = jointMats->ToFloatPtr() + ( parent + parent + parent ) * 4;
+		float* __restrict childMatrix = jointMats->ToFloatPtr() + ( joint + joint + joint ) * 4;
+		
+		const __m128 pma = _mm_load_ps( parentMatrix + 0 );
+		const __m128 pmb = _mm_load_ps( parentMatrix + 4 );
+		const __m128 pmc = _mm_load_ps( parentMatrix + 8 );
+		
+		const __m128 cma = _mm_sub_ps( _mm_load_ps( childMatrix + 0 ), _mm_and_ps( pma, vector_float_mask_keep_last ) );
+		const __m128 cmb = _mm_sub_ps( _mm_load_ps( childMatrix + 4 ), _mm_and_ps( pmb, vector_float_mask_keep_last ) );
+		const __m128 cmc = _mm_sub_ps( _mm_load_ps( childMatrix + 8 ), _mm_and_ps( pmc, vector_float_mask_keep_last ) );
+		
+		// result rows a and b use columns 0 and 1 of the parent, row c uses column 2
+		__m256 rab = _mm256_mul_ps( _mm256_permutevar_ps( BroadcastLanes( pma ), vector_int_splat_01 ), BroadcastLanes( cma ) );
+		__m128 rc = _mm_mul_ps( _mm_permute_ps( pma, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cma );
+		
+		rab = _mm256_fmadd_ps( _mm256_permutevar_ps( BroadcastLanes( pmb ), vector_int_splat_01 ), BroadcastLanes( cmb ), rab );
+		rc = _mm_fmadd_ps( _mm_permute_ps( pmb, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cmb, rc );
+		
+		rab = _mm256_fmadd_ps( _mm256_permutevar_ps( BroadcastLanes( pmc ), vector_int_splat_01 ), BroadcastLanes( cmc ), rab );
+		rc = _mm_fmadd_ps( _mm_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cmc, rc );
+		
+		_mm256_storeu_ps( childMatrix + 0, rab );
+		_mm_store_ps( childMatrix + 8, rc );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformJointsBatch
+
+Two independent joints per register, one in each lane.
+============
+*/
+ID_AVX2_TARGET void VPCALL idSIMD_AVX2::TransformJointsBatch( idJointMat* jointMats, const int* parents, const int* jointIndexes, const int numJoints )
+{
+	const __m256 vector_float_mask_keep_last	= _mm256_castsi256_ps( _mm256_setr_epi32( 0, 0, 0, -1, 0, 0, 0, -1 ) );
+	
+	float* __restrict matrices = jointMats->ToFloatPtr();
+	
+	int i = 0;
+	for( ; i + 1 < numJoints; i += 2 )
+	{
+		const int joint0 = jointIndexes[i + 0];
+		const int joint1 = jointIndexes[i + 1];
+		assert( parents[joint0] < joint0 && parents[joint1] < joint1 );
+		const float* parent0 = matrices + ( parents[joint0] * 3 ) * 4;
+		const float* parent1 = matrices + ( parents[joint1] * 3 ) * 4;
+		float* child0 = matrices + ( joint0 * 3 ) * 4;
+		float* child1 = matrices + ( joint1 * 3 ) * 4;
+		
+		const __m256 pma = LoadLanes( parent0 + 0, parent1 + 0 );
+		const __m256 pmb = LoadLanes( parent0 + 4, parent1 + 4 );
+		const __m256 pmc = LoadLanes( parent0 + 8, parent1 + 8 );
+		
+		const __m256 cma = LoadLanes( child0 + 0, child1 + 0 );
+		const __m256 cmb = LoadLanes( child0 + 4, child1 + 4 );
+		const __m256 cmc = LoadLanes( child0 + 8, child1 + 8 );
+		
+		__m256 ra = _mm256_fmadd_ps( _mm256_permute_ps( pma, _MM_SHUFFLE( 0, 0, 0, 0 ) ), cma, _mm256_and_ps( pma, vector_float_mask_keep_last ) );
+		__m256 rb = _mm256_fmadd_ps( _mm256_permute_ps( pmb, _MM_SHUFFLE( 0, 0, 0, 0 ) ), cma, _mm256_and_ps( pmb, vector_float_mask_keep_last ) );
+		__m256 rc = _mm256_fmadd_ps( _mm256_permute_ps( pmc, _MM_SHUFFLE( 0, 0, 0, 0 ) ), cma, _mm256_and_ps( pmc, vector_float_mask_keep_last ) );
+		
+		ra = _mm256_fmadd_ps( _mm256_permute_ps( pma, _MM_SHUFFLE( 1, 1, 1, 1 ) ), cmb, ra );
+		rb = _mm256_fmadd_ps( _mm256_permute_ps( pmb, _MM_SHUFFLE( 1, 1, 1, 1 ) ), cmb, rb );
+		rc = _mm256_fmadd_ps( _mm256_permute_ps( pmc, _MM_SHUFFLE( 1, 1, 1, 1 ) ), cmb, rc );
+		
+		ra = _mm256_fmadd_ps( _mm256_permute_ps( pma, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cmc, ra );
+		rb = _mm256_fmadd_ps( _mm256_permute_ps( pmb, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cmc, rb );
+		rc = _mm256_fmadd_ps( _mm256_permute_ps( pmc, _MM_SHUFFLE( 2, 2, 2, 2 ) ), cmc, rc );
+		
+		StoreLanes( child0 + 0, child1 + 0, ra );
+		StoreLanes( child0 + 4, child1 + 4, rb );
+		StoreLanes( child0 + 8, child1 + 8, rc );
+	}
+	
+	if( i < numJoints )
+	{
+		// same rounding as the two wide path
+		TransformJoints( jointMats, parents, jointIndexes[i], jointIndexes[i] );
+	}
+}
+
+#endif // #if defined(USE_INTRINSICS)
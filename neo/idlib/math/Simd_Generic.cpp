@@ -234,3 +234,18 @@ void VPCALL idSIMD_Generic::UntransformJoints( idJointMat* jointMats, const int*
 		jointMats[i] /= jointMats[parents[i]];
 	}
 }
+
+/*
+============
+idSIMD_Generic::TransformJointsBatch
+============
+*/
+void VPCALL idSIMD_Generic::TransformJointsBatch( idJointMat* jointMats, const int* parents, const int* jointIndexes, const int numJoints )
+{
+	for( int i = 0; i < numJoints; i++ )
+	{
+		const int joint = jointIndexes[i];
+		assert( parents[joint] < joint );
+		jointMats[joint] *= jointMats[parents[joint]];
+	}
+}
@@ -57,6 +57,7 @@ public:
 	virtual void VPCALL ConvertJointMatsToJointQuats( idJointQuat* jointQuats, const idJointMat* jointMats, const int numJoints );
 	virtual void VPCALL TransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint );
 	virtual void VPCALL UntransformJoints( idJointMat* jointMats, const int* parents, const int firstJoint, const int lastJoint );
+	virtual void VPCALL TransformJointsBatch( idJointMat* jointMats, const int* parents, const int* jointIndexes, const int numJoints );
 };
 
 #endif /* !__MATH_SIMD_GENERIC_H__ */
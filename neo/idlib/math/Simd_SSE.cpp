@@ -974,5 +974,51 @@ void VPCALL idSIMD_SSE::UntransformJoints( idJointMat* jointMats, const int* par
 	}
 }
 
+/*
+============
+idSIMD_SSE::TransformJointsBatch
+
+None of the joints depend on each other, so there is no chain through the
+parent matrix and consecutive iterations overlap in the pipeline.
+============
+*/
+void VPCALL idSIMD_SSE::TransformJointsBatch( idJointMat* jointMats, const int* parents, const int* jointIndexes, const int numJoints )
+{
+	const __m128 vector_float_mask_keep_last	= __m128c( _mm_set_epi32( 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000 ) );
+	
+	for( int i = 0; i < numJoints; i++ )
+	{
+		const int joint = jointIndexes[i];
+		const int parent = parents[joint];
+		assert( parent < joint );
+		const float* __restrict parentMatrix = jointMats->ToFloatPtr() + ( parent + parent + parent ) * 4;
+		float* __restrict childMatrix = jointMats->ToFloatPtr() + ( joint + joint + joint ) * 4;
+		
+		const __m128 pma = _mm_load_ps( parentMatrix + 0 );
+		const __m128 pmb = _mm_load_ps( parentMatrix + 4 );
+		const __m128 pmc = _mm_load_ps( parentMatrix + 8 );
+		
+		const __m128 cma = _mm_load_ps( childMatrix + 0 );
+		const __m128 cmb = _mm_load_ps( childMatrix + 4 );
+		const __m128 cmc = _mm_load_ps( childMatrix + 8 );
+		
+		__m128 ra = _mm_madd_ps( _mm_splat_ps( pma, 0 ), cma, _mm_and_ps( pma, vector_float_mask_keep_last ) );
+		__m128 rb = _mm_madd_ps( _mm_splat_ps( pmb, 0 ), cma, _mm_and_ps( pmb, vector_float_mask_keep_last ) );
+		__m128 rc = _mm_madd_ps( _mm_splat_ps( pmc, 0 ), cma, _mm_and_ps( pmc, vector_float_mask_keep_last ) );
+		
+		ra = _mm_madd_ps( _mm_splat_ps( pma, 1 ), cmb, ra );
+		rb = _mm_madd_ps( _mm_splat_ps( pmb, 1 ), cmb, rb );
+		rc = _mm_madd_ps( _mm_splat_ps( pmc, 1 ), cmb, rc );
+		
+		ra = _mm_madd_ps( _mm_splat_ps( pma, 2 ), cmc, ra );
+		rb = _mm_madd_ps( _mm_splat_ps( pmb, 2 ), cmc, rb );
+		rc = _mm_madd_ps( _mm_splat_ps( pmc, 2 ), cmc, rc );
+		
+		_mm_store_ps( childMatrix + 0, ra );
+		_mm_store_ps( childMatrix + 4, rb );
+		_mm_store_ps( childMatrix + 8, rc );
+	}
+}
+
 #endif // #if defined(USE_INTRINSICS)
 
@@ -63,6 +63,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "../framework/File_SaveGame.h"
 #include "../framework/File_Resource.h"
 #include "../framework/FileSystem.h"
+#include "../framework/File_Async.h"
 #include "../framework/UsercmdGen.h"
 #include "../framework/Serializer.h"
 #include "../framework/PlayerProfile.h"
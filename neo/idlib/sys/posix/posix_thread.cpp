@@ -32,6 +32,14 @@ If you have questions concerning this license or the applicable additional terms
 
 #ifndef _WIN32
 #include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #endif
 
 #ifdef __APPLE__
@@ -280,6 +288,64 @@ void Sys_Yield()
 #endif
 }
 
+/*
+================================================================================================
+
+	Wait on address
+
+================================================================================================
+*/
+
+/*
+========================
+Sys_WaitOnAddress
+========================
+*/
+bool Sys_WaitOnAddress( interlockedInt_t& value, interlockedInt_t compare, int timeout )
+{
+#if defined(__linux__)
+	timespec ts;
+	timespec* tsp = NULL;
+	if( timeout >= 0 )
+	{
+		ts.tv_sec = timeout / 1000;
+		ts.tv_nsec = ( timeout % 1000 ) * 1000000;
+		tsp = &ts;
+	}
+	
+	// the kernel compares the value and goes to sleep atomically, so a wake up that happens
+	// after the caller checked the value is never lost, EAGAIN means the value already changed
+	if( syscall( SYS_futex, &value, FUTEX_WAIT_PRIVATE, compare, tsp, NULL, 0 ) == -1 && errno == ETIMEDOUT )
+	{
+		return false;
+	}
+	return true;
+#else
+	// no wait on address primitive, poll with a sleep that is short enough for frame handoffs
+	for( int waited = 0; *( volatile interlockedInt_t* )&value == compare; waited++ )
+	{
+		if( timeout >= 0 && waited >= timeout )
+		{
+			return false;
+		}
+		usleep( 1000 );
+	}
+	return true;
+#endif
+}
+
+/*
+========================
+Sys_WakeByAddress
+========================
+*/
+void Sys_WakeByAddress( interlockedInt_t& value, bool wakeAll )
+{
+#if defined(__linux__)
+	syscall( SYS_futex, &value, FUTEX_WAKE_PRIVATE, wakeAll ? INT_MAX : 1, NULL, NULL, 0 );
+#endif
+}
+
 /*
 ================================================================================================
 
@@ -587,6 +653,26 @@ interlockedInt_t Sys_InterlockedCompareExchange( interlockedInt_t& value, interl
 	return __sync_val_compare_and_swap( &value, comparand, exchange );
 }
 
+/*
+========================
+Sys_InterlockedAdd64
+========================
+*/
+int64 Sys_InterlockedAdd64( int64& value, int64 i )
+{
+	return __sync_add_and_fetch( &value, i );
+}
+
+/*
+========================
+Sys_InterlockedCompareExchange64
+========================
+*/
+int64 Sys_InterlockedCompareExchange64( int64& value, int64 comparand, int64 exchange )
+{
+	return __sync_val_compare_and_swap( &value, comparand, exchange );
+}
+
 /*
 ================================================================================================
 
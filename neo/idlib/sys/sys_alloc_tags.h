@@ -42,6 +42,7 @@ MEM_TAG( TRI_MIR_VERT )
 MEM_TAG( TRI_DUP_VERT )
 MEM_TAG( SRFTRIS )
 MEM_TAG( TEMP )			// Temp data which should be automatically freed at the end of the function
+MEM_TAG( FRAME_ARENA )	// Temp data of a game tic, comes from the frame arena instead of the heap
 MEM_TAG( PAGE )
 MEM_TAG( DEFRAG_BLOCK )
 MEM_TAG( MATH )
@@ -49,6 +50,7 @@ MEM_TAG( MD5_WEIGHT )
 MEM_TAG( MD5_BASE )
 MEM_TAG( MD5_ANIM )
 MEM_TAG( MD5_INDEX )
+MEM_TAG( MD5_SKIN )
 MEM_TAG( JOINTMAT )
 MEM_TAG( DECAL )
 MEM_TAG( CULLBITS )
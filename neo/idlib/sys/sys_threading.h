@@ -83,46 +83,78 @@ typedef int						interlockedInt_t;
 ================================================================================================
 
 	Platform specific thread local storage.
-	Can be used to store either a pointer or an integer.
+	Can be used to store either a pointer or an integer. The exit callback is
+	called with the value of every thread that exits with a non-zero value,
+	also for threads that were not started with Sys_CreateThread.
 
 ================================================================================================
 */
 
 // RB: added POSIX implementation
 #if defined(_WIN32)
+#define ID_TLS_EXIT_CALLBACK NTAPI
+typedef void ( ID_TLS_EXIT_CALLBACK* tlsExitCallback_t )( void* value );
+
 class idSysThreadLocalStorage
 {
 public:
 	idSysThreadLocalStorage()
 	{
 		tlsIndex = TlsAlloc();
+		isFiberLocal = false;
+	}
+	
+	// fiber local storage is the only kind with a callback, it works the same for threads without fibers
+	idSysThreadLocalStorage( tlsExitCallback_t exitCallback )
+	{
+		tlsIndex = FlsAlloc( exitCallback );
+		isFiberLocal = true;
 	}
 	
 	idSysThreadLocalStorage( const ptrdiff_t& val )
 	{
 		tlsIndex = TlsAlloc();
+		isFiberLocal = false;
 		TlsSetValue( tlsIndex, ( LPVOID )val );
 	}
 	
 	~idSysThreadLocalStorage()
 	{
-		TlsFree( tlsIndex );
+		if( isFiberLocal )
+		{
+			FlsFree( tlsIndex );
+		}
+		else
+		{
+			TlsFree( tlsIndex );
+		}
 	}
 	
 	operator ptrdiff_t()
 	{
-		return ( ptrdiff_t )TlsGetValue( tlsIndex );
+		return isFiberLocal ? ( ptrdiff_t )FlsGetValue( tlsIndex ) : ( ptrdiff_t )TlsGetValue( tlsIndex );
 	}
 	
 	const ptrdiff_t& operator = ( const ptrdiff_t& val )
 	{
-		TlsSetValue( tlsIndex, ( LPVOID )val );
+		if( isFiberLocal )
+		{
+			FlsSetValue( tlsIndex, ( LPVOID )val );
+		}
+		else
+		{
+			TlsSetValue( tlsIndex, ( LPVOID )val );
+		}
 		return val;
 	}
 	
 	DWORD	tlsIndex;
+	bool	isFiberLocal;
 };
 #else
+#define ID_TLS_EXIT_CALLBACK
+typedef void ( *tlsExitCallback_t )( void* value );
+
 class idSysThreadLocalStorage
 {
 public:
@@ -131,6 +163,11 @@ public:
 		pthread_key_create( &key, NULL );
 	}
 
+	idSysThreadLocalStorage( tlsExitCallback_t exitCallback )
+	{
+		pthread_key_create( &key, exitCallback );
+	}
+
 	idSysThreadLocalStorage( const ptrdiff_t& val )
 	{
 		pthread_key_create( &key, NULL );
@@ -228,11 +265,21 @@ interlockedInt_t	Sys_InterlockedSub( interlockedInt_t& value, interlockedInt_t i
 interlockedInt_t	Sys_InterlockedExchange( interlockedInt_t& value, interlockedInt_t exchange );
 interlockedInt_t	Sys_InterlockedCompareExchange( interlockedInt_t& value, interlockedInt_t comparand, interlockedInt_t exchange );
 
+int64				Sys_InterlockedAdd64( int64& value, int64 i );
+int64				Sys_InterlockedCompareExchange64( int64& value, int64 comparand, int64 exchange );
+
 void* 				Sys_InterlockedExchangePointer( void*& ptr, void* exchange );
 void* 				Sys_InterlockedCompareExchangePointer( void*& ptr, void* comparand, void* exchange );
 
 void				Sys_Yield();
 
+// Blocks the calling thread while value equals compare, until Sys_WakeByAddress is called on the
+// same value or the timeout in milliseconds expires. Returns false if the timeout expired.
+// Wake ups may be spurious, so the caller always has to check the value again.
+// Uses a futex on Linux and WaitOnAddress on Windows 8 and later, other platforms poll with a sleep.
+bool				Sys_WaitOnAddress( interlockedInt_t& value, interlockedInt_t compare, int timeout );
+void				Sys_WakeByAddress( interlockedInt_t& value, bool wakeAll );
+
 const int MAX_CRITICAL_SECTIONS		= 4;
 
 enum
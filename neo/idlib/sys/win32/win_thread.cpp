@@ -181,6 +181,85 @@ void Sys_Yield()
 	SwitchToThread();
 }
 
+/*
+================================================================================================
+
+	Wait on address
+
+================================================================================================
+*/
+
+// WaitOnAddress is only available on Windows 8 and later, so it is looked up at run time
+typedef BOOL ( WINAPI* waitOnAddress_t )( volatile VOID* address, PVOID compareAddress, SIZE_T addressSize, DWORD milliseconds );
+typedef VOID ( WINAPI* wakeByAddress_t )( PVOID address );
+
+static struct waitOnAddressFunctions_t
+{
+	waitOnAddressFunctions_t()
+	{
+		HMODULE module = GetModuleHandleA( "kernelbase.dll" );
+		waitOnAddress = ( module != NULL ) ? ( waitOnAddress_t )GetProcAddress( module, "WaitOnAddress" ) : NULL;
+		wakeByAddressSingle = ( module != NULL ) ? ( wakeByAddress_t )GetProcAddress( module, "WakeByAddressSingle" ) : NULL;
+		wakeByAddressAll = ( module != NULL ) ? ( wakeByAddress_t )GetProcAddress( module, "WakeByAddressAll" ) : NULL;
+		if( waitOnAddress == NULL || wakeByAddressSingle == NULL || wakeByAddressAll == NULL )
+		{
+			waitOnAddress = NULL;
+		}
+	}
+	
+	waitOnAddress_t		waitOnAddress;
+	wakeByAddress_t		wakeByAddressSingle;
+	wakeByAddress_t		wakeByAddressAll;
+} waitOnAddressFunctions;
+
+/*
+========================
+Sys_WaitOnAddress
+========================
+*/
+bool Sys_WaitOnAddress( interlockedInt_t& value, interlockedInt_t compare, int timeout )
+{
+	if( waitOnAddressFunctions.waitOnAddress != NULL )
+	{
+		if( !waitOnAddressFunctions.waitOnAddress( &value, &compare, sizeof( value ), ( timeout < 0 ) ? INFINITE : timeout ) )
+		{
+			return ( GetLastError() != ERROR_TIMEOUT );
+		}
+		return true;
+	}
+	
+	// no wait on address primitive, poll with a sleep that is short enough for frame handoffs
+	for( int waited = 0; *( volatile interlockedInt_t* )&value == compare; waited++ )
+	{
+		if( timeout >= 0 && waited >= timeout )
+		{
+			return false;
+		}
+		Sleep( 1 );
+	}
+	return true;
+}
+
+/*
+========================
+Sys_WakeByAddress
+========================
+*/
+void Sys_WakeByAddress( interlockedInt_t& value, bool wakeAll )
+{
+	if( waitOnAddressFunctions.waitOnAddress != NULL )
+	{
+		if( wakeAll )
+		{
+			waitOnAddressFunctions.wakeByAddressAll( &value );
+		}
+		else
+		{
+			waitOnAddressFunctions.wakeByAddressSingle( &value );
+		}
+	}
+}
+
 /*
 ================================================================================================
 
@@ -377,6 +456,26 @@ interlockedInt_t Sys_InterlockedCompareExchange( interlockedInt_t& value, interl
 	return InterlockedCompareExchange( & value, exchange, comparand );
 }
 
+/*
+========================
+Sys_InterlockedAdd64
+========================
+*/
+int64 Sys_InterlockedAdd64( int64& value, int64 i )
+{
+	return InterlockedExchangeAdd64( ( LONGLONG* )& value, i ) + i;
+}
+
+/*
+========================
+Sys_InterlockedCompareExchange64
+========================
+*/
+int64 Sys_InterlockedCompareExchange64( int64& value, int64 comparand, int64 exchange )
+{
+	return InterlockedCompareExchange64( ( LONGLONG* )& value, exchange, comparand );
+}
+
 /*
 ================================================================================================
 
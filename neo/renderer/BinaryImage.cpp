@@ -432,13 +432,37 @@ ID_TIME_T idBinaryImage::LoadFromGeneratedFile( ID_TIME_T sourceFileTime )
 	{
 		return FILE_NOT_FOUND_TIMESTAMP;
 	}
-	if( LoadFromGeneratedFile( bFile, sourceFileTime ) )
+	
+	// when the file is a view into a memory mapped resource container the
+	// image levels are uploaded straight from the mapping without a copy
+	const byte* mappedData = NULL;
+	idFile_InnerResource* innerFile = dynamic_cast< idFile_InnerResource* >( ( idFile* )bFile );
+	if( innerFile != NULL )
+	{
+		mappedData = innerFile->GetMappedData();
+	}
+	
+	if( LoadFromGeneratedFile( bFile, sourceFileTime, mappedData ) )
 	{
 		return bFile->Timestamp();
 	}
 	return FILE_NOT_FOUND_TIMESTAMP;
 }
 
+/*
+==========================
+idBinaryImage::LoadFromGeneratedMemory
+
+Parse a generated file that was read ahead, no file system access so this
+can run in a job.
+==========================
+*/
+bool idBinaryImage::LoadFromGeneratedMemory( const byte* data, int length, ID_TIME_T sourceFileTime )
+{
+	idFile_Memory bFile( GetName(), ( const char* )data, length );
+	return LoadFromGeneratedFile( &bFile, sourceFileTime, data );
+}
+
 /*
 ==========================
 idBinaryImage::LoadFromGeneratedFile
@@ -446,7 +470,7 @@ idBinaryImage::LoadFromGeneratedFile
 Load the preprocessed image from the generated folder.
 ==========================
 */
-bool idBinaryImage::LoadFromGeneratedFile( idFile* bFile, ID_TIME_T sourceFileTime )
+bool idBinaryImage::LoadFromGeneratedFile( idFile* bFile, ID_TIME_T sourceFileTime, const byte* fileView )
 {
 	if( bFile->Read( &fileData, sizeof( fileData ) ) <= 0 )
 	{
@@ -499,6 +523,19 @@ bool idBinaryImage::LoadFromGeneratedFile( idFile* bFile, ID_TIME_T sourceFileTi
 		// sizes are still retained, so the stored data size may be larger than
 		// just the multiplication of dimensions
 		assert( img.dataSize >= img.width * img.height * BitsForFormat( ( textureFormat_t )fileData.format ) / 8 );
+		
+		if( fileView != NULL )
+		{
+			const int dataOffset = bFile->Tell();
+			if( img.dataSize <= 0 || img.dataSize > bFile->Length() - dataOffset )
+			{
+				return false;
+			}
+			img.SetView( fileView + dataOffset, img.dataSize );
+			bFile->Seek( img.dataSize, FS_SEEK_CUR );
+			continue;
+		}
+		
 		img.Alloc( img.dataSize );
 		if( img.data == NULL )
 		{
@@ -56,14 +56,17 @@ public:
 	void				LoadCubeFromMemory( int width, const byte* pics[6], int numLevels, textureFormat_t& textureFormat, bool gammaMips );
 	
 	ID_TIME_T			LoadFromGeneratedFile( ID_TIME_T sourceFileTime );
+	// parses a generated file that is already in memory, the image levels reference
+	// the data so it has to stay valid until the image is uploaded
+	bool				LoadFromGeneratedMemory( const byte* data, int length, ID_TIME_T sourceFileTime );
 	ID_TIME_T			WriteGeneratedFile( ID_TIME_T sourceFileTime );
 	
-	const bimageFile_t& 	GetFileHeader()
+	const bimageFile_t& 	GetFileHeader() const
 	{
 		return fileData;
 	}
 	
-	int					NumImages()
+	int					NumImages() const
 	{
 		return images.Num();
 	}
@@ -84,8 +87,9 @@ private:
 	{
 	public:
 		byte* data;
+		bool ownsData;	// false when data points into a memory mapped resource container
 		
-		idBinaryImageData() : data( NULL ) { }
+		idBinaryImageData() : data( NULL ), ownsData( false ) { }
 		~idBinaryImageData()
 		{
 			Free();
@@ -105,7 +109,10 @@ private:
 		{
 			if( data != NULL )
 			{
-				Mem_Free( data );
+				if( ownsData )
+				{
+					Mem_Free( data );
+				}
 				data = NULL;
 				dataSize = 0;
 			}
@@ -115,6 +122,14 @@ private:
 			Free();
 			dataSize = size;
 			data = ( byte* )Mem_Alloc( size, TAG_CRAP );
+			ownsData = true;
+		}
+		void SetView( const byte* view, int size )
+		{
+			Free();
+			dataSize = size;
+			data = const_cast< byte* >( view );
+			ownsData = false;
 		}
 	};
 	
@@ -122,7 +137,7 @@ private:
 	
 private:
 	void				MakeGeneratedFileName( idStr& gfn );
-	bool				LoadFromGeneratedFile( idFile* f, ID_TIME_T sourceFileTime );
+	bool				LoadFromGeneratedFile( idFile* f, ID_TIME_T sourceFileTime, const byte* fileView );
 };
 
 #endif // __BINARYIMAGE_H__
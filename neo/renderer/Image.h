@@ -150,6 +150,10 @@ public:
 		levelLoadReferenced = true;
 	}
 	void		ActuallyLoadImage( bool fromBackEnd );
+	
+	// true if the parsed generated file can be uploaded without regenerating it,
+	// only reads the image so it can be called from a job
+	bool		IsGeneratedImageValid( const idBinaryImage& im, ID_TIME_T binaryTime ) const;
 	//---------------------------------------------
 	// Platform specific implementations
 	//---------------------------------------------
@@ -193,6 +197,12 @@ public:
 		return texnum != TEXTURE_NOT_LOADED;
 	}
 	
+	// images with a generator function don't load from files
+	bool		HasGeneratorFunction() const
+	{
+		return generatorFunction != NULL;
+	}
+	
 	static void			GetGeneratedName( idStr& _name, const textureUsage_t& _usage, const cubeFiles_t& _cube );
 	
 private:
@@ -201,6 +211,12 @@ private:
 	void				AllocImage();
 	void				DeriveOpts();
 	
+	// the stages of ActuallyLoadImage, idImageManager::LoadGeneratedImages runs them
+	// on different threads
+	void				PrepareLoad( idStr& generatedName );
+	void				SetGeneratedImageOpts( const idBinaryImage& im );
+	void				UploadBinaryImage( const idBinaryImage& im );
+	
 	// parameters that define this image
 	idStr				imgName;				// game path, including extension (except for cube maps), may be an image program
 	cubeFiles_t			cubeFiles;				// If this is a cube map, and if so, what kind
@@ -261,6 +277,20 @@ void	R_WriteTGA( const char* filename, const byte* data, int width, int height,
 void	R_WritePNG( const char* filename, const byte* data, int bytesPerPixel, int width, int height, bool flipVertical = false, const char* basePath = "fs_savepath" );
 // RB end
 
+// timings of idImageManager::LoadGeneratedImages, the job times are summed over all jobs
+struct imageLoadTimes_t
+{
+	uint64				prepareMicroSec;	// resolving the generated file names
+	uint64				readMicroSec;		// jobs waiting for the async reads
+	uint64				parseMicroSec;		// jobs parsing the generated files
+	uint64				stallMicroSec;		// uploads waiting for jobs
+	uint64				uploadMicroSec;		// uploads, including the images loaded the regular way
+	uint64				totalMicroSec;
+	int					numParsed;
+	int					numFallbacks;
+	int64				numBytes;
+};
+
 class idImageManager
 {
 public:
@@ -320,6 +350,13 @@ public:
 	// Loads unloaded level images
 	int					LoadLevelImages( bool pacifier );
 	
+	// Loads the generated files of the images in stages: the async read threads do the I/O,
+	// parallel jobs parse the files and the uploads happen in read order on the calling thread.
+	// Images that can't be loaded this way go through ActuallyLoadImage. Without upload only
+	// the read and parse stages run, which doesn't need a rendering context, and the images are
+	// left as they were.
+	void				LoadGeneratedImages( const idList< idImage* >& imageList, bool upload, bool useJobs, bool pacifier, imageLoadTimes_t& times );
+	
 	// used to clear and then write the dds conversion batch file
 	void				StartBuild();
 	void				FinishBuild( bool removeDups = false );
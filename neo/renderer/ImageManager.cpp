@@ -38,6 +38,7 @@ idImageManager	imageManager;
 idImageManager* globalImages = &imageManager;
 
 idCVar preLoad_Images( "preLoad_Images", "1", CVAR_SYSTEM | CVAR_BOOL, "preload images during beginlevelload" );
+idCVar image_loadJobs( "image_loadJobs", "1", CVAR_RENDERER | CVAR_BOOL, "parse the generated images in parallel jobs during level loads" );
 
 /*
 ===============
@@ -742,6 +743,102 @@ void R_CombineCubeImages_f( const idCmdArgs& args )
 	common->SetRefreshOnPrint( false );
 }
 
+struct imageLoadJob_t
+{
+	const idAsyncReadBatch* 	batch;
+	int							request;			// index of the generated file in the batch
+	const idImage* 				image;
+	idBinaryImage* 				binaryImage;
+	ID_TIME_T					sourceFileTime;
+	int							length;
+	bool						valid;				// parsed and in the format the image expects
+	uint64						readMicroSec;
+	uint64						parseMicroSec;
+	
+	// the image settings from before PrepareLoad, put back when the image isn't uploaded
+	idImageOpts					savedOpts;
+	textureUsage_t				savedUsage;
+	textureRepeat_t				savedRepeat;
+	ID_TIME_T					savedSourceFileTime;
+};
+
+/*
+===============
+R_LoadGeneratedImageJob
+
+Waits for the generated file to be read and parses it, the image levels
+reference the data in the read batch.
+===============
+*/
+static void R_LoadGeneratedImageJob( imageLoadJob_t* job )
+{
+	const uint64 startTime = Sys_Microseconds();
+	const byte* data = job->batch->GetData( job->request, job->length );
+	const uint64 readTime = Sys_Microseconds();
+	
+	// files read from a resource container always have a 0 timestamp
+	job->valid = ( data != NULL )
+				 && job->binaryImage->LoadFromGeneratedMemory( data, job->length, job->sourceFileTime )
+				 && job->image->IsGeneratedImageValid( *job->binaryImage, 0 );
+				 
+	job->readMicroSec = readTime - startTime;
+	job->parseMicroSec = Sys_Microseconds() - readTime;
+}
+
+REGISTER_PARALLEL_JOB( R_LoadGeneratedImageJob, "R_LoadGeneratedImageJob" );
+
+/*
+===============
+R_BenchmarkImageLoad_f
+
+Runs the read and parse stages of the level load image pipeline on all
+images with null uploads, serially and with jobs. This doesn't touch the
+rendering context, so it also works on a headless build.
+
+benchmarkImageLoad [passes]
+===============
+*/
+void R_BenchmarkImageLoad_f( const idCmdArgs& args )
+{
+	if( !fileSystem->UsingResourceFiles() )
+	{
+		common->Printf( "benchmarkImageLoad needs the generated images in resource files\n" );
+		return;
+	}
+	
+	const int numPasses = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 3;
+	
+	idList< idImage* > imageList;
+	for( int i = 0; i < globalImages->images.Num(); i++ )
+	{
+		if( !globalImages->images[ i ]->HasGeneratorFunction() )
+		{
+			imageList.Append( globalImages->images[ i ] );
+		}
+	}
+	
+	common->Printf( "%i images, best of %i passes, the first pass warms the page cache\n", imageList.Num(), numPasses );
+	common->Printf( "mode     total ms  names ms  read ms  parse ms  stall ms     MB/s  parsed  fallbacks\n" );
+	for( int useJobs = 0; useJobs < 2; useJobs++ )
+	{
+		imageLoadTimes_t best;
+		for( int pass = 0; pass < numPasses; pass++ )
+		{
+			imageLoadTimes_t times;
+			globalImages->LoadGeneratedImages( imageList, false, useJobs != 0, false, times );
+			if( pass == 0 || times.totalMicroSec < best.totalMicroSec )
+			{
+				best = times;
+			}
+		}
+		
+		const double megaBytesPerSec = ( double )best.numBytes / Max( best.totalMicroSec, ( uint64 )1 );
+		common->Printf( "%-6s  %9.1f  %8.1f  %7.1f  %8.1f  %8.1f  %7.1f  %6i  %9i\n", useJobs ? "jobs" : "serial",
+						best.totalMicroSec * 0.001, best.prepareMicroSec * 0.001, best.readMicroSec * 0.001,
+						best.parseMicroSec * 0.001, best.stallMicroSec * 0.001, megaBytesPerSec, best.numParsed, best.numFallbacks );
+	}
+}
+
 /*
 ===============
 UnbindAll
@@ -785,6 +882,7 @@ void idImageManager::Init()
 	cmdSystem->AddCommand( "reloadImages", R_ReloadImages_f, CMD_FL_RENDERER, "reloads images" );
 	cmdSystem->AddCommand( "listImages", R_ListImages_f, CMD_FL_RENDERER, "lists images" );
 	cmdSystem->AddCommand( "combineCubeImages", R_CombineCubeImages_f, CMD_FL_RENDERER, "combines six images for roq compression" );
+	cmdSystem->AddCommand( "benchmarkImageLoad", R_BenchmarkImageLoad_f, CMD_FL_RENDERER, "times reading and parsing the generated images without uploading them" );
 	
 	// should forceLoadImages be here?
 }
@@ -875,7 +973,9 @@ void idImageManager::Preload( const idPreloadManifest& manifest, const bool& map
 		int	start = Sys_Milliseconds();
 		int numLoaded = 0;
 		
-		//fileSystem->StartPreload( preloadImageFiles );
+		idStrList preloadImageFiles;
+		preloadImageFiles.SetGranularity( 1024 );
+		
 		for( int i = 0; i < manifest.NumResources(); i++ )
 		{
 			const preloadEntry_s& p = manifest.GetPreloadByIndex( i );
@@ -883,9 +983,17 @@ void idImageManager::Preload( const idPreloadManifest& manifest, const bool& map
 			{
 				globalImages->ImageFromFile( p.resourceName, ( textureFilter_t )p.imgData.filter, ( textureRepeat_t )p.imgData.repeat, ( textureUsage_t )p.imgData.usage, ( cubeFiles_t )p.imgData.cubeMap );
 				numLoaded++;
+				
+				idStr generatedName = p.resourceName;
+				idImage::GetGeneratedName( generatedName, ( textureUsage_t )p.imgData.usage, ( cubeFiles_t )p.imgData.cubeMap );
+				idBinaryImage::GetGeneratedFileName( preloadImageFiles.Alloc(), generatedName );
 			}
 		}
-		//fileSystem->StopPreload();
+		
+		// the images are only created here and loaded later on by LoadLevelImages,
+		// give the file system a chance to read ahead the generated files meanwhile
+		fileSystem->StartPreload( preloadImageFiles );
+		fileSystem->StopPreload();
 		int	end = Sys_Milliseconds();
 		common->Printf( "%05d images preloaded ( or were already loaded ) in %5.1f seconds\n", numLoaded, ( end - start ) * 0.001 );
 		common->Printf( "----------------------------------------\n" );
@@ -900,27 +1008,187 @@ idImageManager::LoadLevelImages
 */
 int idImageManager::LoadLevelImages( bool pacifier )
 {
-	int	loadCount = 0;
+	idList< idImage* > imagesToLoad;
 	for( int i = 0 ; i < images.Num() ; i++ )
+	{
+		idImage*	image = images[ i ];
+		if( image->generatorFunction )
+		{
+			continue;
+		}
+		if( image->levelLoadReferenced && !image->IsLoaded() )
+		{
+			imagesToLoad.Append( image );
+		}
+	}
+	
+	if( R_IsInitialized() && fileSystem->UsingResourceFiles() )
+	{
+		imageLoadTimes_t times;
+		LoadGeneratedImages( imagesToLoad, true, image_loadJobs.GetBool(), pacifier, times );
+		common->DPrintf( "%i images parsed, %i loaded from source, %.1f ms read, %.1f ms parse, %.1f ms upload, %.1f ms stalled\n",
+						 times.numParsed, times.numFallbacks, times.readMicroSec * 0.001, times.parseMicroSec * 0.001,
+						 times.uploadMicroSec * 0.001, times.stallMicroSec * 0.001 );
+		return imagesToLoad.Num();
+	}
+	
+	for( int i = 0; i < imagesToLoad.Num(); i++ )
+	{
+		if( pacifier )
+		{
+			common->UpdateLevelLoadPacifier();
+		}
+		imagesToLoad[ i ]->ActuallyLoadImage( false );
+	}
+	
+	return imagesToLoad.Num();
+}
+
+/*
+===============
+idImageManager::LoadGeneratedImages
+===============
+*/
+void idImageManager::LoadGeneratedImages( const idList< idImage* >& imageList, bool upload, bool useJobs, bool pacifier, imageLoadTimes_t& times )
+{
+	memset( &times, 0, sizeof( times ) );
+	
+	const int numImages = imageList.Num();
+	if( numImages == 0 )
+	{
+		return;
+	}
+	
+	const uint64 startTime = Sys_Microseconds();
+	
+	// I/O stage, the async read threads read the generated files in disk order
+	idAsyncReadBatch batch;
+	idList< imageLoadJob_t > jobs;
+	jobs.SetNum( numImages );
+	for( int i = 0; i < numImages; i++ )
+	{
+		idImage* image = imageList[ i ];
+		imageLoadJob_t& job = jobs[ i ];
+		
+		job.savedOpts = image->opts;
+		job.savedUsage = image->usage;
+		job.savedRepeat = image->repeat;
+		job.savedSourceFileTime = image->sourceFileTime;
+		
+		idStrStatic< MAX_OSPATH > generatedName;
+		image->PrepareLoad( generatedName );
+		
+		idStr binaryFileName;
+		idBinaryImage::GetGeneratedFileName( binaryFileName, generatedName );
+		
+		job.batch = &batch;
+		job.request = batch.Add( binaryFileName );
+		job.image = image;
+		job.binaryImage = new( TAG_IMAGE ) idBinaryImage( generatedName );
+		job.sourceFileTime = image->sourceFileTime;
+		job.length = 0;
+		job.valid = false;
+		job.readMicroSec = 0;
+		job.parseMicroSec = 0;
+	}
+	batch.Submit();
+	
+	// the images that have to be loaded the regular way still get their files from the batch
+	fileSystem->SetReadBatch( &batch );
+	
+	times.prepareMicroSec = Sys_Microseconds() - startTime;
+	
+	// CPU stage, the jobs are added in read order so the uploads can wait for them one at a time
+	idParallelJobList* jobList = NULL;
+	if( useJobs )
+	{
+		jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, numImages, 0, NULL );
+		for( int i = 0; i < numImages; i++ )
+		{
+			jobList->AddJob( ( jobRun_t )R_LoadGeneratedImageJob, &jobs[ batch.GetReadOrder( i ) ] );
+		}
+		// the jobs block on the reads, but the read threads overlap the I/O already
+		jobList->Submit( NULL, JOBLIST_PARALLELISM_MAX_CORES );
+	}
+	
+	// upload stage on the thread that owns the rendering context
+	for( int i = 0; i < numImages; i++ )
 	{
 		if( pacifier )
 		{
 			common->UpdateLevelLoadPacifier();
-			
 		}
 		
-		idImage*	image = images[ i ];
-		if( image->generatorFunction )
+		const int index = batch.GetReadOrder( i );
+		imageLoadJob_t& job = jobs[ index ];
+		
+		const uint64 waitTime = Sys_Microseconds();
+		if( jobList != NULL )
 		{
-			continue;
+			jobList->WaitForJobs( i, 1 );
 		}
-		if( image->levelLoadReferenced && !image->IsLoaded() )
+		else
+		{
+			R_LoadGeneratedImageJob( &job );
+		}
+		const uint64 uploadTime = Sys_Microseconds();
+		if( jobList != NULL )
+		{
+			times.stallMicroSec += uploadTime - waitTime;
+		}
+		
+		if( upload )
+		{
+			idImage* image = imageList[ index ];
+			if( job.valid )
+			{
+				image->binaryFileTime = 0;
+				image->SetGeneratedImageOpts( *job.binaryImage );
+				image->UploadBinaryImage( *job.binaryImage );
+			}
+			else
+			{
+				image->ActuallyLoadImage( false );
+			}
+			times.uploadMicroSec += Sys_Microseconds() - uploadTime;
+		}
+		else
+		{
+			// only timing the pipeline, leave the image as it was
+			idImage* image = imageList[ index ];
+			image->opts = job.savedOpts;
+			image->usage = job.savedUsage;
+			image->repeat = job.savedRepeat;
+			image->sourceFileTime = job.savedSourceFileTime;
+		}
+		
+		times.readMicroSec += job.readMicroSec;
+		times.parseMicroSec += job.parseMicroSec;
+		if( job.valid )
 		{
-			loadCount++;
-			image->ActuallyLoadImage( false );
+			times.numParsed++;
+			times.numBytes += job.length;
 		}
+		else
+		{
+			times.numFallbacks++;
+		}
+		
+		// the image levels referenced the read buffer
+		delete job.binaryImage;
+		job.binaryImage = NULL;
+		batch.ReleaseData( index );
 	}
-	return loadCount;
+	
+	if( jobList != NULL )
+	{
+		jobList->Wait();
+		parallelJobManager->FreeJobList( jobList );
+	}
+	
+	fileSystem->SetReadBatch( NULL );
+	
+	times.totalMicroSec = Sys_Microseconds() - startTime;
 }
 
 /*
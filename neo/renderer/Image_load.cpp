@@ -360,41 +360,8 @@ void idImage::ActuallyLoadImage( bool fromBackEnd )
 		return;
 	}
 	
-	if( com_productionMode.GetInteger() != 0 )
-	{
-		sourceFileTime = FILE_NOT_FOUND_TIMESTAMP;
-		if( cubeFiles != CF_2D )
-		{
-			opts.textureType = TT_CUBIC;
-			repeat = TR_CLAMP;
-		}
-	}
-	else
-	{
-		// RB begin
-		if( cubeFiles == CF_2D_ARRAY )
-		{
-			opts.textureType = TT_2D_ARRAY;
-		}
-		// RB end
-		else if( cubeFiles != CF_2D )
-		{
-			opts.textureType = TT_CUBIC;
-			repeat = TR_CLAMP;
-			R_LoadCubeImages( GetName(), cubeFiles, NULL, NULL, &sourceFileTime );
-		}
-		else
-		{
-			opts.textureType = TT_2D;
-			R_LoadImageProgram( GetName(), NULL, NULL, NULL, &sourceFileTime, &usage );
-		}
-	}
-	
-	// Figure out opts.colorFormat and opts.format so we can make sure the binary image is up to date
-	DeriveOpts();
-	
-	idStrStatic< MAX_OSPATH > generatedName = GetName();
-	GetGeneratedName( generatedName, usage, cubeFiles );
+	idStrStatic< MAX_OSPATH > generatedName;
+	PrepareLoad( generatedName );
 	
 	idBinaryImage im( generatedName );
 	binaryFileTime = im.LoadFromGeneratedFile( sourceFileTime );
@@ -442,25 +409,10 @@ void idImage::ActuallyLoadImage( bool fromBackEnd )
 			}
 		}
 	}
-	const bimageFile_t& header = im.GetFileHeader();
 	
-	if( ( fileSystem->InProductionMode() && binaryFileTime != FILE_NOT_FOUND_TIMESTAMP ) || ( ( binaryFileTime != FILE_NOT_FOUND_TIMESTAMP )
-			&& ( header.colorFormat == opts.colorFormat )
-			&& ( header.format == opts.format )
-			&& ( header.textureType == opts.textureType )
-																							) )
-	{
-		opts.width = header.width;
-		opts.height = header.height;
-		opts.numLevels = header.numLevels;
-		opts.colorFormat = ( textureColor_t )header.colorFormat;
-		opts.format = ( textureFormat_t )header.format;
-		opts.textureType = ( textureType_t )header.textureType;
-		if( cvarSystem->GetCVarBool( "fs_buildresources" ) )
-		{
-			// for resource gathering write this image to the preload file for this map
-			fileSystem->AddImagePreload( GetName(), filter, repeat, usage, cubeFiles );
-		}
+	if( IsGeneratedImageValid( im, binaryFileTime ) )
+	{
+		SetGeneratedImageOpts( im );
 	}
 	else
 	{
@@ -532,8 +484,110 @@ void idImage::ActuallyLoadImage( bool fromBackEnd )
 		binaryFileTime = im.WriteGeneratedFile( sourceFileTime );
 	}
 	
-	AllocImage();
+	UploadBinaryImage( im );
+}
+
+/*
+===============
+PrepareLoad
+
+Sets up the texture type and the expected format of the generated
+file and updates the source file time outside of production mode
+===============
+*/
+void idImage::PrepareLoad( idStr& generatedName )
+{
+	if( com_productionMode.GetInteger() != 0 )
+	{
+		sourceFileTime = FILE_NOT_FOUND_TIMESTAMP;
+		if( cubeFiles != CF_2D )
+		{
+			opts.textureType = TT_CUBIC;
+			repeat = TR_CLAMP;
+		}
+	}
+	else
+	{
+		// RB begin
+		if( cubeFiles == CF_2D_ARRAY )
+		{
+			opts.textureType = TT_2D_ARRAY;
+		}
+		// RB end
+		else if( cubeFiles != CF_2D )
+		{
+			opts.textureType = TT_CUBIC;
+			repeat = TR_CLAMP;
+			R_LoadCubeImages( GetName(), cubeFiles, NULL, NULL, &sourceFileTime );
+		}
+		else
+		{
+			opts.textureType = TT_2D;
+			R_LoadImageProgram( GetName(), NULL, NULL, NULL, &sourceFileTime, &usage );
+		}
+	}
+	
+	// Figure out opts.colorFormat and opts.format so we can make sure the binary image is up to date
+	DeriveOpts();
+	
+	generatedName = GetName();
+	GetGeneratedName( generatedName, usage, cubeFiles );
+}
+
+/*
+===============
+IsGeneratedImageValid
+
+True if the generated file was found and can be uploaded as is
+===============
+*/
+bool idImage::IsGeneratedImageValid( const idBinaryImage& im, ID_TIME_T binaryTime ) const
+{
+	if( binaryTime == FILE_NOT_FOUND_TIMESTAMP )
+	{
+		return false;
+	}
+	if( fileSystem->InProductionMode() )
+	{
+		return true;
+	}
+	
+	const bimageFile_t& header = im.GetFileHeader();
+	return ( header.colorFormat == opts.colorFormat )
+		   && ( header.format == opts.format )
+		   && ( header.textureType == opts.textureType );
+}
+
+/*
+===============
+SetGeneratedImageOpts
+===============
+*/
+void idImage::SetGeneratedImageOpts( const idBinaryImage& im )
+{
+	const bimageFile_t& header = im.GetFileHeader();
 	
+	opts.width = header.width;
+	opts.height = header.height;
+	opts.numLevels = header.numLevels;
+	opts.colorFormat = ( textureColor_t )header.colorFormat;
+	opts.format = ( textureFormat_t )header.format;
+	opts.textureType = ( textureType_t )header.textureType;
+	if( cvarSystem->GetCVarBool( "fs_buildresources" ) )
+	{
+		// for resource gathering write this image to the preload file for this map
+		fileSystem->AddImagePreload( GetName(), filter, repeat, usage, cubeFiles );
+	}
+}
+
+/*
+===============
+UploadBinaryImage
+===============
+*/
+void idImage::UploadBinaryImage( const idBinaryImage& im )
+{
+	AllocImage();
 	
 	for( int i = 0; i < im.NumImages(); i++ )
 	{
@@ -516,6 +516,7 @@ bool idRenderModelStatic::LoadBinaryModel( idFile* file, const ID_TIME_T sourceT
 			tri.indexCache = 0;
 			tri.ambientCache = 0;
 			tri.shadowCache = 0;
+			tri.compactCache = 0;
 		}
 	}
 	
@@ -119,6 +119,7 @@ struct srfTriangles_t
 	vertCacheHandle_t			indexCache;				// GL_INDEX_TYPE
 	vertCacheHandle_t			ambientCache;			// idDrawVert
 	vertCacheHandle_t			shadowCache;			// idVec4
+	vertCacheHandle_t			compactCache;			// idDrawVertCompact, only for static surfaces with r_useCompactVerts
 	
 	DISALLOW_COPY_AND_ASSIGN( srfTriangles_t );
 };
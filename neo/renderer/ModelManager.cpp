@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "Model_local.h"
 #include "tr_local.h"	// just for R_FreeWorldInteractions and R_CreateWorldInteractions
+#include "../idlib/geometry/DrawVert_intrinsics.h"
 
 idCVar r_binaryLoadRenderModels( "r_binaryLoadRenderModels", "1", 0, "enable binary load/write of render models" );
 idCVar preload_MapModels( "preload_MapModels", "1", CVAR_SYSTEM | CVAR_BOOL, "preload models during begin or end levelload" );
@@ -73,6 +74,9 @@ private:
 	static void				ListModels_f( const idCmdArgs& args );
 	static void				ReloadModels_f( const idCmdArgs& args );
 	static void				TouchModel_f( const idCmdArgs& args );
+	static void				BenchMD5Skinning_f( const idCmdArgs& args );
+	static void				ListVertexCache_f( const idCmdArgs& args );
+	static void				TestCompactVerts_f( const idCmdArgs& args );
 };
 
 
@@ -194,6 +198,220 @@ void idRenderModelManagerLocal::TouchModel_f( const idCmdArgs& args )
 	}
 }
 
+/*
+==============
+idRenderModelManagerLocal::BenchMD5Skinning_f
+
+Skins every loaded MD5 mesh with the per vertex CPU path and the blocked SoA path
+==============
+*/
+void idRenderModelManagerLocal::BenchMD5Skinning_f( const idCmdArgs& args )
+{
+	int numIterations = 100;
+	if( args.Argc() > 1 )
+	{
+		numIterations = Max( 1, atoi( args.Argv( 1 ) ) );
+	}
+	
+	int numModels = 0;
+	int numVerts = 0;
+	uint64 scalarMicroseconds = 0;
+	uint64 blockMicroseconds = 0;
+	float maxError = 0.0f;
+	
+	for( int i = 0; i < localModelManager.models.Num(); i++ )
+	{
+		idRenderModel* model = localModelManager.models[i];
+		if( model == NULL || !model->IsLoaded() || model->IsDefaultModel() )
+		{
+			continue;
+		}
+		
+		const idRenderModelMD5* md5 = dynamic_cast< const idRenderModelMD5* >( model );
+		if( md5 == NULL )
+		{
+			continue;
+		}
+		
+		numVerts += md5->BenchSkinning( numIterations, scalarMicroseconds, blockMicroseconds, maxError );
+		numModels++;
+	}
+	
+	if( numVerts == 0 )
+	{
+		common->Printf( "no MD5 meshes loaded\n" );
+		return;
+	}
+	
+	const double totalVerts = ( double )numVerts * numIterations;
+	common->Printf( "%d MD5 models, %d verts, %d iterations\n", numModels, numVerts, numIterations );
+	common->Printf( "per vertex: %8.1f ms, %6.1f Mverts/s\n", scalarMicroseconds * 0.001, totalVerts / Max( scalarMicroseconds, ( uint64 )1 ) );
+	common->Printf( "blocked:    %8.1f ms, %6.1f Mverts/s\n", blockMicroseconds * 0.001, totalVerts / Max( blockMicroseconds, ( uint64 )1 ) );
+	common->Printf( "speedup %.2fX, max error %f\n", ( double )scalarMicroseconds / Max( blockMicroseconds, ( uint64 )1 ), maxError );
+}
+
+/*
+==============
+idRenderModelManagerLocal::ListVertexCache_f
+
+Reports the static vertex cache usage of the loaded models and how many bytes
+the shadow map passes fetch per vertex with and without the compact vertices
+==============
+*/
+void idRenderModelManagerLocal::ListVertexCache_f( const idCmdArgs& args )
+{
+	int numSurfaces = 0;
+	int numCompactSurfaces = 0;
+	int numVerts = 0;
+	int numCompactVerts = 0;
+	int ambientBytes = 0;
+	int compactBytes = 0;
+	int shadowBytes = 0;
+	int indexBytes = 0;
+	
+	for( int i = 0; i < localModelManager.models.Num(); i++ )
+	{
+		idRenderModel* model = localModelManager.models[i];
+		if( model == NULL || !model->IsLoaded() )
+		{
+			continue;
+		}
+		
+		for( int j = 0; j < model->NumSurfaces(); j++ )
+		{
+			const srfTriangles_t* tri = model->Surface( j )->geometry;
+			if( tri == NULL )
+			{
+				continue;
+			}
+			
+			if( vertexCache.CacheIsStatic( tri->ambientCache ) )
+			{
+				ambientBytes += idVertexCache::CacheSize( tri->ambientCache );
+				numVerts += tri->numVerts;
+				numSurfaces++;
+			}
+			if( vertexCache.CacheIsStatic( tri->compactCache ) )
+			{
+				compactBytes += idVertexCache::CacheSize( tri->compactCache );
+				numCompactVerts += tri->numVerts;
+				numCompactSurfaces++;
+			}
+			if( vertexCache.CacheIsStatic( tri->shadowCache ) )
+			{
+				shadowBytes += idVertexCache::CacheSize( tri->shadowCache );
+			}
+			if( vertexCache.CacheIsStatic( tri->indexCache ) )
+			{
+				indexBytes += idVertexCache::CacheSize( tri->indexCache );
+			}
+		}
+	}
+	
+	common->Printf( "static vertex memory: %6ikB of %ikB\n", vertexCache.staticData.vertexMemUsed.GetValue() / 1024, STATIC_VERTEX_MEMORY / 1024 );
+	common->Printf( "static index memory:  %6ikB of %ikB\n", vertexCache.staticData.indexMemUsed.GetValue() / 1024, STATIC_INDEX_MEMORY / 1024 );
+	common->Printf( "  idDrawVert:         %6ikB, %i verts in %i surfaces\n", ambientBytes / 1024, numVerts, numSurfaces );
+	common->Printf( "  idDrawVertCompact:  %6ikB on top of idDrawVert, %i verts in %i surfaces\n", compactBytes / 1024, numCompactVerts, numCompactSurfaces );
+	common->Printf( "net static vertex memory change from idDrawVertCompact: %+ikB (%+.1f%% of idDrawVert)\n", compactBytes / 1024,
+					( ambientBytes > 0 ) ? 100.0f * compactBytes / ambientBytes : 0.0f );
+	common->Printf( "  idShadowVert:       %6ikB\n", shadowBytes / 1024 );
+	common->Printf( "  indexes:            %6ikB\n", indexBytes / 1024 );
+	common->Printf( "per frame high water: %6ikB vertex, %ikB index, %ikB joint of %ikB, %ikB, %ikB\n",
+					vertexCache.mostUsedVertex / 1024, vertexCache.mostUsedIndex / 1024, vertexCache.mostUsedJoint / 1024,
+					VERTCACHE_VERTEX_MEMORY_PER_FRAME / 1024, VERTCACHE_INDEX_MEMORY_PER_FRAME / 1024, VERTCACHE_JOINT_MEMORY_PER_FRAME / 1024 );
+					
+	if( numCompactVerts > 0 )
+	{
+		const int drawVertBytes = numCompactVerts * sizeof( idDrawVert );
+		common->Printf( "shadow map vertex fetch for compact surfaces: %ikB instead of %ikB\n", compactBytes / 1024, drawVertBytes / 1024 );
+	}
+	else if( !r_useCompactVerts.GetBool() )
+	{
+		common->Printf( "set r_useCompactVerts 1 and reload the map to create compact vertices\n" );
+	}
+}
+
+/*
+==============
+idRenderModelManagerLocal::TestCompactVerts_f
+
+Packs the static surfaces of the loaded models into compact vertices and unpacks them again,
+the positions have to stay within GetMaxPositionError and the normals and tangents within
+COMPACT_NORMAL_MIN_DOT of the idDrawVert values.
+==============
+*/
+void idRenderModelManagerLocal::TestCompactVerts_f( const idCmdArgs& args )
+{
+	idList<idDrawVertCompact, TAG_TEMP> compactVerts;
+	idList<idDrawVert, TAG_TEMP> unpackedVerts;
+	
+	int numSurfaces = 0;
+	int numVerts = 0;
+	int numFailed = 0;
+	float maxPositionError = 0.0f;
+	float minNormalDot = 1.0f;
+	
+	for( int i = 0; i < localModelManager.models.Num(); i++ )
+	{
+		idRenderModel* model = localModelManager.models[i];
+		if( model == NULL || !model->IsLoaded() )
+		{
+			continue;
+		}
+		
+		for( int j = 0; j < model->NumSurfaces(); j++ )
+		{
+			const srfTriangles_t* tri = model->Surface( j )->geometry;
+			if( tri == NULL || tri->verts == NULL || tri->numVerts == 0 || tri->staticModelWithJoints != NULL )
+			{
+				continue;
+			}
+			
+			compactVerts.SetNum( tri->numVerts );
+			unpackedVerts.SetNum( tri->numVerts );
+			PackDrawVertsCompact( compactVerts.Ptr(), tri->verts, tri->numVerts, tri->bounds );
+			UnpackDrawVertsCompact( unpackedVerts.Ptr(), compactVerts.Ptr(), tri->numVerts, tri->bounds );
+			
+			const float positionBound = idDrawVertCompact::GetMaxPositionError( tri->bounds );
+			float positionError = 0.0f;
+			float normalDot = 1.0f;
+			for( int k = 0; k < tri->numVerts; k++ )
+			{
+				const idDrawVert& vert = tri->verts[k];
+				const idDrawVert& unpacked = unpackedVerts[k];
+				for( int a = 0; a < 3; a++ )
+				{
+					positionError = Max( positionError, idMath::Fabs( unpacked.xyz[a] - vert.xyz[a] ) );
+				}
+				// degenerate vertices have no direction to keep
+				if( vert.GetNormalRaw().LengthSqr() > 0.25f )
+				{
+					normalDot = Min( normalDot, vert.GetNormal() * unpacked.GetNormal() );
+				}
+				if( vert.GetTangentRaw().LengthSqr() > 0.25f )
+				{
+					normalDot = Min( normalDot, vert.GetTangent() * unpacked.GetTangent() );
+				}
+			}
+			
+			if( positionError > positionBound || normalDot < COMPACT_NORMAL_MIN_DOT )
+			{
+				common->Warning( "%s surface %i: position error %f of %f, normal dot %f", model->Name(), j, positionError, positionBound, normalDot );
+				numFailed++;
+			}
+			assert( positionError <= positionBound );
+			assert( normalDot >= COMPACT_NORMAL_MIN_DOT );
+			
+			maxPositionError = Max( maxPositionError, positionError );
+			minNormalDot = Min( minNormalDot, normalDot );
+			numVerts += tri->numVerts;
+			numSurfaces++;
+		}
+	}
+	
+	common->Printf( "%i verts in %i surfaces, %i out of bounds, max position error %f, min normal dot %f\n", numVerts, numSurfaces, numFailed, maxPositionError, minNormalDot );
+}
+
 /*
 =================
 idRenderModelManagerLocal::WritePrecacheCommands
@@ -232,6 +450,9 @@ void idRenderModelManagerLocal::Init()
 	cmdSystem->AddCommand( "printModel", PrintModel_f, CMD_FL_RENDERER, "prints model info", idCmdSystem::ArgCompletion_ModelName );
 	cmdSystem->AddCommand( "reloadModels", ReloadModels_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "reloads models" );
 	cmdSystem->AddCommand( "touchModel", TouchModel_f, CMD_FL_RENDERER, "touches a model", idCmdSystem::ArgCompletion_ModelName );
+	cmdSystem->AddCommand( "benchMD5Skinning", BenchMD5Skinning_f, CMD_FL_RENDERER, "compares CPU skinning paths over all loaded MD5 models" );
+	cmdSystem->AddCommand( "listVertexCache", ListVertexCache_f, CMD_FL_RENDERER, "reports static vertex cache usage of the loaded models" );
+	cmdSystem->AddCommand( "testCompactVerts", TestCompactVerts_f, CMD_FL_RENDERER, "checks the compact vertex error bounds on the static surfaces of the loaded models" );
 	
 	insideLevelLoad = false;
 	
@@ -748,21 +969,63 @@ void idRenderModelManagerLocal::EndLevelLoad()
 		common->UpdateLevelLoadPacifier();
 	}
 	
-	// load any new ones
+	// load any new ones, the files are read on the async read threads
+	// while the models are loaded in the order they come off the disk
+	idAsyncReadBatch batch;
+	idList< int > modelIndex;
 	for( int i = 0; i < models.Num(); i++ )
+	{
+		idRenderModel* model = models[i];
+		
+		if( model->IsLevelLoadReferenced() && !model->IsLoaded() && model->IsReloadable() )
+		{
+			if( model->SupportsBinaryModel() && r_binaryLoadRenderModels.GetBool() )
+			{
+				idStrStatic< MAX_OSPATH > extension;
+				idStrStatic< MAX_OSPATH > generatedFileName = "generated/rendermodels/";
+				generatedFileName.AppendPath( model->Name() );
+				generatedFileName.ExtractFileExtension( extension );
+				generatedFileName.SetFileExtension( va( "b%s", extension.c_str() ) );
+				batch.Add( generatedFileName );
+			}
+			else
+			{
+				batch.Add( model->Name() );
+			}
+			modelIndex.Append( i );
+		}
+	}
+	
+	batch.Submit();
+	fileSystem->SetReadBatch( &batch );
+	
+	for( int i = 0; i < batch.Num(); i++ )
 	{
 		common->UpdateLevelLoadPacifier();
 		
 		
-		idRenderModel* model = models[i];
+		idRenderModel* model = models[ modelIndex[ batch.GetReadOrder( i ) ] ];
 		
-		if( model->IsLevelLoadReferenced() && !model->IsLoaded() && model->IsReloadable() )
+		loadCount++;
+		
+		// same as reloading a purged model in FindModel
+		if( model->SupportsBinaryModel() && r_binaryLoadRenderModels.GetBool() )
+		{
+			idFileLocal file( fileSystem->OpenFileReadMemory( batch.GetFileName( batch.GetReadOrder( i ) ) ) );
+			model->PurgeModel();
+			if( !model->LoadBinaryModel( file, 0 ) )
+			{
+				model->LoadModel();
+			}
+		}
+		else
 		{
-			loadCount++;
 			model->LoadModel();
 		}
 	}
 	
+	fileSystem->SetReadBatch( NULL );
+	
 	// create static vertex/index buffers for all models
 	for( int i = 0; i < models.Num(); i++ )
 	{
@@ -774,7 +1037,8 @@ void idRenderModelManagerLocal::EndLevelLoad()
 		{
 			for( int j = 0; j < model->NumSurfaces(); j++ )
 			{
-				R_CreateStaticBuffersForTri( *( model->Surface( j )->geometry ) );
+				const modelSurface_t* surf = model->Surface( j );
+				R_CreateStaticBuffersForTri( *surf->geometry, surf->shader == NULL || surf->shader->SurfaceCastsShadow() );
 			}
 		}
 	}
@@ -164,6 +164,21 @@ protected:
 ===============================================================================
 */
 
+// Base pose of four vertices packed as structure of arrays for CPU skinning.
+// Vertices past the end of the mesh are padded with zero weights.
+struct md5SkinBlock_t
+{
+	float						xyz[3][4];			// [component][vertex]
+	float						normal[3][4];		// decoded and normalized like idDrawVert::GetNormal
+	float						tangent[3][4];
+	float						weights[4][4];		// [weight][vertex] in the range [0, 1]
+	byte						joints[4][4];		// [weight][vertex]
+	byte						normalW[4];			// normal[3] and tangent[3] of the base verts
+	byte						tangentW[4];
+	int							numWeights;			// highest number of weights used by the four vertices
+	int							pad;
+};
+
 class idMD5Mesh
 {
 	friend class				idRenderModelMD5;
@@ -188,6 +203,8 @@ public:
 	void						CalculateBounds( const idJointMat* entJoints, idBounds& bounds ) const;
 	int							NearestJoint( int a, int b, int c ) const;
 	
+	void						BenchSkinning( const idJointMat* joints, int numIterations, uint64& scalarMicroseconds, uint64& blockMicroseconds, float& maxError ) const;
+	
 private:
 	const idMaterial* 			shader;				// material applied to mesh
 	int							numVerts;			// number of vertices
@@ -197,6 +214,12 @@ private:
 	float						maxJointVertDist;	// maximum distance a vertex is separated from a joint
 	deformInfo_t* 				deformInfo;			// used to create srfTriangles_t from base frames and new vertexes
 	int							surfaceNum;			// number of the static surface created for this mesh
+	mutable md5SkinBlock_t* 	skinBlocks;			// SoA copy of deformInfo->verts, built on the first CPU skinning
+	int							numSkinBlocks;
+	
+	void						ResetSkinBlocks();
+	md5SkinBlock_t* 			BuildSkinBlocks() const;
+	const md5SkinBlock_t* 		GetSkinBlocks() const;
 };
 
 class idRenderModelMD5 : public idRenderModelStatic
@@ -226,6 +249,9 @@ public:
 		return true;
 	}
 	
+	// skins every mesh in the default pose with the per vertex and the blocked path
+	int							BenchSkinning( int numIterations, uint64& scalarMicroseconds, uint64& blockMicroseconds, float& maxError ) const;
+	
 private:
 	idList<idMD5Joint, TAG_MODEL>	joints;
 	idList<idJointQuat, TAG_MODEL>	defaultPose;
@@ -77,6 +77,8 @@ idMD5Mesh::idMD5Mesh()
 	maxJointVertDist	= 0.0f;
 	deformInfo			= NULL;
 	surfaceNum			= 0;
+	skinBlocks			= NULL;
+	numSkinBlocks		= 0;
 }
 
 /*
@@ -96,6 +98,11 @@ idMD5Mesh::~idMD5Mesh()
 		R_FreeDeformInfo( deformInfo );
 		deformInfo = NULL;
 	}
+	if( skinBlocks != NULL )
+	{
+		Mem_Free( skinBlocks );
+		skinBlocks = NULL;
+	}
 }
 
 /*
@@ -440,9 +447,100 @@ void idMD5Mesh::ParseMesh( idLexer& parser, int numJoints, const idJointMat* joi
 		}
 	}
 	
+	ResetSkinBlocks();
+	
 	Mem_Free( basePose );
 }
 
+/*
+====================
+idMD5Mesh::ResetSkinBlocks
+
+Drops the skin blocks of a previous load, meshes that are only skinned on the GPU never build them.
+====================
+*/
+void idMD5Mesh::ResetSkinBlocks()
+{
+	if( skinBlocks != NULL )
+	{
+		Mem_Free( skinBlocks );
+		skinBlocks = NULL;
+	}
+	numSkinBlocks = ( deformInfo->numOutputVerts + 3 ) >> 2;
+}
+
+/*
+====================
+idMD5Mesh::GetSkinBlocks
+
+Builds the skin blocks on first use. Meshes can be skinned by several jobs at
+once, so the first blocks published win and the other copies are freed.
+====================
+*/
+const md5SkinBlock_t* idMD5Mesh::GetSkinBlocks() const
+{
+	md5SkinBlock_t* blocks = skinBlocks;
+	if( blocks != NULL || numSkinBlocks == 0 )
+	{
+		return blocks;
+	}
+	
+	blocks = BuildSkinBlocks();
+	md5SkinBlock_t* existing = ( md5SkinBlock_t* )Sys_InterlockedCompareExchangePointer( reinterpret_cast< void*& >( skinBlocks ), NULL, blocks );
+	if( existing != NULL )
+	{
+		Mem_Free( blocks );
+		return existing;
+	}
+	return blocks;
+}
+
+/*
+====================
+idMD5Mesh::BuildSkinBlocks
+====================
+*/
+md5SkinBlock_t* idMD5Mesh::BuildSkinBlocks() const
+{
+	compile_time_assert( ( sizeof( md5SkinBlock_t ) & 15 ) == 0 );
+	
+	const int numOutputVerts = deformInfo->numOutputVerts;
+	md5SkinBlock_t* blocks = ( md5SkinBlock_t* )Mem_ClearedAlloc( numSkinBlocks * sizeof( blocks[0] ), TAG_MD5_SKIN );
+	assert( ( ( intptr_t )blocks & 15 ) == 0 );
+	
+	for( int i = 0; i < numOutputVerts; i++ )
+	{
+		const idDrawVert& base = deformInfo->verts[i];
+		md5SkinBlock_t& block = blocks[i >> 2];
+		const int v = i & 3;
+		
+		const idVec3 normal = base.GetNormal();
+		const idVec3 tangent = base.GetTangent();
+		
+		for( int j = 0; j < 3; j++ )
+		{
+			block.xyz[j][v] = base.xyz[j];
+			block.normal[j][v] = normal[j];
+			block.tangent[j][v] = tangent[j];
+		}
+		
+		for( int j = 0; j < 4; j++ )
+		{
+			block.weights[j][v] = base.color2[j] * ( 1.0f / 255.0f );
+			block.joints[j][v] = base.color[j];
+			
+			if( base.color2[j] != 0 && j + 1 > block.numWeights )
+			{
+				block.numWeights = j + 1;
+			}
+		}
+		
+		block.normalW[v] = ( ( const byte* )&base )[DRAWVERT_NORMAL_OFFSET + 3];
+		block.tangentW[v] = ( ( const byte* )&base )[DRAWVERT_TANGENT_OFFSET + 3];
+	}
+	return blocks;
+}
+
 /*
 ============
 TransformVertsAndTangents
@@ -477,6 +575,125 @@ void TransformVertsAndTangents( idDrawVert* targetVerts, const int numVerts, con
 	}
 }
 
+/*
+============
+TransformSkinBlocks
+
+Same result as TransformVertsAndTangents, but skins four vertices at once from
+the SoA copy of the base pose. The joints of the four vertices are transposed so
+the blended matrix and the transforms run with one vertex per SIMD lane.
+============
+*/
+#if defined(USE_INTRINSICS)
+static void TransformSkinBlocks( idDrawVert* targetVerts, const int numVerts, const md5SkinBlock_t* blocks, const idJointMat* joints )
+{
+	const __m128 vector_float_one			= { 1.0f, 1.0f, 1.0f, 1.0f };
+	const __m128 vector_float_half			= { 0.5f, 0.5f, 0.5f, 0.5f };
+	const __m128 vector_float_255_over_2	= { 255.0f / 2.0f, 255.0f / 2.0f, 255.0f / 2.0f, 255.0f / 2.0f };
+	
+	const float* jointPtr = joints->ToFloatPtr();
+	
+	for( int i = 0; i < numVerts; i += 4 )
+	{
+		const md5SkinBlock_t& block = blocks[i >> 2];
+		assert( block.numWeights > 0 );
+		
+		// blend the joint matrices, m[row][column] holds one element of four matrices
+		__m128 m[3][4];
+		
+		for( int k = 0; k < block.numWeights; k++ )
+		{
+			const float* j0 = jointPtr + block.joints[k][0] * JOINTMAT_TYPESIZE;
+			const float* j1 = jointPtr + block.joints[k][1] * JOINTMAT_TYPESIZE;
+			const float* j2 = jointPtr + block.joints[k][2] * JOINTMAT_TYPESIZE;
+			const float* j3 = jointPtr + block.joints[k][3] * JOINTMAT_TYPESIZE;
+			
+			const __m128 w = _mm_load_ps( block.weights[k] );
+			
+			for( int r = 0; r < 3; r++ )
+			{
+				__m128 c0 = _mm_load_ps( j0 + r * 4 );
+				__m128 c1 = _mm_load_ps( j1 + r * 4 );
+				__m128 c2 = _mm_load_ps( j2 + r * 4 );
+				__m128 c3 = _mm_load_ps( j3 + r * 4 );
+				
+				_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+				
+				if( k == 0 )
+				{
+					m[r][0] = _mm_mul_ps( c0, w );
+					m[r][1] = _mm_mul_ps( c1, w );
+					m[r][2] = _mm_mul_ps( c2, w );
+					m[r][3] = _mm_mul_ps( c3, w );
+				}
+				else
+				{
+					m[r][0] = _mm_madd_ps( c0, w, m[r][0] );
+					m[r][1] = _mm_madd_ps( c1, w, m[r][1] );
+					m[r][2] = _mm_madd_ps( c2, w, m[r][2] );
+					m[r][3] = _mm_madd_ps( c3, w, m[r][3] );
+				}
+			}
+		}
+		
+		const __m128 x = _mm_load_ps( block.xyz[0] );
+		const __m128 y = _mm_load_ps( block.xyz[1] );
+		const __m128 z = _mm_load_ps( block.xyz[2] );
+		
+		const __m128 nx = _mm_load_ps( block.normal[0] );
+		const __m128 ny = _mm_load_ps( block.normal[1] );
+		const __m128 nz = _mm_load_ps( block.normal[2] );
+		
+		const __m128 tx = _mm_load_ps( block.tangent[0] );
+		const __m128 ty = _mm_load_ps( block.tangent[1] );
+		const __m128 tz = _mm_load_ps( block.tangent[2] );
+		
+		__m128 p[4];
+		__m128i n[3];
+		__m128i t[3];
+		for( int r = 0; r < 3; r++ )
+		{
+			p[r] = _mm_add_ps( _mm_madd_ps( m[r][2], z, _mm_madd_ps( m[r][1], y, _mm_mul_ps( m[r][0], x ) ) ), m[r][3] );
+			
+			const __m128 rn = _mm_madd_ps( m[r][2], nz, _mm_madd_ps( m[r][1], ny, _mm_mul_ps( m[r][0], nx ) ) );
+			const __m128 rt = _mm_madd_ps( m[r][2], tz, _mm_madd_ps( m[r][1], ty, _mm_mul_ps( m[r][0], tx ) ) );
+			
+			// same rounding as VertexFloatToByte
+			n[r] = _mm_cvtps_epi32( _mm_madd_ps( _mm_add_ps( rn, vector_float_one ), vector_float_255_over_2, vector_float_half ) );
+			t[r] = _mm_cvtps_epi32( _mm_madd_ps( _mm_add_ps( rt, vector_float_one ), vector_float_255_over_2, vector_float_half ) );
+		}
+		
+		// pack x0-3 y0-3 z0-3 w0-3 to bytes, then interleave to x y z w per vertex
+		const __m128i nw = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( *( const int* )block.normalW ), _mm_setzero_si128() ), _mm_setzero_si128() );
+		const __m128i tw = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( *( const int* )block.tangentW ), _mm_setzero_si128() ), _mm_setzero_si128() );
+		
+		__m128i nb = _mm_packus_epi16( _mm_packs_epi32( n[0], n[1] ), _mm_packs_epi32( n[2], nw ) );
+		__m128i tb = _mm_packus_epi16( _mm_packs_epi32( t[0], t[1] ), _mm_packs_epi32( t[2], tw ) );
+		nb = _mm_unpacklo_epi16( _mm_unpacklo_epi8( nb, _mm_srli_si128( nb, 4 ) ), _mm_unpacklo_epi8( _mm_srli_si128( nb, 8 ), _mm_srli_si128( nb, 12 ) ) );
+		tb = _mm_unpacklo_epi16( _mm_unpacklo_epi8( tb, _mm_srli_si128( tb, 4 ) ), _mm_unpacklo_epi8( _mm_srli_si128( tb, 8 ), _mm_srli_si128( tb, 12 ) ) );
+		
+		p[3] = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS( p[0], p[1], p[2], p[3] );
+		
+		ALIGN16( unsigned int normals[4] );
+		ALIGN16( unsigned int tangents[4] );
+		_mm_store_si128( ( __m128i* )normals, nb );
+		_mm_store_si128( ( __m128i* )tangents, tb );
+		
+		const int count = Min( 4, numVerts - i );
+		for( int v = 0; v < count; v++ )
+		{
+			byte* dst = ( byte* )&targetVerts[i + v];
+			
+			_mm_storel_pi( ( __m64* )( dst + DRAWVERT_XYZ_OFFSET ), p[v] );
+			_mm_store_ss( ( float* )( dst + DRAWVERT_XYZ_OFFSET + 8 ), _mm_movehl_ps( p[v], p[v] ) );
+			*( unsigned int* )( dst + DRAWVERT_NORMAL_OFFSET ) = normals[v];
+			*( unsigned int* )( dst + DRAWVERT_TANGENT_OFFSET ) = tangents[v];
+		}
+	}
+}
+#endif
+
 /*
 ====================
 idMD5Mesh::UpdateSurface
@@ -549,7 +766,11 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s* ent, const idJointMa
 			assert( tri->verts != NULL );	// quiet analyze warning
 			memcpy( tri->verts, deformInfo->verts, deformInfo->numOutputVerts * sizeof( deformInfo->verts[0] ) );	// copy over the texture coordinates
 		}
+#if defined(USE_INTRINSICS)
+		TransformSkinBlocks( tri->verts, deformInfo->numOutputVerts, GetSkinBlocks(), entJointsInverted );
+#else
 		TransformVertsAndTangents( tri->verts, deformInfo->numOutputVerts, deformInfo->verts, entJointsInverted );
+#endif
 		tri->referencedVerts = false;
 	}
 	tri->tangentsCalculated = true;
@@ -655,6 +876,46 @@ int idMD5Mesh::NearestJoint( int a, int b, int c ) const
 	return bestJoint;
 }
 
+/*
+====================
+idMD5Mesh::BenchSkinning
+====================
+*/
+void idMD5Mesh::BenchSkinning( const idJointMat* joints, int numIterations, uint64& scalarMicroseconds, uint64& blockMicroseconds, float& maxError ) const
+{
+	const int numOutputVerts = deformInfo->numOutputVerts;
+	
+	idTempArray< idDrawVert > scalarVerts( numOutputVerts );
+	idTempArray< idDrawVert > blockVerts( numOutputVerts );
+	memcpy( scalarVerts.Ptr(), deformInfo->verts, numOutputVerts * sizeof( idDrawVert ) );
+	memcpy( blockVerts.Ptr(), deformInfo->verts, numOutputVerts * sizeof( idDrawVert ) );
+	
+	uint64 start = Sys_Microseconds();
+	for( int i = 0; i < numIterations; i++ )
+	{
+		TransformVertsAndTangents( scalarVerts.Ptr(), numOutputVerts, deformInfo->verts, joints );
+	}
+	scalarMicroseconds += Sys_Microseconds() - start;
+	
+	start = Sys_Microseconds();
+	for( int i = 0; i < numIterations; i++ )
+	{
+#if defined(USE_INTRINSICS)
+		TransformSkinBlocks( blockVerts.Ptr(), numOutputVerts, GetSkinBlocks(), joints );
+#else
+		TransformVertsAndTangents( blockVerts.Ptr(), numOutputVerts, deformInfo->verts, joints );
+#endif
+	}
+	blockMicroseconds += Sys_Microseconds() - start;
+	
+	for( int i = 0; i < numOutputVerts; i++ )
+	{
+		maxError = Max( maxError, ( scalarVerts[i].xyz - blockVerts[i].xyz ).LengthFast() );
+		maxError = Max( maxError, ( scalarVerts[i].GetNormalRaw() - blockVerts[i].GetNormalRaw() ).LengthFast() );
+		maxError = Max( maxError, ( scalarVerts[i].GetTangentRaw() - blockVerts[i].GetTangentRaw() ).LengthFast() );
+	}
+}
+
 /***********************************************************************
 
 	idRenderModelMD5
@@ -859,6 +1120,8 @@ bool idRenderModelMD5::LoadBinaryModel( idFile* file, const ID_TIME_T sourceTime
 		
 		Mem_Free( shadowVerts );
 		
+		meshes[i].ResetSkinBlocks();
+		
 		file->ReadBig( meshes[i].surfaceNum );
 	}
 	
@@ -1545,6 +1808,30 @@ int idRenderModelMD5::NearestJoint( int surfaceNum, int a, int b, int c ) const
 	return 0;
 }
 
+/*
+====================
+idRenderModelMD5::BenchSkinning
+
+returns the number of skinned vertices per iteration
+====================
+*/
+int idRenderModelMD5::BenchSkinning( int numIterations, uint64& scalarMicroseconds, uint64& blockMicroseconds, float& maxError ) const
+{
+	int numVerts = 0;
+	for( int i = 0; i < meshes.Num(); i++ )
+	{
+		const idMD5Mesh& mesh = meshes[i];
+		if( mesh.deformInfo == NULL || mesh.deformInfo->numOutputVerts == 0 )
+		{
+			continue;
+		}
+		// the inverted default pose is a valid set of skinning joints on its own
+		mesh.BenchSkinning( invertedDefaultPose.Ptr(), numIterations, scalarMicroseconds, blockMicroseconds, maxError );
+		numVerts += mesh.deformInfo->numOutputVerts;
+	}
+	return numVerts;
+}
+
 /*
 ====================
 idRenderModelMD5::TouchData
@@ -1604,6 +1891,11 @@ int	idRenderModelMD5::Memory() const
 		// sum up deform info
 		total += sizeof( mesh->deformInfo );
 		total += R_DeformInfoMemoryUsed( mesh->deformInfo );
+		
+		if( mesh->skinBlocks != NULL )
+		{
+			total += mesh->numSkinBlocks * sizeof( mesh->skinBlocks[0] );
+		}
 	}
 	return total;
 }
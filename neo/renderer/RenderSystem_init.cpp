@@ -234,6 +234,8 @@ idCVar r_shadowMapLodScale( "r_shadowMapLodScale", "1.4", CVAR_RENDERER | CVAR_F
 idCVar r_shadowMapLodBias( "r_shadowMapLodBias", "0", CVAR_RENDERER | CVAR_INTEGER, "" );
 idCVar r_shadowMapPolygonFactor( "r_shadowMapPolygonFactor", "2", CVAR_RENDERER | CVAR_FLOAT, "polygonOffset factor for drawing shadow buffer" );
 idCVar r_shadowMapPolygonOffset( "r_shadowMapPolygonOffset", "3000", CVAR_RENDERER | CVAR_FLOAT, "polygonOffset units for drawing shadow buffer" );
+idCVar r_useCompactVerts( "r_useCompactVerts", "0", CVAR_RENDERER | CVAR_BOOL, "upload an extra 16 byte compact vertex stream for static shadow casting surfaces at level load and use it in the shadow map passes" );
+idCVar r_compactVertsMaxError( "r_compactVertsMaxError", "0.0625", CVAR_RENDERER | CVAR_FLOAT, "largest position error in units a surface may get from the 16 bit compact vertices, larger surfaces keep using idDrawVert" );
 idCVar r_shadowMapOccluderFacing( "r_shadowMapOccluderFacing", "2", CVAR_RENDERER | CVAR_INTEGER, "0 = front faces, 1 = back faces, 2 = twosided" );
 // RB end
 
@@ -935,6 +937,112 @@ static void R_ReloadSurface_f( const idCmdArgs& args )
 	mt.material->ReloadImages( false );
 }
 
+/*
+=====================
+R_TestCullBounds_f
+
+Culls the reference bounds of all entities and lights in the world, and the surface
+bounds of the static models, to the last primary view, one at a time and in batches.
+=====================
+*/
+static void R_TestCullBounds_f( const idCmdArgs& args )
+{
+	if( tr.primaryWorld == NULL || tr.primaryView == NULL )
+	{
+		common->Printf( "No primary view.\n" );
+		return;
+	}
+	
+	const int numTests = ( args.Argc() > 1 ) ? Max( atoi( args.Argv( 1 ) ), 1 ) : 100;
+	const idRenderMatrix mvp = tr.primaryView->worldSpace.mvp;
+	
+	idList<idBounds> bounds;
+	for( int i = 0; i < tr.primaryWorld->entityDefs.Num(); i++ )
+	{
+		const idRenderEntityLocal* def = tr.primaryWorld->entityDefs[i];
+		if( def == NULL )
+		{
+			continue;
+		}
+		bounds.Append( def->globalReferenceBounds );
+		
+		const idRenderModel* model = def->parms.hModel;
+		if( model == NULL || model->IsDynamicModel() != DM_STATIC )
+		{
+			continue;
+		}
+		for( int j = 0; j < model->NumSurfaces(); j++ )
+		{
+			const srfTriangles_t* tri = model->Surface( j )->geometry;
+			if( tri != NULL )
+			{
+				idBounds b;
+				b.FromTransformedBounds( tri->bounds, def->parms.origin, def->parms.axis );
+				bounds.Append( b );
+			}
+		}
+	}
+	for( int i = 0; i < tr.primaryWorld->lightDefs.Num(); i++ )
+	{
+		const idRenderLightLocal* def = tr.primaryWorld->lightDefs[i];
+		if( def != NULL )
+		{
+			bounds.Append( def->globalLightBounds );
+		}
+	}
+	
+	const int numBounds = bounds.Num();
+	if( numBounds == 0 )
+	{
+		common->Printf( "No bounds to cull.\n" );
+		return;
+	}
+	
+	const int numBlocks = ( numBounds + CULL_BOUNDS_BLOCK_SIZE - 1 ) / CULL_BOUNDS_BLOCK_SIZE;
+	cullBoundsBlock_t* blocks = ( cullBoundsBlock_t* )Mem_ClearedAlloc( numBlocks * sizeof( cullBoundsBlock_t ), TAG_RENDER );
+	byte* singleBits = ( byte* )Mem_Alloc( numBounds, TAG_RENDER );
+	byte* batchBits = ( byte* )Mem_Alloc( numBounds, TAG_RENDER );
+	for( int i = 0; i < numBounds; i++ )
+	{
+		idRenderMatrix::SetCullBounds( blocks, i, bounds[i] );
+	}
+	
+	int singleVisible = 0;
+	int64 start = Sys_Microseconds();
+	for( int t = 0; t < numTests; t++ )
+	{
+		singleVisible = 0;
+		for( int i = 0; i < numBounds; i++ )
+		{
+			singleVisible += !idRenderMatrix::CullBoundsToMVPbits( mvp, bounds[i], &singleBits[i] );
+		}
+	}
+	const int64 singleTime = Sys_Microseconds() - start;
+	
+	int batchVisible = 0;
+	start = Sys_Microseconds();
+	for( int t = 0; t < numTests; t++ )
+	{
+		batchVisible = idRenderMatrix::CullBoundsToMVPbitsBatch( mvp, blocks, numBounds, batchBits );
+	}
+	const int64 batchTime = Sys_Microseconds() - start;
+	
+	int numMismatches = 0;
+	for( int i = 0; i < numBounds; i++ )
+	{
+		numMismatches += ( ( singleBits[i] == 0 ) != ( batchBits[i] == 0 ) );
+	}
+	
+	common->Printf( "%d bounds, %d tests\n", numBounds, numTests );
+	common->Printf( "single: %5d visible, %7.3f usec per pass\n", singleVisible, ( float )singleTime / numTests );
+	common->Printf( "batch:  %5d visible, %7.3f usec per pass, %.2fx\n", batchVisible, ( float )batchTime / numTests, ( float )singleTime / Max( batchTime, ( int64 )1 ) );
+	common->Printf( "%d mismatches\n", numMismatches );
+	
+	Mem_Free( blocks );
+	Mem_Free( singleBits );
+	Mem_Free( batchBits );
+}
+
 /*
 ==============
 R_ListModes_f
@@ -2051,6 +2159,7 @@ void R_InitCommands()
 	cmdSystem->AddCommand( "listRenderLightDefs", R_ListRenderLightDefs_f, CMD_FL_RENDERER, "lists the light defs" );
 	cmdSystem->AddCommand( "listModes", R_ListModes_f, CMD_FL_RENDERER, "lists all video modes" );
 	cmdSystem->AddCommand( "reloadSurface", R_ReloadSurface_f, CMD_FL_RENDERER, "reloads the decl and images for selected surface" );
+	cmdSystem->AddCommand( "testCullBounds", R_TestCullBounds_f, CMD_FL_RENDERER, "compares single and batched culling of the world bounds to the last view" );
 }
 
 /*
@@ -2103,6 +2212,7 @@ void idRenderSystemLocal::Clear()
 	}
 	
 	frontEndJobList = NULL;
+	frontEndModelJobList = NULL;
 }
 
 /*
@@ -2369,6 +2479,7 @@ void idRenderSystemLocal::Init()
 	}
 	
 	frontEndJobList = parallelJobManager->AllocJobList( JOBLIST_RENDERER_FRONTEND, JOBLIST_PRIORITY_MEDIUM, 2048, 0, NULL );
+	frontEndModelJobList = parallelJobManager->AllocJobList( JOBLIST_RENDERER_FRONTEND, JOBLIST_PRIORITY_MEDIUM, 4096, 0, NULL );
 	
 	// make sure the command buffers are ready to accept the first screen update
 	SwapCommandBuffers( NULL, NULL, NULL, NULL );
@@ -2416,6 +2527,7 @@ void idRenderSystemLocal::Shutdown()
 	delete guiModel;
 	
 	parallelJobManager->FreeJobList( frontEndJobList );
+	parallelJobManager->FreeJobList( frontEndModelJobList );
 	
 	Clear();
 	
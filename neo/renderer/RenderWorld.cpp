@@ -136,7 +136,9 @@ void R_ListRenderEntityDefs_f( const idCmdArgs& args )
 idRenderWorldLocal::idRenderWorldLocal
 ===================
 */
-idRenderWorldLocal::idRenderWorldLocal()
+idRenderWorldLocal::idRenderWorldLocal() :
+	areaReferenceAllocator( "areaReferences" ),
+	interactionAllocator( "interactions" )
 {
 	mapName.Clear();
 	mapTimeStamp = FILE_NOT_FOUND_TIMESTAMP;
@@ -629,7 +631,14 @@ void idRenderWorldLocal::ProjectDecalOntoWorld( const idFixedWinding& winding, c
 	int areas[10];
 	int numAreas = BoundsInAreas( globalParms.projectionBounds, areas, 10 );
 	
-	// check all areas for models
+	// gather the static models in these areas so all the model bounds
+	// can be transformed and tested against the projection bounds at once
+	idList<idRenderEntityLocal*, TAG_RENDER> defs;
+	idList<idVec3, TAG_RENDER> origins;
+	idList<idMat3, TAG_RENDER> axes;
+	idBoundsBatch bounds;
+	bounds.SetMemTag( TAG_RENDER );
+	
 	for( int i = 0; i < numAreas; i++ )
 	{
 	
@@ -657,26 +666,37 @@ void idRenderWorldLocal::ProjectDecalOntoWorld( const idFixedWinding& winding, c
 				continue;
 			}
 			
-			idBounds bounds;
-			bounds.FromTransformedBounds( model->Bounds( &def->parms ), def->parms.origin, def->parms.axis );
-			
-			// if the model bounds do not overlap with the projection bounds
-			decalProjectionParms_t localParms;
-			if( !globalParms.projectionBounds.IntersectsBounds( bounds ) )
-			{
-				continue;
-			}
-			
-			// transform the bounding planes, fade planes and texture axis into local space
-			idRenderModelDecal::GlobalProjectionParmsToLocal( localParms, globalParms, def->parms.origin, def->parms.axis );
-			localParms.force = ( def->parms.customShader != NULL );
-			
-			if( def->decals == NULL )
-			{
-				def->decals = AllocDecal( def->index, startTime );
-			}
-			def->decals->AddDeferredDecal( localParms );
+			defs.Append( def );
+			origins.Append( def->parms.origin );
+			axes.Append( def->parms.axis );
+			bounds.Append( model->Bounds( &def->parms ) );
+		}
+	}
+	
+	if( defs.Num() == 0 )
+	{
+		return;
+	}
+	
+	// find the models with bounds that overlap with the projection bounds
+	bounds.FromTransformedBounds( bounds, origins.Ptr(), axes.Ptr() );
+	int* indexes = ( int* ) _alloca16( defs.Num() * sizeof( int ) );
+	const int numIndexes = bounds.IntersectsBounds( globalParms.projectionBounds, indexes );
+	
+	for( int i = 0; i < numIndexes; i++ )
+	{
+		idRenderEntityLocal* def = defs[indexes[i]];
+		
+		// transform the bounding planes, fade planes and texture axis into local space
+		decalProjectionParms_t localParms;
+		idRenderModelDecal::GlobalProjectionParmsToLocal( localParms, globalParms, def->parms.origin, def->parms.axis );
+		localParms.force = ( def->parms.customShader != NULL );
+		
+		if( def->decals == NULL )
+		{
+			def->decals = AllocDecal( def->index, startTime );
 		}
+		def->decals->AddDeferredDecal( localParms );
 	}
 }
 
@@ -81,6 +81,7 @@ void idRenderWorldLocal::FreeWorld()
 		R_StaticFree( doublePortals );
 		doublePortals = NULL;
 		numInterAreaPortals = 0;
+		portalBounds.Free();
 	}
 	
 	if( areaNodes )
@@ -468,6 +469,8 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer* src, idFile* fileOut )
 	
 	doublePortals = ( doublePortal_t* )R_ClearedStaticAlloc( numInterAreaPortals *
 					sizeof( doublePortals [0] ) );
+	portalBounds.SetMemTag( TAG_RENDER );
+	portalBounds.Clear();
 					
 	for( int i = 0; i < numInterAreaPortals; i++ )
 	{
@@ -526,6 +529,10 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer* src, idFile* fileOut )
 		portalAreas[a2].portals = p;
 		
 		doublePortals[i].portals[1] = p;
+		
+		idBounds bounds;
+		w->GetBounds( bounds );
+		portalBounds.Append( bounds );
 	}
 	
 	src->ExpectTokenString( "}" );
@@ -549,6 +556,8 @@ void idRenderWorldLocal::ReadBinaryAreaPortals( idFile* file )
 	SetupAreaRefs();
 	
 	doublePortals = ( doublePortal_t* )R_ClearedStaticAlloc( numInterAreaPortals * sizeof( doublePortals [0] ) );
+	portalBounds.SetMemTag( TAG_RENDER );
+	portalBounds.Clear();
 	
 	for( int i = 0; i < numInterAreaPortals; i++ )
 	{
@@ -594,6 +603,10 @@ void idRenderWorldLocal::ReadBinaryAreaPortals( idFile* file )
 		portalAreas[a2].portals = p;
 		
 		doublePortals[i].portals[1] = p;
+		
+		idBounds bounds;
+		w->GetBounds( bounds );
+		portalBounds.Append( bounds );
 	}
 }
 
@@ -172,14 +172,15 @@ public:
 	
 	doublePortal_t* 		doublePortals;
 	int						numInterAreaPortals;
+	idBoundsBatch			portalBounds;			// winding bounds of each double portal, used by FindPortal
 	
 	idList<idRenderModel*, TAG_MODEL>	localModels;
 	
 	idList<idRenderEntityLocal*, TAG_ENTITY>	entityDefs;
 	idList<idRenderLightLocal*, TAG_LIGHT>		lightDefs;
 	
-	idBlockAlloc<areaReference_t, 1024> areaReferenceAllocator;
-	idBlockAlloc<idInteraction, 256>	interactionAllocator;
+	idSharedBlockAlloc<areaReference_t, 1024>	areaReferenceAllocator;
+	idSharedBlockAlloc<idInteraction, 256>		interactionAllocator;
 	
 #ifdef ID_PC
 	static const int MAX_DECAL_SURFACES = 32;
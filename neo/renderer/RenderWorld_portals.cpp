@@ -135,12 +135,9 @@ bool idRenderWorldLocal::CullEntityByPortals( const idRenderEntityLocal* entity,
 	
 		ALIGNTYPE16 frustumCorners_t corners;
 		idRenderMatrix::GetFrustumCorners( corners, entity->inverseBaseModelProject, bounds_unitCube );
-		for( int i = 0; i < ps->numPortalPlanes; i++ )
+		if( idRenderMatrix::CullFrustumCornersToPlanes( corners, ps->portalPlanes, ps->numPortalPlanes ) )
 		{
-			if( idRenderMatrix::CullFrustumCornersToPlane( corners, ps->portalPlanes[i] ) == FRUSTUM_CULL_FRONT )
-			{
-				return true;
-			}
+			return true;
 		}
 		
 	}
@@ -280,12 +277,9 @@ bool idRenderWorldLocal::CullLightByPortals( const idRenderLightLocal* light, co
 	
 		ALIGNTYPE16 frustumCorners_t corners;
 		idRenderMatrix::GetFrustumCorners( corners, light->inverseBaseLightProject, bounds_zeroOneCube );
-		for( int i = 0; i < ps->numPortalPlanes; i++ )
+		if( idRenderMatrix::CullFrustumCornersToPlanes( corners, ps->portalPlanes, ps->numPortalPlanes ) )
 		{
-			if( idRenderMatrix::CullFrustumCornersToPlane( corners, ps->portalPlanes[i] ) == FRUSTUM_CULL_FRONT )
-			{
-				return true;
-			}
+			return true;
 		}
 		
 	}
@@ -1013,28 +1007,10 @@ Returns 0 if no portal contacts the bounds
 */
 qhandle_t idRenderWorldLocal::FindPortal( const idBounds& b ) const
 {
-	int				i, j;
-	idBounds		wb;
-	doublePortal_t*	portal;
-	idWinding*		w;
-	
-	for( i = 0; i < numInterAreaPortals; i++ )
-	{
-		portal = &doublePortals[i];
-		w = portal->portals[0]->w;
-		
-		wb.Clear();
-		for( j = 0; j < w->GetNumPoints(); j++ )
-		{
-			wb.AddPoint( ( *w )[j].ToVec3() );
-		}
-		if( wb.IntersectsBounds( b ) )
-		{
-			return i + 1;
-		}
-	}
+	assert( portalBounds.Num() == numInterAreaPortals );
 	
-	return 0;
+	// the winding bounds are calculated once at load time
+	return portalBounds.FirstIntersectsBounds( b ) + 1;
 }
 
 /*
@@ -157,6 +157,11 @@ public:
 		return ( handle & VERTCACHE_STATIC ) != 0;
 	}
 	
+	static int		CacheSize( const vertCacheHandle_t handle )
+	{
+		return ( int )( handle >> VERTCACHE_SIZE_SHIFT ) & VERTCACHE_SIZE_MASK;
+	}
+	
 	// vb/ib is a temporary reference -- don't store it
 	bool			GetVertexBuffer( vertCacheHandle_t handle, idVertexBuffer* vb );
 	bool			GetIndexBuffer( vertCacheHandle_t handle, idIndexBuffer* ib );
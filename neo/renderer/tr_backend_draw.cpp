@@ -265,6 +265,79 @@ void RB_DrawElementsWithCounters( const drawSurf_t* surf )
 	// RB end
 }
 
+/*
+================
+RB_DrawElementsCompact
+
+Draws a static surface from its idDrawVertCompact stream. Only the position is
+bound, so this can only be used with the depth programs and the MVP has to
+include the transform from the 16 bit positions to the surface bounds.
+================
+*/
+static void RB_DrawElementsCompact( const drawSurf_t* surf, const vertCacheHandle_t vbHandle )
+{
+	assert( vertexCache.CacheIsStatic( vbHandle ) );
+	assert( !renderProgManager.ShaderUsesJoints() );
+	
+	idVertexBuffer* vertexBuffer = &vertexCache.staticData.vertexBuffer;
+	const int vertOffset = ( int )( vbHandle >> VERTCACHE_OFFSET_SHIFT ) & VERTCACHE_OFFSET_MASK;
+	
+	const vertCacheHandle_t ibHandle = surf->indexCache;
+	idIndexBuffer* indexBuffer;
+	if( vertexCache.CacheIsStatic( ibHandle ) )
+	{
+		indexBuffer = &vertexCache.staticData.indexBuffer;
+	}
+	else
+	{
+		const uint64 frameNum = ( int )( ibHandle >> VERTCACHE_FRAME_SHIFT ) & VERTCACHE_FRAME_MASK;
+		if( frameNum != ( ( vertexCache.currentFrame - 1 ) & VERTCACHE_FRAME_MASK ) )
+		{
+			idLib::Warning( "RB_DrawElementsCompact, indexBuffer == NULL" );
+			return;
+		}
+		indexBuffer = &vertexCache.frameData[vertexCache.drawListNum].indexBuffer;
+	}
+	const GLintptrARB indexOffset = ( GLintptrARB )( ibHandle >> VERTCACHE_OFFSET_SHIFT ) & VERTCACHE_OFFSET_MASK;
+	
+	RENDERLOG_PRINTF( "Binding Compact Buffers: %p:%i %p:%i\n", vertexBuffer, vertOffset, indexBuffer, indexOffset );
+	
+	renderProgManager.CommitUniforms();
+	
+	if( backEnd.glState.currentIndexBuffer != ( GLintptrARB )indexBuffer->GetAPIObject() || !r_useStateCaching.GetBool() )
+	{
+		glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, ( GLintptrARB )indexBuffer->GetAPIObject() );
+		backEnd.glState.currentIndexBuffer = ( GLintptrARB )indexBuffer->GetAPIObject();
+	}
+	
+	if( ( backEnd.glState.vertexLayout != LAYOUT_DRAW_VERT_COMPACT ) || ( backEnd.glState.currentVertexBuffer != ( GLintptrARB )vertexBuffer->GetAPIObject() ) || !r_useStateCaching.GetBool() )
+	{
+		glBindBufferARB( GL_ARRAY_BUFFER_ARB, ( GLintptrARB )vertexBuffer->GetAPIObject() );
+		backEnd.glState.currentVertexBuffer = ( GLintptrARB )vertexBuffer->GetAPIObject();
+		
+		glEnableVertexAttribArrayARB( PC_ATTRIB_INDEX_VERTEX );
+		glDisableVertexAttribArrayARB( PC_ATTRIB_INDEX_NORMAL );
+		glDisableVertexAttribArrayARB( PC_ATTRIB_INDEX_COLOR );
+		glDisableVertexAttribArrayARB( PC_ATTRIB_INDEX_COLOR2 );
+		glDisableVertexAttribArrayARB( PC_ATTRIB_INDEX_ST );
+		glDisableVertexAttribArrayARB( PC_ATTRIB_INDEX_TANGENT );
+		
+		// normalized to [0, 1] inside the surface bounds, w defaults to 1
+		glVertexAttribPointerARB( PC_ATTRIB_INDEX_VERTEX, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof( idDrawVertCompact ), ( void* )( DRAWVERT_COMPACT_XYZ_OFFSET ) );
+		
+		backEnd.glState.vertexLayout = LAYOUT_DRAW_VERT_COMPACT;
+	}
+	
+	glDrawElementsBaseVertex( GL_TRIANGLES,
+							  r_singleTriangle.GetBool() ? 3 : surf->numIndexes,
+							  GL_INDEX_TYPE,
+							  ( triIndex_t* )indexOffset,
+							  vertOffset / sizeof( idDrawVertCompact ) );
+							  
+	backEnd.pc.c_drawElements++;
+	backEnd.pc.c_drawIndexes += surf->numIndexes;
+}
+
 /*
 ======================
 RB_GetShaderTextureMatrix
@@ -2588,6 +2661,9 @@ static void RB_ShadowMapPass( const drawSurf_t* drawSurfs, const viewLight_t* vL
 	// process the chain of shadows with the current rendering state
 	backEnd.currentSpace = NULL;
 	
+	// the MVP of the current space, the compact vertices need it with the bounds transform appended
+	idRenderMatrix spaceMVP;
+	
 	for( const drawSurf_t* drawSurf = drawSurfs; drawSurf != NULL; drawSurf = drawSurf->nextOnLight )
 	{
 	
@@ -2629,21 +2705,20 @@ static void RB_ShadowMapPass( const drawSurf_t* drawSurfs, const viewLight_t* vL
 				idRenderMatrix MVP;
 				idRenderMatrix::Multiply( renderMatrix_clipSpaceToWindowSpace, clipMVP, MVP );
 				
-				RB_SetMVP( clipMVP );
+				spaceMVP = clipMVP;
 			}
 			else if( side < 0 )
 			{
 				// from OpenGL view space to OpenGL NDC ( -1 : 1 in XYZ )
-				idRenderMatrix MVP;
-				idRenderMatrix::Multiply( renderMatrix_windowSpaceToClipSpace, clipMVP, MVP );
-				
-				RB_SetMVP( MVP );
+				idRenderMatrix::Multiply( renderMatrix_windowSpaceToClipSpace, clipMVP, spaceMVP );
 			}
 			else
 			{
-				RB_SetMVP( clipMVP );
+				spaceMVP = clipMVP;
 			}
 			
+			RB_SetMVP( spaceMVP );
+			
 			// set the local light position to allow the vertex program to project the shadow volume end cap to infinity
 			/*
 			idVec4 localLight( 0.0f );
@@ -2769,7 +2844,26 @@ static void RB_ShadowMapPass( const drawSurf_t* drawSurfs, const viewLight_t* vL
 				renderProgManager.BindShader_Depth();
 			}
 			
-			RB_DrawElementsWithCounters( drawSurf );
+			// static surfaces may have a compact vertex stream that only holds
+			// the 16 bit positions the depth program needs
+			const srfTriangles_t* tri = drawSurf->frontEndGeo;
+			if( r_useCompactVerts.GetBool() && drawSurf->jointCache == 0 && tri != NULL && tri->compactCache != 0 &&
+					vertexCache.CacheIsStatic( drawSurf->ambientCache ) && tri->ambientCache == drawSurf->ambientCache )
+			{
+				idRenderMatrix boundsMatrix;
+				idRenderMatrix::CreateFromOriginAxisScale( tri->bounds[0], mat3_identity, tri->bounds[1] - tri->bounds[0], boundsMatrix );
+				
+				idRenderMatrix compactMVP;
+				idRenderMatrix::Multiply( spaceMVP, boundsMatrix, compactMVP );
+				
+				RB_SetMVP( compactMVP );
+				RB_DrawElementsCompact( drawSurf, tri->compactCache );
+				RB_SetMVP( spaceMVP );
+			}
+			else
+			{
+				RB_DrawElementsWithCounters( drawSurf );
+			}
 		}
 	}
 	
@@ -83,6 +83,53 @@ bool idRenderEntityLocal::IsDirectlyVisible() const
 	return true;
 }
 
+/*
+===================
+R_AddShadowOnlyEntities
+
+The shadow bounds of the entities that may cast shadows into the view are culled
+to the view in batches, and a shadowOnlyEntity_t is added for each one that is not culled.
+===================
+*/
+static const int SHADOW_CULL_BATCH = 64;
+
+static void R_AddShadowOnlyEntities( viewLight_t* vLight, idRenderEntityLocal** edefs, const cullBoundsBlock_t* shadowBounds, int numEntities )
+{
+	byte cullBits[SHADOW_CULL_BATCH];
+	
+	// this doesn't say that the shadow can't effect anything, only that it can't
+	// effect anything in the view, so we shouldn't set up a view entity
+	if( idRenderMatrix::CullBoundsToMVPbitsBatch( tr.viewDef->worldSpace.mvp, shadowBounds, numEntities, cullBits ) == 0 )
+	{
+		return;
+	}
+	
+	for( int i = 0; i < numEntities; i++ )
+	{
+		if( cullBits[i] != 0 )
+		{
+			continue;
+		}
+		
+		idRenderEntityLocal* edef = edefs[i];
+		
+		// debug tool to allow viewing of only one entity at a time
+		if( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != edef->index )
+		{
+			continue;
+		}
+		
+		// we do need it for shadows
+		vLight->entityInteractionState[ edef->index ] = viewLight_t::INTERACTION_YES;
+		
+		// we will need to create a viewEntity_t for it in the serial code section
+		shadowOnlyEntity_t* shadEnt = ( shadowOnlyEntity_t* )R_FrameAlloc( sizeof( shadowOnlyEntity_t ), FRAME_ALLOC_SHADOW_ONLY_ENTITY );
+		shadEnt->next = vLight->shadowOnlyViewEntities;
+		shadEnt->edef = edef;
+		vLight->shadowOnlyViewEntities = shadEnt;
+	}
+}
+
 /*
 ===================
 R_AddSingleLight
@@ -356,6 +403,11 @@ static void R_AddSingleLight( viewLight_t* vLight )
 	
 	idInteraction** const interactionTableRow = light->world->interactionTable + light->index * light->world->interactionTableWidth;
 	
+	// entities that may cast shadows into the view are collected and culled in batches
+	idRenderEntityLocal* shadowEntities[SHADOW_CULL_BATCH];
+	ALIGNTYPE16 cullBoundsBlock_t shadowEntityBounds[SHADOW_CULL_BATCH / CULL_BOUNDS_BLOCK_SIZE];
+	int numShadowEntities = 0;
+	
 	for( areaReference_t* lref = light->references; lref != NULL; lref = lref->ownerNext )
 	{
 		portalArea_t* area = lref->area;
@@ -478,31 +530,21 @@ static void R_AddSingleLight( viewLight_t* vLight )
 			// this test is pointless if we knew the light was completely contained
 			// in the view frustum, but the entity would also be directly visible in most
 			// of those cases.
-			
-			// this doesn't say that the shadow can't effect anything, only that it can't
-			// effect anything in the view, so we shouldn't set up a view entity
-			if( idRenderMatrix::CullBoundsToMVP( viewDef->worldSpace.mvp, shadowBounds ) )
-			{
-				continue;
-			}
-			
-			// debug tool to allow viewing of only one entity at a time
-			if( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != edef->index )
+			idRenderMatrix::SetCullBounds( shadowEntityBounds, numShadowEntities, shadowBounds );
+			shadowEntities[numShadowEntities] = edef;
+			if( ++numShadowEntities == SHADOW_CULL_BATCH )
 			{
-				continue;
+				R_AddShadowOnlyEntities( vLight, shadowEntities, shadowEntityBounds, numShadowEntities );
+				numShadowEntities = 0;
 			}
-			
-			// we do need it for shadows
-			vLight->entityInteractionState[ edef->index ] = viewLight_t::INTERACTION_YES;
-			
-			// we will need to create a viewEntity_t for it in the serial code section
-			shadowOnlyEntity_t* shadEnt = ( shadowOnlyEntity_t* )R_FrameAlloc( sizeof( shadowOnlyEntity_t ), FRAME_ALLOC_SHADOW_ONLY_ENTITY );
-			shadEnt->next = vLight->shadowOnlyViewEntities;
-			shadEnt->edef = edef;
-			vLight->shadowOnlyViewEntities = shadEnt;
 		}
 	}
 	
+	if( numShadowEntities > 0 )
+	{
+		R_AddShadowOnlyEntities( vLight, shadowEntities, shadowEntityBounds, numShadowEntities );
+	}
+	
 	//--------------------------------------------
 	// add the prelight shadows for the static world geometry
 	//--------------------------------------------
@@ -580,6 +622,28 @@ static void R_AddSingleLight( viewLight_t* vLight )
 
 REGISTER_PARALLEL_JOB( R_AddSingleLight, "R_AddSingleLight" );
 
+/*
+=================
+R_AddSingleLightShadowVolume
+
+Sets up the pre-light shadow volume of a light once R_AddSingleLight has created its parms.
+A light only has the shadow volume of the first surface of its prelight model, so this is
+the job of a single shadowParms.
+=================
+*/
+static void R_AddSingleLightShadowVolume( viewLight_t* vLight )
+{
+	preLightShadowVolumeParms_t* shadowParms = vLight->preLightShadowVolumes;
+	if( shadowParms != NULL && !vLight->removeFromList )
+	{
+		assert( shadowParms->next == NULL );
+		PreLightShadowVolumeJob( shadowParms );
+	}
+	vLight->preLightShadowVolumes = NULL;
+}
+
+REGISTER_PARALLEL_JOB( R_AddSingleLightShadowVolume, "R_AddSingleLightShadowVolume" );
+
 /*
 =================
 R_AddLights
@@ -595,12 +659,34 @@ void R_AddLights()
 	
 	if( r_useParallelAddLights.GetBool() )
 	{
+		jobHandle_t firstLightJob = INVALID_JOB_HANDLE;
+		int numLightJobs = 0;
 		for( viewLight_t* vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next )
 		{
-			tr.frontEndJobList->AddJob( ( jobRun_t )R_AddSingleLight, vLight );
+			jobHandle_t lightJob = tr.frontEndJobList->AddJob( ( jobRun_t )R_AddSingleLight, vLight );
+			if( numLightJobs++ == 0 )
+			{
+				firstLightJob = lightJob;
+			}
+		}
+		
+		if( r_useParallelAddShadows.GetInteger() == 1 )
+		{
+			// the pre-light shadow volume of a light can be setup as soon as that light is done
+			jobHandle_t lightJob = firstLightJob;
+			for( viewLight_t* vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next, lightJob++ )
+			{
+				tr.frontEndJobList->AddJob( ( jobRun_t )R_AddSingleLightShadowVolume, vLight, &lightJob, 1 );
+			}
+			tr.frontEndJobList->Submit();
+			// the shadow volume jobs keep running until the end of R_AddModels
+			tr.frontEndJobList->WaitForJobs( firstLightJob, numLightJobs );
+		}
+		else
+		{
+			tr.frontEndJobList->Submit();
+			tr.frontEndJobList->Wait();
 		}
-		tr.frontEndJobList->Submit();
-		tr.frontEndJobList->Wait();
 	}
 	else
 	{
@@ -650,13 +736,18 @@ void R_AddLights()
 	
 	if( r_useParallelAddShadows.GetInteger() == 1 )
 	{
-		for( viewLight_t* vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next )
+		// with parallel lights the jobs were already added behind the light jobs
+		if( !r_useParallelAddLights.GetBool() )
 		{
-			for( preLightShadowVolumeParms_t* shadowParms = vLight->preLightShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
+			for( viewLight_t* vLight = tr.viewDef->viewLights; vLight != NULL; vLight = vLight->next )
 			{
-				tr.frontEndJobList->AddJob( ( jobRun_t )PreLightShadowVolumeJob, shadowParms );
+				for( preLightShadowVolumeParms_t* shadowParms = vLight->preLightShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
+				{
+					tr.frontEndJobList->AddJob( ( jobRun_t )PreLightShadowVolumeJob, shadowParms );
+				}
+				vLight->preLightShadowVolumes = NULL;
 			}
-			vLight->preLightShadowVolumes = NULL;
+			tr.frontEndJobList->Submit();
 		}
 	}
 	else
@@ -575,13 +575,41 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 	idVec3 localViewOrigin;
 	R_GlobalPointToLocal( vEntity->modelMatrix, viewDef->renderView.vieworg, localViewOrigin );
 	
+	// the precise surface bounds are culled to the view in batches
+	static const int SURFACE_CULL_BATCH = 64;
+	ALIGNTYPE16 cullBoundsBlock_t surfaceCullBounds[SURFACE_CULL_BATCH / CULL_BOUNDS_BLOCK_SIZE];
+	byte surfaceCullBits[SURFACE_CULL_BATCH];
+	
 	//---------------------------
 	// add all the model surfaces
 	//---------------------------
 	for( int surfaceNum = 0; surfaceNum < model->NumSurfaces(); surfaceNum++ )
 	{
+		// If the entire model wasn't visible, there is no need to check the
+		// individual surfaces.
+		if( modelIsVisible && ( surfaceNum % SURFACE_CULL_BATCH ) == 0 )
+		{
+			const int numBatchSurfaces = Min( model->NumSurfaces() - surfaceNum, SURFACE_CULL_BATCH );
+			for( int i = 0; i < numBatchSurfaces; i++ )
+			{
+				const srfTriangles_t* batchTri = model->Surface( surfaceNum + i )->geometry;
+				idRenderMatrix::SetCullBounds( surfaceCullBounds, i, ( batchTri != NULL ) ? batchTri->bounds : bounds_zero );
+			}
+			idRenderMatrix::CullBoundsToMVPbitsBatch( vEntity->mvp, surfaceCullBounds, numBatchSurfaces, surfaceCullBits );
+		}
+		
 		const modelSurface_t* surf = model->Surface( surfaceNum );
 		
+		// the shadow volumes of the surface go to its own job if there is one
+		staticShadowVolumeParms_t** staticShadowVolumes = &vEntity->staticShadowVolumes;
+		dynamicShadowVolumeParms_t** dynamicShadowVolumes = &vEntity->dynamicShadowVolumes;
+		if( vEntity->numSurfaceShadowVolumes > 0 )
+		{
+			surfaceShadowVolumes_t& surfaceShadowVolumes = vEntity->surfaceShadowVolumes[surfaceNum % vEntity->numSurfaceShadowVolumes];
+			staticShadowVolumes = &surfaceShadowVolumes.staticShadowVolumes;
+			dynamicShadowVolumes = &surfaceShadowVolumes.dynamicShadowVolumes;
+		}
+		
 		// for debugging, only show a single surface at a time
 		if( r_singleSurface.GetInteger() >= 0 && surfaceNum != r_singleSurface.GetInteger() )
 		{
@@ -669,9 +697,7 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 		
 		// view frustum culling for the precise surface bounds, which is tighter
 		// than the entire entity reference bounds
-		// If the entire model wasn't visible, there is no need to check the
-		// individual surfaces.
-		const bool surfaceDirectlyVisible = modelIsVisible && !idRenderMatrix::CullBoundsToMVP( vEntity->mvp, tri->bounds );
+		const bool surfaceDirectlyVisible = modelIsVisible && surfaceCullBits[surfaceNum % SURFACE_CULL_BATCH] == 0;
 		
 		// RB: added check wether GPU skinning is available at all
 		const bool gpuSkinned = ( tri->staticModelWithJoints != NULL && r_useGPUSkinning.GetBool() && glConfig.gpuSkinningAvailable );
@@ -873,8 +899,8 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 								
 								lightDrawSurf->shadowVolumeState = SHADOWVOLUME_UNFINISHED;
 								
-								dynamicShadowParms->next = vEntity->dynamicShadowVolumes;
-								vEntity->dynamicShadowVolumes = dynamicShadowParms;
+								dynamicShadowParms->next = *dynamicShadowVolumes;
+								*dynamicShadowVolumes = dynamicShadowParms;
 							}
 						}
 					}
@@ -1078,8 +1104,8 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 					
 					shadowDrawSurf->shadowVolumeState = SHADOWVOLUME_UNFINISHED;
 					
-					staticShadowParms->next = vEntity->staticShadowVolumes;
-					vEntity->staticShadowVolumes = staticShadowParms;
+					staticShadowParms->next = *staticShadowVolumes;
+					*staticShadowVolumes = staticShadowParms;
 				}
 				
 			}
@@ -1161,8 +1187,8 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 					// if the parms we not already linked for culling interaction triangles to the light frustum
 					if( dynamicShadowParms->lightIndices == NULL )
 					{
-						dynamicShadowParms->next = vEntity->dynamicShadowVolumes;
-						vEntity->dynamicShadowVolumes = dynamicShadowParms;
+						dynamicShadowParms->next = *dynamicShadowVolumes;
+						*dynamicShadowVolumes = dynamicShadowParms;
 					}
 					
 					tr.pc.c_createShadowVolumes++;
@@ -1192,6 +1218,55 @@ void R_AddSingleModel( viewEntity_t* vEntity )
 
 REGISTER_PARALLEL_JOB( R_AddSingleModel, "R_AddSingleModel" );
 
+/*
+===================
+R_AddSurfaceShadowVolumes
+
+Sets up the static and dynamic shadow volumes of the surfaces of an entity that share a job
+once R_AddSingleModel has created their parms, usually those of a single surface.
+===================
+*/
+static void R_AddSurfaceShadowVolumes( surfaceShadowVolumes_t* shadowVolumes )
+{
+	for( staticShadowVolumeParms_t* shadowParms = shadowVolumes->staticShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
+	{
+		StaticShadowVolumeJob( shadowParms );
+	}
+	for( dynamicShadowVolumeParms_t* shadowParms = shadowVolumes->dynamicShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
+	{
+		DynamicShadowVolumeJob( shadowParms );
+	}
+	shadowVolumes->staticShadowVolumes = NULL;
+	shadowVolumes->dynamicShadowVolumes = NULL;
+}
+
+REGISTER_PARALLEL_JOB( R_AddSurfaceShadowVolumes, "R_AddSurfaceShadowVolumes" );
+
+/*
+===================
+R_NumSurfaceShadowVolumeJobs
+
+The shadow volume parms are only known once R_AddSingleModel has run, so the jobs are
+added for the surfaces the model had last frame.
+===================
+*/
+static int R_NumSurfaceShadowVolumeJobs( const viewEntity_t* vEntity )
+{
+	static const int MAX_SURFACE_SHADOW_VOLUME_JOBS = 32;
+	
+	const idRenderEntityLocal* entityDef = vEntity->entityDef;
+	int numSurfaces = 1;
+	if( entityDef->parms.hModel != NULL )
+	{
+		numSurfaces = Max( numSurfaces, entityDef->parms.hModel->NumSurfaces() );
+	}
+	if( entityDef->cachedDynamicModel != NULL )
+	{
+		numSurfaces = Max( numSurfaces, entityDef->cachedDynamicModel->NumSurfaces() );
+	}
+	return Min( numSurfaces, MAX_SURFACE_SHADOW_VOLUME_JOBS );
+}
+
 /*
 =================
 R_LinkDrawSurfToView
@@ -1245,43 +1320,65 @@ void R_AddModels()
 	// any light that intersects the view (for shadows).
 	//-------------------------------------------------
 	
+	const bool parallelShadows = ( r_useParallelAddShadows.GetInteger() == 1 );
+	
 	if( r_useParallelAddModels.GetBool() )
 	{
+		// the shadow volumes of each surface of an entity can be setup as soon as that entity is done
 		for( viewEntity_t* vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next )
 		{
-			tr.frontEndJobList->AddJob( ( jobRun_t )R_AddSingleModel, vEntity );
+			vEntity->surfaceShadowVolumes = NULL;
+			vEntity->numSurfaceShadowVolumes = 0;
+			jobHandle_t modelJob = tr.frontEndModelJobList->AddJob( ( jobRun_t )R_AddSingleModel, vEntity );
+			if( parallelShadows )
+			{
+				vEntity->numSurfaceShadowVolumes = R_NumSurfaceShadowVolumeJobs( vEntity );
+				vEntity->surfaceShadowVolumes = ( surfaceShadowVolumes_t* )R_ClearedFrameAlloc( vEntity->numSurfaceShadowVolumes * sizeof( surfaceShadowVolumes_t ), FRAME_ALLOC_SHADOW_VOLUME_PARMS );
+				for( int i = 0; i < vEntity->numSurfaceShadowVolumes; i++ )
+				{
+					tr.frontEndModelJobList->AddJob( ( jobRun_t )R_AddSurfaceShadowVolumes, &vEntity->surfaceShadowVolumes[i], &modelJob, 1 );
+				}
+			}
 		}
-		tr.frontEndJobList->Submit();
-		tr.frontEndJobList->Wait();
+		tr.frontEndModelJobList->Submit();
+		tr.frontEndModelJobList->Wait();
 	}
 	else
 	{
 		for( viewEntity_t* vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next )
 		{
+			vEntity->surfaceShadowVolumes = NULL;
+			vEntity->numSurfaceShadowVolumes = 0;
 			R_AddSingleModel( vEntity );
 		}
+		
+		if( parallelShadows )
+		{
+			// the parms are known now, so each shadow volume gets its own job
+			for( viewEntity_t* vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next )
+			{
+				for( staticShadowVolumeParms_t* shadowParms = vEntity->staticShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
+				{
+					tr.frontEndModelJobList->AddJob( ( jobRun_t )StaticShadowVolumeJob, shadowParms );
+				}
+				for( dynamicShadowVolumeParms_t* shadowParms = vEntity->dynamicShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
+				{
+					tr.frontEndModelJobList->AddJob( ( jobRun_t )DynamicShadowVolumeJob, shadowParms );
+				}
+				vEntity->staticShadowVolumes = NULL;
+				vEntity->dynamicShadowVolumes = NULL;
+			}
+			tr.frontEndModelJobList->Submit();
+			tr.frontEndModelJobList->Wait();
+		}
 	}
 	
 	//-------------------------------------------------
-	// Kick off jobs to setup static and dynamic shadow volumes.
+	// Setup static and dynamic shadow volumes if that was not done by the jobs.
 	//-------------------------------------------------
 	
-	if( r_useParallelAddShadows.GetInteger() == 1 )
+	if( parallelShadows )
 	{
-		for( viewEntity_t* vEntity = tr.viewDef->viewEntitys; vEntity != NULL; vEntity = vEntity->next )
-		{
-			for( staticShadowVolumeParms_t* shadowParms = vEntity->staticShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
-			{
-				tr.frontEndJobList->AddJob( ( jobRun_t )StaticShadowVolumeJob, shadowParms );
-			}
-			for( dynamicShadowVolumeParms_t* shadowParms = vEntity->dynamicShadowVolumes; shadowParms != NULL; shadowParms = shadowParms->next )
-			{
-				tr.frontEndJobList->AddJob( ( jobRun_t )DynamicShadowVolumeJob, shadowParms );
-			}
-			vEntity->staticShadowVolumes = NULL;
-			vEntity->dynamicShadowVolumes = NULL;
-		}
-		tr.frontEndJobList->Submit();
 		// wait here otherwise the shadow volume index buffer may be unmapped before all shadow volumes have been constructed
 		tr.frontEndJobList->Wait();
 	}
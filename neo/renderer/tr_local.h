@@ -340,6 +340,13 @@ struct viewLight_t
 	preLightShadowVolumeParms_t* 	preLightShadowVolumes;
 };
 
+// the shadow volumes of the model surfaces that are setup by a single job
+struct surfaceShadowVolumes_t
+{
+	staticShadowVolumeParms_t* 		staticShadowVolumes;
+	dynamicShadowVolumeParms_t* 	dynamicShadowVolumes;
+};
+
 // a viewEntity is created whenever a idRenderEntityLocal is considered for inclusion
 // in the current view, but it may still turn out to be culled.
 // viewEntity are allocated on the frame temporary stack memory
@@ -379,6 +386,11 @@ struct viewEntity_t
 	// R_AddSingleModel will build a chain of parameters here to setup shadow volumes
 	staticShadowVolumeParms_t* 		staticShadowVolumes;
 	dynamicShadowVolumeParms_t* 	dynamicShadowVolumes;
+	
+	// with parallel models and shadows R_AddSingleModel builds the chains here instead,
+	// surface i goes to job i % numSurfaceShadowVolumes
+	surfaceShadowVolumes_t* 		surfaceShadowVolumes;
+	int								numSurfaceShadowVolumes;
 };
 
 
@@ -673,7 +685,8 @@ enum vertexLayoutType_t
 	LAYOUT_UNKNOWN = 0,
 	LAYOUT_DRAW_VERT,
 	LAYOUT_DRAW_SHADOW_VERT,
-	LAYOUT_DRAW_SHADOW_VERT_SKINNED
+	LAYOUT_DRAW_SHADOW_VERT_SKINNED,
+	LAYOUT_DRAW_VERT_COMPACT
 };
 
 struct glstate_t
@@ -898,7 +911,8 @@ public:
 	drawSurf_t				zeroOneCubeSurface_;
 	drawSurf_t				testImageSurface_;
 	
-	idParallelJobList* 		frontEndJobList;
+	idParallelJobList* 		frontEndJobList;		// lights and pre-light shadow volumes, may keep running through R_AddModels
+	idParallelJobList* 		frontEndModelJobList;	// models and their shadow volumes
 	
 	unsigned				timerQueryId;		// for GL_TIME_ELAPSED_EXT queries
 };
@@ -958,6 +972,8 @@ extern idCVar r_useLightDepthBounds;		// use depth bounds test on lights to redu
 extern idCVar r_useShadowDepthBounds;		// use depth bounds test on individual shadows to reduce shadow fill
 // RB begin
 extern idCVar r_useShadowMapping;			// use shadow mapping instead of stencil shadows
+extern idCVar r_useCompactVerts;			// upload compact vertices for static surfaces and use them in the shadow map passes
+extern idCVar r_compactVertsMaxError;		// surfaces with a larger position quantization error keep using idDrawVert
 extern idCVar r_useHalfLambertLighting;		// use Half-Lambert lighting instead of classic Lambert
 // RB end
 
@@ -1353,7 +1369,7 @@ void				R_InitDrawSurfFromTri( drawSurf_t& ds, srfTriangles_t& tri );
 
 // For static surfaces, the indexes, ambient, and shadow buffers can be pre-created at load
 // time, rather than being re-created each frame in the frame temporary buffers.
-void				R_CreateStaticBuffersForTri( srfTriangles_t& tri );
+void				R_CreateStaticBuffersForTri( srfTriangles_t& tri, bool castsShadows = true );
 
 // deformable meshes precalculate as much as possible from a base frame, then generate
 // complete srfTriangles_t from just a new set of vertexes
@@ -31,6 +31,8 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "tr_local.h"
 
+#include "../idlib/geometry/DrawVert_intrinsics.h"
+
 /*
 ==============================================================================
 
@@ -190,6 +192,7 @@ void R_FreeStaticTriSurfVertexCaches( srfTriangles_t* tri )
 	tri->ambientCache = 0;
 	tri->indexCache = 0;
 	tri->shadowCache = 0;
+	tri->compactCache = 0;
 }
 
 /*
@@ -275,6 +278,7 @@ void R_FreeStaticTriSurfVerts( srfTriangles_t* tri )
 	// we don't support reclaiming static geometry memory
 	// without a level change
 	tri->ambientCache = 0;
+	tri->compactCache = 0;
 	
 	if( tri->verts != NULL )
 	{
@@ -2163,11 +2167,12 @@ For static surfaces, the indexes, ambient, and shadow buffers can be pre-created
 time, rather than being re-created each frame in the frame temporary buffers.
 ===================
 */
-void R_CreateStaticBuffersForTri( srfTriangles_t& tri )
+void R_CreateStaticBuffersForTri( srfTriangles_t& tri, bool castsShadows )
 {
 	tri.indexCache = 0;
 	tri.ambientCache = 0;
 	tri.shadowCache = 0;
+	tri.compactCache = 0;
 	
 	// index cache
 	if( tri.indexes != NULL )
@@ -2181,6 +2186,26 @@ void R_CreateStaticBuffersForTri( srfTriangles_t& tri )
 		tri.ambientCache = vertexCache.AllocStaticVertex( tri.verts, ALIGN( tri.numVerts * sizeof( tri.verts[0] ), VERTEX_CACHE_ALIGN ) );
 	}
 	
+	// compact cache for the depth only shadow map passes. It comes on top of the
+	// ambient cache, the shading programs need the full idDrawVert, so it is only
+	// worth it for surfaces that are drawn into shadow maps. Skinned surfaces need
+	// the joint weights in the vertex colors and huge surfaces would lose too much
+	// precision in 16 bits, so they are left out.
+	if( r_useCompactVerts.GetBool() && castsShadows && tri.verts != NULL && tri.staticModelWithJoints == NULL &&
+			idDrawVertCompact::GetMaxPositionError( tri.bounds ) <= r_compactVertsMaxError.GetFloat() )
+	{
+		const int compactSize = ALIGN( tri.numVerts * sizeof( idDrawVertCompact ), VERTEX_CACHE_ALIGN );
+		
+		// the compact stream is optional, so don't run out of static memory for it
+		if( vertexCache.staticData.vertexMemUsed.GetValue() + compactSize <= STATIC_VERTEX_MEMORY )
+		{
+			idDrawVertCompact* compactVerts = ( idDrawVertCompact* ) Mem_Alloc16( compactSize, TAG_TEMP );
+			PackDrawVertsCompact( compactVerts, tri.verts, tri.numVerts, tri.bounds );
+			tri.compactCache = vertexCache.AllocStaticVertex( compactVerts, compactSize );
+			Mem_Free( compactVerts );
+		}
+	}
+	
 	// shadow cache
 	if( tri.preLightShadowVertexes != NULL )
 	{
@@ -572,8 +572,9 @@ void idSoundSystemLocal::Preload( idPreloadManifest& manifest )
 	int	start = Sys_Milliseconds();
 	int numLoaded = 0;
 	
-	idList< preloadSort_t > preloadSort;
-	preloadSort.Resize( manifest.NumResources() );
+	// the batch reads the samples sorted by their offset in the resource files
+	idAsyncReadBatch batch;
+	idList< int > manifestIndex;
 	for( int i = 0; i < manifest.NumResources(); i++ )
 	{
 		const preloadEntry_s& p = manifest.GetPreloadByIndex( i );
@@ -590,20 +591,18 @@ void idSoundSystemLocal::Preload( idPreloadManifest& manifest )
 			filename.SetFileExtension( "idwav" );
 			if( fileSystem->GetResourceCacheEntry( filename, rc ) )
 			{
-				preloadSort_t ps = {};
-				ps.idx = i;
-				ps.ofs = rc.offset;
-				preloadSort.Append( ps );
+				batch.Add( filename );
+				manifestIndex.Append( i );
 			}
 		}
 	}
 	
-	preloadSort.SortWithTemplate( idSort_Preload() );
+	batch.Submit();
+	fileSystem->SetReadBatch( &batch );
 	
-	for( int i = 0; i < preloadSort.Num(); i++ )
+	for( int i = 0; i < batch.Num(); i++ )
 	{
-		const preloadSort_t& ps = preloadSort[ i ];
-		const preloadEntry_s& p = manifest.GetPreloadByIndex( ps.idx );
+		const preloadEntry_s& p = manifest.GetPreloadByIndex( manifestIndex[ batch.GetReadOrder( i ) ] );
 		filename = p.resourceName;
 		filename.Replace( "generated/", "" );
 		numLoaded++;
@@ -615,6 +614,8 @@ void idSoundSystemLocal::Preload( idPreloadManifest& manifest )
 		}
 	}
 	
+	fileSystem->SetReadBatch( NULL );
+	
 	int	end = Sys_Milliseconds();
 	common->Printf( "%05d sounds preloaded in %5.1f seconds\n", numLoaded, ( end - start ) * 0.001 );
 	common->Printf( "----------------------------------------\n" );
@@ -635,8 +636,9 @@ void idSoundSystemLocal::EndLevelLoad()
 	int		keepCount = 0;
 	int		loadCount = 0;
 	
-	idList< preloadSort_t > preloadSort;
-	preloadSort.Resize( samples.Num() );
+	// the batch reads the samples sorted by their offset in the resource files
+	idAsyncReadBatch batch;
+	idList< int > sampleIndex;
 	
 	for( int i = 0; i < samples.Num(); i++ )
 	{
@@ -657,29 +659,25 @@ void idSoundSystemLocal::EndLevelLoad()
 			idStrStatic< MAX_OSPATH > filename  = "generated/";
 			filename += samples[ i ]->GetName();
 			filename.SetFileExtension( "idwav" );
-			preloadSort_t ps = {};
-			ps.idx = i;
-			idResourceCacheEntry rc;
-			if( fileSystem->GetResourceCacheEntry( filename, rc ) )
-			{
-				ps.ofs = rc.offset;
-			}
-			else
-			{
-				ps.ofs = 0;
-			}
-			preloadSort.Append( ps );
+			batch.Add( filename );
+			sampleIndex.Append( i );
 			loadCount++;
 		}
 	}
-	preloadSort.SortWithTemplate( idSort_Preload() );
-	for( int i = 0; i < preloadSort.Num(); i++ )
+	
+	batch.Submit();
+	fileSystem->SetReadBatch( &batch );
+	
+	for( int i = 0; i < batch.Num(); i++ )
 	{
 		common->UpdateLevelLoadPacifier();
 		
 		
-		samples[ preloadSort[ i ].idx ]->LoadResource();
+		samples[ sampleIndex[ batch.GetReadOrder( i ) ] ]->LoadResource();
 	}
+	
+	fileSystem->SetReadBatch( NULL );
+	
 	int	end = Sys_Milliseconds();
 	
 	common->Printf( "%5i sounds loaded in %5.1f seconds\n", loadCount, ( end - start ) * 0.001 );
@@ -52,14 +52,20 @@ void Sys_ExecuteSavegameCommandAsyncImpl( idSaveLoadParms* savegameParms )
 {
 	assert( savegameParms != NULL );
 	
-	session->GetSaveGameManager().GetSaveGameThread().data.saveLoadParms = savegameParms;
+	idSaveGameThread& saveThread = session->GetSaveGameManager().GetSaveGameThread();
 	
-	if( session->GetSaveGameManager().GetSaveGameThread().GetThreadHandle() == 0 )
+	if( saveThread.GetThreadHandle() == 0 )
 	{
-		session->GetSaveGameManager().GetSaveGameThread().StartWorkerThread( "Savegame", CORE_ANY );
+		saveThread.StartWorkerThread( "Savegame", CORE_ANY );
 	}
 	
-	session->GetSaveGameManager().GetSaveGameThread().SignalWork();
+	// the manager runs one processor at a time so the queue should never be full
+	while( !saveThread.QueueCommand( savegameParms ) )
+	{
+		saveThread.WaitForThread();
+	}
+	
+	saveThread.SignalWork();
 }
 
 /*
@@ -748,6 +754,26 @@ int idSaveGameThread::Run()
 {
 	int ret = ERROR_SUCCESS;
 	
+	// run all commands queued since the last time the thread was signalled
+	idSaveLoadParms* parms;
+	while( commands.Pop( parms ) )
+	{
+		data.saveLoadParms = parms;
+		ret = RunCommand();
+	}
+	
+	return ret;
+}
+
+/*
+========================
+idSaveGameThread::RunCommand
+========================
+*/
+int idSaveGameThread::RunCommand()
+{
+	int ret = ERROR_SUCCESS;
+	
 	try
 	{
 		idLocalUserWin* user = GetLocalUserFromSaveParms( data );
@@ -75,7 +75,13 @@ Sys_GetProcessorId
 */
 cpuid_t Sys_GetProcessorId()
 {
-	return CPUID_GENERIC;
+	static cpuid_t cpuid = CPUID_NONE;
+	
+	if( cpuid == CPUID_NONE )
+	{
+		cpuid = Sys_GetCPUId();
+	}
+	return cpuid;
 }
 
 /*
@@ -807,6 +807,70 @@ ID_TIME_T Sys_FileTimeStamp( idFileHandle fp )
 	return st.st_mtime;
 }
 
+/*
+================
+Sys_MapFileRead
+================
+*/
+const byte* Sys_MapFileRead( const char* ospath, int& length )
+{
+	length = 0;
+	
+	int fd = open( ospath, O_RDONLY );
+	if( fd == -1 )
+	{
+		return NULL;
+	}
+	
+	struct stat st;
+	if( fstat( fd, &st ) == -1 || st.st_size <= 0 || st.st_size > INT_MAX )
+	{
+		close( fd );
+		return NULL;
+	}
+	
+	void* data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	
+	// the mapping keeps its own reference to the file
+	close( fd );
+	
+	if( data == MAP_FAILED )
+	{
+		return NULL;
+	}
+	
+	length = ( int )st.st_size;
+	return ( const byte* )data;
+}
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile( const byte* data, int length )
+{
+	if( data != NULL )
+	{
+		munmap( ( void* )data, length );
+	}
+}
+
+/*
+================
+Sys_AdviseMappedRange
+================
+*/
+void Sys_AdviseMappedRange( const byte* data, int length, bool willNeed )
+{
+	// madvise wants a page aligned start address
+	const uintptr_t pageSize = sysconf( _SC_PAGESIZE );
+	const uintptr_t start = ( uintptr_t )data & ~( pageSize - 1 );
+	const uintptr_t end = ( uintptr_t )data + length;
+	
+	madvise( ( void* )start, end - start, willNeed ? MADV_WILLNEED : MADV_NORMAL );
+}
+
 void Sys_Sleep( int msec )
 {
 #if 0 // DG: I don't really care, this spams the console (and on windows this case isn't handled either)
@@ -61,6 +61,8 @@ char*		Posix_ConsoleInput();
 
 double 		MeasureClockTicks();
 
+cpuid_t		Sys_GetCPUId();
+
 #ifdef __APPLE__
 enum clk_id_t { CLOCK_REALTIME, CLOCK_MONOTONIC, CLOCK_MONOTONIC_RAW };
 int clock_gettime( clk_id_t clock, struct timespec* tp );
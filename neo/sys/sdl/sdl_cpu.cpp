@@ -39,6 +39,15 @@ If you have questions concerning this license or the applicable additional terms
 
 #include <SDL_cpuinfo.h>
 
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define ID_X86_CPUID
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 
 #pragma warning(disable:4740)	// warning C4740: flow in or out of inline asm code suppresses global optimization
 #pragma warning(disable:4731)	// warning C4731: 'XXX' : frame pointer register 'ebx' modified by inline assembly code
@@ -177,6 +186,99 @@ void Sys_CPUCount( int& numLogicalCPUCores, int& numPhysicalCPUCores, int& numCP
 }
 #endif
 
+#if defined(ID_X86_CPUID)
+/*
+================
+CPUIDEx
+================
+*/
+static void CPUIDEx( unsigned int func, unsigned int subFunc, unsigned int regs[4] )
+{
+#if defined(_MSC_VER)
+	__cpuidex( ( int* )regs, func, subFunc );
+#else
+	__cpuid_count( func, subFunc, regs[0], regs[1], regs[2], regs[3] );
+#endif
+}
+
+/*
+================
+XGetBV
+
+reads an extended control register, only valid when CPUID reports OSXSAVE
+================
+*/
+static unsigned long long XGetBV( unsigned int index )
+{
+#if defined(_MSC_VER)
+	return _xgetbv( index );
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__( ".byte 0x0f, 0x01, 0xd0" : "=a"( eax ), "=d"( edx ) : "c"( index ) );
+	return ( ( unsigned long long )edx << 32 ) | eax;
+#endif
+}
+
+/*
+================
+GetExtendedCPUFlags
+
+SDL only knows about the instruction sets up to SSE2, so query AVX, AVX2 and FMA3 directly.
+AVX is only reported when the OS saves the YMM registers on a context switch.
+================
+*/
+static int GetExtendedCPUFlags()
+{
+	unsigned int regs[4];
+	int flags = 0;
+	
+	CPUIDEx( 0, 0, regs );
+	const unsigned int maxFunc = regs[0];
+	if( maxFunc < 1 )
+	{
+		return 0;
+	}
+	
+	CPUIDEx( 1, 0, regs );
+	
+	// bit 0 of ECX denotes SSE3 existence
+	if( regs[2] & ( 1 << 0 ) )
+	{
+		flags |= CPUID_SSE3;
+	}
+	
+	// bit 27 of ECX is OSXSAVE, bit 28 is AVX
+	const bool osxsave = ( regs[2] & ( 1 << 27 ) ) != 0;
+	const bool avx = ( regs[2] & ( 1 << 28 ) ) != 0;
+	const bool fma = ( regs[2] & ( 1 << 12 ) ) != 0;
+	
+	if( !osxsave || !avx || ( XGetBV( 0 ) & 6 ) != 6 )
+	{
+		return flags;
+	}
+	
+	flags |= CPUID_AVX;
+	
+	if( fma )
+	{
+		flags |= CPUID_FMA3;
+	}
+	
+	if( maxFunc >= 7 )
+	{
+		CPUIDEx( 7, 0, regs );
+		
+		// bit 5 of EBX denotes AVX2 existence
+		if( regs[1] & ( 1 << 5 ) )
+		{
+			flags |= CPUID_AVX2;
+		}
+	}
+	
+	return flags;
+}
+#endif
+
 /*
 ================
 Sys_GetCPUId
@@ -213,12 +315,10 @@ cpuid_t Sys_GetCPUId()
 		flags |= CPUID_SSE2;
 	}
 	
-	// check for Streaming SIMD Extensions 3 aka Prescott's New Instructions
-#if 0 //SDL_VERSION_ATLEAST(2,0,0)
-	if( SDL_HasSSE3() )
-	{
-		flags |= CPUID_SSE3;
-	}
+	// check for Streaming SIMD Extensions 3 aka Prescott's New Instructions,
+	// Advanced Vector Extensions 1 & 2 and Fused Multiply-Add
+#if defined(ID_X86_CPUID)
+	flags |= GetExtendedCPUFlags();
 #endif
 	
 	/*
@@ -58,7 +58,10 @@ enum cpuid_t
 	CPUID_FTZ							= 0x04000,	// Flush-To-Zero mode (denormal results are flushed to zero)
 	CPUID_DAZ							= 0x08000,	// Denormals-Are-Zero mode (denormal source operands are set to zero)
 	CPUID_XENON							= 0x10000,	// Xbox 360
-	CPUID_CELL							= 0x20000	// PS3
+	CPUID_CELL							= 0x20000,	// PS3
+	CPUID_AVX							= 0x40000,	// Advanced Vector Extensions (with OS support for saving the YMM state)
+	CPUID_AVX2							= 0x80000,	// Advanced Vector Extensions 2
+	CPUID_FMA3							= 0x100000	// Fused Multiply-Add
 };
 
 enum fpuExceptions_t
@@ -576,6 +579,12 @@ typedef FILE* idFileHandle;
 
 
 ID_TIME_T		Sys_FileTimeStamp( idFileHandle fp );
+
+// read only memory mapping of a whole file, returns NULL if the platform can't map it
+const byte* 	Sys_MapFileRead( const char* ospath, int& length );
+void			Sys_UnmapFile( const byte* data, int length );
+// readahead hint for a range of a mapped file, the kernel may start paging it in asynchronously
+void			Sys_AdviseMappedRange( const byte* data, int length, bool willNeed );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char* 	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 const char* 	Sys_SecToStr( int sec );
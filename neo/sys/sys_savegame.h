@@ -312,7 +312,14 @@ public:
 		cancel = true;
 	}
 	
+	// main thread only, queues a command for the thread, the caller still has to SignalWork()
+	bool	QueueCommand( idSaveLoadParms* parms )
+	{
+		return commands.Push( parms );
+	}
+	
 private:
+	int		RunCommand();
 	int		Save();
 	int		Load();
 	int		Enumerate();
@@ -324,6 +331,9 @@ private:
 public:
 	saveGameThreadArgs_t	data;
 	volatile bool			cancel;
+	
+private:
+	idLockFreeQueueSPSC< idSaveLoadParms*, 16 >	commands;	// filled by the main thread, emptied by Run()
 };
 
 /*
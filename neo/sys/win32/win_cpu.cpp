@@ -32,6 +32,8 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "win_local.h"
 
+#include <intrin.h>
+
 #pragma warning(disable:4740)	// warning C4740: flow in or out of inline asm code suppresses global optimization
 #pragma warning(disable:4731)	// warning C4731: 'XXX' : frame pointer register 'ebx' modified by inline assembly code
 
@@ -385,6 +387,46 @@ static bool HasSSE3() {
 }
 #endif
 
+/*
+================
+GetAVXFlags
+
+AVX is only reported when the OS saves the YMM registers on a context switch
+================
+*/
+static int GetAVXFlags() {
+	int regs[4];
+	int flags = 0;
+
+	__cpuidex( regs, 0, 0 );
+	const int maxFunc = regs[_REG_EAX];
+
+	__cpuidex( regs, 1, 0 );
+
+	// bit 27 of ECX denotes OSXSAVE, bit 28 AVX and bit 12 FMA3
+	if ( !( regs[_REG_ECX] & ( 1 << 27 ) ) || !( regs[_REG_ECX] & ( 1 << 28 ) ) ) {
+		return 0;
+	}
+	if ( ( _xgetbv( 0 ) & 6 ) != 6 ) {
+		return 0;
+	}
+	flags |= CPUID_AVX;
+
+	if ( regs[_REG_ECX] & ( 1 << 12 ) ) {
+		flags |= CPUID_FMA3;
+	}
+
+	if ( maxFunc >= 7 ) {
+		__cpuidex( regs, 7, 0 );
+
+		// bit 5 of EBX denotes AVX2 existence
+		if ( regs[_REG_EBX] & ( 1 << 5 ) ) {
+			flags |= CPUID_AVX2;
+		}
+	}
+	return flags;
+}
+
 /*
 ================
 LogicalProcPerPhysicalProc
@@ -778,6 +820,9 @@ cpuid_t Sys_GetCPUId()
 	flags |= CPUID_SSE;
 	flags |= CPUID_SSE2;
 
+	// check for Advanced Vector Extensions 1 & 2 and Fused Multiply-Add
+	flags |= GetAVXFlags();
+
 	return (cpuid_t)flags;
 #else
 	int flags;
@@ -819,6 +864,9 @@ cpuid_t Sys_GetCPUId()
 		flags |= CPUID_SSE3;
 	}
 
+	// check for Advanced Vector Extensions 1 & 2 and Fused Multiply-Add
+	flags |= GetAVXFlags();
+
 	// check for Hyper-Threading Technology
 	if ( HasHTT() ) {
 		flags |= CPUID_HTT;
@@ -461,6 +461,61 @@ ID_TIME_T Sys_FileTimeStamp( idFileHandle fp ) {
 	return itime.QuadPart;
 }
 
+/*
+========================
+Sys_MapFileRead
+========================
+*/
+const byte *Sys_MapFileRead( const char *ospath, int &length ) {
+	length = 0;
+
+	HANDLE file = CreateFile( ospath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 || size.QuadPart > INT_MAX ) {
+		CloseHandle( file );
+		return NULL;
+	}
+
+	HANDLE mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	const byte *data = NULL;
+	if ( mapping != NULL ) {
+		data = (const byte *)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+		// the view keeps the mapping and the file alive
+		CloseHandle( mapping );
+	}
+	CloseHandle( file );
+
+	if ( data != NULL ) {
+		length = (int)size.QuadPart;
+	}
+	return data;
+}
+
+/*
+========================
+Sys_UnmapFile
+========================
+*/
+void Sys_UnmapFile( const byte *data, int length ) {
+	if ( data != NULL ) {
+		UnmapViewOfFile( data );
+	}
+}
+
+/*
+========================
+Sys_AdviseMappedRange
+
+PrefetchVirtualMemory isn't available before Windows 8, rely on the default readahead
+========================
+*/
+void Sys_AdviseMappedRange( const byte *data, int length, bool willNeed ) {
+}
+
 /*
 ========================
 Sys_Rmdir
@@ -1208,6 +1263,15 @@ void Sys_Init() {
 		if ( win32.cpuid & CPUID_SSE3 ) {
 			string += "SSE3 & ";
 		}
+		if ( win32.cpuid & CPUID_AVX ) {
+			string += "AVX & ";
+		}
+		if ( win32.cpuid & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( win32.cpuid & CPUID_FMA3 ) {
+			string += "FMA3 & ";
+		}
 		if ( win32.cpuid & CPUID_HTT ) {
 			string += "HTT & ";
 		}
@@ -1237,6 +1301,12 @@ void Sys_Init() {
 				id |= CPUID_SSE2;
 			} else if ( token.Icmp( "sse3" ) == 0 ) {
 				id |= CPUID_SSE3;
+			} else if ( token.Icmp( "avx" ) == 0 ) {
+				id |= CPUID_AVX;
+			} else if ( token.Icmp( "avx2" ) == 0 ) {
+				id |= CPUID_AVX2;
+			} else if ( token.Icmp( "fma3" ) == 0 ) {
+				id |= CPUID_FMA3;
 			} else if ( token.Icmp( "htt" ) == 0 ) {
 				id |= CPUID_HTT;
 			}